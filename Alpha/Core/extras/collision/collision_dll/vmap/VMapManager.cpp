@@ -255,19 +255,14 @@ namespace VMAP
 		if( instanceTree == NULL )
 		{
 			instanceTree = new MapTree( pBasePath );
+			fullMemoryBarrier();
 			m_maps[pMapId] = instanceTree;
 		}
 
+		// the tree stays even if nothing could be loaded, only the destructor deletes
+		// it because queries on other threads may be using it
 		unsigned int mapTileIdent = MAP_TILE_IDENT(x,y);
 		result = instanceTree->loadMap(dirFileName, mapTileIdent);
-		if(!result)                                         // remove on fail
-		{
-			if(instanceTree->size() == 0)
-			{
-				m_maps[pMapId] = NULL;
-				delete instanceTree;
-			}
-		}
 		return(result);
     }
 
@@ -288,11 +283,6 @@ namespace VMAP
 
 			unsigned int mapTileIdent = MAP_TILE_IDENT(x,y);
 			instanceTree->unloadMap(dirFileName, mapTileIdent);
-			if(instanceTree->size() == 0)
-			{
-				m_maps[ pMapId ] = NULL;
-				delete instanceTree;
-			}
 		}
     }
 
@@ -305,11 +295,6 @@ namespace VMAP
             MapTree* instanceTree = m_maps[ pMapId ];
             std::string dirFileName = getDirFileName(pMapId);
             instanceTree->unloadMap(dirFileName, 0);
-            if(instanceTree->size() == 0)
-            {
-				m_maps[pMapId]=NULL;
-                delete instanceTree;
-            }
         }
     }
     //==========================================================
@@ -485,11 +470,28 @@ namespace VMAP
             iBasePath.append("/");
         }
         iTree = new AABSPTree<ModelContainer *>();
+        iSnapshot = NULL;
+        iStartingReaders = 0;
     }
 
     //=========================================================
     MapTree::~MapTree()
     {
+        // no queries are running any more
+        for(int i=0; i<iRetired.size(); ++i)
+        {
+            delete iRetired[i].iSnapshot;
+            iRetired[i].iUnloadedModels.deleteAll();
+        }
+        iRetired.clear();
+        delete iSnapshot;
+        for(int i=0; i<iChunks.size(); ++i)
+        {
+            if(iChunks[i]->decRefCount())
+                delete iChunks[i];
+        }
+        iChunks.clear();
+
         Array<ModelContainer *> mcArray;
         iTree->getMembers(mcArray);
         int no = mcArray.size();
@@ -500,6 +502,198 @@ namespace VMAP
         }
         delete iTree;
     }
+
+    //=========================================================
+
+    MapTreeSnapshot* MapTree::beginRead()
+    {
+        // Announce the reader before loading the pointer, freeRetiredSnapshots() checks the
+        // count after the swap. It is only held until the snapshot counts the query itself.
+        atomicIncrement(&iStartingReaders);
+        MapTreeSnapshot* snapshot = iSnapshot;
+        if(snapshot != NULL)
+        {
+            atomicIncrement(&snapshot->iReaders);
+        }
+        atomicDecrement(&iStartingReaders);
+        return snapshot;
+    }
+
+    //=========================================================
+
+    void MapTree::publishSnapshot(const Array<ModelContainer *>& pLoadedModels, const Array<ModelContainer *>& pUnloadedModels)
+    {
+        // only the chunks which lost models are rebuilt, over the ones they still have
+        if(pUnloadedModels.size() > 0)
+        {
+            std::set<ModelContainer *> unloaded;
+            for(int i=0; i<pUnloadedModels.size(); ++i)
+            {
+                unloaded.insert(pUnloadedModels[i]);
+            }
+
+            Array<MapTreeChunk *> chunks;
+            for(int i=0; i<iChunks.size(); ++i)
+            {
+                MapTreeChunk* chunk = iChunks[i];
+                const Array<ModelContainer *>& models = chunk->getModels();
+                Array<ModelContainer *> kept;
+                for(int j=0; j<models.size(); ++j)
+                {
+                    if(unloaded.find(models[j]) == unloaded.end())
+                    {
+                        kept.append(models[j]);
+                    }
+                }
+
+                if(kept.size() == models.size())
+                {
+                    chunks.append(chunk);
+                    continue;
+                }
+
+                if(kept.size() > 0)
+                {
+                    MapTreeChunk* rebuilt = new MapTreeChunk(kept);
+                    rebuilt->incRefCount();
+                    chunks.append(rebuilt);
+                }
+                if(chunk->decRefCount())
+                {
+                    delete chunk;
+                }
+            }
+            iChunks = chunks;
+        }
+
+        if(pLoadedModels.size() > 0)
+        {
+            MapTreeChunk* chunk = new MapTreeChunk(pLoadedModels);
+            chunk->incRefCount();
+            iChunks.append(chunk);
+        }
+
+        RetiredSnapshot retired;
+        retired.iSnapshot = iSnapshot;
+        retired.iUnloadedModels = pUnloadedModels;
+
+        MapTreeSnapshot* snapshot = (iChunks.size() > 0) ? new MapTreeSnapshot(iChunks) : NULL;
+        fullMemoryBarrier();
+        iSnapshot = snapshot;
+        fullMemoryBarrier();
+
+        if(retired.iSnapshot != NULL || retired.iUnloadedModels.size() > 0)
+            iRetired.append(retired);
+        freeRetiredSnapshots();
+    }
+
+    //=========================================================
+
+    void MapTree::freeRetiredSnapshots()
+    {
+        // A query that loaded a retired pointer but has not counted itself on it yet is
+        // a starting reader, so none of them means the counts of the retired snapshots are
+        // final. Readers that start now get the current one. Whatever is still in use is
+        // tried again on the next load or unload.
+        if(iRetired.size() == 0)
+            return;
+        fullMemoryBarrier();
+        if(iStartingReaders != 0)
+            return;
+
+        // Models unloaded with a snapshot can still be in the older ones, so they are
+        // freed oldest first and stop at the first one that is in use.
+        int freed = 0;
+        while(freed < iRetired.size())
+        {
+            RetiredSnapshot& retired = iRetired[freed];
+            if(retired.iSnapshot != NULL && retired.iSnapshot->iReaders != 0)
+                break;
+
+            delete retired.iSnapshot;
+            retired.iUnloadedModels.deleteAll();
+            ++freed;
+        }
+
+        if(freed > 0)
+        {
+            iRetired.remove(0, freed);
+        }
+    }
+
+    //=========================================================
+
+    MapTreeChunk::MapTreeChunk(const Array<ModelContainer *>& pModels)
+    {
+        iRefCount = 0;
+        iModels = pModels;
+        iTree.insert(pModels);
+        iTree.balance();
+    }
+
+    //=========================================================
+
+    MapTreeSnapshot::MapTreeSnapshot(const Array<MapTreeChunk *>& pChunks)
+    {
+        iReaders = 0;
+        iChunks = pChunks;
+        for(int i=0; i<iChunks.size(); ++i)
+        {
+            iChunks[i]->incRefCount();
+        }
+    }
+
+    //=========================================================
+
+    MapTreeSnapshot::~MapTreeSnapshot()
+    {
+        for(int i=0; i<iChunks.size(); ++i)
+        {
+            if(iChunks[i]->decRefCount())
+                delete iChunks[i];
+        }
+    }
+
+    //=========================================================
+
+    float MapTreeSnapshot::getIntersectionTime(const Ray& pRay, float pMaxDist, bool pStopAtFirstHit) const
+    {
+        float firstDistance = inf();
+        for(int i=0; i<iChunks.size(); ++i)
+        {
+            float t = iChunks[i]->getIntersectionTime(pRay, pMaxDist, pStopAtFirstHit);
+            if(t < firstDistance)
+            {
+                firstDistance = t;
+                if(pStopAtFirstHit && t < inf()) break;
+            }
+        }
+        return firstDistance;
+    }
+
+    //=========================================================
+
+    bool MapTreeSnapshot::isInDoors(const Vector3& pos) const
+    {
+        for(int i=0; i<iChunks.size(); ++i)
+        {
+            if(iChunks[i]->isInDoors(pos))
+                return true;
+        }
+        return false;
+    }
+
+    //=========================================================
+
+    bool MapTreeSnapshot::isOutDoors(const Vector3& pos) const
+    {
+        for(int i=0; i<iChunks.size(); ++i)
+        {
+            if(!iChunks[i]->isOutDoors(pos))
+                return false;
+        }
+        return true;
+    }
     //=========================================================
 
     // just for visual debugging with an external debug class
@@ -518,12 +712,12 @@ namespace VMAP
     return dist to hit or inf() if no hit
     */
 
-    float MapTree::getIntersectionTime(const Ray& pRay, float pMaxDist, bool pStopAtFirstHit)
+    float MapTreeChunk::getIntersectionTime(const Ray& pRay, float pMaxDist, bool pStopAtFirstHit) const
     {
         double  firstDistance = inf();
 
-        const IT end = iTree->endRayIntersection();
-        IT obj = iTree->beginRayIntersection(pRay, pMaxDist);
+        const IT end = iTree.endRayIntersection();
+        IT obj = iTree.beginRayIntersection(pRay, pMaxDist);
 
         for ( ;obj != end; ++obj)                           // (preincrement is *much* faster than postincrement!)
         {
@@ -560,7 +754,7 @@ namespace VMAP
     }
     //=========================================================
 
-    bool MapTree::isInLineOfSight(const Vector3& pos1, const Vector3& pos2)
+    bool MapTreeSnapshot::isInLineOfSight(const Vector3& pos1, const Vector3& pos2) const
     {
         bool result = true;
         float maxDist = abs((pos2 - pos1).magnitude());
@@ -578,7 +772,7 @@ namespace VMAP
     Return the hit pos or the original dest pos
     */
 
-    bool MapTree::getObjectHitPos(const Vector3& pPos1, const Vector3& pPos2, Vector3& pResultHitPos, float pModifyDist)
+    bool MapTreeSnapshot::getObjectHitPos(const Vector3& pPos1, const Vector3& pPos2, Vector3& pResultHitPos, float pModifyDist) const
     {
         bool result;
         float maxDist = abs((pPos2 - pPos1).magnitude());
@@ -615,7 +809,7 @@ namespace VMAP
 
     //=========================================================
 
-    float MapTree::getHeight(const Vector3& pPos)
+    float MapTreeSnapshot::getHeight(const Vector3& pPos) const
     {
         float height = inf();
         Vector3 dir = Vector3(0,-1,0);
@@ -629,7 +823,7 @@ namespace VMAP
     }
 
 	//=========================================================
-	bool MapTree::isInDoors(const Vector3& pos)
+	bool MapTreeChunk::isInDoors(const Vector3& pos) const
 	{
 		Vector3 dir = Vector3(0,-1,0);
 		Ray ray = Ray::fromOriginAndDirection(pos, dir);   // direction with length of 1
@@ -642,8 +836,8 @@ namespace VMAP
 		ModelContainer * mc;
 		SubModel * sm;
 
-		MITR = iTree->beginRayIntersection( ray, MAX_CAN_FALL_DISTANCE );
-		MITREND = iTree->endRayIntersection();
+		MITR = iTree.beginRayIntersection( ray, MAX_CAN_FALL_DISTANCE );
+		MITREND = iTree.endRayIntersection();
 
 		for(; MITR != MITREND; ++MITR)
 		{
@@ -705,7 +899,7 @@ namespace VMAP
 		return false;
 	}
 
-	bool MapTree::isOutDoors(const Vector3& pos)
+	bool MapTreeChunk::isOutDoors(const Vector3& pos) const
 	{
 		Vector3 dir = Vector3(0,-1,0);
 		Ray ray = Ray::fromOriginAndDirection(pos, dir);   // direction with length of 1
@@ -718,8 +912,8 @@ namespace VMAP
 		ModelContainer * mc;
 		SubModel * sm;
 
-		MITR = iTree->beginRayIntersection( ray, MAX_CAN_FALL_DISTANCE );
-		MITREND = iTree->endRayIntersection();
+		MITR = iTree.beginRayIntersection( ray, MAX_CAN_FALL_DISTANCE );
+		MITREND = iTree.endRayIntersection();
 
 		for(; MITR != MITREND; ++MITR)
 		{
@@ -783,6 +977,77 @@ namespace VMAP
 
     //=========================================================
 
+    bool MapTree::isInLineOfSight(const Vector3& pos1, const Vector3& pos2)
+    {
+        bool result = true;
+        MapTreeSnapshot* snapshot = beginRead();
+        if(snapshot != NULL)
+        {
+            result = snapshot->isInLineOfSight(pos1, pos2);
+        }
+        endRead(snapshot);
+        return result;
+    }
+
+    //=========================================================
+
+    bool MapTree::getObjectHitPos(const Vector3& pPos1, const Vector3& pPos2, Vector3& pResultHitPos, float pModifyDist)
+    {
+        bool result = false;
+        pResultHitPos = pPos2;
+        MapTreeSnapshot* snapshot = beginRead();
+        if(snapshot != NULL)
+        {
+            result = snapshot->getObjectHitPos(pPos1, pPos2, pResultHitPos, pModifyDist);
+        }
+        endRead(snapshot);
+        return result;
+    }
+
+    //=========================================================
+
+    float MapTree::getHeight(const Vector3& pPos)
+    {
+        float height = inf();
+        MapTreeSnapshot* snapshot = beginRead();
+        if(snapshot != NULL)
+        {
+            height = snapshot->getHeight(pPos);
+        }
+        endRead(snapshot);
+        return height;
+    }
+
+    //=========================================================
+
+    bool MapTree::isInDoors(const Vector3& pos)
+    {
+        bool result = false;
+        MapTreeSnapshot* snapshot = beginRead();
+        if(snapshot != NULL)
+        {
+            result = snapshot->isInDoors(pos);
+        }
+        endRead(snapshot);
+        return result;
+    }
+
+    //=========================================================
+
+    bool MapTree::isOutDoors(const Vector3& pos)
+    {
+        bool result = true;
+        MapTreeSnapshot* snapshot = beginRead();
+        if(snapshot != NULL)
+        {
+            result = snapshot->isOutDoors(pos);
+        }
+        endRead(snapshot);
+        return result;
+    }
+
+    //=========================================================
+
     bool MapTree::loadMap(const std::string& pDirFileName, unsigned int pMapTileIdent)
     {
         bool result = true;
@@ -798,7 +1063,7 @@ namespace VMAP
             {
                 char lineBuffer[FILENAMEBUFFER_SIZE];
                 result = true;
-                bool newModelLoaded = false;
+                Array<ModelContainer *> loadedModels;
                 while(result && (fgets(lineBuffer, FILENAMEBUFFER_SIZE-1, df) != 0))
                 {
                     std::string name = std::string(lineBuffer);
@@ -816,7 +1081,7 @@ namespace VMAP
                             if(result)
                             {
                                 addModelConatiner(name, mc);
-                                newModelLoaded = true;
+                                loadedModels.append(mc);
                             }
 							else
 								delete mc;
@@ -828,9 +1093,9 @@ namespace VMAP
                         mc->incRefCount();
                     }
                 }
-                if(result && newModelLoaded)
+                if(loadedModels.size() > 0)
                 {
-                    iTree->balance();
+                    publishSnapshot(loadedModels, Array<ModelContainer *>());
                 }
                 if(result && ferror(df) != 0)
                 {
@@ -872,7 +1137,7 @@ namespace VMAP
             if(filesInDir.getRefCount() <= 0)
             {
                 Array<std::string> fileNames = filesInDir.getFiles();
-                bool treeChanged = false;
+                Array<ModelContainer *> unloadedModels;
                 for(int i=0; i<fileNames.size(); ++i)
                 {
                     std::string name = fileNames[i];
@@ -880,16 +1145,16 @@ namespace VMAP
                     mc->decRefCount();
                     if(mc->getRefCount() <= 0)
                     {
+                        // deleted once no query can see it any more
                         iLoadedModelContainer.remove(name);
                         iTree->remove(mc);
-                        delete mc;
-                        treeChanged = true;
+                        unloadedModels.append(mc);
                     }
                 }
                 iLoadedDirFiles.remove(dirFileName);
-                if(treeChanged)
+                if(unloadedModels.size() > 0)
                 {
-                    iTree->balance();
+                    publishSnapshot(Array<ModelContainer *>(), unloadedModels);
                 }
             }
         }
@@ -27,6 +27,7 @@
 #include "../LocationVector.h"
 
 #include <G3D/Table.h>
+#include <set>
 
 //===========================================================
 
@@ -70,11 +71,120 @@ namespace VMAP
     //===========================================================
     //===========================================================
 
+    inline long atomicIncrement(volatile long* pValue)
+    {
+#ifdef WIN32
+        return InterlockedIncrement(pValue);
+#else
+        return __sync_add_and_fetch(pValue, 1);
+#endif
+    }
+
+    inline long atomicDecrement(volatile long* pValue)
+    {
+#ifdef WIN32
+        return InterlockedDecrement(pValue);
+#else
+        return __sync_sub_and_fetch(pValue, 1);
+#endif
+    }
+
+    inline void fullMemoryBarrier()
+    {
+#ifdef WIN32
+        MemoryBarrier();
+#else
+        __sync_synchronize();
+#endif
+    }
+
+    //===========================================================
+    /**
+    Balanced tree over the models one loadMap() call added. It is never changed after it was
+    built, so any number of threads can query it at once and snapshots can share it.
+    */
+
+    class MapTreeChunk
+    {
+        private:
+            AABSPTree<ModelContainer *> iTree;
+            Array<ModelContainer *> iModels;
+            // snapshots and the map tree using it, only changed by the loading thread
+            int iRefCount;
+        public:
+            MapTreeChunk(const Array<ModelContainer *>& pModels);
+
+            const Array<ModelContainer *>& getModels() const { return iModels; }
+            void incRefCount() { ++iRefCount; }
+            bool decRefCount() { return (--iRefCount == 0); }
+
+            float getIntersectionTime(const Ray& pRay, float pMaxDist, bool pStopAtFirstHit) const;
+            bool isInDoors(const Vector3& pos) const;
+            bool isOutDoors(const Vector3& pos) const;
+    };
+
+    //===========================================================
+    /**
+    The chunks a map had loaded at one point in time. Publishing a new one only builds the
+    chunks that changed, the others are shared with the previous snapshot.
+    */
+
+    class MapTreeSnapshot
+    {
+        private:
+            Array<MapTreeChunk *> iChunks;
+
+            float getIntersectionTime(const Ray& pRay, float pMaxDist, bool pStopAtFirstHit) const;
+        public:
+            // queries running on it
+            volatile long iReaders;
+
+            MapTreeSnapshot(const Array<MapTreeChunk *>& pChunks);
+            ~MapTreeSnapshot();
+
+            bool isInLineOfSight(const Vector3& pos1, const Vector3& pos2) const;
+            bool getObjectHitPos(const Vector3& pos1, const Vector3& pos2, Vector3& pResultHitPos, float pModifyDist) const;
+            bool isInDoors(const Vector3& pos) const;
+            bool isOutDoors(const Vector3& pos) const;
+            float getHeight(const Vector3& pPos) const;
+    };
+
+    //===========================================================
+    /**
+    A snapshot which was replaced, together with the models only it still refers to.
+    */
+
+    class RetiredSnapshot
+    {
+        public:
+            MapTreeSnapshot* iSnapshot;
+            Array<ModelContainer *> iUnloadedModels;
+    };
+
+    //===========================================================
+    /**
+    Queries read the current snapshot without locking. loadMap() and unloadMap() change the
+    model set, publish a new snapshot and retire the old one; the caller has to make sure only
+    one thread does that at a time. A retired snapshot is freed once the queries which started
+    on it are done, together with the models unloaded when it was replaced.
+    */
+
     class MapTree
     {
         private:
+            // models of the loaded tiles, only used by loadMap() and unloadMap()
             AABSPTree<ModelContainer *> *iTree;
 
+            // chunks of the current snapshot
+            Array<MapTreeChunk *> iChunks;
+
+            // what the queries use
+            MapTreeSnapshot* volatile iSnapshot;
+            // queries between loading iSnapshot and counting themselves on it
+            volatile long iStartingReaders;
+            // oldest first
+            Array<RetiredSnapshot> iRetired;
+
             // Key: filename, value ModelContainer
             Table<std::string, ManagedModelContainer *> iLoadedModelContainer;
 
@@ -87,14 +197,16 @@ namespace VMAP
             std::string iBasePath;
 
         private:
-            float getIntersectionTime(const Ray& pRay, float pMaxDist, bool pStopAtFirstHit);
             bool isAlreadyLoaded(const std::string& pName) { return(iLoadedModelContainer.containsKey(pName)); }
-            RayIntersectionIterator<AABSPTree<ModelContainer*>::Node, ModelContainer*> beginRayIntersection(const Ray& ray, bool skipAABoxTests = false) const;
-            RayIntersectionIterator<AABSPTree<ModelContainer*>::Node, ModelContainer*> endRayIntersection() const;
             void setLoadedMapTile(unsigned int pTileIdent) { iLoadedMapTiles.set(pTileIdent, true); }
             void removeLoadedMapTile(unsigned int pTileIdent) { iLoadedMapTiles.remove(pTileIdent); }
             bool hasLoadedMapTiles() { return(iLoadedMapTiles.size() > 0); }
             bool containsLoadedMapTile(unsigned int pTileIdent) { return(iLoadedMapTiles.containsKey(pTileIdent)); }
+
+            MapTreeSnapshot* beginRead();
+            void endRead(MapTreeSnapshot* pSnapshot) { if(pSnapshot != NULL) atomicDecrement(&pSnapshot->iReaders); }
+            void publishSnapshot(const Array<ModelContainer *>& pLoadedModels, const Array<ModelContainer *>& pUnloadedModels);
+            void freeRetiredSnapshots();
         public:
             ManagedModelContainer *getModelContainer(const std::string& pName) { return(iLoadedModelContainer.get(pName)); }
             const bool hasDirFile(const std::string& pDirName) const { return(iLoadedDirFiles.containsKey(pDirName)); }
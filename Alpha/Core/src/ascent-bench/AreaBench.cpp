@@ -0,0 +1,240 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// AreaBench.cpp
+//
+// Area spell target searches in a crowded zone. The fillers used to walk the
+// caster's whole in-range set and distance test every member, they now gather
+// the units of the cells around both the spot and the caster, filter them with
+// MapMgr::FilterPointsInRange and keep the ones in the caster's in-range set.
+//
+
+#include "Bench.h"
+
+#define AREA_BENCH_SIZE 600.0f
+#define AREA_BENCH_VISIBILITY 100.0f
+#define AREA_BENCH_SPOT 30.0f
+#define AREA_BENCH_MIN_RADIUS 8.0f
+#define AREA_BENCH_MAX_RADIUS 30.0f
+#define AREA_BENCH_GRID ((uint32)(AREA_BENCH_SIZE / _cellSize) + 1)
+
+// same slack as MapMgr::GetUnitsInRange
+#define AREA_BENCH_CELL_SLACK 5.0f
+
+struct AreaBenchObject
+{
+	float x, y, z;
+	bool unit;
+
+	IndexedObjectSet<AreaBenchObject> inRange;
+};
+
+struct AreaBenchCast
+{
+	uint32 caster;
+	float x, y, z;
+	float radius;
+};
+
+/** One zone, both searches run over the same objects and casts.
+ */
+class AreaBenchWorld
+{
+public:
+	AreaBenchWorld(uint32 count, uint32 casts, uint32 seed) : m_objects(count), m_cells(AREA_BENCH_GRID * AREA_BENCH_GRID)
+	{
+		BenchRandom rnd(seed);
+		uint32 i, j;
+
+		// one in five objects is a gameobject, they are in the in-range sets but never hit
+		for(i = 0; i < count; ++i)
+		{
+			m_objects[i].x = rnd.Float(AREA_BENCH_SIZE);
+			m_objects[i].y = rnd.Float(AREA_BENCH_SIZE);
+			m_objects[i].z = rnd.Float(10.0f);
+			m_objects[i].unit = (rnd.Next() % 5) != 0;
+			if(m_objects[i].unit)
+				m_cells[_Cell(m_objects[i].x, m_objects[i].y)].push_back(&m_objects[i]);
+		}
+
+		for(i = 0; i < count; ++i)
+		{
+			for(j = i + 1; j < count; ++j)
+			{
+				if(_DistanceSq(&m_objects[i], m_objects[j].x, m_objects[j].y, m_objects[j].z) <= AREA_BENCH_VISIBILITY * AREA_BENCH_VISIBILITY)
+				{
+					m_objects[i].inRange.insert(&m_objects[j]);
+					m_objects[j].inRange.insert(&m_objects[i]);
+				}
+			}
+		}
+
+		m_casts.resize(casts);
+		for(i = 0; i < casts; ++i)
+		{
+			AreaBenchCast & c = m_casts[i];
+			do
+			{
+				c.caster = rnd.Next() % count;
+			} while(!m_objects[c.caster].unit);
+
+			c.x = m_objects[c.caster].x + rnd.Float(AREA_BENCH_SPOT * 2.0f) - AREA_BENCH_SPOT;
+			c.y = m_objects[c.caster].y + rnd.Float(AREA_BENCH_SPOT * 2.0f) - AREA_BENCH_SPOT;
+			c.z = m_objects[c.caster].z;
+			c.radius = AREA_BENCH_MIN_RADIUS + rnd.Float(AREA_BENCH_MAX_RADIUS - AREA_BENCH_MIN_RADIUS);
+		}
+	}
+
+	ASCENT_INLINE size_t GetCastCount() { return m_casts.size(); }
+
+	/** The fillers before the cell query, returns the number of targets found.
+	 */
+	uint64 SearchInRangeSet()
+	{
+		uint64 targets = 0;
+		for(size_t i = 0; i < m_casts.size(); ++i)
+		{
+			AreaBenchCast & c = m_casts[i];
+			AreaBenchObject * caster = &m_objects[c.caster];
+			float r = c.radius * c.radius;
+
+			for(IndexedObjectSet<AreaBenchObject>::iterator itr = caster->inRange.begin(); itr != caster->inRange.end(); ++itr)
+			{
+				if(!(*itr)->unit)
+					continue;
+
+				if(_DistanceSq(*itr, c.x, c.y, c.z) <= r)
+					++targets;
+			}
+		}
+		return targets;
+	}
+
+	/** MapMgr::GetUnitsInRange, returns the number of targets found.
+	 */
+	uint64 SearchCells()
+	{
+		uint64 targets = 0;
+		for(size_t i = 0; i < m_casts.size(); ++i)
+		{
+			AreaBenchCast & c = m_casts[i];
+			AreaBenchObject * caster = &m_objects[c.caster];
+			float pad = c.radius + AREA_BENCH_CELL_SLACK;
+
+			m_units.clear();
+			uint32 casterX = _GridPos(caster->x);
+			uint32 casterY = _GridPos(caster->y);
+			uint32 startX = max(_GridPos(c.x - pad), casterX > 0 ? casterX - 1 : 0);
+			uint32 endX = min(_GridPos(c.x + pad), casterX + 1);
+			uint32 startY = max(_GridPos(c.y - pad), casterY > 0 ? casterY - 1 : 0);
+			uint32 endY = min(_GridPos(c.y + pad), casterY + 1);
+			for(uint32 cx = startX; cx <= endX; ++cx)
+			{
+				for(uint32 cy = startY; cy <= endY; ++cy)
+				{
+					vector<AreaBenchObject*> & cell = m_cells[cx * AREA_BENCH_GRID + cy];
+					m_units.insert(m_units.end(), cell.begin(), cell.end());
+				}
+			}
+
+			size_t count = m_units.size();
+			if(count == 0)
+				continue;
+
+			if(m_x.size() < count)
+			{
+				m_x.resize(count);
+				m_y.resize(count);
+				m_z.resize(count);
+				m_hit.resize(count);
+			}
+
+			for(size_t j = 0; j < count; ++j)
+			{
+				m_x[j] = m_units[j]->x;
+				m_y[j] = m_units[j]->y;
+				m_z[j] = m_units[j]->z;
+			}
+
+			MapMgr::FilterPointsInRange(&m_x[0], &m_y[0], &m_z[0], count, c.x, c.y, c.z, c.radius, &m_hit[0]);
+
+			for(size_t j = 0; j < count; ++j)
+			{
+				// the in-range set does not hold the caster itself
+				if(m_hit[j] && m_units[j] != caster && caster->inRange.count(m_units[j]))
+					++targets;
+			}
+		}
+		return targets;
+	}
+
+private:
+	ASCENT_INLINE static float _DistanceSq(AreaBenchObject * o, float x, float y, float z)
+	{
+		float dx = o->x - x;
+		float dy = o->y - y;
+		float dz = o->z - z;
+		return dx*dx + dy*dy + dz*dz;
+	}
+
+	ASCENT_INLINE static uint32 _GridPos(float c)
+	{
+		if(c <= 0.0f)
+			return 0;
+		return min((uint32)(c / _cellSize), AREA_BENCH_GRID - 1);
+	}
+
+	ASCENT_INLINE static uint32 _Cell(float x, float y)
+	{
+		return _GridPos(x) * AREA_BENCH_GRID + _GridPos(y);
+	}
+
+	vector<AreaBenchObject> m_objects;
+	vector< vector<AreaBenchObject*> > m_cells;
+	vector<AreaBenchCast> m_casts;
+
+	vector<AreaBenchObject*> m_units;
+	vector<float> m_x;
+	vector<float> m_y;
+	vector<float> m_z;
+	vector<uint8> m_hit;
+};
+
+void BenchArea(BenchOptions & opt)
+{
+	uint32 count = opt.count ? opt.count : 2000;
+	uint32 casts = opt.steps ? opt.steps : 100000;
+	uint64 start, targets;
+
+	printf("area: %u objects in %.0fx%.0f yards, visibility %.0f, %u casts of %.0f - %.0f yards\n", count, AREA_BENCH_SIZE, AREA_BENCH_SIZE,
+		AREA_BENCH_VISIBILITY, casts, AREA_BENCH_MIN_RADIUS, AREA_BENCH_MAX_RADIUS);
+
+	AreaBenchWorld world(count, casts, opt.seed);
+
+	start = BenchMicroTime();
+	targets = world.SearchInRangeSet();
+	BenchReport("area", "in-range set walk", BenchMicroTime() - start, world.GetCastCount());
+	printf("%-14s %-28s %10u targets\n", "", "", (uint32)targets);
+
+	start = BenchMicroTime();
+	targets = world.SearchCells();
+	BenchReport("area", "cells + packed filter", BenchMicroTime() - start, world.GetCastCount());
+	printf("%-14s %-28s %10u targets\n", "", "", (uint32)targets);
+}
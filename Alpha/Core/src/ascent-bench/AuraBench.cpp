@@ -0,0 +1,135 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// AuraBench.cpp
+//
+// The periodic ticks of a busy map's auras, once as a timed event per tick on the
+// aura like they used to be and once in the map's PeriodicAuraScheduler.
+//
+
+#include "Bench.h"
+
+#define AURA_BENCH_INSTANCE 2
+#define AURA_BENCH_UPDATE 100
+
+/** Counts the ticks instead of firing them. No combat log is written, so nothing is ever sent.
+ */
+class BenchAuraHandler : public PeriodicAuraHandler
+{
+public:
+	BenchAuraHandler() : m_ticks(0) {}
+
+	void FirePeriodicTick(Aura * aura, uint8 tick) { ++m_ticks; }
+	void SendPeriodicAuraLog(const uint64 & sender, WorldPacket * data) {}
+
+	uint64 m_ticks;
+};
+
+class BenchAuraObject : public EventableObject
+{
+public:
+	BenchAuraObject() : m_ticks(0) {}
+
+	int32 event_GetInstanceID() { return AURA_BENCH_INSTANCE; }
+	void Tick(uint32 tick) { ++m_ticks; }
+
+	uint64 m_ticks;
+};
+
+/** Damage and heal over time effects mostly tick every 1 - 3 seconds, a few every 5.
+ */
+static void GetBenchAura(BenchRandom & rnd, uint32 * ticks, uint32 * period)
+{
+	static const uint32 periods[] = { 1000, 2000, 3000, 3000, 3000, 5000 };
+	*ticks = 1 + rnd.Next() % MAX_AURA_PERIODIC_TICKS;
+	*period = periods[rnd.Next() % (sizeof(periods) / sizeof(periods[0]))];
+}
+
+void BenchAuras(BenchOptions & opt)
+{
+	uint32 count = opt.count ? opt.count : 30000;
+	uint32 steps = opt.steps ? opt.steps : 600;
+	uint32 ticks, period, scheduled;
+	uint64 start, fired;
+	uint32 i, j;
+
+	printf("auras: %u auras with 1 - %u ticks, %u updates of %ums\n", count, MAX_AURA_PERIODIC_TICKS, steps, AURA_BENCH_UPDATE);
+
+	if(EventMgr::getSingletonPtr() == NULL)
+		new EventMgr;
+
+	// a timed event per tick
+	{
+		vector<BenchAuraObject*> auras(count);
+		EventableObjectHolder * holder = new EventableObjectHolder(AURA_BENCH_INSTANCE);
+		BenchRandom rnd(opt.seed);
+
+		scheduled = 0;
+		for(i = 0; i < count; ++i)
+		{
+			auras[i] = new BenchAuraObject;
+			GetBenchAura(rnd, &ticks, &period);
+			for(j = 0; j < ticks; ++j)
+				sEventMgr.AddEvent(auras[i], &BenchAuraObject::Tick, j, EVENT_AURA_PERIODIC_DAMAGE + j, period, 0, EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+			scheduled += ticks;
+		}
+
+		start = BenchMicroTime();
+		for(i = 0; i < steps; ++i)
+			holder->Update(AURA_BENCH_UPDATE);
+
+		BenchReport("auras", "timed event per tick", BenchMicroTime() - start, steps);
+
+		fired = 0;
+		for(i = 0; i < count; ++i)
+		{
+			fired += auras[i]->m_ticks;
+			delete auras[i];
+		}
+		printf("%-14s %-28s %10u ticks of %u scheduled\n", "", "", (uint32)fired, scheduled);
+		delete holder;
+	}
+
+	// PeriodicAuraScheduler
+	{
+		// the scheduler only keeps the pointers and hands them to the handler
+		vector<uint64> auras(count);
+		BenchAuraHandler handler;
+		PeriodicAuraScheduler * scheduler = new PeriodicAuraScheduler;
+		BenchRandom rnd(opt.seed);
+
+		scheduler->SetHandler(&handler);
+
+		for(i = 0; i < count; ++i)
+		{
+			GetBenchAura(rnd, &ticks, &period);
+			for(j = 0; j < ticks; ++j)
+				scheduler->Add((Aura*)&auras[i], (uint8)j, period, period);
+		}
+
+		start = BenchMicroTime();
+		for(i = 0; i < steps; ++i)
+			scheduler->Update(AURA_BENCH_UPDATE);
+
+		BenchReport("auras", "PeriodicAuraScheduler", BenchMicroTime() - start, steps);
+		printf("%-14s %-28s %10u ticks of %u scheduled\n", "", "", (uint32)handler.m_ticks, scheduler->GetScheduledCount());
+		delete scheduler;
+	}
+}
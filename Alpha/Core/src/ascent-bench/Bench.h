@@ -0,0 +1,77 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// Bench.h
+//
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include "StdAfx.h"
+
+/** Command line options of ascent-bench. Zero counts pick the default of the benchmark.
+ */
+struct BenchOptions
+{
+	BenchOptions() : count(0), steps(0), seed(1), config(NULL) {}
+
+	uint32 count;
+	uint32 steps;
+	uint32 seed;
+	const char * config;		// world config for the benchmarks which need the database
+};
+
+/** Small deterministic generator, so both sides of a benchmark see the same input.
+ */
+class BenchRandom
+{
+public:
+	BenchRandom(uint32 seed) : m_state(seed ? seed : 1) {}
+
+	ASCENT_INLINE uint32 Next()
+	{
+		m_state = m_state * 1664525 + 1013904223;
+		return m_state >> 8;
+	}
+
+	/** Uniform in [0, range). */
+	ASCENT_INLINE float Float(float range) { return range * (float)(Next() & 0xFFFF) / 65536.0f; }
+
+private:
+	uint32 m_state;
+};
+
+typedef void (*BenchFunction)(BenchOptions & opt);
+
+uint64 BenchMicroTime();
+
+/** Prints the time per operation of one side of a benchmark.
+ */
+void BenchReport(const char * bench, const char * path, uint64 microseconds, uint64 operations);
+
+void BenchInRange(BenchOptions & opt);
+void BenchEvents(BenchOptions & opt);
+void BenchDatabase(BenchOptions & opt);
+void BenchTerrain(BenchOptions & opt);
+void BenchArea(BenchOptions & opt);
+void BenchFaction(BenchOptions & opt);
+void BenchAuras(BenchOptions & opt);
+
+#endif
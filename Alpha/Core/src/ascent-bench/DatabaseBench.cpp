@@ -0,0 +1,137 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// DatabaseBench.cpp
+//
+// Reads whole world tables the way the storage loaders do, once through text
+// queries and once through prepared statements with binary rows. Needs the
+// WorldDatabase section of a world config, given with -c.
+//
+
+#include "Bench.h"
+
+#define DATABASE_BENCH_PASSES 3
+
+static const char * m_tables[] = { "creature_spawns", "items", "creature_proto", NULL };
+
+/** Touches every field of every row like a loader filling its structures.
+ */
+static uint64 ReadRows(QueryResult * result, uint32 * checksum)
+{
+	uint64 rows = 0;
+	if(result == NULL)
+		return 0;
+
+	uint32 fields = result->GetFieldCount();
+	do
+	{
+		Field * f = result->Fetch();
+		for(uint32 i = 0; i < fields; ++i)
+			*checksum += f[i].GetUInt32();
+		++rows;
+	} while(result->NextRow());
+
+	result->Delete();
+	return rows;
+}
+
+static void BenchTable(Database * db, const char * table, uint32 passes)
+{
+	uint32 checksum = 0;
+	uint64 rows = 0;
+	uint64 start;
+	uint32 i;
+	char sql[256];
+
+	start = BenchMicroTime();
+	for(i = 0; i < passes; ++i)
+		rows += ReadRows(db->Query("SELECT * FROM %s", table), &checksum);
+
+	if(rows == 0)
+	{
+		printf("database: %s is empty or missing, skipped\n", table);
+		return;
+	}
+
+	BenchReport(table, "text query", BenchMicroTime() - start, rows);
+	printf("%-14s %-28s %10u rows, checksum %08X\n", "", "", (uint32)(rows / passes), checksum);
+
+	snprintf(sql, sizeof(sql), "SELECT * FROM %s", table);
+	uint32 id = db->PrepareStatement(sql);
+
+	checksum = 0;
+	rows = 0;
+	start = BenchMicroTime();
+	for(i = 0; i < passes; ++i)
+	{
+		PreparedStatement stmt(id);
+		rows += ReadRows(db->QueryPrepared(&stmt), &checksum);
+	}
+
+	BenchReport(table, "prepared statement", BenchMicroTime() - start, rows);
+	printf("%-14s %-28s %10u rows, checksum %08X\n", "", "", (uint32)(rows / passes), checksum);
+}
+
+void BenchDatabase(BenchOptions & opt)
+{
+	string hostname, username, password, database;
+	int port = 0;
+	int type = 1;
+
+	if(opt.config == NULL)
+	{
+		printf("database: no world config given with -c, skipped\n");
+		return;
+	}
+
+	if(!Config.MainConfig.SetSource(opt.config))
+	{
+		printf("database: could not read %s, skipped\n", opt.config);
+		return;
+	}
+
+	bool result = Config.MainConfig.GetString("WorldDatabase", "Username", &username);
+	Config.MainConfig.GetString("WorldDatabase", "Password", &password);
+	result = !result ? result : Config.MainConfig.GetString("WorldDatabase", "Hostname", &hostname);
+	result = !result ? result : Config.MainConfig.GetString("WorldDatabase", "Name", &database);
+	result = !result ? result : Config.MainConfig.GetInt("WorldDatabase", "Port", &port);
+	Config.MainConfig.GetInt("WorldDatabase", "Type", &type);
+	if(!result)
+	{
+		printf("database: WorldDatabase directive is incomplete in %s, skipped\n", opt.config);
+		return;
+	}
+
+	uint32 passes = opt.steps ? opt.steps : DATABASE_BENCH_PASSES;
+	printf("database: %s on %s, %u passes over each table\n", database.c_str(), hostname.c_str(), passes);
+
+	ThreadPool.Startup();
+	Database * db = Database::CreateDatabaseInterface(type);
+	if(db->Initialize(hostname.c_str(), (unsigned int)port, username.c_str(), password.c_str(), database.c_str(), 2, 16384))
+	{
+		for(uint32 i = 0; m_tables[i] != NULL; ++i)
+			BenchTable(db, m_tables[i], passes);
+		db->EndThreads();
+	}
+	else
+		printf("database: could not connect, skipped\n");
+
+	delete db;
+}
@@ -0,0 +1,195 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// EventBench.cpp
+//
+// A map's worth of respawn timers, aura ticks and AI events, updated every 100ms
+// by the EventableObjectHolder timer wheel and by the list walk it replaced.
+//
+
+#include "Bench.h"
+
+#define EVENT_BENCH_INSTANCE 1
+#define EVENT_BENCH_PER_OBJECT 10
+#define EVENT_BENCH_UPDATE 100
+
+class BenchEventObject : public EventableObject
+{
+public:
+	BenchEventObject() : m_ticks(0) {}
+
+	int32 event_GetInstanceID() { return EVENT_BENCH_INSTANCE; }
+	void Tick() { ++m_ticks; }
+
+	uint64 m_ticks;
+};
+
+/** EventableObjectHolder::Update as it was before the timer wheel: every event is
+ * visited and counted down on every update.
+ */
+class BenchListHolder
+{
+public:
+	~BenchListHolder()
+	{
+		for(EventList::iterator itr = m_events.begin(); itr != m_events.end(); ++itr)
+			(*itr)->DecRef();
+	}
+
+	void AddEvent(TimedEvent * ev)
+	{
+		ev->IncRef();
+		m_events.push_back(ev);
+	}
+
+	void Update(uint32 time_difference)
+	{
+		EventList::iterator itr = m_events.begin();
+		EventList::iterator it2;
+		TimedEvent * ev;
+
+		while(itr != m_events.end())
+		{
+			it2 = itr++;
+			ev = *it2;
+			if(ev->deleted)
+			{
+				ev->DecRef();
+				m_events.erase(it2);
+				continue;
+			}
+
+			if((uint32)ev->currTime <= time_difference)
+			{
+				ev->cb->execute();
+				if(ev->repeats && --ev->repeats == 0)
+				{
+					ev->deleted = true;
+					ev->DecRef();
+					m_events.erase(it2);
+					continue;
+				}
+
+				ev->currTime = ev->msTime;
+			}
+			else
+				ev->currTime -= time_difference;
+		}
+	}
+
+private:
+	EventList m_events;
+};
+
+/** Respawn timers are long one-shot events, aura ticks and AI events repeat. */
+static void GetBenchEvent(BenchRandom & rnd, uint32 * time, uint32 * repeats)
+{
+	uint32 kind = rnd.Next() % 10;
+	if(kind < 6)
+	{
+		*time = 60000 + rnd.Next() % 540000;
+		*repeats = 1;
+	}
+	else if(kind < 9)
+	{
+		*time = 1000 + rnd.Next() % 4000;
+		*repeats = 0;
+	}
+	else
+	{
+		*time = 100 + rnd.Next() % 900;
+		*repeats = 0;
+	}
+}
+
+static uint64 CountTicks(vector<BenchEventObject*> & objects)
+{
+	uint64 ticks = 0;
+	for(size_t i = 0; i < objects.size(); ++i)
+		ticks += objects[i]->m_ticks;
+	return ticks;
+}
+
+void BenchEvents(BenchOptions & opt)
+{
+	uint32 count = opt.count ? opt.count : 100000;
+	uint32 steps = opt.steps ? opt.steps : 600;
+	uint32 objects = (count + EVENT_BENCH_PER_OBJECT - 1) / EVENT_BENCH_PER_OBJECT;
+	uint32 time, repeats;
+	uint64 start;
+
+	printf("events: %u events on %u objects, %u updates of %ums\n", count, objects, steps, EVENT_BENCH_UPDATE);
+
+	if(EventMgr::getSingletonPtr() == NULL)
+		new EventMgr;
+
+	// list walk
+	{
+		vector<BenchEventObject*> obj(objects);
+		BenchListHolder holder;
+		BenchRandom rnd(opt.seed);
+		for(uint32 i = 0; i < objects; ++i)
+			obj[i] = new BenchEventObject;
+
+		for(uint32 i = 0; i < count; ++i)
+		{
+			GetBenchEvent(rnd, &time, &repeats);
+			TimedEvent * ev = new TimedEvent(obj[i / EVENT_BENCH_PER_OBJECT], NULL, EVENT_UNK, time, repeats, 0);
+			ev->SetCallback(CallbackP0<BenchEventObject>(obj[i / EVENT_BENCH_PER_OBJECT], &BenchEventObject::Tick));
+			holder.AddEvent(ev);
+		}
+
+		start = BenchMicroTime();
+		for(uint32 i = 0; i < steps; ++i)
+			holder.Update(EVENT_BENCH_UPDATE);
+
+		BenchReport("events", "list walk", BenchMicroTime() - start, steps);
+		printf("%-14s %-28s %10u callbacks\n", "", "", (uint32)CountTicks(obj));
+
+		for(uint32 i = 0; i < objects; ++i)
+			delete obj[i];
+	}
+
+	// timer wheel
+	{
+		vector<BenchEventObject*> obj(objects);
+		EventableObjectHolder * holder = new EventableObjectHolder(EVENT_BENCH_INSTANCE);
+		BenchRandom rnd(opt.seed);
+		for(uint32 i = 0; i < objects; ++i)
+			obj[i] = new BenchEventObject;
+
+		for(uint32 i = 0; i < count; ++i)
+		{
+			GetBenchEvent(rnd, &time, &repeats);
+			sEventMgr.AddEvent(obj[i / EVENT_BENCH_PER_OBJECT], &BenchEventObject::Tick, EVENT_UNK, time, repeats, 0);
+		}
+
+		start = BenchMicroTime();
+		for(uint32 i = 0; i < steps; ++i)
+			holder->Update(EVENT_BENCH_UPDATE);
+
+		BenchReport("events", "timer wheel", BenchMicroTime() - start, steps);
+		printf("%-14s %-28s %10u callbacks\n", "", "", (uint32)CountTicks(obj));
+
+		for(uint32 i = 0; i < objects; ++i)
+			delete obj[i];
+		delete holder;
+	}
+}
@@ -0,0 +1,157 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// FactionBench.cpp
+//
+// Every unit of a battle checks every other one for hostility and combat support,
+// once by working the relation out from the faction templates and once from the
+// table BuildFactionRelations() makes. DBC/FactionTemplate.dbc is used when the
+// bench runs in a server directory, otherwise a synthetic one is written.
+//
+
+#include "Bench.h"
+
+#define FACTION_BENCH_DBC "DBC/FactionTemplate.dbc"
+#define FACTION_BENCH_SYNTHETIC_DBC "FactionTemplate.bench.dbc"
+#define FACTION_BENCH_TEMPLATES 1200
+#define FACTION_BENCH_FACTIONS 400
+
+/** Players, monsters and a few faction specific templates, like FactionTemplate.dbc has.
+ */
+static bool WriteFactionTemplates(const char * path, uint32 seed)
+{
+	FILE * f = fopen(path, "wb");
+	if(f == NULL)
+		return false;
+
+	BenchRandom rnd(seed);
+	uint32 header[5] = { 0x43424457, FACTION_BENCH_TEMPLATES, 14, 14 * 4, 0 };
+	fwrite(header, sizeof(uint32), 5, f);
+
+	for(uint32 i = 0; i < FACTION_BENCH_TEMPLATES; ++i)
+	{
+		FactionTemplateDBC t;
+		memset(&t, 0, sizeof(t));
+		t.ID = i * 2 + 1;
+		t.Faction = 1 + rnd.Next() % FACTION_BENCH_FACTIONS;
+
+		// 1 player, 2 alliance, 4 horde, 8 monster
+		uint32 kind = rnd.Next() % 4;
+		t.Mask = (kind == 3) ? 8 : (1 << kind) | (kind ? 0 : 2 + (rnd.Next() & 1) * 2);
+		t.FriendlyMask = (kind == 3) ? 8 : t.Mask & 6;
+		t.HostileMask = (kind == 3) ? 7 : ((t.Mask & 6) ^ 6) | 8;
+
+		for(uint32 j = 0; j < 4; ++j)
+		{
+			if(rnd.Next() % 4 == 0)
+				t.EnemyFactions[j] = 1 + rnd.Next() % FACTION_BENCH_FACTIONS;
+			if(rnd.Next() % 4 == 0)
+				t.FriendlyFactions[j] = 1 + rnd.Next() % FACTION_BENCH_FACTIONS;
+		}
+		fwrite(&t, sizeof(t), 1, f);
+	}
+
+	fclose(f);
+	return true;
+}
+
+void BenchFaction(BenchOptions & opt)
+{
+	uint32 count = opt.count ? opt.count : 500;
+	uint32 steps = opt.steps ? opt.steps : 20;
+	const char * path = FACTION_BENCH_DBC;
+	uint64 start, hostile, support;
+	uint32 i, j, s, relation;
+
+	FILE * f = fopen(path, "rb");
+	if(f != NULL)
+		fclose(f);
+	else
+	{
+		path = FACTION_BENCH_SYNTHETIC_DBC;
+		if(!WriteFactionTemplates(path, opt.seed))
+		{
+			printf("faction: could not write %s, skipped\n", path);
+			return;
+		}
+	}
+
+	if(dbcFactionTemplate.GetNumRows() == 0 && !dbcFactionTemplate.Load(path, "uuuuuuuuuuuuuu", true, false))
+	{
+		printf("faction: could not load %s, skipped\n", path);
+		return;
+	}
+
+	uint32 rows = dbcFactionTemplate.GetNumRows();
+	printf("faction: %u units, %u faction templates from %s, %u rounds\n", count, rows, path, steps);
+
+	// a battle is mostly two sides plus whatever creatures are around
+	vector<FactionTemplateDBC*> units(count);
+	BenchRandom rnd(opt.seed);
+	FactionTemplateDBC * sides[2] = { dbcFactionTemplate.LookupRow(rnd.Next() % rows), dbcFactionTemplate.LookupRow(rnd.Next() % rows) };
+	for(i = 0; i < count; ++i)
+	{
+		if(rnd.Next() % 5 == 0)
+			units[i] = dbcFactionTemplate.LookupRow(rnd.Next() % rows);
+		else
+			units[i] = sides[i & 1];
+	}
+
+	hostile = support = 0;
+	start = BenchMicroTime();
+	for(s = 0; s < steps; ++s)
+	{
+		for(i = 0; i < count; ++i)
+		{
+			for(j = 0; j < count; ++j)
+			{
+				relation = CalculateFactionRelation(units[i], units[j]);
+				hostile += relation & FACTION_RELATION_HOSTILE;
+				support += (relation & FACTION_RELATION_SUPPORT) >> 1;
+			}
+		}
+	}
+	BenchReport("faction", "calculated", BenchMicroTime() - start, (uint64)count * count * steps);
+	printf("%-14s %-28s %10u hostile %10u support\n", "", "", (uint32)hostile, (uint32)support);
+
+	start = BenchMicroTime();
+	BuildFactionRelations();
+	printf("%-14s %-28s %10u ms to build the table\n", "", "", (uint32)((BenchMicroTime() - start) / 1000));
+
+	hostile = support = 0;
+	start = BenchMicroTime();
+	for(s = 0; s < steps; ++s)
+	{
+		for(i = 0; i < count; ++i)
+		{
+			for(j = 0; j < count; ++j)
+			{
+				relation = GetFactionRelation(units[i], units[j]);
+				hostile += relation & FACTION_RELATION_HOSTILE;
+				support += (relation & FACTION_RELATION_SUPPORT) >> 1;
+			}
+		}
+	}
+	BenchReport("faction", "relation table", BenchMicroTime() - start, (uint64)count * count * steps);
+	printf("%-14s %-28s %10u hostile %10u support\n", "", "", (uint32)hostile, (uint32)support);
+
+	if(path == FACTION_BENCH_SYNTHETIC_DBC)
+		remove(path);
+}
@@ -0,0 +1,193 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// InRangeBench.cpp
+//
+// Objects wander through a crowded area and keep their in-range sets up to date
+// the way MapMgr::ChangeObjectLocation does, once with the std::set the sets used
+// to be and once with IndexedObjectSet.
+//
+
+#include "Bench.h"
+
+#define INRANGE_AREA 300.0f
+#define INRANGE_RANGE 40.0f
+#define INRANGE_STEP 3.0f
+#define INRANGE_GRID ((uint32)(INRANGE_AREA / INRANGE_RANGE) + 1)
+
+struct StdSetObject
+{
+	float x, y;
+	uint32 cell;
+
+	typedef std::set<StdSetObject*> InRangeType;
+	InRangeType inRange;
+};
+
+struct IndexedSetObject
+{
+	float x, y;
+	uint32 cell;
+
+	typedef IndexedObjectSet<IndexedSetObject> InRangeType;
+	InRangeType inRange;
+};
+
+// std::set::erase does not return the next iterator before C++11
+template<class T>
+static ASCENT_INLINE typename std::set<T*>::iterator EraseInRange(std::set<T*> & s, typename std::set<T*>::iterator itr)
+{
+	s.erase(itr++);
+	return itr;
+}
+
+template<class T>
+static ASCENT_INLINE typename IndexedObjectSet<T>::iterator EraseInRange(IndexedObjectSet<T> & s, typename IndexedObjectSet<T>::iterator itr)
+{
+	return s.erase(itr);
+}
+
+template<class T>
+class InRangeWorld
+{
+public:
+	InRangeWorld(uint32 count, uint32 seed) : m_objects(count), m_cells(INRANGE_GRID * INRANGE_GRID), m_random(seed), m_pairs(0)
+	{
+		for(uint32 i = 0; i < count; ++i)
+		{
+			m_objects[i].x = m_random.Float(INRANGE_AREA);
+			m_objects[i].y = m_random.Float(INRANGE_AREA);
+			m_objects[i].cell = _Cell(&m_objects[i]);
+			m_cells[m_objects[i].cell].push_back(&m_objects[i]);
+		}
+	}
+
+	/** Moves every object once and updates its in-range set, returns the relocations done.
+	 */
+	uint64 Step()
+	{
+		for(size_t i = 0; i < m_objects.size(); ++i)
+			_Relocate(&m_objects[i]);
+
+		return m_objects.size();
+	}
+
+	/** Pairs in range, both sides have to end up with the same result. */
+	ASCENT_INLINE uint64 GetPairs() { return m_pairs; }
+
+private:
+	ASCENT_INLINE uint32 _Cell(T * obj)
+	{
+		return (uint32)(obj->x / INRANGE_RANGE) * INRANGE_GRID + (uint32)(obj->y / INRANGE_RANGE);
+	}
+
+	ASCENT_INLINE static bool _InRange(T * a, T * b)
+	{
+		float dx = a->x - b->x;
+		float dy = a->y - b->y;
+		return (dx*dx + dy*dy) <= (INRANGE_RANGE * INRANGE_RANGE);
+	}
+
+	void _Relocate(T * obj)
+	{
+		obj->x += m_random.Float(INRANGE_STEP * 2.0f) - INRANGE_STEP;
+		obj->y += m_random.Float(INRANGE_STEP * 2.0f) - INRANGE_STEP;
+		obj->x = max(0.0f, min(obj->x, INRANGE_AREA - 0.01f));
+		obj->y = max(0.0f, min(obj->y, INRANGE_AREA - 0.01f));
+
+		uint32 cell = _Cell(obj);
+		if(cell != obj->cell)
+		{
+			vector<T*> & old = m_cells[obj->cell];
+			*std::find(old.begin(), old.end(), obj) = old.back();
+			old.pop_back();
+			m_cells[cell].push_back(obj);
+			obj->cell = cell;
+		}
+
+		// drop whatever went out of range
+		for(typename T::InRangeType::iterator itr = obj->inRange.begin(); itr != obj->inRange.end();)
+		{
+			T * other = *itr;
+			if(_InRange(obj, other))
+			{
+				++itr;
+				continue;
+			}
+
+			other->inRange.erase(obj);
+			itr = EraseInRange(obj->inRange, itr);
+			--m_pairs;
+		}
+
+		// and add what came into range from the surrounding cells
+		int32 cx = (int32)(cell / INRANGE_GRID);
+		int32 cy = (int32)(cell % INRANGE_GRID);
+		for(int32 x = max(cx - 1, 0); x <= min(cx + 1, (int32)INRANGE_GRID - 1); ++x)
+		{
+			for(int32 y = max(cy - 1, 0); y <= min(cy + 1, (int32)INRANGE_GRID - 1); ++y)
+			{
+				vector<T*> & objects = m_cells[x * INRANGE_GRID + y];
+				for(size_t i = 0; i < objects.size(); ++i)
+				{
+					T * other = objects[i];
+					if(other == obj || !_InRange(obj, other) || obj->inRange.count(other))
+						continue;
+
+					obj->inRange.insert(other);
+					other->inRange.insert(obj);
+					++m_pairs;
+				}
+			}
+		}
+	}
+
+	vector<T> m_objects;
+	vector< vector<T*> > m_cells;
+	BenchRandom m_random;
+	uint64 m_pairs;
+};
+
+template<class T>
+static void RunInRange(const char * path, BenchOptions & opt, uint32 count, uint32 steps)
+{
+	InRangeWorld<T> world(count, opt.seed);
+
+	// the first step fills the sets, it is not part of the measurement
+	world.Step();
+
+	uint64 relocations = 0;
+	uint64 start = BenchMicroTime();
+	for(uint32 i = 0; i < steps; ++i)
+		relocations += world.Step();
+
+	BenchReport("inrange", path, BenchMicroTime() - start, relocations);
+	printf("%-14s %-28s %10u pairs in range\n", "", "", (uint32)world.GetPairs());
+}
+
+void BenchInRange(BenchOptions & opt)
+{
+	uint32 count = opt.count ? opt.count : 5000;
+	uint32 steps = opt.steps ? opt.steps : 10;
+
+	printf("inrange: %u objects in %.0fx%.0f yards, range %.0f, %u steps\n", count, INRANGE_AREA, INRANGE_AREA, INRANGE_RANGE, steps);
+	RunInRange<StdSetObject>("std::set", opt, count, steps);
+	RunInRange<IndexedSetObject>("IndexedObjectSet", opt, count, steps);
+}
@@ -0,0 +1,126 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// Main.cpp
+//
+// Runs the old and the new implementation of a server path side by side
+// on synthetic data and prints the time per operation of both.
+//
+
+#include "Bench.h"
+
+struct BenchEntry
+{
+	const char * name;
+	BenchFunction function;
+	const char * description;
+};
+
+static BenchEntry m_benches[] = {
+	{ "inrange", &BenchInRange, "in-range set upkeep of objects moving through a crowded area" },
+	{ "events", &BenchEvents, "timed event holder updates with 100k respawn, aura and AI events" },
+	{ "database", &BenchDatabase, "world table loading through text queries and prepared statements" },
+	{ "terrain", &BenchTerrain, "land height, water height and area lookups of waypoint sized point groups" },
+	{ "area", &BenchArea, "area spell target searches in a crowded zone" },
+	{ "faction", &BenchFaction, "hostility and combat support checks between every unit of a 500 unit battle" },
+	{ "auras", &BenchAuras, "periodic ticks of 30k auras as timed events and in the aura scheduler" },
+	{ NULL, NULL, NULL },
+};
+
+uint64 BenchMicroTime()
+{
+#ifdef WIN32
+	LARGE_INTEGER freq, now;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (uint64)((now.QuadPart / freq.QuadPart) * 1000000 + ((now.QuadPart % freq.QuadPart) * 1000000) / freq.QuadPart);
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return ((uint64)tv.tv_sec * 1000000) + tv.tv_usec;
+#endif
+}
+
+void BenchReport(const char * bench, const char * path, uint64 microseconds, uint64 operations)
+{
+	double ns = operations ? ((double)microseconds * 1000.0) / (double)operations : 0.0;
+	printf("%-14s %-28s %10u ms %12.1f ns/op\n", bench, path, (uint32)(microseconds / 1000), ns);
+}
+
+static void Usage(const char * self)
+{
+	printf("Usage: %s [-n count] [-s steps] [-r seed] [-c world config] [benchmark...]\n\n", self);
+	printf("Runs every benchmark if none is named:\n");
+	for(BenchEntry * b = m_benches; b->name != NULL; ++b)
+		printf("  %-14s %s\n", b->name, b->description);
+}
+
+int main(int argc, char ** argv)
+{
+	BenchOptions opt;
+	vector<BenchEntry*> run;
+	BenchEntry * b;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		if(argv[i][0] == '-' && argv[i][1] == 'c' && i + 1 < argc)
+		{
+			opt.config = argv[++i];
+			continue;
+		}
+
+		if(argv[i][0] == '-' && i + 1 < argc && (argv[i][1] == 'n' || argv[i][1] == 's' || argv[i][1] == 'r'))
+		{
+			uint32 value = atol(argv[i + 1]);
+			if(argv[i][1] == 'n')
+				opt.count = value;
+			else if(argv[i][1] == 's')
+				opt.steps = value;
+			else
+				opt.seed = value;
+			++i;
+			continue;
+		}
+
+		for(b = m_benches; b->name != NULL; ++b)
+		{
+			if(!stricmp(b->name, argv[i]))
+				break;
+		}
+
+		if(b->name == NULL)
+		{
+			Usage(argv[0]);
+			return 1;
+		}
+		run.push_back(b);
+	}
+
+	if(run.empty())
+	{
+		for(b = m_benches; b->name != NULL; ++b)
+			run.push_back(b);
+	}
+
+	for(vector<BenchEntry*>::iterator itr = run.begin(); itr != run.end(); ++itr)
+		(*itr)->function(opt);
+
+	return 0;
+}
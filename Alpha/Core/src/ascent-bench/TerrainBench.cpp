@@ -0,0 +1,201 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// TerrainBench.cpp
+//
+// Land height, water height and area lookups for groups of nearby points, like
+// the random waypoint command generates them. Every point goes through the
+// single point functions once, then the whole set through GetTerrainInfo().
+// The map file is written into the current directory and removed afterwards.
+//
+
+#include "Bench.h"
+
+#define TERRAIN_BENCH_MAP 999
+#define TERRAIN_BENCH_FIRST_CELL 240
+#define TERRAIN_BENCH_CELLS 32
+#define TERRAIN_BENCH_GROUP 16
+#define TERRAIN_BENCH_GROUP_RADIUS 30.0f
+#define TERRAIN_BENCH_SAMPLE_SIZE (_cellSize / CELL_RESOLUTION)
+
+// TerrainMgr::CellGoneIdle reads the world settings, the benchmark never calls it.
+initialiseSingleton(World);
+
+/** The terrain of the synthetic map, gx and gy are global height sample positions.
+ */
+static float SurfaceHeight(float gx, float gy)
+{
+	return 40.0f * sinf(gx * 0.07f) * cosf(gy * 0.05f) + 10.0f * sinf(gx * 0.31f + gy * 0.17f);
+}
+
+static bool WriteTerrainFile(const char * path)
+{
+	FILE * f = fopen(path, "wb");
+	if(f == NULL)
+		return false;
+
+	// the header holds the file offset of every cell, 0 for cells without data
+	vector<uint32> offsets(_sizeX * _sizeY, 0);
+	uint32 offset = TERRAIN_HEADER_SIZE;
+	for(uint32 x = 0; x < TERRAIN_BENCH_CELLS; ++x)
+	{
+		for(uint32 y = 0; y < TERRAIN_BENCH_CELLS; ++y)
+		{
+			offsets[(TERRAIN_BENCH_FIRST_CELL + x) * _sizeY + TERRAIN_BENCH_FIRST_CELL + y] = offset;
+			offset += sizeof(CellTerrainInformation);
+		}
+	}
+	fwrite(&offsets[0], sizeof(uint32), offsets.size(), f);
+
+	CellTerrainInformation cell;
+	memset(&cell, 0, sizeof(cell));
+	for(uint32 x = 0; x < TERRAIN_BENCH_CELLS; ++x)
+	{
+		for(uint32 y = 0; y < TERRAIN_BENCH_CELLS; ++y)
+		{
+			uint32 cx = TERRAIN_BENCH_FIRST_CELL + x;
+			uint32 cy = TERRAIN_BENCH_FIRST_CELL + y;
+			for(uint32 i = 0; i < 2; ++i)
+			{
+				for(uint32 j = 0; j < 2; ++j)
+				{
+					cell.AreaID[i][j] = (uint16)(1 + (cx * 2 + i) % 7);
+					cell.LiquidLevel[i][j] = ((cx + cy) % 3) ? -500.0f : 5.0f;
+				}
+			}
+
+			for(uint32 i = 0; i < CELL_RESOLUTION; ++i)
+			{
+				for(uint32 j = 0; j < CELL_RESOLUTION; ++j)
+					cell.Z[i][j] = SurfaceHeight((float)(cx * CELL_RESOLUTION + i), (float)(cy * CELL_RESOLUTION + j));
+			}
+			fwrite(&cell, sizeof(cell), 1, f);
+		}
+	}
+
+	fclose(f);
+	return true;
+}
+
+/** The height TerrainMgr returned before interpolation, the sample at or before the point.
+ */
+static float NearestSampleHeight(float x, float y)
+{
+	float gx = (_maxX - x) / TERRAIN_BENCH_SAMPLE_SIZE;
+	float gy = (_maxY - y) / TERRAIN_BENCH_SAMPLE_SIZE;
+	return SurfaceHeight(floorf(gx), floorf(gy));
+}
+
+void BenchTerrain(BenchOptions & opt)
+{
+	uint32 count = opt.count ? opt.count : 200000;
+	uint32 steps = opt.steps ? opt.steps : 20;
+	char path[200];
+	uint64 start;
+	uint32 i, s;
+
+	count -= count % TERRAIN_BENCH_GROUP;
+	if(count == 0)
+		count = TERRAIN_BENCH_GROUP;
+
+	snprintf(path, 200, "./Map_%u.bin", (unsigned int)TERRAIN_BENCH_MAP);
+	if(!WriteTerrainFile(path))
+	{
+		printf("terrain: could not write %s, skipped\n", path);
+		return;
+	}
+
+	printf("terrain: %u points in groups of %u, %ux%u loaded cells, %u passes\n", count, TERRAIN_BENCH_GROUP, TERRAIN_BENCH_CELLS, TERRAIN_BENCH_CELLS, steps);
+
+	TerrainMgr * terrain = new TerrainMgr(".", TERRAIN_BENCH_MAP, true);
+	if(!terrain->LoadTerrainHeader())
+	{
+		printf("terrain: could not load %s, skipped\n", path);
+		delete terrain;
+		remove(path);
+		return;
+	}
+
+	for(uint32 x = 0; x < TERRAIN_BENCH_CELLS; ++x)
+	{
+		for(uint32 y = 0; y < TERRAIN_BENCH_CELLS; ++y)
+			terrain->CellGoneActive(TERRAIN_BENCH_FIRST_CELL + x, TERRAIN_BENCH_FIRST_CELL + y);
+	}
+
+	// groups of points around spots of the loaded area
+	vector<float> px(count), py(count);
+	BenchRandom rnd(opt.seed);
+	float first = _maxX - (TERRAIN_BENCH_FIRST_CELL + TERRAIN_BENCH_CELLS) * _cellSize + TERRAIN_BENCH_GROUP_RADIUS;
+	float area = TERRAIN_BENCH_CELLS * _cellSize - TERRAIN_BENCH_GROUP_RADIUS * 2.0f;
+	for(i = 0; i < count; i += TERRAIN_BENCH_GROUP)
+	{
+		float cx = first + rnd.Float(area);
+		float cy = first + rnd.Float(area);
+		for(uint32 j = 0; j < TERRAIN_BENCH_GROUP; ++j)
+		{
+			px[i + j] = cx + rnd.Float(TERRAIN_BENCH_GROUP_RADIUS * 2.0f) - TERRAIN_BENCH_GROUP_RADIUS;
+			py[i + j] = cy + rnd.Float(TERRAIN_BENCH_GROUP_RADIUS * 2.0f) - TERRAIN_BENCH_GROUP_RADIUS;
+		}
+	}
+
+	vector<float> heights(count), waterHeights(count);
+	vector<uint16> areas(count);
+	float checksum = 0.0f;
+
+	start = BenchMicroTime();
+	for(s = 0; s < steps; ++s)
+	{
+		for(i = 0; i < count; ++i)
+		{
+			heights[i] = terrain->GetLandHeight(px[i], py[i]);
+			waterHeights[i] = terrain->GetWaterHeight(px[i], py[i]);
+			areas[i] = terrain->GetAreaID(px[i], py[i]);
+		}
+		checksum += heights[s % count] + waterHeights[s % count] + areas[s % count];
+	}
+	BenchReport("terrain", "single point functions", BenchMicroTime() - start, (uint64)count * steps);
+	printf("%-14s %-28s %10.1f checksum\n", "", "", checksum);
+
+	checksum = 0.0f;
+	start = BenchMicroTime();
+	for(s = 0; s < steps; ++s)
+	{
+		terrain->GetTerrainInfo(count, &px[0], &py[0], &heights[0], &waterHeights[0], &areas[0]);
+		checksum += heights[s % count] + waterHeights[s % count] + areas[s % count];
+	}
+	BenchReport("terrain", "GetTerrainInfo", BenchMicroTime() - start, (uint64)count * steps);
+	printf("%-14s %-28s %10.1f checksum\n", "", "", checksum);
+
+	// how far both lookups are off the surface the samples were taken from
+	double nearest = 0.0, interpolated = 0.0;
+	for(i = 0; i < count; ++i)
+	{
+		float gx = (_maxX - px[i]) / TERRAIN_BENCH_SAMPLE_SIZE;
+		float gy = (_maxY - py[i]) / TERRAIN_BENCH_SAMPLE_SIZE;
+		float h = SurfaceHeight(gx, gy);
+		nearest += fabs(NearestSampleHeight(px[i], py[i]) - h);
+		interpolated += fabs(heights[i] - h);
+	}
+	printf("%-14s %-28s %10.3f yards off the surface\n", "terrain", "nearest sample (old)", nearest / count);
+	printf("%-14s %-28s %10.3f yards off the surface\n", "terrain", "interpolated", interpolated / count);
+
+	delete terrain;
+	remove(path);
+}
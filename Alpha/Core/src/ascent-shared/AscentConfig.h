@@ -46,7 +46,7 @@
 //#define COLLISION 1
 
 /** Use memory mapping for map files for faster access (let OS take care of caching)
- * (currently only available under windows)
+ * The files are mapped read-only and shared by all instances of a map, idle cells are given back to the OS.
  * Only recommended under X64 builds, X86 builds will most likely run out of address space.
  * Default: Disabled
  */
@@ -45,6 +45,13 @@ public:
 		_rpos = _wpos = 0;
 	}
 
+	// exchanges contents and reserved memory with another buffer
+	void swap(ByteBuffer & buf) {
+		std::swap(_rpos, buf._rpos);
+		std::swap(_wpos, buf._wpos);
+		_storage.swap(buf._storage);
+	}
+
 	//template <typename T> void insert(size_t pos, T value) {
 	//  insert(pos, (uint8 *)&value, sizeof(value));
 	//}
@@ -330,6 +337,7 @@ public:
 	const uint8 *contents() const { return &_storage[0]; };
 
 	ASCENT_INLINE size_t size() const { return _storage.size(); };
+	ASCENT_INLINE size_t capacity() const { return _storage.capacity(); };
 	// one should never use resize probably
 	void resize(size_t newsize) {
 		_storage.resize(newsize);
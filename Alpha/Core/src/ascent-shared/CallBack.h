@@ -161,6 +161,20 @@ private:
 	P4 _p4;
 };
 
+class CallbackFunctionP0 : public CallbackBase
+{
+public:
+
+	typedef void (*Function)();
+	CallbackFunctionP0(Function _function) : _func(_function) {}
+	void operator()() { return _func(); }
+	void execute() { return operator()(); }
+
+private:
+
+	Function _func;
+};
+
 class QueryResult;
 struct AsyncQueryResult;
 #include <vector>
@@ -23,6 +23,7 @@
 #include "Common.h"
 #include "DataStore.h"
 #include "Timer.h"
+#include "MappedFile.h"
 
 #pragma pack(push,1)
 
@@ -1046,6 +1047,10 @@ class SERVER_DECL DBCStorage
 	uint32 useless_shit;
 	uint32 header;
 
+	/* rows and strings point into the mapping instead of the heap where possible */
+	MappedFile m_file;
+	bool m_mappedRows;
+
 public:
 	
 	DBCStorage()
@@ -1057,44 +1062,62 @@ public:
 		m_numrows = 0;
 		m_stringlength=0;
 		m_stringData = NULL;
+		m_mappedRows = false;
 	}
 
 	~DBCStorage()
 	{
-		if(m_heapBlock)
+		if(m_heapBlock && !m_mappedRows)
 			free(m_heapBlock);
 		if(m_entries)
 			free(m_entries);
-		if( m_stringData != NULL )
-			free(m_stringData);
+	}
+
+	/** True if the rows of the file can be used as they are: every column is
+	 * a 4 byte value which is kept, and the structure has nothing after them.
+	 */
+	static bool IsRawFormat(const char * format, uint32 cols)
+	{
+#ifdef USING_BIG_ENDIAN
+		return false;
+#else
+		for(const char * t = format; *t != 0; ++t)
+		{
+			if(*t == 's' || *t == 'x')
+				return false;
+		}
+		return (sizeof(T) == cols * 4);
+#endif
 	}
 
 	bool Load(const char * filename, const char * format, bool load_indexed, bool load_strings)
 	{
 		uint32 i;
 		uint32 string_length;
-		long pos;
 		size_t format_len = strlen(format);
+		const uint8 * data;
 
-		FILE * f = fopen(filename, "rb");
-		if(f == NULL)
+		/* mapped copy-on-write: pages are shared between world processes until
+		 * something patches a row (spell fixes), the file itself is never written */
+		if(!m_file.Open(filename, true))
 		{
 			Log.Error("DBC", "Unable to open %s.", filename);
 			return false;
 		}
 
-		/* read the number of rows, and allocate our block on the heap */
-		if(fread(&header, 4, 1, f) != 1 ||
-			fread(&rows, 4, 1, f) != 1 ||
-			fread(&cols, 4, 1, f) != 1 ||
-			fread(&useless_shit, 4, 1, f) != 1 ||
-			fread(&string_length, 4, 1, f) != 1)
+		data = m_file.GetData();
+		if(m_file.GetSize() < 20)
 		{
 			Log.Error("DBC", "Unable to read header for %s.", filename);
-			fclose(f);
+			m_file.Close();
 			return false;
 		}
-		pos = ftell(f);
+
+		memcpy(&header, data, 4);
+		memcpy(&rows, data + 4, 4);
+		memcpy(&cols, data + 8, 4);
+		memcpy(&useless_shit, data + 12, 4);
+		memcpy(&string_length, data + 16, 4);
 
 #ifdef USING_BIG_ENDIAN
 		swap32(&rows); swap32(&cols); swap32(&useless_shit); swap32(&string_length);
@@ -1104,51 +1127,55 @@ public:
 		if(header != 0x43424457)
 		{
 			Log.Error("DBC", "Invalid magic in %s (expected WDBC).", filename);
-			fclose(f);
+			m_file.Close();
 			return false;
 		}
 
 		if(useless_shit != (cols * 4))
 		{
 			Log.Error("DBC", "Invalid record size in %s (record=%u, expected=%u).", filename, useless_shit, cols * 4);
-			fclose(f);
+			m_file.Close();
 			return false;
 		}
 
 		if(format_len != cols)
 		{
 			Log.Error("DBC", "Invalid format for %s (format columns=%u, dbc columns=%u).", filename, (uint32)format_len, cols);
-			fclose(f);
+			m_file.Close();
+			return false;
+		}
+
+		if(m_file.GetSize() < 20 + (size_t)rows * cols * 4 + (load_strings ? string_length : 0))
+		{
+			Log.Error("DBC", "%s is truncated.", filename);
+			m_file.Close();
 			return false;
 		}
 
 		if( load_strings )
 		{
-			fseek( f, 20 + ( rows * cols * 4 ), SEEK_SET );
-			m_stringData = (char*)malloc(string_length);
+			m_stringData = (char*)m_file.GetWritableData() + 20 + ( rows * cols * 4 );
 			m_stringlength = string_length;
-			if(m_stringData == NULL || fread(m_stringData, string_length, 1, f) != 1)
-			{
-				Log.Error("DBC", "Unable to read string table for %s.", filename);
-				fclose(f);
-				return false;
-			}
 		}
 
-		fseek(f, pos, SEEK_SET);
-
-		m_heapBlock = (T*)malloc(rows * sizeof(T));
-		ASSERT(m_heapBlock);
+		if(IsRawFormat(format, cols))
+		{
+			m_heapBlock = (T*)(m_file.GetWritableData() + 20);
+			m_mappedRows = true;
+		}
+		else
+		{
+			m_heapBlock = (T*)malloc(rows * sizeof(T));
+			ASSERT(m_heapBlock);
+		}
 
 		/* read the data for each row */
 		for(i = 0; i < rows; ++i)
 		{
-			memset(&m_heapBlock[i], 0, sizeof(T));
-			if(!ReadEntry(f, &m_heapBlock[i], format, cols, filename))
+			if(!m_mappedRows)
 			{
-				Log.Error("DBC", "Unable to read row %u in %s.", i, filename);
-				fclose(f);
-				return false;
+				memset(&m_heapBlock[i], 0, sizeof(T));
+				ReadEntry(data + 20 + i * cols * 4, &m_heapBlock[i], format);
 			}
 
 			if(load_indexed)
@@ -1176,32 +1203,27 @@ public:
 
 		m_numrows = rows;
 
-		fclose(f);
+		/* neither rows nor strings are used, nothing has to stay mapped */
+		if(!m_mappedRows && !load_strings)
+			m_file.Close();
+
 		return true;
 	}
 
-	bool ReadEntry(FILE * f, T * dest, const char * format, uint32 cols, const char * filename)
+	/** Converts one row of the file, the format length has been checked against the record size.
+	 */
+	void ReadEntry(const uint8 * src, T * dest, const char * format)
 	{
 		const char * t = format;
 		uint32 * dest_ptr = (uint32*)dest;
-		uint32 c = 0;
 		uint32 val;
 
-		while(*t != 0)
+		for(; *t != 0; ++t, src += 4)
 		{
-			if((++c) > cols)
-			{
-				Log.Error("DBC", "Read buffer overflow in DBC reading of file %s.", filename);
-				return false;
-			}
-
-			if(fread(&val, 4, 1, f) != 1)
-				return false;
 			if(*t == 'x')
-			{
-				++t;
 				continue;		// skip!
-			}
+
+			memcpy(&val, src, 4);
 #ifdef USING_BIG_ENDIAN
 			swap32(&val);
 #endif
@@ -1224,11 +1246,7 @@ public:
 				*dest_ptr = val;
 				dest_ptr++;
 			}
-
-			++t;
 		}
-
-		return true;
 	}
 
 	ASCENT_INLINE uint32 GetNumRows()
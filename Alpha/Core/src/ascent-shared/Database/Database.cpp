@@ -22,46 +22,150 @@
 #include "../CrashHandler.h"
 #include "../NGLog.h"
 
+#ifdef WIN32
+#define DATABASE_TLS __declspec(thread)
+#else
+#define DATABASE_TLS __thread
+#endif
+
+// completion queue of the calling thread, NULL completes async queries inline
+static DATABASE_TLS AsyncQueryCompletionQueue * t_completionQueue = NULL;
+
+// connection pool lane of the calling thread
+static DATABASE_TLS uint32 t_connectionPriority = DATABASE_PRIORITY_HIGH;
+
 SQLCallbackBase::~SQLCallbackBase()
 {
 
 }
 
-Database::Database() : CThread()
+Database::Database() : CThread(), m_poolCond(&m_poolLock), m_asyncCond(&m_asyncLock)
 {
 	_counter=0;
 	Connections = NULL;
 	mConnectionCount = -1;   // Not connected.
 	ThreadRunning = true;
+	mAsyncThreadCount = 0;
+	mAsyncThreadsRunning = 0;
+	m_asyncShutdown = false;
+
+	for(uint32 i = 0; i < NUM_DATABASE_PRIORITIES; ++i)
+		m_nextTicket[i] = m_servingTicket[i] = 0;
+	m_poolCheckouts = 0;
+	m_poolWaits = 0;
+	m_poolWaitTime = 0;
 }
 
 Database::~Database()
 {
-	
+	for(vector<char*>::iterator itr = m_preparedSql.begin(); itr != m_preparedSql.end(); ++itr)
+		delete [] (*itr);
 }
 
 void Database::_Initialize()
 {
+	// all connections start out free
+	m_freeConnections.reserve(mConnectionCount);
+	for(int32 i = 0; i < mConnectionCount; ++i)
+		m_freeConnections.push_back(Connections[i]);
+
 	// Spawn Database thread
 	ThreadPool.ExecuteTask(this);
 
 	// launch the query thread
 	qt = new QueryThread(this);
 	ThreadPool.ExecuteTask(qt);
+
+	// the async threads hold the connections Initialize added for them for as long as they run
+	mAsyncThreadsRunning = mAsyncThreadCount;
+	for(uint32 i = 0; i < mAsyncThreadCount; ++i)
+		ThreadPool.ExecuteTask(new AsyncQueryThread(this));
+}
+
+void Database::SetConnectionPriority(uint32 priority)
+{
+	t_connectionPriority = (priority < NUM_DATABASE_PRIORITIES) ? priority : DATABASE_PRIORITY_LOW;
 }
 
 DatabaseConnection * Database::GetFreeConnection()
 {
-	uint32 i = 0;
-	for(;;)
+	return GetFreeConnection(t_connectionPriority);
+}
+
+bool Database::_CanCheckout(uint32 priority, uint64 ticket)
+{
+	if(m_freeConnections.empty() || m_servingTicket[priority] != ticket)
+		return false;
+
+	// higher lanes go first
+	for(uint32 i = 0; i < priority; ++i)
+	{
+		if(m_nextTicket[i] != m_servingTicket[i])
+			return false;
+	}
+	return true;
+}
+
+DatabaseConnection * Database::GetFreeConnection(uint32 priority)
+{
+	DatabaseConnection * con;
+	uint32 start = 0;
+	uint64 ticket;
+
+	m_poolCond.BeginSynchronized();
+	ticket = m_nextTicket[priority]++;
+	if(!_CanCheckout(priority, ticket))
+	{
+		start = getMSTime();
+		++m_poolWaits;
+		do
+		{
+			m_poolCond.Wait();
+		} while(!_CanCheckout(priority, ticket));
+		m_poolWaitTime += getMSTime() - start;
+	}
+
+	++m_servingTicket[priority];
+	++m_poolCheckouts;
+	con = m_freeConnections.back();
+	m_freeConnections.pop_back();
+
+	// the next ticket may be able to go as well
+	if(m_freeConnections.size())
 	{
-		DatabaseConnection * con = Connections[ ((i++) % mConnectionCount) ];
-		if(con->Busy.AttemptAcquire())
-			return con;
+		for(uint32 i = 0; i < NUM_DATABASE_PRIORITIES; ++i)
+		{
+			if(m_nextTicket[i] != m_servingTicket[i])
+			{
+				m_poolCond.Broadcast();
+				break;
+			}
+		}
 	}
+	m_poolCond.EndSynchronized();
+
+	++con->Checkouts;
+	con->AcquireTime = getMSTime();
+	return con;
+}
 
-	// shouldn't be reached
-	return NULL;
+void Database::ReleaseConnection(DatabaseConnection * con)
+{
+	con->HoldTime += getMSTime() - con->AcquireTime;
+
+	m_poolCond.BeginSynchronized();
+	m_freeConnections.push_back(con);
+	m_poolCond.Broadcast();
+	m_poolCond.EndSynchronized();
+}
+
+void Database::GetPoolStatistics(uint64 * checkouts, uint64 * waits, uint64 * wait_time)
+{
+	m_poolCond.BeginSynchronized();
+	*checkouts = m_poolCheckouts;
+	*waits = m_poolWaits;
+	*wait_time = m_poolWaitTime;
+	m_poolCond.EndSynchronized();
 }
 
 
@@ -80,7 +184,7 @@ QueryResult * Database::Query(const char* QueryString, ...)
 	if(_SendQuery(con, sql, false))
 		qResult = _StoreQueryResult( con );
 	
-	con->Busy.Release();
+	ReleaseConnection(con);
 	return qResult;
 }
 
@@ -93,7 +197,7 @@ QueryResult * Database::QueryNA(const char* QueryString)
 	if( _SendQuery( con, QueryString, false ) )
 		qResult = _StoreQueryResult( con );
 
-	con->Busy.Release();
+	ReleaseConnection(con);
 	return qResult;
 }
 
@@ -125,7 +229,9 @@ void QueryBuffer::AddQuery(const char * format, ...)
 	char * pBuffer = new char[len+1];
 	memcpy(pBuffer, query, len + 1);
 
-	queries.push_back(pBuffer);
+	QueryBufferEntry e = { pBuffer, NULL };
+	queries.push_back(e);
+	bytes += len;
 }
 
 void QueryBuffer::AddQueryNA( const char * str )
@@ -134,7 +240,9 @@ void QueryBuffer::AddQueryNA( const char * str )
 	char * pBuffer = new char[len+1];
 	memcpy(pBuffer, str, len + 1);
 
-	queries.push_back(pBuffer);
+	QueryBufferEntry e = { pBuffer, NULL };
+	queries.push_back(e);
+	bytes += len;
 }
 
 void QueryBuffer::AddQueryStr(const string& str)
@@ -143,13 +251,35 @@ void QueryBuffer::AddQueryStr(const string& str)
 	char * pBuffer = new char[len+1];
 	memcpy(pBuffer, str.c_str(), len + 1);
 
-	queries.push_back(pBuffer);
+	QueryBufferEntry e = { pBuffer, NULL };
+	queries.push_back(e);
+	bytes += len;
+}
+
+void QueryBuffer::AddPrepared(PreparedStatement * stmt)
+{
+	QueryBufferEntry e = { NULL, stmt };
+	queries.push_back(e);
+
+	for(size_t i = 0; i < stmt->GetParamCount(); ++i)
+	{
+		const PreparedStatementParam & p = stmt->GetParam(i);
+		bytes += (p.type == PREPARED_PARAM_STRING) ? p.str.size() : 8;
+	}
 }
 
 void Database::PerformQueryBuffer(QueryBuffer * b, DatabaseConnection * ccon)
 {
 	if(!b->queries.size())
+	{
+		if(b->callback != NULL)
+		{
+			b->callback->OnComplete(true);
+			delete b->callback;
+			b->callback = NULL;
+		}
 		return;
+	}
 
     DatabaseConnection * con = ccon;
 	if( ccon == NULL )
@@ -157,16 +287,39 @@ void Database::PerformQueryBuffer(QueryBuffer * b, DatabaseConnection * ccon)
 	
 	_BeginTransaction(con);
 
-	for(vector<char*>::iterator itr = b->queries.begin(); itr != b->queries.end(); ++itr)
+	bool success;
+	bool written = true;
+	for(vector<QueryBuffer::QueryBufferEntry>::iterator itr = b->queries.begin(); itr != b->queries.end(); ++itr)
 	{
-		_SendQuery(con, *itr, false);
-		delete[] (*itr);
+		if(itr->statement != NULL)
+		{
+			QueryResult * res = _SendPrepared(con, itr->statement, &success);
+			if(res != NULL)
+				delete res;
+			if(!success)
+				written = false;
+			delete itr->statement;
+		}
+		else
+		{
+			if(!_SendQuery(con, itr->query, false))
+				written = false;
+			delete[] itr->query;
+		}
 	}
 
-	_EndTransaction(con);
+	if(!_EndTransaction(con))
+		written = false;
+
+	if(b->callback != NULL)
+	{
+		b->callback->OnComplete(written);
+		delete b->callback;
+		b->callback = NULL;
+	}
 
 	if( ccon == NULL )
-		con->Busy.Release();
+		ReleaseConnection(con);
 }
 
 bool Database::Execute(const char* QueryString, ...)
@@ -213,7 +366,7 @@ bool Database::WaitExecute(const char* QueryString, ...)
 
 	DatabaseConnection * con = GetFreeConnection();
 	bool Result = _SendQuery(con, sql, false);
-	con->Busy.Release();
+	ReleaseConnection(con);
 	return Result;
 }
 
@@ -221,7 +374,7 @@ bool Database::WaitExecuteNA(const char* QueryString)
 {
 	DatabaseConnection * con = GetFreeConnection();
 	bool Result = _SendQuery(con, QueryString, false);
-	con->Busy.Release();
+	ReleaseConnection(con);
 	return Result;
 }
 
@@ -229,6 +382,7 @@ bool Database::run()
 {
 	SetThreadName("Database Execute Thread");
 	SetThreadState(THREADSTATE_BUSY);
+	SetConnectionPriority(DATABASE_PRIORITY_LOW);
 	ThreadRunning = true;
 	char * query = queries_queue.pop();
 	DatabaseConnection * con = GetFreeConnection();
@@ -242,7 +396,7 @@ bool Database::run()
 		query = queries_queue.pop();
 	}
 
-	con->Busy.Release();
+	ReleaseConnection(con);
 
 	if(queries_queue.get_size() > 0)
 	{
@@ -252,7 +406,7 @@ bool Database::run()
 		{
 			DatabaseConnection * con = GetFreeConnection();
 			_SendQuery( con, query, false );
-			con->Busy.Release();
+			ReleaseConnection(con);
 			delete[] query;
 			query=queries_queue.pop_nowait();
 		}
@@ -283,12 +437,20 @@ void AsyncQuery::AddQuery(const char * format, ...)
 void AsyncQuery::Perform()
 {
 	DatabaseConnection * conn = db->GetFreeConnection();
+	_Execute(conn);
+	db->ReleaseConnection(conn);
+	_Complete();
+}
+
+void AsyncQuery::_Execute(DatabaseConnection * conn)
+{
 	for(vector<AsyncQueryResult>::iterator itr = queries.begin(); itr != queries.end(); ++itr)
 		itr->result = db->FQuery(itr->query, conn);
+}
 
-	conn->Busy.Release();
+void AsyncQuery::_Complete()
+{
 	func->run(queries);
-
 	delete this;
 }
 
@@ -307,7 +469,14 @@ AsyncQuery::~AsyncQuery()
 void Database::EndThreads()
 {
 	SetThreadState(THREADSTATE_TERMINATE);
-	while(ThreadRunning || qt)
+
+	// async threads finish what is queued before they exit
+	m_asyncCond.BeginSynchronized();
+	m_asyncShutdown = true;
+	m_asyncCond.Broadcast();
+	m_asyncCond.EndSynchronized();
+
+	while(ThreadRunning || qt || mAsyncThreadsRunning)
 	{
 		if(query_buffer.get_size() == 0)
 			query_buffer.GetCond().Broadcast();
@@ -316,7 +485,7 @@ void Database::EndThreads()
 			queries_queue.GetCond().Broadcast();
 
 		Sleep(100);
-		if(!ThreadRunning)
+		if(!ThreadRunning && !mAsyncThreadsRunning)
 			break;
 			
 		Sleep(1000);
@@ -325,6 +494,8 @@ void Database::EndThreads()
 
 bool QueryThread::run( )
 {
+	// saves are background traffic
+	Database::SetConnectionPriority(DATABASE_PRIORITY_LOW);
 	db->thread_proc_query( );
 	return true;
 }
@@ -351,7 +522,7 @@ void Database::thread_proc_query()
 		q = query_buffer.pop( );
 	}
 
-	con->Busy.Release();
+	ReleaseConnection(con);
 
 	// kill any queries
 	q = query_buffer.pop_nowait( );
@@ -364,19 +535,162 @@ void Database::thread_proc_query()
 	}
 }
 
+bool AsyncQueryThread::run()
+{
+	SetThreadName("Database Async Query Thread");
+	db->thread_proc_async();
+	return true;
+}
+
+void Database::thread_proc_async()
+{
+	AsyncQuery * q;
+	DatabaseConnection * con = GetFreeConnection();
+
+	m_asyncCond.BeginSynchronized();
+	for(;;)
+	{
+		if(m_asyncQueue.empty())
+		{
+			if(m_asyncShutdown)
+				break;
+
+			m_asyncCond.Wait();
+			continue;
+		}
+
+		q = m_asyncQueue.front();
+		m_asyncQueue.pop_front();
+		m_asyncCond.EndSynchronized();
+
+		// results go back to the thread which queued the query
+		q->_Execute(con);
+		q->completion->_Push(q);
+
+		m_asyncCond.BeginSynchronized();
+	}
+	--mAsyncThreadsRunning;
+	m_asyncCond.EndSynchronized();
+
+	ReleaseConnection(con);
+}
+
 void Database::QueueAsyncQuery(AsyncQuery * query)
 {
 	query->db = this;
-	/*if(qt == NULL)
+
+	AsyncQueryCompletionQueue * cq = t_completionQueue;
+	if(cq != NULL)
 	{
-		query->Perform();
-		return;
+		m_asyncCond.BeginSynchronized();
+		if(mAsyncThreadsRunning && !m_asyncShutdown)
+		{
+			query->completion = cq;
+#ifdef WIN32
+			InterlockedIncrement(&cq->m_pending);
+#else
+			__sync_add_and_fetch(&cq->m_pending, 1);
+#endif
+			m_asyncQueue.push_back(query);
+			m_asyncCond.Signal();
+			m_asyncCond.EndSynchronized();
+			return;
+		}
+		m_asyncCond.EndSynchronized();
 	}
 
-	qqueries_queue.push(query);*/
+	// no async threads or no thread to deliver the results to
 	query->Perform();
 }
 
+uint32 Database::GetAsyncQueueSize()
+{
+	uint32 ret;
+	m_asyncCond.BeginSynchronized();
+	ret = (uint32)m_asyncQueue.size();
+	m_asyncCond.EndSynchronized();
+	return ret;
+}
+
+AsyncQueryCompletionQueue::~AsyncQueryCompletionQueue()
+{
+	// the owner is gone, wait for the queries still executing and drop the results
+	while(m_pending)
+	{
+		m_lock.Acquire();
+		for(vector<AsyncQuery*>::iterator itr = m_completed.begin(); itr != m_completed.end(); ++itr)
+		{
+			delete *itr;
+#ifdef WIN32
+			InterlockedDecrement(&m_pending);
+#else
+			__sync_sub_and_fetch(&m_pending, 1);
+#endif
+		}
+		m_completed.clear();
+		m_lock.Release();
+
+		if(m_pending)
+			Sleep(10);
+	}
+
+	if(t_completionQueue == this)
+		t_completionQueue = NULL;
+}
+
+void AsyncQueryCompletionQueue::Bind()
+{
+	t_completionQueue = this;
+}
+
+void AsyncQueryCompletionQueue::Unbind()
+{
+	t_completionQueue = NULL;
+}
+
+AsyncQueryCompletionQueue * AsyncQueryCompletionQueue::GetCurrent()
+{
+	return t_completionQueue;
+}
+
+void AsyncQueryCompletionQueue::_Push(AsyncQuery * query)
+{
+	m_lock.Acquire();
+	m_completed.push_back(query);
+	m_lock.Release();
+}
+
+void AsyncQueryCompletionQueue::Process()
+{
+	if(!m_pending)
+		return;
+
+	m_lock.Acquire();
+	m_work.swap(m_completed);
+	m_lock.Release();
+
+	for(vector<AsyncQuery*>::iterator itr = m_work.begin(); itr != m_work.end(); ++itr)
+	{
+		(*itr)->_Complete();
+#ifdef WIN32
+		InterlockedDecrement(&m_pending);
+#else
+		__sync_sub_and_fetch(&m_pending, 1);
+#endif
+	}
+	m_work.clear();
+}
+
+void AsyncQueryCompletionQueue::Drain()
+{
+	while(m_pending)
+	{
+		Process();
+		if(m_pending)
+			Sleep(10);
+	}
+}
+
 void Database::AddQueryBuffer(QueryBuffer * b)
 {
 	if( qt != NULL )
@@ -392,3 +706,100 @@ void Database::FreeQueryResult(QueryResult * p)
 {
 	delete p;
 }
+
+uint32 Database::PrepareStatement(const char * sql)
+{
+	uint32 id;
+	string key(sql);
+
+	m_preparedLock.Acquire();
+	map<string, uint32>::iterator itr = m_preparedIds.find(key);
+	if(itr != m_preparedIds.end())
+		id = itr->second;
+	else
+	{
+		size_t len = key.size();
+		char * pBuffer = new char[len+1];
+		memcpy(pBuffer, sql, len + 1);
+
+		id = (uint32)m_preparedSql.size();
+		m_preparedSql.push_back(pBuffer);
+		m_preparedIds.insert(make_pair(key, id));
+	}
+	m_preparedLock.Release();
+
+	return id;
+}
+
+const char * Database::_GetPreparedSQL(uint32 id)
+{
+	const char * ret = NULL;
+
+	// the strings never move, only the vector holding the pointers does
+	m_preparedLock.Acquire();
+	if(id < m_preparedSql.size())
+		ret = m_preparedSql[id];
+	m_preparedLock.Release();
+
+	return ret;
+}
+
+QueryResult * Database::QueryPrepared(PreparedStatement * stmt)
+{
+	bool success;
+	DatabaseConnection * con = GetFreeConnection();
+	QueryResult * qResult = _SendPrepared(con, stmt, &success);
+	ReleaseConnection(con);
+	return qResult;
+}
+
+bool Database::WaitExecutePrepared(PreparedStatement * stmt)
+{
+	bool success;
+	DatabaseConnection * con = GetFreeConnection();
+	QueryResult * qResult = _SendPrepared(con, stmt, &success);
+	ReleaseConnection(con);
+
+	if(qResult != NULL)
+		delete qResult;
+	return success;
+}
+
+void Database::ExecutePrepared(PreparedStatement * stmt)
+{
+	QueryBuffer * b = new QueryBuffer;
+	b->AddPrepared(stmt);
+	AddQueryBuffer(b);
+}
+
+QueryResult * Database::_SendPrepared(DatabaseConnection * con, PreparedStatement * stmt, bool * success)
+{
+	const char * sql = _GetPreparedSQL(stmt->GetId());
+	*success = false;
+	if(sql == NULL)
+		return NULL;
+
+	stringstream ss;
+	char buf[32];
+	size_t param = 0;
+	for(const char * p = sql; *p != 0; ++p)
+	{
+		if(*p != '?' || param >= stmt->GetParamCount())
+		{
+			ss << *p;
+			continue;
+		}
+
+		const PreparedStatementParam & v = stmt->GetParam(param++);
+		switch(v.type)
+		{
+		case PREPARED_PARAM_INT:	snprintf(buf, 32, SI64FMTD, (long long)v.value.i); ss << buf; break;
+		case PREPARED_PARAM_UINT:	snprintf(buf, 32, I64FMTD, (unsigned long long)v.value.u); ss << buf; break;
+		case PREPARED_PARAM_REAL:	snprintf(buf, 32, "%.9g", v.value.f); ss << buf; break;
+		default:					ss << "'" << EscapeString(v.str.c_str(), con) << "'"; break;
+		}
+	}
+
+	*success = _SendQuery(con, ss.str().c_str(), false);
+	return *success ? _StoreQueryResult(con) : NULL;
+}
@@ -27,11 +27,29 @@
 using namespace std;
 class QueryResult;
 class QueryThread;
+class AsyncQueryThread;
+class AsyncQueryCompletionQueue;
 class Database;
 
+/** Lanes of the connection pool. Waiters of a higher lane are served first,
+ * waiters of the same lane in the order they arrived.
+ */
+enum DatabasePriority
+{
+	DATABASE_PRIORITY_HIGH		= 0,		// queries somebody is waiting for (default)
+	DATABASE_PRIORITY_LOW		= 1,		// saves, cleanup and other background traffic
+	NUM_DATABASE_PRIORITIES		= 2,
+};
+
 struct DatabaseConnection
 {
-	FastMutex Busy;
+	DatabaseConnection() : Queries(0), Checkouts(0), HoldTime(0), AcquireTime(0) {}
+
+	// statistics, written by the thread holding the connection
+	uint64 Queries;
+	uint64 Checkouts;
+	uint64 HoldTime;			// ms the connection was checked out
+	uint32 AcquireTime;
 };
 
 struct SERVER_DECL AsyncQueryResult
@@ -43,30 +61,160 @@ struct SERVER_DECL AsyncQueryResult
 class SERVER_DECL AsyncQuery
 {
 	friend class Database;
+	friend class AsyncQueryCompletionQueue;
 	SQLCallbackBase * func;
 	vector<AsyncQueryResult> queries;
 	Database * db;
+	AsyncQueryCompletionQueue * completion;
+
+	void _Execute(DatabaseConnection * conn);
+	void _Complete();
 public:
-	AsyncQuery(SQLCallbackBase * f) : func(f) {}
+	AsyncQuery(SQLCallbackBase * f) : func(f), db(NULL), completion(NULL) {}
 	~AsyncQuery();
 	void AddQuery(const char * format, ...);
 	void Perform();
 	ASCENT_INLINE void SetDB(Database * dbb) { db = dbb; }
 };
 
+/** Async queries which are done and wait for the thread that queued them. A thread binds
+ * its queue once and calls Process() from its loop, so the callbacks run on that thread
+ * like the rest of its work. Queries queued from a thread without a queue are executed
+ * and completed inline.
+ */
+class SERVER_DECL AsyncQueryCompletionQueue
+{
+	friend class Database;
+	Mutex m_lock;
+	vector<AsyncQuery*> m_completed;
+	vector<AsyncQuery*> m_work;
+	volatile long m_pending;
+
+	void _Push(AsyncQuery * query);
+public:
+	AsyncQueryCompletionQueue() : m_pending(0) {}
+	~AsyncQueryCompletionQueue();
+
+	/** Queries queued by the calling thread complete in this queue from now on.
+	 */
+	void Bind();
+	static void Unbind();
+	static AsyncQueryCompletionQueue * GetCurrent();
+
+	/** Runs the callbacks of all completed queries, called by the owning thread.
+	 */
+	void Process();
+
+	/** Waits for the queries still executing and processes them, for owners about to go away.
+	 */
+	void Drain();
+
+	ASCENT_INLINE uint32 GetPendingCount() { return (uint32)m_pending; }
+};
+
+enum PreparedParamType
+{
+	PREPARED_PARAM_INT,
+	PREPARED_PARAM_UINT,
+	PREPARED_PARAM_REAL,
+	PREPARED_PARAM_STRING,
+};
+
+struct PreparedStatementParam
+{
+	uint8 type;
+	union
+	{
+		int64 i;
+		uint64 u;
+		double f;
+	} value;
+	string str;
+};
+
+/** One execution of a statement registered with Database::PrepareStatement(). Values are
+ * bound in the order of the ? placeholders in the statement and sent in binary, the
+ * statement itself is prepared once per connection.
+ */
+class SERVER_DECL PreparedStatement
+{
+	friend class Database;
+	uint32 m_id;
+	vector<PreparedStatementParam> m_params;
+
+	ASCENT_INLINE PreparedStatementParam & _Add(uint8 type)
+	{
+		m_params.resize(m_params.size() + 1);
+		m_params.back().type = type;
+		return m_params.back();
+	}
+public:
+	PreparedStatement(uint32 id) : m_id(id) {}
+
+	ASCENT_INLINE uint32 GetId() const { return m_id; }
+	ASCENT_INLINE size_t GetParamCount() const { return m_params.size(); }
+	ASCENT_INLINE const PreparedStatementParam & GetParam(size_t i) const { return m_params[i]; }
+
+	ASCENT_INLINE void BindInt32(int32 v) { _Add(PREPARED_PARAM_INT).value.i = v; }
+	ASCENT_INLINE void BindUInt32(uint32 v) { _Add(PREPARED_PARAM_UINT).value.u = v; }
+	ASCENT_INLINE void BindUInt64(uint64 v) { _Add(PREPARED_PARAM_UINT).value.u = v; }
+	ASCENT_INLINE void BindFloat(float v) { _Add(PREPARED_PARAM_REAL).value.f = v; }
+	ASCENT_INLINE void BindString(const char * v) { _Add(PREPARED_PARAM_STRING).str = v ? v : ""; }
+	ASCENT_INLINE void BindString(const string & v) { _Add(PREPARED_PARAM_STRING).str = v; }
+
+	/** Clears the bound values to execute the statement again.
+	 */
+	ASCENT_INLINE void Reset() { m_params.clear(); }
+};
+
+/** Told whether a query buffer was written, on the thread that executed it, once its
+ * transaction is done. The buffer deletes it afterwards.
+ */
+class SERVER_DECL QueryBufferCallback
+{
+public:
+	virtual ~QueryBufferCallback() {}
+	virtual void OnComplete(bool success) = 0;
+};
+
 class SERVER_DECL QueryBuffer
 {
-	vector<char*> queries;
+	// either a query string or a prepared statement, in the order they were added
+	struct QueryBufferEntry
+	{
+		char * query;
+		PreparedStatement * statement;
+	};
+	vector<QueryBufferEntry> queries;
+	size_t bytes;
+	QueryBufferCallback * callback;
 public:
 	friend class Database;
+	QueryBuffer() : bytes(0), callback(NULL) {}
+
 	void AddQuery( const char * format, ... );
 	void AddQueryNA( const char * str );
 	void AddQueryStr(const string& str);
+
+	/** Adds a heap allocated statement, the buffer deletes it once it is executed.
+	 */
+	void AddPrepared(PreparedStatement * stmt);
+
+	/** Sets a heap allocated callback to tell once the buffer is executed.
+	 */
+	ASCENT_INLINE void SetCallback(QueryBufferCallback * cb) { callback = cb; }
+
+	ASCENT_INLINE size_t GetCount() const { return queries.size(); }
+
+	/** Size of the query text plus the bound values of prepared statements.
+	 */
+	ASCENT_INLINE size_t GetSize() const { return bytes; }
 };
 
 class SERVER_DECL Database : public CThread
 {
 	friend class QueryThread;
+	friend class AsyncQueryThread;
 	friend class AsyncQuery;
 public:
 	Database();
@@ -100,6 +248,10 @@ public:
 	ASCENT_INLINE const string& GetHostName() { return mHostname; }
 	ASCENT_INLINE const string& GetDatabaseName() { return mDatabaseName; }
 	ASCENT_INLINE const uint32 GetQueueSize() { return queries_queue.get_size(); }
+	uint32 GetAsyncQueueSize();
+
+	// number of threads executing async queries, each gets a connection on top of ConnectionCount. Set before Initialize().
+	ASCENT_INLINE void SetAsyncThreadCount(uint32 count) { mAsyncThreadCount = count; }
 
 	virtual string EscapeString(string Escape) = 0;
 	virtual void EscapeLongString(const char * str, uint32 len, stringstream& out) = 0;
@@ -109,30 +261,78 @@ public:
 	void EndThreads();
 	
 	void thread_proc_query();
+	void thread_proc_async();
 	void FreeQueryResult(QueryResult * p);
 
+	/** Checks out a connection, blocks until one is returned if all of them are busy.
+	 * Uses the lane set for the calling thread, see SetConnectionPriority().
+	 */
 	DatabaseConnection * GetFreeConnection();
+	DatabaseConnection * GetFreeConnection(uint32 priority);
+	void ReleaseConnection(DatabaseConnection * con);
+
+	/** Lane the calling thread checks out connections with, defaults to DATABASE_PRIORITY_HIGH.
+	 */
+	static void SetConnectionPriority(uint32 priority);
+
+	ASCENT_INLINE int32 GetConnectionCount() { return mConnectionCount; }
+	ASCENT_INLINE DatabaseConnection * GetConnection(uint32 i) { return Connections[i]; }
+
+	/** checkouts: connections handed out, waits: checkouts which had to block,
+	 * wait_time: ms spent blocking in total.
+	 */
+	void GetPoolStatistics(uint64 * checkouts, uint64 * waits, uint64 * wait_time);
 
 	void PerformQueryBuffer(QueryBuffer * b, DatabaseConnection * ccon);
 	void AddQueryBuffer(QueryBuffer * b);
 
+	/** Registers a statement with ? placeholders and returns its id. Registering the same
+	 * text again returns the same id, so loaders may simply call this before every use.
+	 */
+	uint32 PrepareStatement(const char * sql);
+
+	/** Executes a prepared statement and returns its result, rows are read in binary.
+	 */
+	QueryResult * QueryPrepared(PreparedStatement * stmt);
+	bool WaitExecutePrepared(PreparedStatement * stmt);
+
+	/** Queues a heap allocated statement for the query buffer thread, which deletes it.
+	 */
+	void ExecutePrepared(PreparedStatement * stmt);
+
 	static Database * CreateDatabaseInterface(uint32 uType);
 
 	virtual bool SupportsReplaceInto() = 0;
 	virtual bool SupportsTableLocking() = 0;
 
+	/** Value which changes whenever the table is written, 0 if the table does not exist.
+	 * Returns false if the server cannot tell without reading the whole table.
+	 */
+	virtual bool GetTableVersion(const char * table, uint64 * version) { *version = 0; return false; }
+
 protected:
 
 	// spawn threads and shizzle
 	void _Initialize();
 
 	virtual void _BeginTransaction(DatabaseConnection * conn) = 0;
-	virtual void _EndTransaction(DatabaseConnection * conn) = 0;
+	virtual bool _EndTransaction(DatabaseConnection * conn) = 0;
 
 	// actual query function
 	virtual bool _SendQuery(DatabaseConnection *con, const char* Sql, bool Self) = 0;
 	virtual QueryResult * _StoreQueryResult(DatabaseConnection * con) = 0;
 
+	/** Executes a prepared statement on con. The default substitutes the escaped values into
+	 * the statement text and sends it as a normal query, for clients without prepared statements.
+	 */
+	virtual QueryResult * _SendPrepared(DatabaseConnection * con, PreparedStatement * stmt, bool * success);
+	const char * _GetPreparedSQL(uint32 id);
+
+	////////////////////////////////
+	Mutex m_preparedLock;
+	vector<char*> m_preparedSql;
+	map<string, uint32> m_preparedIds;
+
 	////////////////////////////////
 	FQueue<QueryBuffer*> query_buffer;
 
@@ -143,6 +343,29 @@ protected:
 	uint32 _counter;
 	///////////////////////////////
 
+	////////////////////////////////
+	// connection pool, waiters take a ticket of their lane and are served in ticket order
+	Mutex m_poolLock;
+	Condition m_poolCond;
+	vector<DatabaseConnection*> m_freeConnections;
+	uint64 m_nextTicket[NUM_DATABASE_PRIORITIES];
+	uint64 m_servingTicket[NUM_DATABASE_PRIORITIES];
+	uint64 m_poolCheckouts;
+	uint64 m_poolWaits;
+	uint64 m_poolWaitTime;
+
+	bool _CanCheckout(uint32 priority, uint64 ticket);
+	///////////////////////////////
+
+	////////////////////////////////
+	Mutex m_asyncLock;
+	Condition m_asyncCond;
+	deque<AsyncQuery*> m_asyncQueue;
+	uint32 mAsyncThreadCount;
+	volatile long mAsyncThreadsRunning;
+	bool m_asyncShutdown;
+	///////////////////////////////
+
 	int32 mConnectionCount;
 
 	// For reconnecting a broken connection
@@ -184,4 +407,12 @@ public:
 	bool run();
 };
 
+class SERVER_DECL AsyncQueryThread : public CThread
+{
+	Database * db;
+public:
+	AsyncQueryThread(Database * d) : CThread(), db(d) {}
+	bool run();
+};
+
 #endif
@@ -20,22 +20,71 @@
 #if !defined(FIELD_H)
 #define FIELD_H
 
+/** Field values of text protocol results are parsed on every access, binary results
+ * (prepared statements) store the value as the column type instead.
+ */
+enum FieldValueType
+{
+	FIELD_VALUE_TEXT,
+	FIELD_VALUE_INT,
+	FIELD_VALUE_UINT,
+	FIELD_VALUE_REAL,
+};
+
 class Field
 {
 public:
+	Field() : mValue(NULL), mType(FIELD_VALUE_TEXT) {}
+
+	ASCENT_INLINE void SetValue(char* value) { mValue = value; mType = FIELD_VALUE_TEXT; }
+	ASCENT_INLINE void SetInt(int64 value) { mInt = value; mType = FIELD_VALUE_INT; }
+	ASCENT_INLINE void SetUInt(uint64 value) { mUInt = value; mType = FIELD_VALUE_UINT; }
+	ASCENT_INLINE void SetReal(double value) { mReal = value; mType = FIELD_VALUE_REAL; }
+
+	ASCENT_INLINE uint8 GetValueType() { return mType; }
+
+	const char *GetString()
+	{
+		switch(mType)
+		{
+		case FIELD_VALUE_INT:	snprintf(mBuffer, sizeof(mBuffer), SI64FMTD, (long long)mInt); return mBuffer;
+		case FIELD_VALUE_UINT:	snprintf(mBuffer, sizeof(mBuffer), I64FMTD, (unsigned long long)mUInt); return mBuffer;
+		case FIELD_VALUE_REAL:	snprintf(mBuffer, sizeof(mBuffer), "%.9g", mReal); return mBuffer;
+		}
+		return mValue;
+	}
 
-	ASCENT_INLINE void SetValue(char* value) { mValue = value; }
+	ASCENT_INLINE float GetFloat()
+	{
+		if(mType == FIELD_VALUE_TEXT)
+			return mValue ? static_cast<float>(atof(mValue)) : 0;
+		return static_cast<float>(_GetReal());
+	}
 
-	ASCENT_INLINE const char *GetString() { return mValue; }
-	ASCENT_INLINE float GetFloat() { return mValue ? static_cast<float>(atof(mValue)) : 0; }
-	ASCENT_INLINE bool GetBool() { return mValue ? atoi(mValue) > 0 : false; }
-	ASCENT_INLINE uint8 GetUInt8() { return mValue ? static_cast<uint8>(atol(mValue)) : 0; }
-	ASCENT_INLINE int8 GetInt8() { return mValue ? static_cast<int8>(atol(mValue)) : 0; }
-	ASCENT_INLINE uint16 GetUInt16() { return mValue ? static_cast<uint16>(atol(mValue)) : 0; }
-	ASCENT_INLINE uint32 GetUInt32() { return mValue ? static_cast<uint32>(atol(mValue)) : 0; }
-	ASCENT_INLINE uint32 GetInt32() { return mValue ? static_cast<int32>(atol(mValue)) : 0; }
+	ASCENT_INLINE double GetDouble()
+	{
+		if(mType == FIELD_VALUE_TEXT)
+			return mValue ? atof(mValue) : 0;
+		return _GetReal();
+	}
+
+	ASCENT_INLINE bool GetBool()
+	{
+		if(mType == FIELD_VALUE_TEXT)
+			return mValue ? atoi(mValue) > 0 : false;
+		return _GetInt() > 0;
+	}
+
+	ASCENT_INLINE uint8 GetUInt8() { return (mType == FIELD_VALUE_TEXT) ? (mValue ? static_cast<uint8>(atol(mValue)) : 0) : static_cast<uint8>(_GetInt()); }
+	ASCENT_INLINE int8 GetInt8() { return (mType == FIELD_VALUE_TEXT) ? (mValue ? static_cast<int8>(atol(mValue)) : 0) : static_cast<int8>(_GetInt()); }
+	ASCENT_INLINE uint16 GetUInt16() { return (mType == FIELD_VALUE_TEXT) ? (mValue ? static_cast<uint16>(atol(mValue)) : 0) : static_cast<uint16>(_GetInt()); }
+	ASCENT_INLINE uint32 GetUInt32() { return (mType == FIELD_VALUE_TEXT) ? (mValue ? static_cast<uint32>(atol(mValue)) : 0) : static_cast<uint32>(_GetInt()); }
+	ASCENT_INLINE uint32 GetInt32() { return (mType == FIELD_VALUE_TEXT) ? (mValue ? static_cast<int32>(atol(mValue)) : 0) : static_cast<int32>(_GetInt()); }
 	uint64 GetUInt64() 
 	{
+		if(mType != FIELD_VALUE_TEXT)
+			return static_cast<uint64>(_GetInt());
+
 		if(mValue)
 		{
 			uint64 value;
@@ -51,7 +100,31 @@ public:
 	}
 
 private:
+	ASCENT_INLINE int64 _GetInt()
+	{
+		if(mType == FIELD_VALUE_REAL)
+			return static_cast<int64>(mReal);
+		return mInt;
+	}
+
+	ASCENT_INLINE double _GetReal()
+	{
+		if(mType == FIELD_VALUE_INT)
+			return static_cast<double>(mInt);
+		if(mType == FIELD_VALUE_UINT)
+			return static_cast<double>(mUInt);
+		return mReal;
+	}
+
 		char *mValue;
+		union
+		{
+			int64 mInt;
+			uint64 mUInt;
+			double mReal;
+		};
+		uint8 mType;
+		char mBuffer[24];
 };
 
 #endif
@@ -29,7 +29,10 @@
 MySQLDatabase::~MySQLDatabase()
 {
 	for(int32 i = 0; i < mConnectionCount; ++i)
+	{
+		_CloseStatements(static_cast<MySQLDatabaseConnection*>(Connections[i]));
 		delete Connections[i];
+	}
 
 	delete [] Connections;
 }
@@ -44,9 +47,9 @@ void MySQLDatabase::_BeginTransaction(DatabaseConnection * conn)
 	_SendQuery( conn, "START TRANSACTION", false );
 }
 
-void MySQLDatabase::_EndTransaction(DatabaseConnection * conn)
+bool MySQLDatabase::_EndTransaction(DatabaseConnection * conn)
 {
-	_SendQuery( conn, "COMMIT", false );
+	return _SendQuery( conn, "COMMIT", false );
 }
 
 bool MySQLDatabase::Initialize(const char* Hostname, unsigned int port, const char* Username, const char* Password, const char* DatabaseName, uint32 ConnectionCount, uint32 BufferSize)
@@ -56,6 +59,9 @@ bool MySQLDatabase::Initialize(const char* Hostname, unsigned int port, const ch
 	MySQLDatabaseConnection ** conns;
 	my_bool my_true = true;
 
+	// every async query thread keeps a connection of its own on top of the configured ones
+	ConnectionCount += mAsyncThreadCount;
+
 	mHostname = string(Hostname);
 	mConnectionCount = ConnectionCount;
 	mUsername = string(Username);
@@ -101,7 +107,7 @@ string MySQLDatabase::EscapeString(string Escape)
 	else
 		ret = a2;
 
-	con->Busy.Release();
+	ReleaseConnection(con);
 	return string(ret);
 }
 
@@ -117,7 +123,7 @@ void MySQLDatabase::EscapeLongString(const char * str, uint32 len, stringstream&
 		ret = a2;
 
 	out.write(a2, (std::streamsize)strlen(a2));
-	con->Busy.Release();
+	ReleaseConnection(con);
 }
 
 string MySQLDatabase::EscapeString(const char * esc, DatabaseConnection * con)
@@ -132,6 +138,48 @@ string MySQLDatabase::EscapeString(const char * esc, DatabaseConnection * con)
 	return string(ret);
 }
 
+bool MySQLDatabase::GetTableVersion(const char * table, uint64 * version)
+{
+	char sql[512];
+	*version = 0;
+
+	// QUICK returns the live checksum of MyISAM tables created with CHECKSUM=1 and NULL for
+	// every other table, it never scans one
+	QueryResult * result = Query("CHECKSUM TABLE `%s` QUICK", table);
+	if(result != NULL)
+	{
+		*version = result->Fetch()[1].GetUInt64();
+		delete result;
+		if(*version != 0)
+			return true;
+	}
+
+	// Otherwise the time of the last write. MySQL 8 caches the table statistics for a day
+	// unless the session asks for current ones, older servers don't know the variable.
+	// InnoDB only has an update time once the table was written since the server started.
+	DatabaseConnection * con = GetFreeConnection();
+	mysql_query(static_cast<MySQLDatabaseConnection*>(con)->MySql, "SET SESSION information_schema_stats_expiry = 0");
+	snprintf(sql, 512, "SELECT UNIX_TIMESTAMP(UPDATE_TIME), UNIX_TIMESTAMP(CREATE_TIME) FROM information_schema.TABLES "
+		"WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = '%s'", table);
+	result = FQuery(sql, con);
+	ReleaseConnection(con);
+
+	if(result == NULL)
+		return true;		// no such table
+
+	Field * f = result->Fetch();
+	uint32 updated = f[0].GetUInt32();
+	*version = ((uint64)updated << 32) | f[1].GetUInt32();
+	delete result;
+
+	if(updated == 0)
+	{
+		*version = 0;
+		return false;
+	}
+	return true;
+}
+
 void MySQLDatabase::Shutdown()
 {
 	// TODO
@@ -139,6 +187,9 @@ void MySQLDatabase::Shutdown()
 
 bool MySQLDatabase::_SendQuery(DatabaseConnection *con, const char* Sql, bool Self)
 {
+	if(!Self)
+		++con->Queries;
+
 	//dunno what it does ...leaving untouched 
 	int result = mysql_query(static_cast<MySQLDatabaseConnection*>(con)->MySql, Sql);
 	if(result > 0)
@@ -234,10 +285,286 @@ bool MySQLDatabase::_Reconnect(MySQLDatabaseConnection * conn)
 	}
 
 	if( conn->MySql != NULL )
+	{
+		_CloseStatements( conn );
 		mysql_close( conn->MySql );
+	}
 
 	conn->MySql = temp;
 	return true;
 }
 
+#define PREPARED_RESULT_BLOCK_SIZE 65536
+
+MYSQL_STMT * MySQLDatabase::_GetStatement(MySQLDatabaseConnection * con, uint32 id)
+{
+	if(id < con->Statements.size() && con->Statements[id] != NULL)
+		return con->Statements[id];
+
+	const char * sql = _GetPreparedSQL(id);
+	if(sql == NULL)
+		return NULL;
+
+	MYSQL_STMT * stmt = mysql_stmt_init(con->MySql);
+	if(stmt == NULL)
+		return NULL;
+
+	if(mysql_stmt_prepare(stmt, sql, (unsigned long)strlen(sql)) != 0)
+	{
+		printf("Sql statement could not be prepared due to [%s], Query: [%s]\n", mysql_stmt_error(stmt), sql);
+		mysql_stmt_close(stmt);
+		return NULL;
+	}
+
+	if(id >= con->Statements.size())
+		con->Statements.resize(id + 1, NULL);
+
+	con->Statements[id] = stmt;
+	return stmt;
+}
+
+void MySQLDatabase::_CloseStatements(MySQLDatabaseConnection * con)
+{
+	// statements belong to the MYSQL handle, they are prepared again after a reconnect
+	for(vector<MYSQL_STMT*>::iterator itr = con->Statements.begin(); itr != con->Statements.end(); ++itr)
+	{
+		if((*itr) != NULL)
+			mysql_stmt_close(*itr);
+	}
+	con->Statements.clear();
+}
+
+QueryResult * MySQLDatabase::_SendPrepared(DatabaseConnection * con, PreparedStatement * stmt, bool * success)
+{
+	MySQLDatabaseConnection * db = static_cast<MySQLDatabaseConnection*>(con);
+	MYSQL_STMT * st;
+	size_t i, count = stmt->GetParamCount();
+	vector<MYSQL_BIND> params(count);
+	vector<unsigned long> lengths(count);
+	bool retried = false;
+
+	*success = false;
+	++con->Queries;
+
+	if(count)
+		memset(&params[0], 0, sizeof(MYSQL_BIND) * count);
+
+	for(i = 0; i < count; ++i)
+	{
+		const PreparedStatementParam & p = stmt->GetParam(i);
+		switch(p.type)
+		{
+		case PREPARED_PARAM_INT:
+		case PREPARED_PARAM_UINT:
+			params[i].buffer_type = MYSQL_TYPE_LONGLONG;
+			params[i].buffer = (void*)&p.value.i;
+			params[i].is_unsigned = (p.type == PREPARED_PARAM_UINT);
+			break;
+
+		case PREPARED_PARAM_REAL:
+			params[i].buffer_type = MYSQL_TYPE_DOUBLE;
+			params[i].buffer = (void*)&p.value.f;
+			break;
+
+		default:
+			lengths[i] = (unsigned long)p.str.size();
+			params[i].buffer_type = MYSQL_TYPE_STRING;
+			params[i].buffer = (void*)p.str.c_str();
+			params[i].buffer_length = lengths[i];
+			params[i].length = &lengths[i];
+			break;
+		}
+	}
+
+	for(;;)
+	{
+		st = _GetStatement(db, stmt->GetId());
+		if(st == NULL)
+			return NULL;
+
+		if((count == 0 || mysql_stmt_bind_param(st, &params[0]) == 0) && mysql_stmt_execute(st) == 0)
+			break;
+
+		uint32 err = mysql_stmt_errno(st);
+		if(retried || !_HandleError(db, err))
+		{
+			printf("Sql statement failed due to [%s], Query: [%s]\n", mysql_stmt_error(st), _GetPreparedSQL(stmt->GetId()));
+			return NULL;
+		}
+
+		// reconnected, the statement is prepared again on the new handle
+		retried = true;
+	}
+
+	*success = true;
+
+	MYSQL_RES * meta = mysql_stmt_result_metadata(st);
+	if(meta == NULL)
+		return NULL;
+
+	uint32 fields = mysql_num_fields(meta);
+	MYSQL_FIELD * f = mysql_fetch_fields(meta);
+	my_bool update_max = 1;
+	mysql_stmt_attr_set(st, STMT_ATTR_UPDATE_MAX_LENGTH, &update_max);
+	if(mysql_stmt_store_result(st) != 0)
+	{
+		printf("Sql statement result could not be stored due to [%s]\n", mysql_stmt_error(st));
+		mysql_free_result(meta);
+		*success = false;
+		return NULL;
+	}
+
+	if(mysql_stmt_num_rows(st) == 0)
+	{
+		mysql_free_result(meta);
+		mysql_stmt_free_result(st);
+		return NULL;
+	}
+
+	MySQLPreparedResult * res = new MySQLPreparedResult(fields);
+	vector<MYSQL_BIND> binds(fields);
+	vector<uint64> values(fields);
+	vector<my_bool> nulls(fields);
+	vector<unsigned long> sizes(fields);
+	vector<char*> buffers(fields, (char*)NULL);
+	memset(&binds[0], 0, sizeof(MYSQL_BIND) * fields);
+
+	for(i = 0; i < fields; ++i)
+	{
+		binds[i].is_null = &nulls[i];
+		binds[i].length = &sizes[i];
+		switch(f[i].type)
+		{
+		case MYSQL_TYPE_TINY:
+		case MYSQL_TYPE_SHORT:
+		case MYSQL_TYPE_INT24:
+		case MYSQL_TYPE_LONG:
+		case MYSQL_TYPE_LONGLONG:
+			binds[i].buffer_type = MYSQL_TYPE_LONGLONG;
+			binds[i].buffer = &values[i];
+			binds[i].is_unsigned = (f[i].flags & UNSIGNED_FLAG) != 0;
+			res->SetColumnType(i, binds[i].is_unsigned ? FIELD_VALUE_UINT : FIELD_VALUE_INT);
+			break;
+
+		case MYSQL_TYPE_FLOAT:
+		case MYSQL_TYPE_DOUBLE:
+			binds[i].buffer_type = MYSQL_TYPE_DOUBLE;
+			binds[i].buffer = &values[i];
+			res->SetColumnType(i, FIELD_VALUE_REAL);
+			break;
+
+		default:
+			buffers[i] = new char[f[i].max_length + 1];
+			binds[i].buffer_type = MYSQL_TYPE_STRING;
+			binds[i].buffer = buffers[i];
+			binds[i].buffer_length = f[i].max_length + 1;
+			res->SetColumnType(i, FIELD_VALUE_TEXT);
+			break;
+		}
+	}
+
+	if(mysql_stmt_bind_result(st, &binds[0]) == 0)
+	{
+		while(mysql_stmt_fetch(st) == 0)
+			res->AddRow(&binds[0], &values[0], &nulls[0], &sizes[0]);
+	}
+
+	for(i = 0; i < fields; ++i)
+		delete [] buffers[i];
+
+	mysql_free_result(meta);
+	mysql_stmt_free_result(st);
+
+	res->NextRow();
+	return res;
+}
+
+MySQLPreparedResult::MySQLPreparedResult(uint32 FieldCount) : QueryResult(FieldCount, 0), mTypes(FieldCount, FIELD_VALUE_TEXT), mBlockUsed(PREPARED_RESULT_BLOCK_SIZE), mNextRow(0)
+{
+	mCurrentRow = new Field[FieldCount];
+}
+
+MySQLPreparedResult::~MySQLPreparedResult()
+{
+	for(vector<char*>::iterator itr = mBlocks.begin(); itr != mBlocks.end(); ++itr)
+		delete [] (*itr);
+
+	delete [] mCurrentRow;
+}
+
+char * MySQLPreparedResult::_Store(const char * str, size_t len)
+{
+	char * ret;
+	if(len + 1 > PREPARED_RESULT_BLOCK_SIZE)
+	{
+		// does not fit a block, give it its own and keep filling the current one
+		ret = new char[len + 1];
+		mBlocks.insert(mBlocks.begin(), ret);
+	}
+	else
+	{
+		if(mBlockUsed + len + 1 > PREPARED_RESULT_BLOCK_SIZE)
+		{
+			mBlocks.push_back(new char[PREPARED_RESULT_BLOCK_SIZE]);
+			mBlockUsed = 0;
+		}
+
+		ret = mBlocks.back() + mBlockUsed;
+		mBlockUsed += len + 1;
+	}
+
+	memcpy(ret, str, len);
+	ret[len] = 0;
+	return ret;
+}
+
+void MySQLPreparedResult::AddRow(MYSQL_BIND * binds, uint64 * values, my_bool * nulls, unsigned long * lengths)
+{
+	for(uint32 i = 0; i < mFieldCount; ++i)
+	{
+		mNulls.push_back(nulls[i] ? 1 : 0);
+		if(nulls[i])
+			mValues.push_back(0);
+		else if(mTypes[i] == FIELD_VALUE_TEXT)
+			mValues.push_back((uint64)(size_t)_Store((const char*)binds[i].buffer, lengths[i]));
+		else
+			mValues.push_back(values[i]);
+	}
+
+	++mRowCount;
+}
+
+bool MySQLPreparedResult::NextRow()
+{
+	if(mNextRow >= mRowCount)
+		return false;
+
+	size_t offset = (size_t)mNextRow * mFieldCount;
+	for(uint32 i = 0; i < mFieldCount; ++i)
+	{
+		uint64 v = mValues[offset + i];
+		if(mNulls[offset + i])
+		{
+			mCurrentRow[i].SetValue(NULL);
+			continue;
+		}
+
+		switch(mTypes[i])
+		{
+		case FIELD_VALUE_INT:	mCurrentRow[i].SetInt((int64)v); break;
+		case FIELD_VALUE_UINT:	mCurrentRow[i].SetUInt(v); break;
+		case FIELD_VALUE_REAL:
+			{
+				double d;
+				memcpy(&d, &v, sizeof(double));
+				mCurrentRow[i].SetReal(d);
+			}break;
+		default:				mCurrentRow[i].SetValue((char*)(size_t)v); break;
+		}
+	}
+
+	++mNextRow;
+	return true;
+}
+
 #endif
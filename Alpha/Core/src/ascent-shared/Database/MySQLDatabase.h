@@ -6,6 +6,9 @@
 struct MySQLDatabaseConnection : public DatabaseConnection
 {
 	MYSQL * MySql;
+
+	// statements prepared on this connection, indexed by the statement id
+	vector<MYSQL_STMT*> Statements;
 };
 
 class SERVER_DECL MySQLDatabase : public Database
@@ -28,6 +31,7 @@ public:
 
 	bool SupportsReplaceInto() { return true; }
 	bool SupportsTableLocking() { return true; }
+	bool GetTableVersion(const char * table, uint64 * version);
 	
 protected:
 
@@ -35,10 +39,14 @@ protected:
 	bool _SendQuery(DatabaseConnection *con, const char* Sql, bool Self = false);
 
 	void _BeginTransaction(DatabaseConnection * conn);
-	void _EndTransaction(DatabaseConnection * conn);
+	bool _EndTransaction(DatabaseConnection * conn);
 	bool _Reconnect(MySQLDatabaseConnection * conn);
 
 	QueryResult * _StoreQueryResult(DatabaseConnection * con);
+
+	QueryResult * _SendPrepared(DatabaseConnection * con, PreparedStatement * stmt, bool * success);
+	MYSQL_STMT * _GetStatement(MySQLDatabaseConnection * con, uint32 id);
+	void _CloseStatements(MySQLDatabaseConnection * con);
 };
 
 class SERVER_DECL MySQLQueryResult : public QueryResult
@@ -53,4 +61,29 @@ protected:
 	MYSQL_RES* mResult;
 };
 
+/** Rows of a prepared statement, fetched in binary and kept until the result is freed.
+ * Numeric columns are handed out without going through a string.
+ */
+class SERVER_DECL MySQLPreparedResult : public QueryResult
+{
+public:
+	MySQLPreparedResult(uint32 FieldCount);
+	~MySQLPreparedResult();
+
+	bool NextRow();
+
+	void SetColumnType(uint32 column, uint8 type) { mTypes[column] = type; }
+	void AddRow(MYSQL_BIND * binds, uint64 * values, my_bool * nulls, unsigned long * lengths);
+
+protected:
+	char * _Store(const char * str, size_t len);
+
+	vector<uint8> mTypes;
+	vector<uint64> mValues;
+	vector<uint8> mNulls;
+	vector<char*> mBlocks;
+	size_t mBlockUsed;
+	uint32 mNextRow;
+};
+
 #endif		// __MYSQLDATABASE_H
@@ -42,9 +42,9 @@ void PostgresDatabase::_BeginTransaction(DatabaseConnection * conn)
 	_SendQuery( conn, "BEGIN TRANSACTION", false );
 }
 
-void PostgresDatabase::_EndTransaction(DatabaseConnection * conn)
+bool PostgresDatabase::_EndTransaction(DatabaseConnection * conn)
 {
-	_SendQuery( conn, "COMMIT TRANSACTION", false );
+	return _SendQuery( conn, "COMMIT TRANSACTION", false );
 }
 
 bool PostgresDatabase::Initialize(const char* Hostname, unsigned int port, const char* Username, const char* Password, const char* DatabaseName, uint32 ConnectionCount, uint32 BufferSize)
@@ -52,6 +52,9 @@ bool PostgresDatabase::Initialize(const char* Hostname, unsigned int port, const
 	uint32 i;
 	PostgresDatabaseConnection * con;
 
+	// every async query thread keeps a connection of its own on top of the configured ones
+	ConnectionCount += mAsyncThreadCount;
+
 	mHostname = string(Hostname);
 	mConnectionCount = ConnectionCount;
 	mUsername = string(Username);
@@ -98,7 +101,7 @@ string PostgresDatabase::EscapeString(string Escape)
 	else
 		ret = a2;
 
-	con->Busy.Release();
+	ReleaseConnection(con);
 	return string(ret);
 }
 
@@ -115,7 +118,7 @@ void PostgresDatabase::EscapeLongString(const char * str, uint32 len, stringstre
 		ret = a2;
 
 	out.write(a2, (std::streamsize)strlen(a2));
-	con->Busy.Release();
+	ReleaseConnection(con);
 }
 
 string PostgresDatabase::EscapeString(const char * esc, DatabaseConnection * con)
@@ -138,6 +141,9 @@ void PostgresDatabase::Shutdown()
 
 bool PostgresDatabase::_SendQuery(DatabaseConnection *con, const char* Sql, bool Self)
 {
+	if(!Self)
+		++con->Queries;
+
 	PGresult * res = PQexec( static_cast<PostgresDatabaseConnection*>(con)->PgSql, Sql );
 	if( res == NULL )
 	{
@@ -40,9 +40,10 @@ void SQLiteDatabase::_BeginTransaction(DatabaseConnection * conn)
 	//_SendQuery( conn, "BEGIN TRANSACTION", false );
 }
 
-void SQLiteDatabase::_EndTransaction(DatabaseConnection * conn)
+bool SQLiteDatabase::_EndTransaction(DatabaseConnection * conn)
 {
 	//_SendQuery( conn, "COMMIT TRANSACTION", false );
+	return true;
 }
 
 bool SQLiteDatabase::Initialize(const char* Hostname, unsigned int port, const char* Username, const char* Password, const char* DatabaseName, uint32 ConnectionCount, uint32 BufferSize)
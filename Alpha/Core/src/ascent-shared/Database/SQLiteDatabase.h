@@ -35,7 +35,7 @@ protected:
 	bool _SendQuery(DatabaseConnection *con, const char* Sql, bool Self = false);
 
 	void _BeginTransaction(DatabaseConnection * conn);
-	void _EndTransaction(DatabaseConnection * conn);
+	bool _EndTransaction(DatabaseConnection * conn);
 
 	QueryResult * _StoreQueryResult(DatabaseConnection * con);
 
@@ -29,6 +29,11 @@ public:
 	ASCENT_INLINE void Release() { }
 };
 
+/** nodes a queue keeps for reuse after popping, so a busy queue does not allocate
+ * one node per element.
+ */
+#define FASTQUEUE_SPARE_NODES 32
+
 /** linked-list style queue
  */
 template<class T, class LOCK>
@@ -42,19 +47,56 @@ class FastQueue
 
 	node * last;
 	node * first;
+	node * spare;
+	uint32 spare_count;
 	LOCK m_lock;
 
+	// both called with the lock held
+	ASCENT_INLINE node * _NewNode()
+	{
+		if(spare == 0)
+			return new node;
+
+		node * n = spare;
+		spare = n->next;
+		--spare_count;
+		return n;
+	}
+
+	ASCENT_INLINE void _FreeNode(node * n)
+	{
+		if(spare_count >= FASTQUEUE_SPARE_NODES)
+		{
+			delete n;
+			return;
+		}
+
+		n->next = spare;
+		spare = n;
+		++spare_count;
+	}
+
 public:
 
 	FastQueue()
 	{
 		last = 0;
 		first = 0;
+		spare = 0;
+		spare_count = 0;
 	}
 
 	~FastQueue()
 	{
 		Clear();
+
+		node * n;
+		while(spare != 0)
+		{
+			n = spare;
+			spare = n->next;
+			delete n;
+		}
 	}
 
 	void Clear()
@@ -67,7 +109,7 @@ public:
 	void Push(T elem)
 	{
 		m_lock.Acquire();
-		node * n = new node;
+		node * n = _NewNode();
 		if(last)
 			last->next = n;
 		else
@@ -94,7 +136,7 @@ public:
 		if(!first)
 			last = 0;
 
-		delete td;
+		_FreeNode(td);
 		m_lock.Release();
 		return ret;
 	}
@@ -127,7 +169,7 @@ public:
 		if(!first)
 			last = 0;
 
-		delete td;
+		_FreeNode(td);
 		m_lock.Release();
 	}
 
@@ -0,0 +1,183 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Common.h"
+#include "MappedFile.h"
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+MappedFile::MappedFile() : m_data(NULL), m_size(0), m_copyOnWrite(false)
+{
+#ifdef WIN32
+	m_file = INVALID_HANDLE_VALUE;
+	m_map = NULL;
+#else
+	m_fd = -1;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef WIN32
+
+bool MappedFile::Open(const char * filename, bool copy_on_write)
+{
+	Close();
+
+	m_file = CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if(m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	m_size = (size_t)GetFileSize(m_file, NULL);
+	if(m_size == 0 || m_size == (size_t)INVALID_FILE_SIZE)
+	{
+		Close();
+		return false;
+	}
+
+	m_map = CreateFileMapping(m_file, NULL, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+	if(m_map == NULL)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = (const uint8*)MapViewOfFile(m_map, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+	if(m_data == NULL)
+	{
+		Close();
+		return false;
+	}
+
+	m_copyOnWrite = copy_on_write;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(m_data != NULL)
+		UnmapViewOfFile((LPCVOID)m_data);
+	if(m_map != NULL)
+		CloseHandle(m_map);
+	if(m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+
+	m_data = NULL;
+	m_size = 0;
+	m_copyOnWrite = false;
+	m_map = NULL;
+	m_file = INVALID_HANDLE_VALUE;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size)
+{
+	// PrefetchVirtualMemory is not available before Windows 8
+}
+
+void MappedFile::Release(size_t offset, size_t size)
+{
+}
+
+#else
+
+bool MappedFile::Open(const char * filename, bool copy_on_write)
+{
+	struct stat st;
+	void * p;
+
+	Close();
+
+	m_fd = open(filename, O_RDONLY);
+	if(m_fd < 0)
+		return false;
+
+	if(fstat(m_fd, &st) != 0 || st.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_size = (size_t)st.st_size;
+	if(copy_on_write)
+		p = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_fd, 0);
+	else
+		p = mmap(NULL, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+
+	if(p == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = (const uint8*)p;
+	m_copyOnWrite = copy_on_write;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if(m_data != NULL)
+		munmap((void*)m_data, m_size);
+	if(m_fd >= 0)
+		close(m_fd);
+
+	m_data = NULL;
+	m_size = 0;
+	m_copyOnWrite = false;
+	m_fd = -1;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size)
+{
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size_t start, end;
+
+	if(m_data == NULL || offset >= m_size)
+		return;
+
+	// every page touching the range
+	start = offset & ~(page - 1);
+	end = (offset + size < m_size) ? offset + size : m_size;
+	madvise((void*)(m_data + start), end - start, MADV_WILLNEED);
+}
+
+void MappedFile::Release(size_t offset, size_t size)
+{
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size_t start, end;
+
+	// copy-on-write pages would lose their changes
+	if(m_data == NULL || m_copyOnWrite || offset >= m_size)
+		return;
+
+	// only pages entirely inside the range, the neighbours may still be in use
+	start = (offset + page - 1) & ~(page - 1);
+	end = ((offset + size < m_size) ? offset + size : m_size) & ~(page - 1);
+	if(end > start)
+		madvise((void*)(m_data + start), end - start, MADV_DONTNEED);
+}
+
+#endif
@@ -0,0 +1,71 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _MAPPEDFILE_H
+#define _MAPPEDFILE_H
+
+/** Read-only view of a whole file. Pages are loaded by the OS when they are touched
+ * and shared between processes mapping the same file.
+ */
+class SERVER_DECL MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	/** Maps the file, returns false if it does not exist or cannot be mapped.
+	 * A copy-on-write mapping can be written to, the written pages become private
+	 * to the process and the file is never changed.
+	 */
+	bool Open(const char * filename, bool copy_on_write = false);
+	void Close();
+
+	ASCENT_INLINE bool IsOpen() const { return m_data != NULL; }
+	ASCENT_INLINE const uint8 * GetData() const { return m_data; }
+	ASCENT_INLINE size_t GetSize() const { return m_size; }
+
+	/** NULL unless the file was mapped copy-on-write.
+	 */
+	ASCENT_INLINE uint8 * GetWritableData() const { return m_copyOnWrite ? (uint8*)m_data : NULL; }
+
+	/** Hints that the range will be read soon, the OS starts reading it in.
+	 */
+	void Prefetch(size_t offset, size_t size);
+
+	/** Hints that the range is not needed any more. Its pages are dropped from the
+	 * process and read again from the page cache on the next access.
+	 */
+	void Release(size_t offset, size_t size);
+
+private:
+	MappedFile(const MappedFile &);
+	MappedFile & operator=(const MappedFile &);
+
+	const uint8 * m_data;
+	size_t m_size;
+	bool m_copyOnWrite;
+#ifdef WIN32
+	HANDLE m_file;
+	HANDLE m_map;
+#else
+	int m_fd;
+#endif
+};
+
+#endif
@@ -277,3 +277,23 @@ void * CircularBuffer::GetBufferStart()
 		return m_regionBPointer;
 		
 }
+
+/** Returns the stored data as at most two contiguous blocks, oldest first
+ */
+void CircularBuffer::GetBlocks(uint8 ** first, size_t * firstSize, uint8 ** second, size_t * secondSize)
+{
+	if( m_regionASize > 0 )
+	{
+		*first = m_regionAPointer;
+		*firstSize = m_regionASize;
+		*second = (m_regionBSize > 0) ? m_regionBPointer : NULL;
+		*secondSize = m_regionBSize;
+	}
+	else
+	{
+		*first = m_regionBPointer;
+		*firstSize = m_regionBSize;
+		*second = NULL;
+		*secondSize = 0;
+	}
+}
@@ -103,6 +103,11 @@ public:
 	/** Returns a pointer at the "beginning" of the buffer, where data can be pulled from
 	*/
 	void * GetBufferStart();
+
+	/** Returns the stored data as at most two contiguous blocks, oldest first
+	* @param second set to the wrapped part of the data, NULL if there is none
+	*/
+	void GetBlocks(uint8 ** first, size_t * firstSize, uint8 ** second, size_t * secondSize);
 };
 
 #endif		// _NETLIB_CIRCULARBUFFER_H
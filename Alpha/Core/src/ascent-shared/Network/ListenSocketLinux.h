@@ -18,24 +18,27 @@ class ListenSocketBase
 {
 public:
 	virtual ~ListenSocketBase() {}
-	virtual void OnAccept() = 0;
+	virtual void OnAccept(int fd) = 0;
 	virtual int GetFd() = 0;
 };
 
+/* With <Listen ReusePort = "1"> one listening socket per reactor is bound to the same port
+ * with SO_REUSEPORT so the kernel spreads the connections. Accepted sockets stay on the
+ * reactor of the listener which accepted them. Otherwise, or without SO_REUSEPORT, a single
+ * listener is used and sockets are assigned round-robin by the SocketMgr.
+ */
 template<class T>
 class ListenSocket : public ListenSocketBase
 {
 public:
 	ListenSocket(const char * ListenAddress, uint32 Port) : ListenSocketBase()
     {
-        m_socket = socket(AF_INET, SOCK_STREAM, 0);
-        SocketOps::ReuseAddr(m_socket);
-        SocketOps::Nonblocking(m_socket);
-
         m_address.sin_family = AF_INET;
         m_address.sin_port = ntohs((u_short)Port);
         m_address.sin_addr.s_addr = htonl(INADDR_ANY);
         m_opened = false;
+        m_count = 0;
+        len = sizeof(sockaddr_in);
 
         if(strcmp(ListenAddress, "0.0.0.0"))
         {
@@ -44,63 +47,98 @@ public:
                 memcpy(&m_address.sin_addr.s_addr, hostname->h_addr_list[0], hostname->h_length);
         }
 
-        // bind.. well attempt to.
-        int ret = bind(m_socket, (const sockaddr*)&m_address, sizeof(m_address));
-        if(ret != 0)
+        uint32 reactors = sSocketMgr.GetReactorCount();
+        if(reactors > SOCKET_MAX_REACTORS)
+            reactors = SOCKET_MAX_REACTORS;
+        if(!sSocketMgr.GetReusePort())
+            reactors = 1;
+
+        for(uint32 i = 0; i < reactors; ++i)
         {
-            printf("Bind unsuccessful on port %u.", (unsigned int)Port);
-            return;
+            m_sockets[i] = socket(AF_INET, SOCK_STREAM, 0);
+            SocketOps::ReuseAddr(m_sockets[i]);
+            SocketOps::Nonblocking(m_sockets[i]);
+            if(reactors > 1 && !SocketOps::ReusePort(m_sockets[i]))
+            {
+                // no load balancing, one listener has to do
+                reactors = 1;
+            }
+
+            // bind.. well attempt to.
+            int ret = bind(m_sockets[i], (const sockaddr*)&m_address, sizeof(m_address));
+            if(ret != 0)
+            {
+                SocketOps::CloseSocket(m_sockets[i]);
+                if(i == 0)
+                    printf("Bind unsuccessful on port %u.", (unsigned int)Port);
+                break;
+            }
+
+            ret = listen(m_sockets[i], 5);
+            if(ret != 0) 
+            {
+                SocketOps::CloseSocket(m_sockets[i]);
+                if(i == 0)
+                    printf("Unable to listen on port %u.", (unsigned int)Port);
+                break;
+            }
+            ++m_count;
         }
 
-        ret = listen(m_socket, 5);
-        if(ret != 0) 
-        {
-            printf("Unable to listen on port %u.", (unsigned int)Port);
+        if(m_count == 0)
             return;
-        }
-        len = sizeof(sockaddr_in);
+
+        if(m_count > 1)
+            Log.Notice("Network", "Port %u is shared by %u listeners with SO_REUSEPORT.", (unsigned int)Port, m_count);
+
         m_opened = true;
-		sSocketMgr.AddListenSocket(this);
+        for(uint32 i = 0; i < m_count; ++i)
+            sSocketMgr.AddListenSocket(this, m_sockets[i], i);
     }
 
     ~ListenSocket()
     {
-        if(m_opened)
-            SocketOps::CloseSocket(m_socket);
+        Close();
     }
 
     void Close()
     {
         if(m_opened)
-            SocketOps::CloseSocket(m_socket);
+        {
+            for(uint32 i = 0; i < m_count; ++i)
+                SocketOps::CloseSocket(m_sockets[i]);
+        }
         m_opened = false;
     }
 
-    /*void Update()
-    {
-        aSocket = accept(m_socket, (sockaddr*)&m_tempAddress, (socklen_t*)&len);
-        if(aSocket == -1)
-            return;
-
-        dsocket = new T(aSocket);
-        dsocket->Accept(&m_tempAddress);
-    }*/
-
-	void OnAccept()
+	void OnAccept(int fd)
 	{
-		aSocket = accept(m_socket, (sockaddr*)&m_tempAddress, (socklen_t*)&len);
+		aSocket = accept(fd, (sockaddr*)&m_tempAddress, (socklen_t*)&len);
 		if(aSocket == -1)
 			return;
 
 		dsocket = new T(aSocket);
+		if(m_count > 1)
+		{
+			// keep the connection on the reactor whose listener took it
+			for(uint32 i = 0; i < m_count; ++i)
+			{
+				if(m_sockets[i] == fd)
+				{
+					dsocket->SetReactor((int)i);
+					break;
+				}
+			}
+		}
 		dsocket->Accept(&m_tempAddress);
 	}
 
     inline bool IsOpen() { return m_opened; }
-	int GetFd() { return m_socket; }	
+	int GetFd() { return m_sockets[0]; }
 
 private:
-    SOCKET m_socket;
+    SOCKET m_sockets[SOCKET_MAX_REACTORS];
+    uint32 m_count;
     SOCKET aSocket;
     struct sockaddr_in m_address;
     struct sockaddr_in m_tempAddress;
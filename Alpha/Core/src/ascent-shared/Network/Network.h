@@ -13,6 +13,7 @@
 #include "../Log.h"
 #include "../NGLog.h"
 #include "CircularBuffer.h"
+#include "SharedBuffer.h"
 #include "SocketDefines.h"
 #include "SocketOps.h"
 #include "Socket.h"
@@ -0,0 +1,71 @@
+/*
+ * Multiplatform Async Network Library
+ * Copyright (c) 2007 Burlex
+ *
+ * SharedBuffer - Immutable reference counted payload which can be queued
+ *				  on any number of sockets without being copied.
+ *
+ */
+
+#ifndef _NETLIB_SHAREDBUFFER_H
+#define _NETLIB_SHAREDBUFFER_H
+
+class SharedBuffer
+{
+public:
+	/** Copies size bytes of data, the returned buffer holds one reference for the caller.
+	 */
+	static SharedBuffer * Create(const void * data, size_t size)
+	{
+		SharedBuffer * buffer = new SharedBuffer;
+		buffer->m_size = size;
+		buffer->m_data = new uint8[size ? size : 1];
+		if(size)
+			memcpy(buffer->m_data, data, size);
+		return buffer;
+	}
+
+	/** Same as above for a payload which is split in two parts, e.g. a header and a packet.
+	 */
+	static SharedBuffer * Create(const void * first, size_t firstSize, const void * second, size_t secondSize)
+	{
+		SharedBuffer * buffer = new SharedBuffer;
+		buffer->m_size = firstSize + secondSize;
+		buffer->m_data = new uint8[buffer->m_size ? buffer->m_size : 1];
+		if(firstSize)
+			memcpy(buffer->m_data, first, firstSize);
+		if(secondSize)
+			memcpy(buffer->m_data + firstSize, second, secondSize);
+		return buffer;
+	}
+
+	inline const uint8 * GetData() const { return m_data; }
+	inline size_t GetSize() const { return m_size; }
+
+	// references are dropped by the socket threads once the payload is sent
+#ifdef WIN32
+	inline void AddRef() { InterlockedIncrement(&m_refs); }
+	inline void DecRef()
+	{
+		if(InterlockedDecrement(&m_refs) == 0)
+			delete this;
+	}
+#else
+	inline void AddRef() { __sync_add_and_fetch(&m_refs, 1); }
+	inline void DecRef()
+	{
+		if(__sync_sub_and_fetch(&m_refs, 1) == 0)
+			delete this;
+	}
+#endif
+
+private:
+	SharedBuffer() : m_refs(1), m_data(NULL), m_size(0) {}
+	~SharedBuffer() { delete [] m_data; }
+
+	volatile long m_refs;
+	uint8 * m_data;
+	size_t m_size;
+};
+
+#endif		// _NETLIB_SHAREDBUFFER_H
@@ -24,6 +24,15 @@ Socket::Socket(SOCKET fd, uint32 sendbuffersize, uint32 recvbuffersize) : m_fd(f
 	m_writeLock = 0;
 #endif
 
+#ifdef CONFIG_USE_EPOLL
+	m_reactor = -1;
+	m_sharedOffset = 0;
+	m_sharedBytes = 0;
+	m_sharedLimit = sendbuffersize * 2;
+	m_bufferedIn = 0;
+	m_bufferedOut = 0;
+#endif
+
 	// Check for needed fd allocation.
 	if(m_fd == 0)
 		m_fd = SocketOps::CreateTCPFileDescriptor();
@@ -31,7 +40,10 @@ Socket::Socket(SOCKET fd, uint32 sendbuffersize, uint32 recvbuffersize) : m_fd(f
 
 Socket::~Socket()
 {
-
+#ifdef CONFIG_USE_EPOLL
+	for(std::deque<SharedChunk>::iterator itr = m_sharedChunks.begin(); itr != m_sharedChunks.end(); ++itr)
+		itr->buffer->DecRef();
+#endif
 }
 
 bool Socket::Connect(const char * Address, uint32 Port)
@@ -98,7 +110,34 @@ bool Socket::Send(const uint8 * Bytes, uint32 Size)
 
 bool Socket::BurstSend(const uint8 * Bytes, uint32 Size)
 {
+#ifdef CONFIG_USE_EPOLL
+	if(!writeBuffer.Write(Bytes, Size))
+		return false;
+
+	m_bufferedIn += Size;
+	return true;
+#else
 	return writeBuffer.Write(Bytes, Size);
+#endif
+}
+
+bool Socket::BurstSendShared(SharedBuffer * Buffer)
+{
+#ifdef CONFIG_USE_EPOLL
+	// callers check CanSendShared() first, the limit is not enforced here
+	if(!Buffer->GetSize())
+		return true;
+
+	SharedChunk chunk;
+	chunk.buffer = Buffer;
+	chunk.position = m_bufferedIn;
+	Buffer->AddRef();
+	m_sharedChunks.push_back(chunk);
+	m_sharedBytes += Buffer->GetSize();
+	return true;
+#else
+	return BurstSend(Buffer->GetData(), (uint32)Buffer->GetSize());
+#endif
 }
 
 string Socket::GetRemoteIP()
@@ -51,6 +51,10 @@ public:
 	// Burst system - Adds bytes to output buffer.
 	bool BurstSend(const uint8 * Bytes, uint32 Size);
 
+	// Burst system - Adds a reference to a payload shared with other sockets, it is sent
+	// after the bytes added so far. Platforms without gathered writes copy it instead.
+	bool BurstSendShared(SharedBuffer * Buffer);
+
 	// Burst system - Pushes event to queue - do at the end of write events.
 	void BurstPush();
 
@@ -76,6 +80,18 @@ public:
 	ASCENT_INLINE CircularBuffer& GetReadBuffer() { return readBuffer; }
 	ASCENT_INLINE CircularBuffer& GetWriteBuffer() { return writeBuffer; }
 
+#ifdef CONFIG_USE_EPOLL
+	ASCENT_INLINE bool HasPendingWrites() { return (writeBuffer.GetSize() > 0 || !m_sharedChunks.empty()); }
+	ASCENT_INLINE size_t GetSharedBytes() { return m_sharedBytes; }
+
+	// Can len more bytes be queued outside the write buffer (shared payloads or packets which did not fit)?
+	ASCENT_INLINE bool CanSendShared(size_t len) { return (m_sharedBytes + len <= m_sharedLimit); }
+#else
+	ASCENT_INLINE bool HasPendingWrites() { return (writeBuffer.GetSize() > 0); }
+	ASCENT_INLINE size_t GetSharedBytes() { return 0; }
+	ASCENT_INLINE bool CanSendShared(size_t len) { return false; }
+#endif
+
 /* Deletion */
 	void Delete();
 
@@ -144,6 +160,10 @@ public:
 	// Posts a epoll event with the specifed arguments.
 	void PostEvent(uint32 events);
 
+	// Reactor (epoll set + worker thread) the socket belongs to, -1 until it is added to the SocketMgr.
+	ASCENT_INLINE int GetReactor() { return m_reactor; }
+	ASCENT_INLINE void SetReactor(int reactor) { m_reactor = reactor; }
+
 	// Atomic wrapper functions for increasing read/write locks
 	ASCENT_INLINE void IncSendLock() { m_writeLockMutex.Acquire(); m_writeLock++; m_writeLockMutex.Release(); }
 	ASCENT_INLINE void DecSendLock() { m_writeLockMutex.Acquire(); m_writeLock--; m_writeLockMutex.Release(); }
@@ -166,6 +186,24 @@ public:
 private:
 	unsigned int m_writeLock;
 	Mutex m_writeLockMutex;
+	int m_reactor;
+
+	// Drops len sent bytes from the write buffer and the shared payloads, in stream order.
+	void _RemoveWritten(size_t len);
+
+	struct SharedChunk
+	{
+		SharedBuffer * buffer;
+		uint64 position;			// write buffer stream offset the payload follows
+	};
+
+	// Shared payloads waiting to be sent, interleaved with the write buffer by position.
+	std::deque<SharedChunk> m_sharedChunks;
+	size_t m_sharedOffset;			// bytes of the first payload which are already out
+	size_t m_sharedBytes;			// bytes of all queued payloads not sent yet
+	size_t m_sharedLimit;
+	uint64 m_bufferedIn;			// bytes ever added to / sent from the write buffer
+	uint64 m_bufferedOut;
 #endif
 
 /* FreeBSD - kqueue specific calls */
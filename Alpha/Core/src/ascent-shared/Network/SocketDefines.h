@@ -26,8 +26,13 @@ using namespace std;
 
 // select: epoll
 #include <sys/epoll.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
 #define CONFIG_USE_EPOLL
 
+// most buffers handed to one writev() call
+#define SOCKET_WRITE_IOV_COUNT 64
+
 #elif UNIX_FLAVOUR == UNIX_FLAVOUR_BSD
 
 // select: kqueue
@@ -11,7 +11,7 @@
 
 void Socket::PostEvent(uint32 events)
 {
-    int epoll_fd = sSocketMgr.GetEpollFd();
+    int epoll_fd = sSocketMgr.GetEpollFd(m_reactor);
 
     struct epoll_event ev;
 	memset(&ev, 0, sizeof(epoll_event));
@@ -19,6 +19,7 @@ void Socket::PostEvent(uint32 events)
     ev.events = events | EPOLLET;			/* use edge-triggered instead of level-triggered because we're using nonblocking sockets */
 
     // post actual event
+    sSocketMgr.CountSyscall();
     if(epoll_ctl(epoll_fd, EPOLL_CTL_MOD, ev.data.fd, &ev))
 		Log.Warning("epoll", "Could not post event on fd %u", m_fd);
 }
@@ -50,22 +51,124 @@ void Socket::ReadCallback(uint32 len)
 void Socket::WriteCallback()
 {
     // We should already be locked at this point, so try to push everything out.
-    int bytes_written = send(m_fd, writeBuffer.GetBufferStart(), writeBuffer.GetContiguiousBytes(), 0);
-    if(bytes_written < 0)
+    // Both parts of the write buffer and the shared payloads go out in stream order,
+    // as many as fit into one writev() per pass.
+    iovec iov[SOCKET_WRITE_IOV_COUNT];
+    uint8 * blocks[2];
+    size_t sizes[2];
+    size_t offset, len, total;
+    uint64 pos;
+    uint32 block;
+    int count;
+    ssize_t bytes_written;
+    std::deque<SharedChunk>::iterator itr;
+
+    while(HasPendingWrites())
     {
-        // error.
-        Disconnect();
-        return;
+        writeBuffer.GetBlocks(&blocks[0], &sizes[0], &blocks[1], &sizes[1]);
+        itr = m_sharedChunks.begin();
+        offset = m_sharedOffset;
+        pos = m_bufferedOut;
+        block = 0;
+        count = 0;
+        total = 0;
+
+        while(count < SOCKET_WRITE_IOV_COUNT)
+        {
+            if(itr != m_sharedChunks.end() && itr->position == pos)
+            {
+                // a shared payload is next in line
+                iov[count].iov_base = (void*)(itr->buffer->GetData() + offset);
+                iov[count].iov_len = itr->buffer->GetSize() - offset;
+                total += iov[count].iov_len;
+                ++count;
+                ++itr;
+                offset = 0;
+                continue;
+            }
+
+            // buffered bytes up to the next payload
+            while(block < 2 && sizes[block] == 0)
+                ++block;
+
+            if(block == 2)
+                break;
+
+            len = sizes[block];
+            if(itr != m_sharedChunks.end() && itr->position - pos < len)
+                len = (size_t)(itr->position - pos);
+
+            iov[count].iov_base = blocks[block];
+            iov[count].iov_len = len;
+            total += len;
+            ++count;
+            blocks[block] += len;
+            sizes[block] -= len;
+            pos += len;
+        }
+
+        sSocketMgr.CountSyscall();
+        bytes_written = writev(m_fd, iov, count);
+        if(bytes_written < 0)
+        {
+            if(errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+
+            // error.
+            Disconnect();
+            return;
+        }
+
+        _RemoveWritten((size_t)bytes_written);
+
+        // the kernel buffer is full, the rest goes out on EPOLLOUT
+        if((size_t)bytes_written < total)
+            return;
     }
+}
 
-    //RemoveWriteBufferBytes(bytes_written, false);
-    writeBuffer.Remove(bytes_written);
+void Socket::_RemoveWritten(size_t len)
+{
+    size_t n;
+    while(len > 0)
+    {
+        if(!m_sharedChunks.empty() && m_sharedChunks.front().position == m_bufferedOut)
+        {
+            SharedChunk & chunk = m_sharedChunks.front();
+            n = chunk.buffer->GetSize() - m_sharedOffset;
+            if(len < n)
+            {
+                m_sharedOffset += len;
+                m_sharedBytes -= len;
+                return;
+            }
+
+            len -= n;
+            m_sharedBytes -= n;
+            m_sharedOffset = 0;
+            chunk.buffer->DecRef();
+            m_sharedChunks.pop_front();
+            continue;
+        }
+
+        n = writeBuffer.GetSize();
+        if(!m_sharedChunks.empty() && m_sharedChunks.front().position - m_bufferedOut < n)
+            n = (size_t)(m_sharedChunks.front().position - m_bufferedOut);
+        if(len < n)
+            n = len;
+
+        writeBuffer.Remove(n);
+        m_bufferedOut += n;
+        len -= n;
+    }
 }
 
 void Socket::BurstPush()
 {
+    // no syscall here, the worker thread flushes everything pushed since its last pass at once
+    sSocketMgr.CountPacket();
     if(AcquireSendLock())
-        PostEvent(EPOLLOUT);
+        sSocketMgr.QueueFlush(this);
 }
 
 #endif
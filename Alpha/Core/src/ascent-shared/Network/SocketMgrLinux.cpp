@@ -7,9 +7,125 @@
  */
 
 #include "Network.h"
+#include "../Config/ConfigEnv.h"
 #ifdef CONFIG_USE_EPOLL
 
 initialiseSingleton(SocketMgr);
+
+SocketReactor::SocketReactor(uint32 reactor_id) : id(reactor_id)
+{
+    epoll_fd = epoll_create(SOCKET_HOLDER_SIZE);
+    if(epoll_fd == -1)
+    {
+        printf("Could not create epoll fd (/dev/epoll).");
+        exit(-1);
+    }
+
+    // the worker thread waits on this next to the sockets
+    wakeup_fd = eventfd(0, EFD_NONBLOCK);
+    if(wakeup_fd == -1)
+    {
+        printf("Could not create eventfd.");
+        exit(-1);
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(epoll_event));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = wakeup_fd;
+    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &ev))
+        Log.Warning("epoll", "Could not add wakeup fd to epoll set");
+}
+
+SocketReactor::~SocketReactor()
+{
+    // close epoll handle
+    close(wakeup_fd);
+    close(epoll_fd);
+}
+
+void SocketReactor::QueueFlush(Socket * s)
+{
+    bool wake;
+
+    flush_lock.Acquire();
+    wake = flush_queue.empty();
+    flush_queue.push_back(s);
+    flush_lock.Release();
+
+    // the worker takes the whole queue on every wakeup, so only the first socket has to wake it
+    if(wake)
+    {
+        uint64 v = 1;
+        sSocketMgr.CountSyscall();
+        if(write(wakeup_fd, &v, sizeof(v)) != sizeof(v))
+            Log.Warning("epoll", "Could not wake up the socket worker, errno %u", errno);
+    }
+}
+
+void SocketReactor::_FlushQueued()
+{
+    // reset the eventfd before taking the queue, a socket queued after this wakes us again
+    uint64 v;
+    sSocketMgr.CountSyscall();
+    if(read(wakeup_fd, &v, sizeof(v)) < 0 && errno != EAGAIN)
+        Log.Warning("epoll", "Could not read wakeup fd, errno %u", errno);
+
+    flush_lock.Acquire();
+    flush_work.swap(flush_queue);
+    flush_lock.Release();
+
+    Socket * ptr;
+    for(std::vector<Socket*>::iterator itr = flush_work.begin(); itr != flush_work.end(); ++itr)
+    {
+        ptr = *itr;
+        ptr->BurstBegin();
+        if(ptr->IsConnected())
+            ptr->WriteCallback();
+
+        if(ptr->IsConnected() && ptr->HasPendingWrites())
+        {
+            // kernel buffer is full, keep the send lock and wait for it to drain
+            ptr->PostEvent(EPOLLIN | EPOLLOUT);
+        }
+        else
+            ptr->DecSendLock();
+        ptr->BurstEnd();
+    }
+    flush_work.clear();
+}
+
+SocketMgr::SocketMgr()
+{
+    // one reactor per cpu, each socket is only ever serviced by the thread of its reactor
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    reactor_count = (cpus > 0) ? (uint32)cpus : 1;
+    if(reactor_count > SOCKET_MAX_REACTORS)
+        reactor_count = SOCKET_MAX_REACTORS;
+
+    // off by default, SO_REUSEPORT lets any other process of the same user bind the port as well
+    reuse_port = Config.MainConfig.GetBoolDefault("Listen", "ReusePort", false);
+
+    memset(reactors, 0, sizeof(void*) * SOCKET_MAX_REACTORS);
+    for(uint32 i = 0; i < reactor_count; ++i)
+        reactors[i] = new SocketReactor(i);
+
+    // null out the pointer array
+    memset(fds, 0, sizeof(void*) * SOCKET_HOLDER_SIZE);
+	memset(listenfds, 0, sizeof(void*) * SOCKET_HOLDER_SIZE);
+
+    next_reactor = 0;
+    socket_count = 0;
+    send_syscalls = 0;
+    send_packets = 0;
+}
+
+SocketMgr::~SocketMgr()
+{
+    for(uint32 i = 0; i < reactor_count; ++i)
+        delete reactors[i];
+}
+
 void SocketMgr::AddSocket(Socket * s)
 {
 	if(fds[s->GetFd()] != NULL)
@@ -20,32 +136,36 @@ void SocketMgr::AddSocket(Socket * s)
 		return;
 	}
 
+	// accepted sockets stay on the reactor of the listener which accepted them
+	if(s->GetReactor() < 0)
+		s->SetReactor((int)((uint32)__sync_fetch_and_add(&next_reactor, 1) % reactor_count));
+
     fds[s->GetFd()] = s;
 
     // Add epoll event based on socket activity.
     struct epoll_event ev;
     memset(&ev, 0, sizeof(epoll_event));
-    ev.events = (s->GetWriteBuffer().GetSize()) ? EPOLLOUT : EPOLLIN;
+    ev.events = (s->HasPendingWrites()) ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
     ev.events |= EPOLLET;			/* use edge-triggered instead of level-triggered because we're using nonblocking sockets */
     ev.data.fd = s->GetFd();
     
-    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev))
+    if(epoll_ctl(reactors[s->GetReactor()]->GetEpollFd(), EPOLL_CTL_ADD, ev.data.fd, &ev))
 		Log.Warning("epoll", "Could not add event to epoll set on fd %u", ev.data.fd);
 }
 
-void SocketMgr::AddListenSocket(ListenSocketBase * s)
+void SocketMgr::AddListenSocket(ListenSocketBase * s, int fd, uint32 reactor)
 {
-	assert(listenfds[s->GetFd()] == 0);
-	listenfds[s->GetFd()] = s;
+	assert(listenfds[fd] == 0);
+	listenfds[fd] = s;
 
 	// Add epoll event based on socket activity.
 	struct epoll_event ev;
 	memset(&ev, 0, sizeof(epoll_event));
 	ev.events = EPOLLIN;
 	ev.events |= EPOLLET;			/* use edge-triggered instead of level-triggered because we're using nonblocking sockets */
-	ev.data.fd = s->GetFd();
+	ev.data.fd = fd;
 
-	if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ev.data.fd, &ev))
+	if(epoll_ctl(reactors[reactor % reactor_count]->GetEpollFd(), EPOLL_CTL_ADD, ev.data.fd, &ev))
 		Log.Warning("epoll", "Could not add event to epoll set on fd %u", ev.data.fd);
 }
 
@@ -64,7 +184,7 @@ void SocketMgr::RemoveSocket(Socket * s)
     ev.data.fd = s->GetFd();
     ev.events = EPOLLIN | EPOLLOUT | EPOLLERR | EPOLLHUP | EPOLLONESHOT;
 
-    if(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, ev.data.fd, &ev))
+    if(epoll_ctl(reactors[s->GetReactor()]->GetEpollFd(), EPOLL_CTL_DEL, ev.data.fd, &ev))
 		Log.Warning("epoll", "Could not remove fd %u from epoll set, errno %u", s->GetFd(), errno);
 }
 
@@ -75,11 +195,17 @@ void SocketMgr::CloseAll()
             fds[i]->Delete();
 }
 
+void SocketMgr::QueueFlush(Socket * s)
+{
+    // data pushed before the socket was added is written by the first reactor
+    reactors[(s->GetReactor() < 0) ? 0 : s->GetReactor()]->QueueFlush(s);
+}
+
 void SocketMgr::SpawnWorkerThreads()
 {
-    uint32 count = 1;
-    for(uint32 i = 0; i < count; ++i)
-        ThreadPool.ExecuteTask(new SocketWorkerThread());
+    Log.Notice("SocketMgr", "Starting %u epoll worker threads.", reactor_count);
+    for(uint32 i = 0; i < reactor_count; ++i)
+        ThreadPool.ExecuteTask(new SocketWorkerThread(reactors[i]));
 }
 
 bool SocketWorkerThread::run()
@@ -92,9 +218,15 @@ bool SocketWorkerThread::run()
 
     while(running)
     {
-        fd_count = epoll_wait(mgr->epoll_fd, events, THREAD_EVENT_SIZE, 5000);
+        fd_count = epoll_wait(reactor->epoll_fd, events, THREAD_EVENT_SIZE, 5000);
         for(i = 0; i < fd_count; ++i)
         {
+            if(events[i].data.fd == reactor->wakeup_fd)
+            {
+                reactor->_FlushQueued();
+                continue;
+            }
+
             if(events[i].data.fd >= SOCKET_HOLDER_SIZE)
             {
                 Log.Warning("epoll", "Requested FD that is too high (%u)", events[i].data.fd);
@@ -106,7 +238,7 @@ bool SocketWorkerThread::run()
             if(ptr == NULL)
             {
 				if( (ptr = ((Socket*)mgr->listenfds[events[i].data.fd])) != NULL )
-					((ListenSocketBase*)ptr)->OnAccept();
+					((ListenSocketBase*)ptr)->OnAccept(events[i].data.fd);
 				else
 					Log.Warning("epoll", "Returned invalid fd (no pointer) of FD %u", events[i].data.fd);
 
@@ -118,25 +250,28 @@ bool SocketWorkerThread::run()
 				ptr->Disconnect();
                 continue;
             }
-			else if(events[i].events & EPOLLIN)
+
+			if(events[i].events & EPOLLIN)
             {
                 ptr->ReadCallback(0);               // Len is unknown at this point.
 
-				/* changing to written state? */
-				if(ptr->GetWriteBuffer().GetSize() && !ptr->HasSendLock() && ptr->IsConnected())
-					ptr->PostEvent(EPOLLOUT);
+				/* anything left behind without a flush pending? the write buffer and
+				   the shared chunks are filled by other threads, look at them locked */
+				ptr->BurstBegin();
+				bool pending = ptr->IsConnected() && ptr->HasPendingWrites();
+				ptr->BurstEnd();
+
+				if(pending && ptr->AcquireSendLock())
+					reactor->QueueFlush(ptr);
             }
-			else if(events[i].events & EPOLLOUT)
+
+			if(events[i].events & EPOLLOUT && ptr->IsConnected())
             {
                 ptr->BurstBegin();          // Lock receive mutex
-                ptr->WriteCallback();       // Perform actual send()
-                if(ptr->GetWriteBuffer().GetSize() > 0)
-                {
-                    /* we don't have to do anything here. no more oneshots :) */
-                }
-                else
+                ptr->WriteCallback();       // Perform actual writev()
+                if(!ptr->HasPendingWrites() && ptr->IsConnected() && ptr->HasSendLock())
                 {
-					/* change back to a read event */
+					/* all out, change back to a read event */
                     ptr->DecSendLock();
                     ptr->PostEvent(EPOLLIN);
                 }
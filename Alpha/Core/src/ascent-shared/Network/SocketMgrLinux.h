@@ -20,15 +20,53 @@
 #define THREAD_EVENT_SIZE 4096      // This is the number of socket events each thread can receieve at once.
                                     // This default value should be more than enough.
 
+#define SOCKET_MAX_REACTORS 16       // Upper bound for the number of epoll sets / worker threads.
+
 class Socket;
 class SocketWorkerThread;
 class ListenSocketBase;
 
-class SocketMgr : public Singleton<SocketMgr>
+/// one epoll set with the worker thread serving it, a socket stays on the reactor it was added to
+class SocketReactor
 {
+    /// reactor index
+    uint32 id;
+
     /// /dev/epoll instance handle
     int epoll_fd;
 
+    /// sockets with new data, flushed by the worker thread which is woken through wakeup_fd
+    std::vector<Socket*> flush_queue;
+    std::vector<Socket*> flush_work;
+    Mutex flush_lock;
+    int wakeup_fd;
+
+    /// writes out all sockets in the flush queue, called by the worker thread
+    void _FlushQueued();
+
+public:
+    friend class SocketWorkerThread;
+
+    SocketReactor(uint32 reactor_id);
+    ~SocketReactor();
+
+    inline uint32 GetId() { return id; }
+    inline int GetEpollFd() { return epoll_fd; }
+
+    /// queues a socket with new data for the worker thread, the caller holds its send lock
+    void QueueFlush(Socket * s);
+};
+
+class SocketMgr : public Singleton<SocketMgr>
+{
+    /// epoll sets, one worker thread each
+    SocketReactor * reactors[SOCKET_MAX_REACTORS];
+    uint32 reactor_count;
+    volatile long next_reactor;
+
+    /// one listener per reactor with SO_REUSEPORT, <Listen ReusePort>
+    bool reuse_port;
+
     // fd -> pointer binding.
     Socket * fds[SOCKET_HOLDER_SIZE];
 	ListenSocketBase * listenfds[SOCKET_HOLDER_SIZE];
@@ -36,42 +74,34 @@ class SocketMgr : public Singleton<SocketMgr>
     /// socket counter
     int socket_count;
 
+    /// send statistics
+    volatile long send_syscalls;
+    volatile long send_packets;
+
 public:
 
     /// friend class of the worker thread -> it has to access our private resources
     friend class SocketWorkerThread;
 
-    /// constructor > create epoll device handle + initialize event set
-    SocketMgr()
-    {
-        epoll_fd = epoll_create(SOCKET_HOLDER_SIZE);
-        if(epoll_fd == -1)
-        {
-            printf("Could not create epoll fd (/dev/epoll).");
-            exit(-1);
-        }
-
-        // null out the pointer array
-        memset(fds, 0, sizeof(void*) * SOCKET_HOLDER_SIZE);
-		memset(listenfds, 0, sizeof(void*) * SOCKET_HOLDER_SIZE);
-    }
+    /// constructor > create one epoll set per cpu + initialize event set
+    SocketMgr();
 
-    /// destructor > destroy epoll handle
-    ~SocketMgr()
-    {
-        // close epoll handle
-        close(epoll_fd);
-    }
+    /// destructor > destroy epoll handles
+    ~SocketMgr();
 
-    /// add a new socket to the epoll set and to the fd mapping
+    /// add a new socket to the epoll set of its reactor (round-robin if it has none yet) and to the fd mapping
     void AddSocket(Socket * s);
-	void AddListenSocket(ListenSocketBase * s);
+
+    /// adds one listening fd of s to the epoll set of the given reactor
+	void AddListenSocket(ListenSocketBase * s, int fd, uint32 reactor);
 
     /// remove a socket from epoll set/fd mapping
     void RemoveSocket(Socket * s);
 
-    /// returns epoll fd
-    inline int GetEpollFd() { return epoll_fd; }
+    /// returns epoll fd of a reactor
+    inline int GetEpollFd(uint32 reactor) { return reactors[reactor]->GetEpollFd(); }
+    inline uint32 GetReactorCount() { return reactor_count; }
+    inline bool GetReusePort() { return reuse_port; }
 
     /// returns number of sockets in array
     inline int Count() { return socket_count; }
@@ -79,16 +109,27 @@ public:
     /// closes all sockets
     void CloseAll();
 
-    /// spawns worker threads
+    /// spawns one worker thread per reactor
     void SpawnWorkerThreads();
+
+    /// queues a socket with new data for the worker thread of its reactor, the caller holds its send lock
+    void QueueFlush(Socket * s);
+
+    /// send statistics: syscalls made for sending (writev, epoll_ctl, wakeups) and packets pushed
+    inline void CountSyscall() { __sync_add_and_fetch(&send_syscalls, 1); }
+    inline void CountPacket() { __sync_add_and_fetch(&send_packets, 1); }
+    inline uint64 GetSendSyscalls() { return (uint64)send_syscalls; }
+    inline uint64 GetSentPackets() { return (uint64)send_packets; }
 };
 
 class SocketWorkerThread : public ThreadBase
 {
     /// epoll event struct
     struct epoll_event events[THREAD_EVENT_SIZE];
+    SocketReactor * reactor;
     bool running;
 public:
+    SocketWorkerThread(SocketReactor * r) : reactor(r), running(false) {}
     bool run();
     void OnShutdown()
     {
@@ -38,6 +38,9 @@ namespace SocketOps
 
 	// Sets SO_REUSEADDR
 	void ReuseAddr(SOCKET fd);
+
+	// Sets SO_REUSEPORT, returns false if the platform does not support it
+	bool ReusePort(SOCKET fd);
 };
 
 #endif
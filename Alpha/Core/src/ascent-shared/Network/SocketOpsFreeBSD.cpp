@@ -72,6 +72,13 @@ namespace SocketOps
         uint32 option = 1;
         setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&option, 4);
     }
+
+    // Sets reuseport, listeners bound to the same port share the incoming connections
+    bool ReusePort(SOCKET fd)
+    {
+        // SO_REUSEPORT does not spread accepts here, keep a single listener
+        return false;
+    }
 }
 
 #endif
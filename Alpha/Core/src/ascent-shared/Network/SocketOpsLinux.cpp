@@ -72,6 +72,17 @@ namespace SocketOps
         uint32 option = 1;
         setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&option, 4);
     }
+
+    // Sets reuseport, listeners bound to the same port share the incoming connections
+    bool ReusePort(SOCKET fd)
+    {
+#ifdef SO_REUSEPORT
+        uint32 option = 1;
+        return (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (const char*)&option, 4) == 0);
+#else
+        return false;
+#endif
+    }
 }
 
 #endif
@@ -71,6 +71,12 @@ namespace SocketOps
 		uint32 option = 1;
 		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const char*)&option, 4);
 	}
+
+	// Sets reuseport, listeners bound to the same port share the incoming connections
+	bool ReusePort(SOCKET fd)
+	{
+		return false;
+	}
 }
 
 #endif
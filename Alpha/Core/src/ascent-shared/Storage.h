@@ -29,6 +29,8 @@
 
 #define STORAGE_ARRAY_MAX 200000
 
+#include "StorageSnapshot.h"
+
 #ifdef STORAGE_ALLOCATION_POOLS
 template<class T>
 class SERVER_DECL StorageAllocationPool
@@ -634,6 +636,53 @@ public:
 		}
 	}
 
+	/** Fetches the whole table through a prepared statement, the rows come back in
+	 * binary so numeric columns are not parsed from text again for every entry.
+	 */
+	QueryResult * _QueryTable(const char * IndexName)
+	{
+		char sql[200];
+		snprintf(sql, 200, "SELECT * FROM %s", IndexName);
+
+		PreparedStatement stmt(WorldDatabase.PrepareStatement(sql));
+		uint32 start = getMSTime();
+		QueryResult * result = WorldDatabase.QueryPrepared(&stmt);
+		uint32 elapsed = getMSTime() - start;
+
+		if(result != NULL && elapsed > 0)
+			Log.Debug("Storage", "Fetched %u rows from %s in %ums (%u rows/sec).", result->GetRowCount(), IndexName, elapsed, (uint32)(((uint64)result->GetRowCount() * 1000) / elapsed));
+
+		return result;
+	}
+
+	/** Fills the storage from the snapshot of the table, if there is a current one.
+	 */
+	bool _LoadSnapshot(const char * IndexName, const char * FormatString, uint64 version)
+	{
+		StorageSnapshot snapshot(IndexName, FormatString);
+		uint32 start = getMSTime();
+		if(!snapshot.Open(version))
+			return false;
+
+		if(Storage<T, StorageType>::_storage.NeedsMax())
+			Storage<T, StorageType>::_storage.Setup(snapshot.GetMaxEntry());
+
+		Field * fields;
+		T * Allocated;
+#ifdef STORAGE_ALLOCATION_POOLS
+		Storage<T, StorageType>::_storage.InitPool( snapshot.GetRowCount() );
+#endif
+		while((fields = snapshot.NextRow()) != NULL)
+		{
+			Allocated = Storage<T, StorageType>::_storage.AllocateEntry(fields[0].GetUInt32());
+			if(Allocated)
+				LoadBlock(fields, Allocated);
+		}
+
+		Log.Notice("Storage", "%u entries loaded from snapshot of table %s in %ums.", snapshot.GetRowCount(), IndexName, getMSTime() - start);
+		return true;
+	}
+
 	/** Loads from the table.
 	 */
 	void Load(const char * IndexName, const char * FormatString)
@@ -641,10 +690,19 @@ public:
 		//printf("Loading database cache from `%s`...\n", IndexName);
 		Storage<T, StorageType>::Load(IndexName, FormatString);
 		QueryResult * result;
+
+		// the snapshot is only trusted while the table version matches
+		uint64 version = 0;
+		if(StorageSnapshot::IsEnabled() && WorldDatabase.GetTableVersion(IndexName, &version))
+		{
+			if(version != 0 && _LoadSnapshot(IndexName, FormatString, version))
+				return;
+		}
+
+		uint32 Max = STORAGE_ARRAY_MAX;
 		if(Storage<T, StorageType>::_storage.NeedsMax())
 		{
 			result = WorldDatabase.Query("SELECT MAX(entry) FROM %s", IndexName);
-			uint32 Max = STORAGE_ARRAY_MAX;
 			if(result)
 			{
 				Max = result->Fetch()[0].GetUInt32() + 1;
@@ -662,7 +720,7 @@ public:
 		}
 
 		size_t cols = strlen(FormatString);
-		result = WorldDatabase.Query("SELECT * FROM %s", IndexName);
+		result = _QueryTable(IndexName);
 		if (!result)
 			return;
 		Field * fields = result->Fetch();
@@ -681,6 +739,7 @@ public:
 			}
 		}
 
+		StorageSnapshot * snapshot = (version != 0) ? new StorageSnapshot(IndexName, FormatString) : NULL;
 		uint32 Entry;
 		T * Allocated;
 #ifdef STORAGE_ALLOCATION_POOLS
@@ -688,6 +747,9 @@ public:
 #endif
 		do 
 		{
+			if(snapshot != NULL)
+				snapshot->AddRow(fields);
+
 			Entry = fields[0].GetUInt32();
 			Allocated = Storage<T, StorageType>::_storage.AllocateEntry(Entry);
 			if(!Allocated)
@@ -698,6 +760,12 @@ public:
 		Log.Notice("Storage", "%u entries loaded from table %s.", result->GetRowCount(), IndexName);
 		delete result;
 
+		if(snapshot != NULL)
+		{
+			snapshot->Save(version, Max);
+			delete snapshot;
+		}
+
 		//Log.Success("Storage", "Loaded database cache from `%s`.", IndexName);
 	}
 
@@ -726,7 +794,7 @@ public:
 		}
 		
 		size_t cols = strlen(FormatString);
-		result = WorldDatabase.Query("SELECT * FROM %s", IndexName);
+		result = _QueryTable(IndexName);
 		if (!result)
 			return;
 		Field * fields = result->Fetch();
@@ -783,7 +851,7 @@ public:
 		}
 
 		size_t cols = strlen(Storage<T, StorageType>::_formatString);
-		result = WorldDatabase.Query("SELECT * FROM %s", Storage<T, StorageType>::_indexName);
+		result = _QueryTable(Storage<T, StorageType>::_indexName);
 		if (!result)
 			return;
 		Field * fields = result->Fetch();
@@ -0,0 +1,246 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Common.h"
+#include "Database/Field.h"
+#include "NGLog.h"
+#include "crc32.h"
+#include "StorageSnapshot.h"
+
+static string s_snapshotDirectory;
+
+void StorageSnapshot::SetDirectory(const char * dir)
+{
+	s_snapshotDirectory = dir ? dir : "";
+}
+
+bool StorageSnapshot::IsEnabled()
+{
+	return !s_snapshotDirectory.empty();
+}
+
+StorageSnapshot::StorageSnapshot(const char * table, const char * format) : m_table(table), m_format(format), m_rows(0), m_maxEntry(0), m_pos(NULL), m_end(NULL)
+{
+	m_fields = new Field[m_format.size()];
+}
+
+StorageSnapshot::~StorageSnapshot()
+{
+	delete [] m_fields;
+}
+
+string StorageSnapshot::_GetFileName()
+{
+	return s_snapshotDirectory + "/" + m_table + ".snapshot";
+}
+
+void StorageSnapshot::_Append(const void * p, size_t len)
+{
+	size_t pos = m_data.size();
+	m_data.resize(pos + len);
+	memcpy(&m_data[pos], p, len);
+}
+
+void StorageSnapshot::AddRow(Field * fields)
+{
+	Field * f = fields;
+	uint32 u;
+	float fl;
+	uint16 h;
+	uint8 c;
+	for(const char * p = m_format.c_str(); *p != 0; ++p, ++f)
+	{
+		switch(*p)
+		{
+		case 'u':
+		case 'i':
+			u = f->GetUInt32();
+			_Append(&u, 4);
+			break;
+
+		case 'f':
+			fl = f->GetFloat();
+			_Append(&fl, 4);
+			break;
+
+		case 'h':
+			h = f->GetUInt16();
+			_Append(&h, 2);
+			break;
+
+		case 'c':
+			c = f->GetUInt8();
+			_Append(&c, 1);
+			break;
+
+		case 's':
+			{
+				const char * str = f->GetString();
+				size_t len = str ? strlen(str) : 0;
+				if(len > 0xFFFF)
+					len = 0xFFFF;
+
+				h = (uint16)len;
+				_Append(&h, 2);
+				_Append(str ? str : "", len);
+				_Append("", 1);
+			}break;
+		}
+	}
+
+	++m_rows;
+}
+
+bool StorageSnapshot::Save(uint64 version, uint32 max_entry)
+{
+	StorageSnapshotHeader header;
+	string filename = _GetFileName();
+	string tmpname = filename + ".tmp";
+
+	memset(&header, 0, sizeof(header));
+	header.magic = STORAGE_SNAPSHOT_MAGIC;
+	header.version = STORAGE_SNAPSHOT_VERSION;
+	header.format_crc = (uint32)crc32((const unsigned char*)m_format.c_str(), (unsigned int)m_format.size());
+	header.max_entry = max_entry;
+	header.table_version = version;
+	header.rows = m_rows;
+	header.data_size = (uint32)m_data.size();
+	header.data_crc = m_data.size() ? (uint32)crc32(&m_data[0], (unsigned int)m_data.size()) : 0;
+
+	FILE * f = fopen(tmpname.c_str(), "wb");
+	if(f == NULL)
+	{
+		Log.Warning("StorageSnapshot", "Could not create %s.", tmpname.c_str());
+		return false;
+	}
+
+	bool ok = (fwrite(&header, sizeof(header), 1, f) == 1);
+	if(ok && m_data.size())
+		ok = (fwrite(&m_data[0], m_data.size(), 1, f) == 1);
+	fclose(f);
+
+	// only replace the old snapshot once the new one is complete
+	remove(filename.c_str());
+	if(!ok || rename(tmpname.c_str(), filename.c_str()) != 0)
+	{
+		Log.Warning("StorageSnapshot", "Could not write %s.", filename.c_str());
+		remove(tmpname.c_str());
+		return false;
+	}
+
+	m_data.clear();
+	return true;
+}
+
+bool StorageSnapshot::Open(uint64 version)
+{
+	StorageSnapshotHeader header;
+	string filename = _GetFileName();
+
+	if(!m_file.Open(filename.c_str()))
+		return false;
+
+	if(m_file.GetSize() < sizeof(header))
+	{
+		m_file.Close();
+		return false;
+	}
+
+	memcpy(&header, m_file.GetData(), sizeof(header));
+	const uint8 * data = m_file.GetData() + sizeof(header);
+
+	if(header.magic != STORAGE_SNAPSHOT_MAGIC || header.version != STORAGE_SNAPSHOT_VERSION ||
+		header.format_crc != (uint32)crc32((const unsigned char*)m_format.c_str(), (unsigned int)m_format.size()) ||
+		header.table_version != version || header.data_size != m_file.GetSize() - sizeof(header))
+	{
+		Log.Notice("StorageSnapshot", "Snapshot of %s is out of date.", m_table.c_str());
+		m_file.Close();
+		return false;
+	}
+
+	if(header.data_size && (uint32)crc32(data, header.data_size) != header.data_crc)
+	{
+		Log.Warning("StorageSnapshot", "Snapshot of %s is damaged.", m_table.c_str());
+		m_file.Close();
+		return false;
+	}
+
+	m_rows = header.rows;
+	m_maxEntry = header.max_entry;
+	m_pos = data;
+	m_end = data + header.data_size;
+	return true;
+}
+
+Field * StorageSnapshot::NextRow()
+{
+	Field * f = m_fields;
+	uint32 u;
+	float fl;
+	uint16 h;
+
+	if(m_pos >= m_end)
+		return NULL;
+
+	for(const char * p = m_format.c_str(); *p != 0; ++p, ++f)
+	{
+		switch(*p)
+		{
+		case 'u':
+		case 'i':
+			memcpy(&u, m_pos, 4);
+			m_pos += 4;
+			if(*p == 'i')
+				f->SetInt((int32)u);
+			else
+				f->SetUInt(u);
+			break;
+
+		case 'f':
+			memcpy(&fl, m_pos, 4);
+			m_pos += 4;
+			f->SetReal(fl);
+			break;
+
+		case 'h':
+			memcpy(&h, m_pos, 2);
+			m_pos += 2;
+			f->SetUInt(h);
+			break;
+
+		case 'c':
+			f->SetUInt(*m_pos);
+			m_pos += 1;
+			break;
+
+		case 's':
+			// strings are stored terminated, the field points straight into the mapping
+			memcpy(&h, m_pos, 2);
+			f->SetValue((char*)(m_pos + 2));
+			m_pos += 2 + h + 1;
+			break;
+
+		default:
+			f->SetValue(NULL);
+			break;
+		}
+	}
+
+	return m_fields;
+}
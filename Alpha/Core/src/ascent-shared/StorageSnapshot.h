@@ -0,0 +1,98 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _STORAGESNAPSHOT_H
+#define _STORAGESNAPSHOT_H
+
+#include "MappedFile.h"
+
+using namespace std;
+
+#define STORAGE_SNAPSHOT_MAGIC		0x50534E53		// "SNSP"
+#define STORAGE_SNAPSHOT_VERSION	2
+
+/** Header of a snapshot file. The rows follow it, encoded by the storage format string:
+ * u/i/f as 4 bytes, h as 2, c as 1, s as a 16 bit length followed by the terminated string.
+ */
+struct StorageSnapshotHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint32 format_crc;			// crc32 of the format string
+	uint32 max_entry;			// what the array containers are set up with
+	uint64 table_version;		// Database::GetTableVersion of the table the rows were read from
+	uint32 rows;
+	uint32 data_size;
+	uint32 data_crc;
+	uint32 reserved;
+};
+
+/** Rows of one static world table as they were read from the database, written after
+ * a load from SQL and mapped on the next start as long as the table version still
+ * matches. The rows are fed through the same LoadBlock as query results, so the
+ * structures (and everything built from them later) come out exactly the same.
+ */
+class SERVER_DECL StorageSnapshot
+{
+public:
+	/** Directory the snapshot files are kept in, an empty one disables snapshots.
+	 */
+	static void SetDirectory(const char * dir);
+	static bool IsEnabled();
+
+	StorageSnapshot(const char * table, const char * format);
+	~StorageSnapshot();
+
+	/** Appends the row of a query result.
+	 */
+	void AddRow(Field * fields);
+	bool Save(uint64 version, uint32 max_entry);
+
+	/** Maps the snapshot of the table, fails if it is missing, damaged or was written
+	 * for another table version or format string.
+	 */
+	bool Open(uint64 version);
+
+	/** Decodes the next row, returns NULL when all rows were read.
+	 */
+	Field * NextRow();
+
+	ASCENT_INLINE uint32 GetRowCount() const { return m_rows; }
+	ASCENT_INLINE uint32 GetMaxEntry() const { return m_maxEntry; }
+
+private:
+	string _GetFileName();
+	void _Append(const void * p, size_t len);
+
+	string m_table;
+	string m_format;
+	uint32 m_rows;
+	uint32 m_maxEntry;
+
+	// writing
+	vector<uint8> m_data;
+
+	// reading
+	MappedFile m_file;
+	const uint8 * m_pos;
+	const uint8 * m_end;
+	Field * m_fields;
+};
+
+#endif
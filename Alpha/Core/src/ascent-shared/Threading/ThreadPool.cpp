@@ -19,6 +19,7 @@
 
 #include "ThreadPool.h"
 #include "../NGLog.h"
+#include "../WorldPacketPool.h"
 
 #ifdef WIN32
 
@@ -267,6 +268,9 @@ static unsigned long WINAPI thread_proc(void* param)
 				delete t->ExecutionTarget;
 
 			t->ExecutionTarget = NULL;
+
+			// the thread idles or exits now, packets it cached would be lost to the pool
+			WorldPacketPool::FlushThreadCache();
 		}
 
 		if(!ThreadPool.ThreadExit(t))
@@ -324,6 +328,9 @@ static void * thread_proc(void * param)
 				delete t->ExecutionTarget;
 
 			t->ExecutionTarget = NULL;
+
+			// the thread idles or exits now, packets it cached would be lost to the pool
+			WorldPacketPool::FlushThreadCache();
 		}
 
 		if(!ThreadPool.ThreadExit(t))
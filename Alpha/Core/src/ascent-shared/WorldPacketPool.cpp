@@ -0,0 +1,178 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Common.h"
+#include "WorldPacketPool.h"
+
+#ifdef WIN32
+#define WORLDPACKET_POOL_TLS __declspec(thread)
+#else
+#define WORLDPACKET_POOL_TLS __thread
+#endif
+
+struct WorldPacketCache
+{
+	WorldPacket * packets[WORLDPACKET_POOL_CLASSES][WORLDPACKET_POOL_THREAD_CACHE];
+	uint32 count[WORLDPACKET_POOL_CLASSES];
+
+	// statistics not yet added to the global counters
+	long allocations;
+	long misses;
+};
+
+static WORLDPACKET_POOL_TLS WorldPacketCache t_packetCache;
+
+static Mutex s_poolLock;
+static std::vector<WorldPacket*> s_poolGlobal[WORLDPACKET_POOL_CLASSES];
+
+static volatile long s_poolAllocations = 0;
+static volatile long s_poolMisses = 0;
+
+static ASCENT_INLINE size_t GetClassSize(uint32 c)
+{
+	return (size_t)WORLDPACKET_POOL_MIN_SIZE << (2 * c);
+}
+
+static void FlushStatistics(WorldPacketCache * cache)
+{
+#ifdef WIN32
+	InterlockedExchangeAdd(&s_poolAllocations, cache->allocations);
+	InterlockedExchangeAdd(&s_poolMisses, cache->misses);
+#else
+	__sync_add_and_fetch(&s_poolAllocations, cache->allocations);
+	__sync_add_and_fetch(&s_poolMisses, cache->misses);
+#endif
+	cache->allocations = 0;
+	cache->misses = 0;
+}
+
+WorldPacket * WorldPacketPool::Allocate(uint16 opcode, size_t size)
+{
+	WorldPacketCache * cache = &t_packetCache;
+	WorldPacket * packet;
+	uint32 c = 0;
+
+	if(++cache->allocations >= 64)
+		FlushStatistics(cache);
+
+	while(c < WORLDPACKET_POOL_CLASSES && GetClassSize(c) < size)
+		++c;
+
+	if(c == WORLDPACKET_POOL_CLASSES)
+	{
+		++cache->misses;
+		return new WorldPacket(opcode, size);
+	}
+
+	if(cache->count[c] == 0)
+	{
+		// take a batch of the packets other threads have freed
+		s_poolLock.Acquire();
+		while(cache->count[c] < WORLDPACKET_POOL_BATCH && s_poolGlobal[c].size())
+		{
+			cache->packets[c][cache->count[c]++] = s_poolGlobal[c].back();
+			s_poolGlobal[c].pop_back();
+		}
+		s_poolLock.Release();
+
+		if(cache->count[c] == 0)
+		{
+			++cache->misses;
+			return new WorldPacket(opcode, GetClassSize(c));
+		}
+	}
+
+	packet = cache->packets[c][--cache->count[c]];
+	packet->Initialize(opcode);
+	return packet;
+}
+
+void WorldPacketPool::Free(WorldPacket * packet)
+{
+	WorldPacketCache * cache = &t_packetCache;
+	size_t capacity = packet->capacity();
+	uint32 c;
+
+	// packets which grew far past the last class would hold on to too much memory
+	if(capacity < GetClassSize(0) || capacity > GetClassSize(WORLDPACKET_POOL_CLASSES - 1) * 2)
+	{
+		delete packet;
+		return;
+	}
+
+	c = WORLDPACKET_POOL_CLASSES - 1;
+	while(GetClassSize(c) > capacity)
+		--c;
+
+	if(cache->count[c] == WORLDPACKET_POOL_THREAD_CACHE)
+	{
+		// hand a batch back to the threads which allocate
+		s_poolLock.Acquire();
+		while(cache->count[c] > WORLDPACKET_POOL_THREAD_CACHE - WORLDPACKET_POOL_BATCH)
+		{
+			WorldPacket * p = cache->packets[c][--cache->count[c]];
+			if(s_poolGlobal[c].size() < WORLDPACKET_POOL_GLOBAL_LIMIT)
+				s_poolGlobal[c].push_back(p);
+			else
+				delete p;
+		}
+		s_poolLock.Release();
+	}
+
+	packet->clear();
+	cache->packets[c][cache->count[c]++] = packet;
+}
+
+void WorldPacketPool::FlushThreadCache()
+{
+	WorldPacketCache * cache = &t_packetCache;
+	uint32 c;
+
+	FlushStatistics(cache);
+
+	for(c = 0; c < WORLDPACKET_POOL_CLASSES; ++c)
+	{
+		if(cache->count[c])
+			break;
+	}
+	if(c == WORLDPACKET_POOL_CLASSES)
+		return;
+
+	s_poolLock.Acquire();
+	for(c = 0; c < WORLDPACKET_POOL_CLASSES; ++c)
+	{
+		while(cache->count[c])
+		{
+			WorldPacket * p = cache->packets[c][--cache->count[c]];
+			if(s_poolGlobal[c].size() < WORLDPACKET_POOL_GLOBAL_LIMIT)
+				s_poolGlobal[c].push_back(p);
+			else
+				delete p;
+		}
+	}
+	s_poolLock.Release();
+}
+
+void WorldPacketPool::GetStatistics(uint64 * allocations, uint64 * hits, uint64 * misses)
+{
+	// counters of each thread are added every 64 allocations
+	*allocations = (uint64)s_poolAllocations;
+	*misses = (uint64)s_poolMisses;
+	*hits = (*allocations > *misses) ? (*allocations - *misses) : 0;
+}
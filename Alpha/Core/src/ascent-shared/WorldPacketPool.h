@@ -0,0 +1,63 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _WORLDPACKETPOOL_H
+#define _WORLDPACKETPOOL_H
+
+#include "WorldPacket.h"
+
+/** Size classes of pooled packets, a packet is pooled in the largest class its
+ * reserved storage can hold. Anything bigger than the last class is allocated normally.
+ */
+#define WORLDPACKET_POOL_CLASSES 4
+#define WORLDPACKET_POOL_MIN_SIZE 128			// class n holds 128 << (2 * n) bytes: 128, 512, 2048, 8192
+#define WORLDPACKET_POOL_THREAD_CACHE 32		// packets each thread keeps per class
+#define WORLDPACKET_POOL_BATCH 16				// packets moved between a thread and the global lists at once
+#define WORLDPACKET_POOL_GLOBAL_LIMIT 4096		// packets the global list keeps per class
+
+/** Recycles heap allocated WorldPackets together with their storage, used for the
+ * packets received from clients. Every thread allocates from and frees into its own
+ * cache, so the socket thread which allocates and the map thread which frees do not
+ * contend. Caches that run full or empty exchange batches with the global lists.
+ *
+ * Pooled packets are ordinary heap packets, deleting one instead of freeing it is fine.
+ */
+class SERVER_DECL WorldPacketPool
+{
+public:
+	/** Returns an empty packet with at least size bytes reserved.
+	 */
+	static WorldPacket * Allocate(uint16 opcode, size_t size);
+
+	/** Returns a heap allocated packet to the pool.
+	 */
+	static void Free(WorldPacket * packet);
+
+	/** Moves the packets cached by the calling thread to the global lists. Pool threads
+	 * call it when their task is done, before they idle or exit.
+	 */
+	static void FlushThreadCache();
+
+	/** allocations: packets handed out, hits: packets which came from the pool,
+	 * misses: packets which had to be allocated.
+	 */
+	static void GetStatistics(uint64 * allocations, uint64 * hits, uint64 * misses);
+};
+
+#endif
@@ -606,7 +606,11 @@ void AIInterface::Update(uint32 p_time)
 		}
 	}
 
-	_UpdateMovement(p_time);
+	if(p_time > AI_MOVEMENT_REPLAY_STEP && (m_AIState == STATE_IDLE || m_AIState == STATE_SCRIPTMOVE))
+		_CatchUpMovement(p_time);
+	else
+		_UpdateMovement(p_time);
+
 	if(m_AIState==STATE_EVADE)
 	{
 		tdist = m_Unit->GetDistanceSq(m_returnX,m_returnY,m_returnZ);
@@ -1494,7 +1498,7 @@ Unit* AIInterface::FindTarget()
 #endif
 #endif
 
-	std::set<Object*>::iterator itr, it2;
+	Object::InRangeSet::iterator itr, it2;
 	Object *pObj;
 	Unit *pUnit;
 	float dist;
@@ -1714,7 +1718,7 @@ bool AIInterface::FindFriends(float dist)
 	bool result = false;
 	TargetMap::iterator it;
 
-	std::set<Object*>::iterator itr;
+	Object::InRangeSet::iterator itr;
 	Unit *pUnit;
 
 	
@@ -1812,7 +1816,7 @@ bool AIInterface::FindFriends(float dist)
 
 		uint8 spawned = 0;
 	
-		std::set<Player*>::iterator hostileItr = m_Unit->GetInRangePlayerSetBegin();
+		Object::InRangePlayerSet::iterator hostileItr = m_Unit->GetInRangePlayerSetBegin();
 		for(; hostileItr != m_Unit->GetInRangePlayerSetEnd(); hostileItr++)
 		{
 			if(spawned >= 3)
@@ -2082,7 +2086,7 @@ void AIInterface::SendMoveToPacket(float toX, float toY, float toZ, float toO, u
 	if( m_Unit->GetTypeId() == TYPEID_PLAYER )
 		static_cast<Player*>(m_Unit)->GetSession()->SendPacket(&data);
 
-	for(set<Player*>::iterator itr = m_Unit->GetInRangePlayerSetBegin(); itr != m_Unit->GetInRangePlayerSetEnd(); ++itr)
+	for(Object::InRangePlayerSet::iterator itr = m_Unit->GetInRangePlayerSetBegin(); itr != m_Unit->GetInRangePlayerSetEnd(); ++itr)
 	{
 		if( (*itr)->GetPositionNC().Distance2DSq( m_Unit->GetPosition() ) >= World::m_movementCompressThresholdCreatures )
 			(*itr)->AppendMovementData( SMSG_MONSTER_MOVE, data.GetSize(), (const uint8*)data.GetBufferPointer() );
@@ -2600,6 +2604,32 @@ WayPoint* AIInterface::getWayPoint(uint32 wpid)
 	return m_waypoints->at(wpid);
 }
 
+void AIInterface::_CatchUpMovement(uint32 p_time)
+{
+	// An idle creature nobody sees gets the time of several map loops at once. _UpdateMovement
+	// handles one step of the path per call and drops the time left when its timer runs out,
+	// so the time is handed over in pieces that end where the timer does, which is where the
+	// loops it skipped would have taken the next step.
+	uint32 slice;
+	while(p_time > 0)
+	{
+		if(m_moveTimer > 0)
+			slice = (m_moveTimer < p_time) ? m_moveTimer : p_time;
+		else
+			slice = (AI_MOVEMENT_REPLAY_STEP < p_time) ? AI_MOVEMENT_REPLAY_STEP : p_time;
+
+		_UpdateMovement(slice);
+		p_time -= slice;
+
+		if(!m_Unit->IsInWorld() || !m_Unit->isAlive())
+			break;
+
+		// nowhere to go and nothing to wait for, the next steps would do nothing either
+		if(m_creatureState == STOPPED && m_moveTimer == 0)
+			break;
+	}
+}
+
 void AIInterface::_UpdateMovement(uint32 p_time)
 {
 	if(!m_Unit->isAlive())
@@ -3765,7 +3795,7 @@ void AIInterface::WipeReferences()
 	UnitToFollow = 0;
 	tauntedBy = 0;
 	//Clear targettable
-	for(set<Object*>::iterator itr = m_Unit->GetInRangeSetBegin(); itr != m_Unit->GetInRangeSetEnd(); ++itr)
+	for(Object::InRangeSet::iterator itr = m_Unit->GetInRangeSetBegin(); itr != m_Unit->GetInRangeSetEnd(); ++itr)
 		if( (*itr) && (*itr)->GetTypeId() == TYPEID_UNIT && static_cast<Unit*>(*itr)->GetAIInterface())
 			static_cast<Unit*>(*itr)->GetAIInterface()->RemoveThreatByPtr( m_Unit );
 
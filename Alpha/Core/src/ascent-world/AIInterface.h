@@ -27,6 +27,7 @@
 
 #define M_PI	   3.14159265358979323846
 #define UNIT_MOVEMENT_INTERPOLATE_INTERVAL 400/*750*/ // ms smoother server/client side moving vs less cpu/ less b/w
+#define AI_MOVEMENT_REPLAY_STEP 100 // ms, one map loop, see AIInterface::_CatchUpMovement
 #define TARGET_UPDATE_INTERVAL 600 // ms
 #define oocr 50.0f // out of combat range
 #define PLAYER_SIZE 1.5f
@@ -429,6 +430,7 @@ protected:
 	// Update
 	void _UpdateTargets();
 	void _UpdateMovement(uint32 p_time);
+	void _CatchUpMovement(uint32 p_time);
 	void _UpdateTimer(uint32 p_time);
 	int m_updateAssist;
 	int m_updateTargets;
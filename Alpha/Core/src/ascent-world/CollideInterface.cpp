@@ -28,6 +28,85 @@ IVMapManager * CollisionMgr;
 Mutex m_loadLock;
 uint32 m_tilesLoaded[MAX_MAP][64][64];
 
+#ifndef COLLISION_DEBUG
+
+/* Per map LOS cache. Every entry is one word holding the key with the result in the
+   lowest bit, so readers and writers need no lock; a torn or overwritten entry just
+   misses. The generation changes whenever tiles of the map are loaded or unloaded,
+   which makes all older entries miss. */
+uint64 * m_losCache[MAX_MAP];
+volatile long m_losGeneration[MAX_MAP];
+uint32 m_losCacheMask;
+
+static void LOSCacheInit()
+{
+	int32 size = Config.MainConfig.GetIntDefault("Terrain", "LOSCacheSize", 4096);
+	uint32 entries = 1;
+
+	memset(m_losCache, 0, sizeof(m_losCache));
+	memset((void*)m_losGeneration, 0, sizeof(m_losGeneration));
+
+	// power of two, 0 turns the cache off
+	while(size > 0 && entries * 2 <= (uint32)size)
+		entries *= 2;
+	m_losCacheMask = (size > 0) ? entries - 1 : 0;
+	if(size > 0)
+		Log.Notice("CollideInterface", "Caching %u LOS results per map.", entries);
+}
+
+static void LOSCacheShutdown()
+{
+	for(uint32 i = 0; i < MAX_MAP; ++i)
+	{
+		delete [] m_losCache[i];
+		m_losCache[i] = NULL;
+	}
+}
+
+/* called with m_loadLock held when a tile of the map was loaded or unloaded */
+static void LOSCacheMapChanged(uint32 mapId)
+{
+	if(m_losCacheMask == 0)
+		return;
+
+	if(m_losCache[mapId] == NULL)
+	{
+		uint64 * cache = new uint64[m_losCacheMask + 1];
+		memset(cache, 0, sizeof(uint64) * (m_losCacheMask + 1));
+		m_losCache[mapId] = cache;
+	}
+
+#ifdef WIN32
+	InterlockedIncrement(&m_losGeneration[mapId]);
+#else
+	__sync_add_and_fetch(&m_losGeneration[mapId], 1);
+#endif
+}
+
+static ASCENT_INLINE uint64 LOSCacheMix(uint64 h, int32 v)
+{
+	h ^= (uint32)v;
+	h *= 0x9E3779B97F4A7C15ULL;
+	return h ^ (h >> 29);
+}
+
+static uint64 LOSCacheKey(uint32 generation, bool eye_level, LocationVector & pos1, LocationVector & pos2)
+{
+	uint64 h = LOSCacheMix(generation, eye_level ? 1 : 0);
+	h = LOSCacheMix(h, float2int32(pos1.x * LOS_CACHE_RESOLUTION));
+	h = LOSCacheMix(h, float2int32(pos1.y * LOS_CACHE_RESOLUTION));
+	h = LOSCacheMix(h, float2int32(pos1.z * LOS_CACHE_RESOLUTION));
+	h = LOSCacheMix(h, float2int32(pos2.x * LOS_CACHE_RESOLUTION));
+	h = LOSCacheMix(h, float2int32(pos2.y * LOS_CACHE_RESOLUTION));
+	h = LOSCacheMix(h, float2int32(pos2.z * LOS_CACHE_RESOLUTION));
+
+	// the lowest bit holds the result, 0 is an empty entry
+	h &= ~uint64(1);
+	return h ? h : 2;
+}
+
+#endif	// COLLISION_DEBUG
+
 #ifdef WIN32
 #ifdef COLLISION_DEBUG
 
@@ -196,6 +275,7 @@ bool CCollideInterface::GetFirstPoint(uint32 mapId, float x1, float y1, float z1
 void CCollideInterface::Init()
 {
 	Log.Notice("CollideInterface", "Init");
+	LOSCacheInit();
 	CollisionMgr = ((IVMapManager*)collision_init());
 }
 
@@ -203,7 +283,10 @@ void CCollideInterface::ActivateTile(uint32 mapId, uint32 tileX, uint32 tileY)
 {
 	m_loadLock.Acquire();
 	if(m_tilesLoaded[mapId][tileX][tileY] == 0)
+	{
 		CollisionMgr->loadMap(sWorld.vMapPath.c_str(), mapId, tileY, tileX);
+		LOSCacheMapChanged(mapId);
+	}
 
 	++m_tilesLoaded[mapId][tileX][tileY];
 	m_loadLock.Release();
@@ -213,7 +296,10 @@ void CCollideInterface::DeactivateTile(uint32 mapId, uint32 tileX, uint32 tileY)
 {
 	m_loadLock.Acquire();
 	if(!(--m_tilesLoaded[mapId][tileX][tileY]))
+	{
 		CollisionMgr->unloadMap(mapId, tileY, tileX);
+		LOSCacheMapChanged(mapId);
+	}
 
 	m_loadLock.Release();
 }
@@ -222,6 +308,26 @@ void CCollideInterface::DeInit()
 {
 	Log.Notice("CollideInterface", "DeInit");
 	collision_shutdown();
+	LOSCacheShutdown();
+}
+
+bool CCollideInterface::_CheckLOS(uint32 mapId, LocationVector & pos1, LocationVector & pos2, bool eye_level)
+{
+	uint64 * cache = (mapId < MAX_MAP) ? m_losCache[mapId] : NULL;
+	if(cache == NULL)
+		return eye_level ? CollisionMgr->isInLineOfSight(mapId, pos1, pos2) : CollisionMgr->isInLineOfSight(mapId, pos1.x, pos1.y, pos1.z, pos2.x, pos2.y, pos2.z);
+
+	// read the generation before the query, a result of a query which overlapped a tile
+	// change is stored under the old generation and never found
+	uint64 key = LOSCacheKey((uint32)m_losGeneration[mapId], eye_level, pos1, pos2);
+	volatile uint64 * entry = &cache[(uint32)(key >> 32) & m_losCacheMask];
+	uint64 value = *entry;
+	if((value & ~uint64(1)) == key)
+		return (value & 1) != 0;
+
+	bool result = eye_level ? CollisionMgr->isInLineOfSight(mapId, pos1, pos2) : CollisionMgr->isInLineOfSight(mapId, pos1.x, pos1.y, pos1.z, pos2.x, pos2.y, pos2.z);
+	*entry = key | (result ? 1 : 0);
+	return result;
 }
 
 #endif		// COLLISION_DEBUG
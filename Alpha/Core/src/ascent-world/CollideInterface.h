@@ -23,6 +23,9 @@
 /* imports */
 #define NO_WMO_HEIGHT -100000.0f
 
+/* LOS results are cached per map for endpoints on this grid (steps per yard) */
+#define LOS_CACHE_RESOLUTION 2.0f
+
 //#define COLLISION_DEBUG 1
 
 #ifdef WIN32
@@ -100,7 +103,9 @@ public:
 
 	ASCENT_INLINE bool CheckLOS(uint32 mapId, float x1, float y1, float z1, float x2, float y2, float z2)
 	{
-		return CollisionMgr->isInLineOfSight( mapId, x1, y1, z1, x2, y2, z2 );
+		LocationVector pos1(x1, y1, z1);
+		LocationVector pos2(x2, y2, z2);
+		return _CheckLOS( mapId, pos1, pos2, false );
 	}
 
 	ASCENT_INLINE bool GetFirstPoint(uint32 mapId, float x1, float y1, float z1, float x2, float y2, float z2, float & outx, float & outy, float & outz, float distmod)
@@ -125,7 +130,7 @@ public:
 
 	ASCENT_INLINE bool CheckLOS(uint32 mapId, LocationVector & pos1, LocationVector & pos2)
 	{
-		return CollisionMgr->isInLineOfSight( mapId, pos1, pos2 );
+		return _CheckLOS( mapId, pos1, pos2, true );
 	}
 
 	ASCENT_INLINE bool GetFirstPoint(uint32 mapId, LocationVector & pos1, LocationVector & pos2, LocationVector & outvec, float distmod)
@@ -148,6 +153,11 @@ public:
 		return CollisionMgr->getHeight( mapId, pos );
 	}
 
+private:
+	/* Looks the result up in the map's LOS cache before asking the collision library.
+	   eye_level selects the LocationVector query, which raises both ends by 2 yards. */
+	bool _CheckLOS(uint32 mapId, LocationVector & pos1, LocationVector & pos2, bool eye_level);
+
 #endif
 
 };
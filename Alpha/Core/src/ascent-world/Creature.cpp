@@ -79,6 +79,10 @@ Creature::Creature(uint64 guid)
 
 	loot.gold = 0;
 	haslinkupevent = false;
+	m_lodTick = 0;
+	m_lodUpdateTime = 0;
+	m_lodElapsed = 0;
+	m_lodRun = true;
 	original_emotestate = 0;
 	mTrainer = 0;
 	m_spawn = 0;
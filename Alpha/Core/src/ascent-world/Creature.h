@@ -521,6 +521,13 @@ public:
 	void RemoveLimboState(Unit * healer);
 	void SetGuardWaypoints();
 	bool m_corpseEvent;
+
+	// level of detail AI, only touched by the map thread (see MapMgr::_ScheduleCreatureUpdates)
+	uint32 m_lodTick;			// map loop the values below were set for
+	uint32 m_lodUpdateTime;		// time to update with in that loop
+	uint32 m_lodElapsed;		// time since the last update while idle
+	bool m_lodRun;				// false if the creature skips that loop
+
 	MapCell * m_respawnCell;
 	bool m_noRespawn;
 	LocationVector * m_transportPosition;
@@ -22,6 +22,8 @@ initialiseSingleton(DatabaseCleaner);
 
 void DatabaseCleaner::Run()
 {
+	Database::SetConnectionPriority(DATABASE_PRIORITY_LOW);
+
 	Log.Notice("DatabaseCleaner", "Stage 1 of 3: Cleaning characters...");
 	CleanCharacters();
 
@@ -30,6 +32,8 @@ void DatabaseCleaner::Run()
 
 	Log.Notice("DatabaseCleaner", "Stage 3 of 3: Optimizing databases...");
 	Optimize();
+
+	Database::SetConnectionPriority(DATABASE_PRIORITY_HIGH);
 }
 
 void DatabaseCleaner::CleanWorld()
@@ -135,8 +135,8 @@ void DynamicObject::UpdateTargets()
 	{
 //		FactionRangeList::iterator itr  = m_inRangeOppFactions.begin();
 //		FactionRangeList::iterator iend = m_inRangeOppFactions.end();
-		std::set<Object*>::iterator itr = GetInRangeSetBegin(),itr2;
-		std::set<Object*>::iterator iend = GetInRangeSetEnd();
+		Object::InRangeSet::iterator itr = GetInRangeSetBegin(),itr2;
+		Object::InRangeSet::iterator iend = GetInRangeSetEnd();
 		Unit * target;
 		Aura * pAura;
 		float radius = m_floatValues[DYNAMICOBJECT_RADIUS]*m_floatValues[DYNAMICOBJECT_RADIUS];
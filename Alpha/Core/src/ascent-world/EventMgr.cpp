@@ -25,3 +25,50 @@ TimedEvent * TimedEvent::Allocate(void* object, CallbackBase* callback, uint32 f
 {
 	return new TimedEvent(object, callback, flags, time, repeat, 0);
 }
+
+/* Event memory is never given back to the system, freed events are linked through
+   their first bytes and handed out again. Boss fights add and drop thousands of
+   events a minute, this keeps them out of the general purpose allocator. */
+static FastMutex m_eventPoolLock;
+static void * m_eventFreeList = NULL;
+
+void * TimedEvent::operator new(size_t size)
+{
+	ASSERT(size == sizeof(TimedEvent));
+	void * p;
+
+	m_eventPoolLock.Acquire();
+	if(m_eventFreeList == NULL)
+	{
+		// carve a new slab into the free list
+		uint8 * slab = (uint8*)malloc(sizeof(TimedEvent) * TIMED_EVENT_SLAB_SIZE);
+		if(slab == NULL)
+		{
+			m_eventPoolLock.Release();
+			throw std::bad_alloc();
+		}
+
+		for(uint32 i = 0; i < TIMED_EVENT_SLAB_SIZE; ++i)
+		{
+			*(void**)(slab + i * sizeof(TimedEvent)) = m_eventFreeList;
+			m_eventFreeList = slab + i * sizeof(TimedEvent);
+		}
+	}
+
+	p = m_eventFreeList;
+	m_eventFreeList = *(void**)p;
+	m_eventPoolLock.Release();
+
+	return p;
+}
+
+void TimedEvent::operator delete(void * p)
+{
+	if(p == NULL)
+		return;
+
+	m_eventPoolLock.Acquire();
+	*(void**)p = m_eventFreeList;
+	m_eventFreeList = p;
+	m_eventPoolLock.Release();
+}
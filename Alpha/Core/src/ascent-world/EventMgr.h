@@ -184,54 +184,84 @@ enum EventFlags
 	EVENT_FLAG_DELETES_OBJECT				   = 0x2,
 };
 
+/** Callbacks up to this size are constructed inside the event instead of on the heap,
+ * which covers a member function pointer with four pointer sized arguments.
+ */
+#define TIMED_EVENT_INLINE_CALLBACK 64
+
+/** Events are carved out of slabs of this many and recycled through a free list.
+ */
+#define TIMED_EVENT_SLAB_SIZE 256
+
 struct SERVER_DECL TimedEvent
 {
 	TimedEvent(void* object, CallbackBase* callback, uint32 type, time_t time, uint32 repeat, uint32 flags) : 
-		obj(object), cb(callback), eventType(type), eventFlag(flags), msTime(time), currTime(time), repeats(repeat), deleted(false),ref(0) {}
+		obj(object), cb(callback), eventType(type), eventFlag(flags), msTime(time), currTime(time), repeats(repeat), deleted(false), dueTime(0), wheelStamp(0), ref(0) {}
+
+	~TimedEvent()
+	{
+		if((void*)cb == (void*)m_callbackStorage.data)
+			cb->~CallbackBase();
+		else
+			delete cb;
+	}
+
+	/** Copies callback into the event, it only goes to the heap if it does not fit.
+	 */
+	template<class Callback>
+	void SetCallback(const Callback & callback)
+	{
+		if(sizeof(Callback) <= TIMED_EVENT_INLINE_CALLBACK)
+			cb = new(m_callbackStorage.data) Callback(callback);
+		else
+			cb = new Callback(callback);
+	}
 		
 	void *obj;
 	CallbackBase *cb;
 	uint32 eventType;
 	uint16 eventFlag;
 	time_t msTime;
-	time_t currTime;
+	time_t currTime;		// time left when the event is (re)scheduled
 	uint16 repeats;
 	bool deleted;
+	uint32 dueTime;			// holder time the event fires at
+	uint32 wheelStamp;		// see EventWheelEntry
 	int instanceId;
 	volatile long ref;
 
 	static TimedEvent * Allocate(void* object, CallbackBase* callback, uint32 flags, time_t time, uint32 repeat);
 
+	// memory comes from the event slabs
+	static void * operator new(size_t size);
+	static void operator delete(void * p);
+
+	// the object's event map and any number of holders reference the event, from different threads
 #ifdef WIN32
 	void DecRef()
 	{
-		InterlockedDecrement(&ref);
-		if(ref <= 0)
-		{
-			delete cb;
+		if(InterlockedDecrement(&ref) <= 0)
 			delete this;
-		}
 	}
 
 	void IncRef() { InterlockedIncrement(&ref); }
 #else
-
-	/* burlex: if anyone knows how to do the equivilent of InterlockedIncrement/Decrement on linux feel free
-	   to change this, I couldn't find the atomic functions anymore though :*( */
-
-	void IncRef() { ++ref; }
+	void IncRef() { __sync_add_and_fetch(&ref, 1); }
     
 	void DecRef()
 	{
-		--ref;
-		if(ref <= 0)
-		{
-			 delete cb;
-			 delete this;
-		}
+		if(__sync_sub_and_fetch(&ref, 1) <= 0)
+			delete this;
 	}
 #endif
 
+private:
+	union
+	{
+		uint8 data[TIMED_EVENT_INLINE_CALLBACK];
+		uint64 align;
+		void * ptr;
+	} m_callbackStorage;
 };
 
 class EventMgr;
@@ -246,7 +276,8 @@ public:
 		void AddEvent(Class *obj, void (Class::*method)(), uint32 type, uint32 time, uint32 repeats, uint32 flags)
 	{
 		// create a timed event
-		TimedEvent * event = new TimedEvent(obj, new CallbackP0<Class>(obj, method), type, time, repeats, flags);
+		TimedEvent * event = new TimedEvent(obj, NULL, type, time, repeats, flags);
+		event->SetCallback(CallbackP0<Class>(obj, method));
 
 		// add this to the object's list, updating will all be done later on...
 		obj->event_AddEvent(event);
@@ -256,7 +287,8 @@ public:
 		void AddEvent(Class *obj, void (Class::*method)(P1), P1 p1, uint32 type, uint32 time, uint32 repeats, uint32 flags)
 	{
 		// create a timed event
-		TimedEvent * event = new TimedEvent(obj, new CallbackP1<Class, P1>(obj, method, p1), type, time, repeats, flags);
+		TimedEvent * event = new TimedEvent(obj, NULL, type, time, repeats, flags);
+		event->SetCallback(CallbackP1<Class, P1>(obj, method, p1));
 
 		// add this to the object's list, updating will all be done later on...
 		obj->event_AddEvent(event);
@@ -266,7 +298,8 @@ public:
 		void AddEvent(Class *obj, void (Class::*method)(P1,P2), P1 p1, P2 p2, uint32 type, uint32 time, uint32 repeats, uint32 flags)
 	{
 		// create a timed event
-		TimedEvent * event = new TimedEvent(obj, new CallbackP2<Class, P1, P2>(obj, method, p1, p2), type, time, repeats, flags);
+		TimedEvent * event = new TimedEvent(obj, NULL, type, time, repeats, flags);
+		event->SetCallback(CallbackP2<Class, P1, P2>(obj, method, p1, p2));
 
 		// add this to the object's list, updating will all be done later on...
 		obj->event_AddEvent(event);
@@ -276,7 +309,8 @@ public:
 		void AddEvent(Class *obj,void (Class::*method)(P1,P2,P3), P1 p1, P2 p2, P3 p3, uint32 type, uint32 time, uint32 repeats, uint32 flags)
 	{
 		// create a timed event
-		TimedEvent * event = new TimedEvent(obj, new CallbackP3<Class, P1, P2, P3>(obj, method, p1, p2, p3), type, time, repeats, flags);
+		TimedEvent * event = new TimedEvent(obj, NULL, type, time, repeats, flags);
+		event->SetCallback(CallbackP3<Class, P1, P2, P3>(obj, method, p1, p2, p3));
 
 		// add this to the object's list, updating will all be done later on...
 		obj->event_AddEvent(event);
@@ -286,7 +320,8 @@ public:
 		void AddEvent(Class *obj, void (Class::*method)(P1,P2,P3,P4), P1 p1, P2 p2, P3 p3, P4 p4, uint32 type, uint32 time, uint32 repeats, uint32 flags)
 	{
 		// create a timed event
-		TimedEvent * event = new TimedEvent(obj, new CallbackP4<Class, P1, P2, P3, P4>(obj, method, p1, p2, p3, p4), type, time, repeats, flags);
+		TimedEvent * event = new TimedEvent(obj, NULL, type, time, repeats, flags);
+		event->SetCallback(CallbackP4<Class, P1, P2, P3, P4>(obj, method, p1, p2, p3, p4));
 
 		// add this to the object's list, updating will all be done later on...
 		obj->event_AddEvent(event);
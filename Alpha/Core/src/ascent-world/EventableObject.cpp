@@ -157,8 +157,8 @@ void EventableObject::event_ModifyTimeLeft(uint32 EventType, uint32 TimeLeft,boo
 		do 
 		{
 			if(unconditioned)
-				itr->second->currTime = TimeLeft;
-			else itr->second->currTime = ((int32)TimeLeft > itr->second->msTime) ? itr->second->msTime : (int32)TimeLeft;
+				event_SetTimeLeft(itr->second, TimeLeft);
+			else event_SetTimeLeft(itr->second, ((int32)TimeLeft > itr->second->msTime) ? (uint32)itr->second->msTime : TimeLeft);
 			++itr;
 		} while(itr != m_events.upper_bound(EventType));
 	}
@@ -186,7 +186,7 @@ bool EventableObject::event_GetTimeLeft(uint32 EventType, uint32 * Time)
 				continue;
 			}
 
-			*Time = (uint32)itr->second->currTime;
+			*Time = m_holder ? m_holder->GetTimeLeft(itr->second) : (uint32)itr->second->currTime;
 			m_lock.Release();
 			return true;
 
@@ -233,7 +233,8 @@ void EventableObject::event_ModifyTimeAndTimeLeft(uint32 EventType, uint32 Time)
 	{
 		do 
 		{
-			itr->second->currTime = itr->second->msTime = Time;
+			itr->second->msTime = Time;
+			event_SetTimeLeft(itr->second, Time);
 			++itr;
 		} while(itr != m_events.upper_bound(EventType));
 	}
@@ -241,6 +242,13 @@ void EventableObject::event_ModifyTimeAndTimeLeft(uint32 EventType, uint32 Time)
 	m_lock.Release();
 }
 
+void EventableObject::event_SetTimeLeft(TimedEvent * ev, uint32 TimeLeft)
+{
+	if(m_holder)
+		m_holder->ModifyEvent(ev, TimeLeft);
+	else
+		ev->currTime = TimeLeft;
+}
 
 bool EventableObject::event_HasEvent(uint32 EventType)
 {
@@ -273,6 +281,7 @@ bool EventableObject::event_HasEvent(uint32 EventType)
 
 EventableObjectHolder::EventableObjectHolder(int32 instance_id) : mInstanceId(instance_id)
 {
+	m_time = 0;
 	sEventMgr.AddEventHolder(this, instance_id);
 }
 
@@ -282,10 +291,133 @@ EventableObjectHolder::~EventableObjectHolder()
 
 	/* decrement events reference count */
 	m_lock.Acquire();
-	EventList::iterator itr = m_events.begin();
-	for(; itr != m_events.end(); ++itr)
-		(*itr)->DecRef();
+	EventWheelSlot::iterator itr;
+	for(uint32 i = 0; i < EVENT_WHEEL_ROOT_SIZE; ++i)
+	{
+		for(itr = m_root[i].begin(); itr != m_root[i].end(); ++itr)
+			itr->ev->DecRef();
+	}
+
+	for(uint32 l = 0; l < EVENT_WHEEL_LEVELS; ++l)
+	{
+		for(uint32 i = 0; i < EVENT_WHEEL_LEVEL_SIZE; ++i)
+		{
+			for(itr = m_levels[l][i].begin(); itr != m_levels[l][i].end(); ++itr)
+				itr->ev->DecRef();
+		}
+	}
 	m_lock.Release();
+
+	m_insertPoolLock.Acquire();
+	for(InsertableQueue::iterator iqi = m_insertPool.begin(); iqi != m_insertPool.end(); ++iqi)
+		(*iqi)->DecRef();
+	m_insertPool.clear();
+	m_insertPoolLock.Release();
+}
+
+void EventableObjectHolder::_Schedule(TimedEvent * ev)
+{
+	// the reference held by the caller moves into the wheel
+	EventWheelEntry e;
+	e.ev = ev;
+	e.stamp = ++ev->wheelStamp;
+	ev->dueTime = m_time + (uint32)ev->currTime;
+	_Insert(e, m_time + 1);
+}
+
+void EventableObjectHolder::_Insert(const EventWheelEntry & e, uint32 base)
+{
+	// base is the first ms which has not been processed yet, anything due before goes there
+	uint32 due = e.ev->dueTime;
+	int32 delta = (int32)(due - base);
+	if(delta < 0)
+	{
+		due = base;
+		delta = 0;
+	}
+
+	if(delta < EVENT_WHEEL_ROOT_SIZE)
+	{
+		m_root[due & (EVENT_WHEEL_ROOT_SIZE - 1)].push_back(e);
+		return;
+	}
+
+	if(delta >= EVENT_WHEEL_MAX_DELAY)
+		due = base + EVENT_WHEEL_MAX_DELAY - 1;
+
+	uint32 shift = EVENT_WHEEL_ROOT_BITS;
+	uint32 l = 0;
+	for(; l < EVENT_WHEEL_LEVELS - 1; ++l, shift += EVENT_WHEEL_LEVEL_BITS)
+	{
+		if(delta < (1 << (shift + EVENT_WHEEL_LEVEL_BITS)))
+			break;
+	}
+
+	m_levels[l][(due >> shift) & (EVENT_WHEEL_LEVEL_SIZE - 1)].push_back(e);
+}
+
+void EventableObjectHolder::_Cascade(EventWheelSlot & slot)
+{
+	// entries land in a lower level (or back here if they were parked), m_time is
+	// the ms being processed so events due right now still make it into the root slot
+	m_firing.swap(slot);
+	for(EventWheelSlot::iterator itr = m_firing.begin(); itr != m_firing.end(); ++itr)
+	{
+		if(itr->stamp != itr->ev->wheelStamp || itr->ev->deleted || itr->ev->instanceId != mInstanceId)
+			itr->ev->DecRef();
+		else
+			_Insert(*itr, m_time);
+	}
+	m_firing.clear();
+}
+
+void EventableObjectHolder::_Fire(const EventWheelEntry & e)
+{
+	TimedEvent * ev = e.ev;
+	if(e.stamp != ev->wheelStamp || ev->instanceId != mInstanceId || ev->deleted || 
+		( mInstanceId == WORLD_INSTANCE && ev->eventFlag & EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT))
+	{
+		// removed, rescheduled or moved to another holder since it was inserted
+		ev->DecRef();
+		return;
+	}
+
+	if((int32)(ev->dueTime - m_time) > 0)
+	{
+		// parked in the last level, not due yet
+		_Insert(e, m_time + 1);
+		return;
+	}
+
+	// execute the callback
+	if(ev->eventFlag & EVENT_FLAG_DELETES_OBJECT)
+	{
+		ev->deleted = true;
+		ev->cb->execute();
+		ev->DecRef();
+		return;
+	}
+	else
+		ev->cb->execute();
+
+	// check if the event is expired now.
+	if(ev->repeats && --ev->repeats == 0)
+	{
+		// Event expired :>
+		ev->deleted = true;
+		ev->DecRef();
+		return;
+	}
+	else if(ev->deleted || e.stamp != ev->wheelStamp || ev->instanceId != mInstanceId)
+	{
+		// event is now deleted, or the callback rescheduled or relocated it
+		ev->DecRef();
+		return;
+	}
+
+	// event has to repeat again, reset the timer
+	ev->currTime = ev->msTime;
+	_Schedule(ev);
 }
 
 void EventableObjectHolder::Update(uint32 time_difference)
@@ -302,79 +434,42 @@ void EventableObjectHolder::Update(uint32 time_difference)
 		if((*iqi)->deleted || (*iqi)->instanceId != mInstanceId)
 			(*iqi)->DecRef();
 		else
-			m_events.push_back( (*iqi) );
+			_Schedule(*iqi);
 
 		m_insertPool.erase(iqi);
 	}
 	m_insertPoolLock.Release();
 
-	/* Now we can proceed normally. */
-	EventList::iterator itr = m_events.begin();
-	EventList::iterator it2;
-	TimedEvent * ev;
-
-	while(itr != m_events.end())
+	/* Now we can proceed normally. Only the slots of the elapsed ms are visited, and only
+	   the events in them are touched. */
+	uint32 target = m_time + time_difference;
+	uint32 idx, shift, l;
+	while(m_time != target)
 	{
-		it2 = itr++;
-
-		if((*it2)->instanceId != mInstanceId || (*it2)->deleted || 
-			( mInstanceId == WORLD_INSTANCE && (*it2)->eventFlag & EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT))
-		{
-			// remove from this list.
-			(*it2)->DecRef();
-			m_events.erase(it2);
-			continue;
-		}
+		++m_time;
 
-		// Event Update Procedure
-		ev = *it2;
-
-		if((uint32)ev->currTime <= time_difference)
+		idx = m_time & (EVENT_WHEEL_ROOT_SIZE - 1);
+		if(idx == 0)
 		{
-			// execute the callback
-			if(ev->eventFlag & EVENT_FLAG_DELETES_OBJECT)
+			// the root wheel wrapped, pull the next slot of each level down
+			shift = EVENT_WHEEL_ROOT_BITS;
+			for(l = 0; l < EVENT_WHEEL_LEVELS; ++l, shift += EVENT_WHEEL_LEVEL_BITS)
 			{
-				ev->deleted = true;
-				ev->cb->execute();
-				m_events.erase(it2);
-				ev->DecRef();
-				continue;
+				uint32 lidx = (m_time >> shift) & (EVENT_WHEEL_LEVEL_SIZE - 1);
+				_Cascade(m_levels[l][lidx]);
+				if(lidx != 0)
+					break;
 			}
-			else
-				ev->cb->execute();
-
-			// check if the event is expired now.
-            if(ev->repeats && --ev->repeats == 0)
-			{
-				// Event expired :>
-				
-				/* remove the event from the object */
-				/*obj = (EventableObject*)ev->obj;
-				obj->event_RemoveByPointer(ev);*/
-
-				/* remove the event from here */
-				ev->deleted = true;
-				ev->DecRef();
-				m_events.erase(it2);
+		}
 
-				continue;
-			}
-			else if(ev->deleted)
-			{
-				// event is now deleted
-				ev->DecRef();
-				m_events.erase(it2);
-				continue;
-			}
+		if(m_root[idx].empty())
+			continue;
 
-			// event has to repeat again, reset the timer
-			ev->currTime = ev->msTime;
-		}
-		else
-		{
-			// event is still "waiting", subtract time difference
-			ev->currTime -= time_difference;
-		}
+		// callbacks may add events to this slot again, work on a swapped out copy
+		m_firing.swap(m_root[idx]);
+		for(EventWheelSlot::iterator itr = m_firing.begin(); itr != m_firing.end(); ++itr)
+			_Fire(*itr);
+		m_firing.clear();
 	}
 
 	m_lock.Release();
@@ -430,11 +525,40 @@ void EventableObjectHolder::AddEvent(TimedEvent * ev)
 	}
 	else
 	{
-		m_events.push_back( ev );
+		_Schedule(ev);
+		m_lock.Release();
+	}
+}
+
+void EventableObjectHolder::ModifyEvent(TimedEvent * ev, uint32 TimeLeft)
+{
+	ev->currTime = TimeLeft;
+
+	ev->IncRef();
+	if(!m_lock.AttemptAcquire())
+	{
+		// rescheduled once the holder thread gets to its insert pool
+		ev->dueTime = m_time + TimeLeft;
+		m_insertPoolLock.Acquire();
+		m_insertPool.push_back( ev );
+		m_insertPoolLock.Release();
+	}
+	else
+	{
+		_Schedule(ev);
 		m_lock.Release();
 	}
 }
 
+uint32 EventableObjectHolder::GetTimeLeft(TimedEvent * ev)
+{
+	if(!ev->wheelStamp)
+		return (uint32)ev->currTime;
+
+	int32 left = (int32)(ev->dueTime - m_time);
+	return (left > 0) ? (uint32)left : 0;
+}
+
 void EventableObjectHolder::AddObject(EventableObject * obj)
 {
 	// transfer all of this objects events into our holder
@@ -459,6 +583,10 @@ void EventableObjectHolder::AddObject(EventableObject * obj)
 			if(mInstanceId == WORLD_INSTANCE && itr->second->eventFlag & EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT)
 				continue;
 
+			// the clocks of two holders have nothing in common, carry the time left over
+			if(obj->m_holder)
+				itr->second->currTime = obj->m_holder->GetTimeLeft(itr->second);
+
 			itr->second->IncRef();
 			itr->second->instanceId = mInstanceId;
 			m_insertPool.push_back(itr->second);
@@ -480,9 +608,12 @@ void EventableObjectHolder::AddObject(EventableObject * obj)
 		if(mInstanceId == WORLD_INSTANCE && itr->second->eventFlag & EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT)
 			continue;
 
+		if(obj->m_holder)
+			itr->second->currTime = obj->m_holder->GetTimeLeft(itr->second);
+
 		itr->second->IncRef();
 		itr->second->instanceId = mInstanceId;
-		m_events.push_back( itr->second );
+		_Schedule(itr->second);
 	}
 
 	m_lock.Release();
@@ -51,6 +51,10 @@ protected:
 	ASCENT_INLINE int32 event_GetCurrentInstanceId() { return m_event_Instanceid; }
 	bool event_GetTimeLeft(uint32 EventType, uint32 * Time);
 
+	/** Moves ev to fire TimeLeft ms from now, m_lock has to be held.
+	 */
+	void event_SetTimeLeft(TimedEvent * ev, uint32 TimeLeft);
+
 public:
 	uint32 event_GetEventPeriod(uint32 EventType);
 	// Public methods
@@ -87,6 +91,29 @@ protected:
 
 typedef set<EventableObject*> EventableObjectSet;
 
+/** The holder keeps its events in a hierarchical timer wheel with a resolution of 1ms.
+ * The root wheel covers the next 256ms, every further level 64 times the previous one,
+ * events further away than the last level are parked in its farthest slot.
+ */
+#define EVENT_WHEEL_ROOT_BITS 8
+#define EVENT_WHEEL_LEVEL_BITS 6
+#define EVENT_WHEEL_LEVELS 3
+#define EVENT_WHEEL_ROOT_SIZE (1 << EVENT_WHEEL_ROOT_BITS)
+#define EVENT_WHEEL_LEVEL_SIZE (1 << EVENT_WHEEL_LEVEL_BITS)
+#define EVENT_WHEEL_MAX_DELAY (1 << (EVENT_WHEEL_ROOT_BITS + EVENT_WHEEL_LEVELS * EVENT_WHEEL_LEVEL_BITS))
+
+/** An event is not taken out of the wheel when it is removed or rescheduled. Every
+ * (re)schedule bumps the event's wheelStamp, entries with an older stamp are dropped
+ * once their slot comes up.
+ */
+struct EventWheelEntry
+{
+	TimedEvent * ev;
+	uint32 stamp;
+};
+
+typedef vector<EventWheelEntry> EventWheelSlot;
+
 class EventableObjectHolder
 {
 public:
@@ -98,12 +125,29 @@ public:
 	void AddEvent(TimedEvent * ev);
 	void AddObject(EventableObject * obj);
 
+	/** Reschedules ev to fire in TimeLeft ms, can be called from any thread.
+	 */
+	void ModifyEvent(TimedEvent * ev, uint32 TimeLeft);
+
+	/** Time left until ev fires in this holder. */
+	uint32 GetTimeLeft(TimedEvent * ev);
+
 	ASCENT_INLINE uint32 GetInstanceID() { return mInstanceId; }
 
 protected:
+	void _Schedule(TimedEvent * ev);
+	void _Insert(const EventWheelEntry & e, uint32 base);
+	void _Cascade(EventWheelSlot & slot);
+	void _Fire(const EventWheelEntry & e);
+
 	int32 mInstanceId;
 	Mutex m_lock;
-	EventList m_events;
+
+	// ms processed so far, events fire once it reaches their dueTime
+	uint32 m_time;
+	EventWheelSlot m_root[EVENT_WHEEL_ROOT_SIZE];
+	EventWheelSlot m_levels[EVENT_WHEEL_LEVELS][EVENT_WHEEL_LEVEL_SIZE];
+	EventWheelSlot m_firing;
 
 	Mutex m_insertPoolLock;
 	typedef list<TimedEvent*> InsertableQueue;
@@ -450,7 +450,7 @@ void EyeOfTheStorm::RespawnCPFlag(uint32 i, uint32 id)
 void EyeOfTheStorm::UpdateCPs()
 {
 	uint32 i;
-	set<Player*>::iterator itr, itrend;
+	Object::InRangePlayerSet::iterator itr, itrend;
 	Player * plr;
 	GameObject * go;
 	int32 delta;
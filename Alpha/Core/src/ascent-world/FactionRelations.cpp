@@ -0,0 +1,128 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// FactionRelations.cpp
+//
+
+#include "StdAfx.h"
+
+#define FACTION_INDEX_NONE			0xFFFF
+
+// template id -> row of the relation table, rows * rows relations
+static uint16 * s_factionIndex = NULL;
+static uint32 s_factionIndexSize = 0;
+static uint8 * s_factionRelations = NULL;
+static uint32 s_factionRows = 0;
+
+uint8 CalculateFactionRelation(FactionTemplateDBC * a, FactionTemplateDBC * b)
+{
+	uint8 relation = 0;
+
+	if(b->Mask & a->HostileMask)
+		relation |= FACTION_RELATION_HOSTILE;
+
+	// check friend/enemy list
+	for(uint32 i = 0; i < 4; i++)
+	{
+		if(a->EnemyFactions[i] == b->Faction)
+		{
+			relation |= FACTION_RELATION_HOSTILE;
+			break;
+		}
+		if(a->FriendlyFactions[i] == b->Faction)
+		{
+			relation &= ~FACTION_RELATION_HOSTILE;
+			break;
+		}
+	}
+
+	if(a->Mask & b->FriendlyMask)
+		relation |= FACTION_RELATION_SUPPORT;
+
+	for(uint32 i = 0; i < 4; i++)
+	{
+		if(b->EnemyFactions[i] == a->Faction)
+		{
+			relation &= ~FACTION_RELATION_SUPPORT;
+			break;
+		}
+		if(b->FriendlyFactions[i] == a->Faction)
+		{
+			relation |= FACTION_RELATION_SUPPORT;
+			break;
+		}
+	}
+
+	return relation;
+}
+
+uint8 GetFactionRelation(FactionTemplateDBC * a, FactionTemplateDBC * b)
+{
+	if(a->ID < s_factionIndexSize && b->ID < s_factionIndexSize)
+	{
+		uint32 ia = s_factionIndex[a->ID];
+		uint32 ib = s_factionIndex[b->ID];
+		if(ia != FACTION_INDEX_NONE && ib != FACTION_INDEX_NONE)
+			return s_factionRelations[ia * s_factionRows + ib];
+	}
+
+	// not a FactionTemplate.dbc row, or the table is not built yet
+	return CalculateFactionRelation(a, b);
+}
+
+void BuildFactionRelations()
+{
+	uint32 start = getMSTime();
+	uint32 rows = dbcFactionTemplate.GetNumRows();
+	uint32 maxId = 0;
+	FactionTemplateDBC * a;
+
+	if(rows == 0 || rows >= FACTION_INDEX_NONE)
+	{
+		Log.Error("Faction", "Not building the faction relation table for %u faction templates.", rows);
+		return;
+	}
+
+	for(uint32 i = 0; i < rows; ++i)
+	{
+		a = dbcFactionTemplate.LookupRow(i);
+		if(a->ID > maxId)
+			maxId = a->ID;
+	}
+
+	uint16 * index = new uint16[maxId + 1];
+	uint8 * relations = new uint8[rows * rows];
+	memset(index, 0xFF, sizeof(uint16) * (maxId + 1));
+
+	for(uint32 i = 0; i < rows; ++i)
+	{
+		a = dbcFactionTemplate.LookupRow(i);
+		index[a->ID] = (uint16)i;
+		for(uint32 j = 0; j < rows; ++j)
+			relations[i * rows + j] = CalculateFactionRelation(a, dbcFactionTemplate.LookupRow(j));
+	}
+
+	s_factionRelations = relations;
+	s_factionRows = rows;
+	s_factionIndex = index;
+	s_factionIndexSize = maxId + 1;
+
+	Log.Notice("Faction", "Built relations of %u faction templates (%u KB) in %ums.", rows, (rows * rows) / 1024, getMSTime() - start);
+}
@@ -0,0 +1,43 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// FactionRelations.h
+//
+
+#ifndef __FACTIONRELATIONS_H
+#define __FACTIONRELATIONS_H
+
+struct FactionTemplateDBC;
+
+/* Precalculates the mask and enemy/friend list part of isHostile and isCombatSupport
+ * for every pair of faction templates. Call once FactionTemplate.dbc is loaded.
+ */
+SERVER_DECL void BuildFactionRelations();
+
+#define FACTION_RELATION_HOSTILE	0x01	// B is hostile for A by masks and enemy/friend lists
+#define FACTION_RELATION_SUPPORT	0x02	// B combat supports A by masks and enemy/friend lists
+
+/* FACTION_RELATION_* bits of two faction templates. GetFactionRelation reads them from the
+ * table when both are DBC rows, CalculateFactionRelation always works them out.
+ */
+SERVER_DECL uint8 GetFactionRelation(FactionTemplateDBC * a, FactionTemplateDBC * b);
+SERVER_DECL uint8 CalculateFactionRelation(FactionTemplateDBC * a, FactionTemplateDBC * b);
+
+#endif
@@ -170,9 +170,9 @@ void GameObject::Update(uint32 p_time)
 			if(counter++%checkrate)
 				return;
 		}
-		ObjectSet::iterator itr = GetInRangeSetBegin();
-		ObjectSet::iterator it2 = itr;
-		ObjectSet::iterator iend = GetInRangeSetEnd();
+		InRangeSet::iterator itr = GetInRangeSetBegin();
+		InRangeSet::iterator it2 = itr;
+		InRangeSet::iterator iend = GetInRangeSetEnd();
 		Unit * pUnit;
 		float dist;
 		for(; it2 != iend;)
@@ -179,7 +179,7 @@ void HonorHandler::OnPlayerKilledUnit( Player *pPlayer, Unit* pVictim )
 			set<Player*> contributors;
 			// First loop: Get all the people in the attackermap.
 			pVictim->UpdateOppFactionSet();
-			for(std::set<Object*>::iterator itr = pVictim->GetInRangeOppFactsSetBegin(); itr != pVictim->GetInRangeOppFactsSetEnd(); itr++)
+			for(Object::InRangeSet::iterator itr = pVictim->GetInRangeOppFactsSetBegin(); itr != pVictim->GetInRangeOppFactsSetEnd(); itr++)
 			{
 				if(!(*itr)->IsPlayer())
 					continue;
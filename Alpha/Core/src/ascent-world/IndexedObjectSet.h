@@ -0,0 +1,227 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// IndexedObjectSet.h
+//
+
+#ifndef __INDEXEDOBJECTSET_H
+#define __INDEXEDOBJECTSET_H
+
+/** Sets with fewer members than this are searched linearly, the open-addressed
+ * index is only built once a set grows past it.
+ */
+#define INDEXED_SET_LINEAR_LIMIT 16
+
+/** Unordered set of object pointers used for the in-range and visibility bookkeeping.
+ * Members live in one contiguous array, removal swaps the last member into the hole
+ * so insert, erase and find are O(1) and no node is allocated per pair of objects.
+ *
+ * Iterators are positions rather than pointers: they survive inserts into the set,
+ * and an iterator past the end compares equal to end(). Erasing moves the last member
+ * into the erased position, so loops that erase have to continue with the iterator
+ * returned by erase() instead of incrementing.
+ */
+template<class T>
+class IndexedObjectSet
+{
+public:
+	class iterator
+	{
+	public:
+		iterator() : m_set(NULL), m_pos(0) {}
+		iterator(const IndexedObjectSet * s, size_t pos) : m_set(s), m_pos(pos) {}
+
+		ASCENT_INLINE T* operator*() const { return m_set->m_items[m_pos]; }
+		ASCENT_INLINE iterator& operator++() { ++m_pos; return *this; }
+		ASCENT_INLINE iterator operator++(int) { iterator tmp(*this); ++m_pos; return tmp; }
+		ASCENT_INLINE bool operator==(const iterator & other) const { return _Pos() == other._Pos(); }
+		ASCENT_INLINE bool operator!=(const iterator & other) const { return _Pos() != other._Pos(); }
+
+		ASCENT_INLINE size_t GetPosition() const { return m_pos; }
+
+	private:
+		ASCENT_INLINE size_t _Pos() const
+		{
+			if(m_set == NULL || m_pos >= m_set->m_items.size())
+				return (size_t)-1;
+			return m_pos;
+		}
+
+		const IndexedObjectSet * m_set;
+		size_t m_pos;
+	};
+	typedef iterator const_iterator;
+
+	IndexedObjectSet() {}
+
+	ASCENT_INLINE iterator begin() const { return iterator(this, 0); }
+	ASCENT_INLINE iterator end() const { return iterator(this, m_items.size()); }
+	ASCENT_INLINE size_t size() const { return m_items.size(); }
+	ASCENT_INLINE bool empty() const { return m_items.empty(); }
+	ASCENT_INLINE size_t count(T* p) const { return (_Find(p) != (size_t)-1) ? 1 : 0; }
+
+	ASCENT_INLINE iterator find(T* p) const
+	{
+		size_t pos = _Find(p);
+		return (pos == (size_t)-1) ? end() : iterator(this, pos);
+	}
+
+	/** Returns false if the object was already a member.
+	 */
+	bool insert(T* p)
+	{
+		if(_Find(p) != (size_t)-1)
+			return false;
+
+		m_items.push_back(p);
+		if(!m_index.empty())
+		{
+			if(m_items.size() * 2 > m_index.size())
+				_Rebuild(m_index.size() * 2);
+			else
+				_IndexInsert(p, (uint32)m_items.size());
+		}
+		else if(m_items.size() > INDEXED_SET_LINEAR_LIMIT)
+			_Rebuild(INDEXED_SET_LINEAR_LIMIT * 4);
+
+		return true;
+	}
+
+	size_t erase(T* p)
+	{
+		size_t pos = _Find(p);
+		if(pos == (size_t)-1)
+			return 0;
+
+		_Remove(pos);
+		return 1;
+	}
+
+	/** Returns the iterator to continue a loop with, which points at the same position.
+	 */
+	iterator erase(iterator itr)
+	{
+		_Remove(itr.GetPosition());
+		return iterator(this, itr.GetPosition());
+	}
+
+	void clear()
+	{
+		m_items.clear();
+		m_index.clear();
+	}
+
+private:
+	ASCENT_INLINE static size_t _Hash(T* p)
+	{
+		// objects are allocated at least 16 bytes apart, drop the low bits before mixing
+		size_t h = ((size_t)p) >> 4;
+		return (size_t)((uint32)h * 0x9E3779B1) ^ (h >> 16);
+	}
+
+	size_t _Find(T* p) const
+	{
+		if(m_index.empty())
+		{
+			for(size_t i = 0; i < m_items.size(); ++i)
+			{
+				if(m_items[i] == p)
+					return i;
+			}
+			return (size_t)-1;
+		}
+
+		size_t slot = _Slot(p);
+		return (slot == (size_t)-1) ? (size_t)-1 : (size_t)(m_index[slot] - 1);
+	}
+
+	/** Index slot holding p, or -1. Slots store the array position plus one, 0 is free.
+	 */
+	size_t _Slot(T* p) const
+	{
+		size_t mask = m_index.size() - 1;
+		for(size_t i = _Hash(p) & mask; m_index[i] != 0; i = (i + 1) & mask)
+		{
+			if(m_items[m_index[i] - 1] == p)
+				return i;
+		}
+		return (size_t)-1;
+	}
+
+	void _IndexInsert(T* p, uint32 value)
+	{
+		size_t mask = m_index.size() - 1;
+		size_t i = _Hash(p) & mask;
+		while(m_index[i] != 0)
+			i = (i + 1) & mask;
+		m_index[i] = value;
+	}
+
+	void _Rebuild(size_t index_size)
+	{
+		m_index.assign(index_size, 0);
+		for(size_t i = 0; i < m_items.size(); ++i)
+			_IndexInsert(m_items[i], (uint32)(i + 1));
+	}
+
+	/** Clears slot i and shifts the following probe run back so lookups never hit a hole.
+	 */
+	void _IndexErase(size_t i)
+	{
+		size_t mask = m_index.size() - 1;
+		size_t j = i;
+		size_t home;
+
+		m_index[i] = 0;
+		for(;;)
+		{
+			j = (j + 1) & mask;
+			if(m_index[j] == 0)
+				break;
+
+			home = _Hash(m_items[m_index[j] - 1]) & mask;
+			if((i <= j) ? (i < home && home <= j) : (i < home || home <= j))
+				continue;
+
+			m_index[i] = m_index[j];
+			m_index[j] = 0;
+			i = j;
+		}
+	}
+
+	void _Remove(size_t pos)
+	{
+		size_t last = m_items.size() - 1;
+		if(!m_index.empty())
+		{
+			_IndexErase(_Slot(m_items[pos]));
+			if(pos != last)
+				m_index[_Slot(m_items[last])] = (uint32)(pos + 1);
+		}
+
+		m_items[pos] = m_items[last];
+		m_items.pop_back();
+	}
+
+	std::vector<T*> m_items;
+	std::vector<uint32> m_index;
+};
+
+#endif
@@ -19,6 +19,13 @@
 
 #include "StdAfx.h"
 
+static uint32 m_itemSaveStatement;
+
+void Item::InitSaveStatement()
+{
+	m_itemSaveStatement = CharacterDatabase.PrepareStatement( "REPLACE INTO playeritems VALUES(?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)" );
+}
+
 Item::Item()//this is called when constructing as container
 {
 	m_itemProto = NULL;
@@ -286,24 +293,6 @@ void Item::SaveToDB( int8 containerslot, int8 slot, bool firstsave, QueryBuffer*
 
 	std::stringstream ss;
 
-	ss << "REPLACE INTO playeritems VALUES(";
-
-	ss << m_uint32Values[ITEM_FIELD_OWNER] << ",";
-    ss << m_uint32Values[OBJECT_FIELD_GUID] << ",";
-	ss << m_uint32Values[OBJECT_FIELD_ENTRY] << ",";
-	ss << wrapped_item_id << ",";
-	ss << m_uint32Values[ITEM_FIELD_GIFTCREATOR] << ",";
-	ss << m_uint32Values[ITEM_FIELD_CREATOR] << ",";
-
-	ss << GetUInt32Value(ITEM_FIELD_STACK_COUNT) << ",";
-	ss << GetChargesLeft() << ",";
-	ss << GetUInt32Value(ITEM_FIELD_FLAGS) << ",";
-	ss << random_prop << ", " << random_suffix << ", ";
-	ss << GetUInt32Value(ITEM_FIELD_ITEM_TEXT_ID) << ",";
-	ss << GetUInt32Value(ITEM_FIELD_DURABILITY) << ",";
-	ss << static_cast<int>(containerslot) << ",";
-	ss << static_cast<int>(slot) << ",'";
-
 	// Pack together enchantment fields
 	if( Enchantments.size() > 0 )
 	{
@@ -335,16 +324,37 @@ void Item::SaveToDB( int8 containerslot, int8 slot, bool firstsave, QueryBuffer*
 			}
 		}
 	}
-	ss << "')";
+
+	PreparedStatement * stmt = new PreparedStatement( m_itemSaveStatement );
+	stmt->BindUInt32( m_uint32Values[ITEM_FIELD_OWNER] );
+	stmt->BindUInt32( m_uint32Values[OBJECT_FIELD_GUID] );
+	stmt->BindUInt32( m_uint32Values[OBJECT_FIELD_ENTRY] );
+	stmt->BindUInt32( wrapped_item_id );
+	stmt->BindUInt32( m_uint32Values[ITEM_FIELD_GIFTCREATOR] );
+	stmt->BindUInt32( m_uint32Values[ITEM_FIELD_CREATOR] );
+
+	stmt->BindUInt32( GetUInt32Value(ITEM_FIELD_STACK_COUNT) );
+	stmt->BindUInt32( GetChargesLeft() );
+	stmt->BindUInt32( GetUInt32Value(ITEM_FIELD_FLAGS) );
+	stmt->BindUInt32( random_prop );
+	stmt->BindUInt32( random_suffix );
+	stmt->BindUInt32( GetUInt32Value(ITEM_FIELD_ITEM_TEXT_ID) );
+	stmt->BindUInt32( GetUInt32Value(ITEM_FIELD_DURABILITY) );
+	stmt->BindInt32( containerslot );
+	stmt->BindInt32( slot );
+	stmt->BindString( ss.str() );
 	
 	if( firstsave )
-		CharacterDatabase.WaitExecute( ss.str().c_str() );
+	{
+		CharacterDatabase.WaitExecutePrepared( stmt );
+		delete stmt;
+	}
 	else
 	{
 		if( buf == NULL )
-			CharacterDatabase.Execute( ss.str().c_str() );
+			CharacterDatabase.ExecutePrepared( stmt );
 		else
-			buf->AddQueryStr( ss.str() );
+			buf->AddPrepared( stmt );
 	}
 
 	m_isDirty = false;
@@ -714,7 +724,7 @@ void Item::ApplyEnchantmentBonus( uint32 Slot, bool Apply )
 						Log.Debug( "Enchant", "Setting procChance to %u%%.", TS.procChance );
 						TS.deleted = false;
 						TS.spellId = Entry->spell[c];
-						m_owner->m_procSpells.push_back( TS );
+						m_owner->AddProcTriggerSpell( TS, false );
 					}
 					else
 					{
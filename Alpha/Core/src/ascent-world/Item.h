@@ -133,6 +133,10 @@ public:
 	//! DB Serialization
 	void LoadFromDB( Field *fields, Player* plr, bool light );
 	void SaveToDB( int8 containerslot, int8 slot, bool firstsave, QueryBuffer* buf );
+
+	/** Registers the save statement, called once at startup before the map threads run.
+	 */
+	static void InitSaveStatement();
 	bool LoadAuctionItemFromDB( uint64 guid );
 	void DeleteFromDB();
 	
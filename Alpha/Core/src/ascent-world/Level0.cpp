@@ -284,6 +284,78 @@ bool ChatHandler::HandleInfoCommand(const char* args, WorldSession *m_session)
 	GreenSystemMessage(m_session, "SQL Query Cache Size (World): |r%u queries delayed", WorldDatabase.GetQueueSize());
 	GreenSystemMessage(m_session, "SQL Query Cache Size (Character): |r%u queries delayed", CharacterDatabase.GetQueueSize());
 
+	static const char * db_names[2] = { "World", "Character" };
+	Database * dbs[2] = { &WorldDatabase, &CharacterDatabase };
+	for(uint32 i = 0; i < 2; ++i)
+	{
+		uint64 checkouts, waits, wait_time, hold_time = 0;
+		dbs[i]->GetPoolStatistics(&checkouts, &waits, &wait_time);
+		if(!checkouts)
+			continue;
+
+		std::stringstream queries;
+		for(int32 j = 0; j < dbs[i]->GetConnectionCount(); ++j)
+		{
+			DatabaseConnection * con = dbs[i]->GetConnection(j);
+			hold_time += con->HoldTime;
+			queries << (j ? "/" : "") << con->Queries;
+		}
+
+		GreenSystemMessage(m_session, "SQL Connections (%s): |r%u checkouts, %u waited %.1fms avg, held %.1fms avg, queries per connection %s",
+			db_names[i], (uint32)checkouts, (uint32)waits, waits ? (float)wait_time / (float)waits : 0.0f,
+			(float)hold_time / (float)checkouts, queries.str().c_str());
+	}
+
+	uint64 packets, bytes_in, bytes_out, usecs;
+	sUpdateCompressor.GetStatistics(&packets, &bytes_in, &bytes_out, &usecs);
+	if(packets)
+	{
+		GreenSystemMessage(m_session, "Compressed Updates: |r%u packets, %u bytes avg, %.1f%% of original size, %.1fus avg",
+			(uint32)packets, (uint32)(bytes_out / packets), (float)bytes_out * 100.0f / (float)bytes_in, (float)usecs / (float)packets);
+	}
+
+	uint64 saves, save_time, save_bytes, save_statements;
+	sWorld.GetSaveStatistics(&saves, &save_time, &save_bytes, &save_statements);
+	if(saves)
+	{
+		GreenSystemMessage(m_session, "Character Saves: |r%u saves, %u bytes avg, %.1f statements avg, %.2fms avg",
+			(uint32)saves, (uint32)(save_bytes / saves), (float)save_statements / (float)saves, (float)save_time / (float)saves);
+	}
+
+	uint64 loops, tiers[CREATURE_TIER_COUNT];
+	MapMgr::GetCreatureTierStatistics(&loops, tiers);
+	if(loops)
+	{
+		GreenSystemMessage(m_session, "Creature AI per map loop: |r%.1f full, %.1f reduced, %.1f deferred, %.1f sleeping",
+			(float)tiers[CREATURE_TIER_FULL] / (float)loops, (float)tiers[CREATURE_TIER_REDUCED] / (float)loops,
+			(float)tiers[CREATURE_TIER_DEFERRED] / (float)loops, (float)tiers[CREATURE_TIER_SLEEPING] / (float)loops);
+	}
+
+	uint64 ticks, log_entries, log_packets;
+	PeriodicAuraScheduler::GetStatistics(&ticks, &log_entries, &log_packets);
+	if(ticks)
+	{
+		GreenSystemMessage(m_session, "Periodic Auras: |r%u ticks, %u log entries in %u packets",
+			(uint32)ticks, (uint32)log_entries, (uint32)log_packets);
+	}
+
+	uint64 allocs, hits, misses;
+	WorldPacketPool::GetStatistics(&allocs, &hits, &misses);
+	if(allocs)
+	{
+		GreenSystemMessage(m_session, "Packet Pool: |r%u allocations, %u hits, %u misses, %.1f%% hit rate",
+			(uint32)allocs, (uint32)hits, (uint32)misses, (float)hits * 100.0f / (float)allocs);
+	}
+
+#ifdef CONFIG_USE_EPOLL
+	uint64 sent = sSocketMgr.GetSentPackets();
+	if(sent)
+	{
+		GreenSystemMessage(m_session, "Network Sends: |r%u packets, %u syscalls, %.3f syscalls per packet",
+			(uint32)sent, (uint32)sSocketMgr.GetSendSyscalls(), (float)sSocketMgr.GetSendSyscalls() / (float)sent);
+	}
+#endif
+
 	return true;
 }
 
@@ -563,8 +563,8 @@ bool ChatHandler::HandleGOSelect(const char *args, WorldSession *m_session)
 	GameObject *GObj = NULL;
 	GameObject *GObjs = m_session->GetPlayer()->GetSelectedGo();
 
-	std::set<Object*>::iterator Itr = m_session->GetPlayer()->GetInRangeSetBegin();
-	std::set<Object*>::iterator Itr2 = m_session->GetPlayer()->GetInRangeSetEnd();
+	Object::InRangeSet::iterator Itr = m_session->GetPlayer()->GetInRangeSetBegin();
+	Object::InRangeSet::iterator Itr2 = m_session->GetPlayer()->GetInRangeSetEnd();
 	float cDist = 9999.0f;
 	float nDist = 0.0f;
 	bool bUseNext = false;
@@ -120,6 +120,17 @@ bool CheckResultLengthGameObject(QueryResult * res)
 		return true;
 }
 
+/* every map runs the same statements, so they are only prepared once per connection */
+static QueryResult * QuerySpawnTable(const char * table, uint32 mapid)
+{
+	char sql[200];
+	snprintf(sql, 200, "SELECT * FROM %s WHERE Map = ?", table);
+
+	PreparedStatement stmt(WorldDatabase.PrepareStatement(sql));
+	stmt.BindUInt32(mapid);
+	return WorldDatabase.QueryPrepared(&stmt);
+}
+
 void Map::LoadSpawns(bool reload)
 {
 	//uint32 st=getMSTime();
@@ -143,7 +154,7 @@ void Map::LoadSpawns(bool reload)
 	set<string>::iterator tableiterator;
 	for(tableiterator=ExtraMapCreatureTables.begin(); tableiterator!=ExtraMapCreatureTables.end();++tableiterator)
 	{
-		result = WorldDatabase.Query("SELECT * FROM %s WHERE Map = %u",(*tableiterator).c_str(),this->_mapId);
+		result = QuerySpawnTable((*tableiterator).c_str(), _mapId);
 		if(result)
 		{
 			if(CheckResultLengthCreatures( result) )
@@ -191,7 +202,7 @@ void Map::LoadSpawns(bool reload)
 		}
 	}
 
-	result = WorldDatabase.Query("SELECT * FROM creature_staticspawns WHERE Map = %u",this->_mapId);
+	result = QuerySpawnTable("creature_staticspawns", _mapId);
 	if(result)
 	{
 		if( CheckResultLengthCreatures(result) )
@@ -227,7 +238,7 @@ void Map::LoadSpawns(bool reload)
 	}
 
 	GameObjectSpawnCount = 0;
-	result = WorldDatabase.Query("SELECT * FROM gameobject_staticspawns WHERE Map = %u",this->_mapId);
+	result = QuerySpawnTable("gameobject_staticspawns", _mapId);
 	if(result)
 	{
 		if( CheckResultLengthGameObject(result) )
@@ -260,7 +271,7 @@ void Map::LoadSpawns(bool reload)
 
 	for(tableiterator=ExtraMapGameObjectTables.begin(); tableiterator!=ExtraMapGameObjectTables.end();++tableiterator)
 	{
-		result = WorldDatabase.Query("SELECT * FROM %s WHERE map = %u",(*tableiterator).c_str(),this->_mapId);
+		result = QuerySpawnTable((*tableiterator).c_str(), _mapId);
 		if(result)
 		{
 			if( CheckResultLengthGameObject(result) )
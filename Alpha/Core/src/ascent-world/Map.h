@@ -182,6 +182,26 @@ public:
 		}
 	}
 
+	ASCENT_INLINE void GetTerrainInfo(uint32 count, const float * x, const float * y, float * heights, float * waterHeights, uint16 * areas)
+	{
+		if(_terrain)
+		{
+			_terrain->GetTerrainInfo(count, x, y, heights, waterHeights, areas);
+		}
+		else
+		{
+			for(uint32 i = 0; i < count; ++i)
+			{
+				if(heights != NULL)
+					heights[i] = 999999.0f;
+				if(waterHeights != NULL)
+					waterHeights[i] = 999999.0f;
+				if(areas != NULL)
+					areas[i] = 0xFFFF;
+			}
+		}
+	}
+
 	ASCENT_INLINE void CellGoneActive(uint32 x, uint32 y)
 	{ 
 		if(_terrain)
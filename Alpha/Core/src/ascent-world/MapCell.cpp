@@ -43,7 +43,8 @@ void MapCell::AddObject(Object *obj)
 	if(obj->IsPlayer())
 		++_playerCount;
 
-	_objects.insert(obj);
+	if(_objects.insert(obj).second && obj->IsUnit())
+		_units.push_back(static_cast<Unit*>(obj));
 }
 
 void MapCell::RemoveObject(Object *obj)
@@ -51,7 +52,15 @@ void MapCell::RemoveObject(Object *obj)
 	if(obj->IsPlayer())
 		--_playerCount;
 
-	_objects.erase(obj);
+	if(_objects.erase(obj) && obj->IsUnit())
+	{
+		UnitVector::iterator itr = std::find(_units.begin(), _units.end(), static_cast<Unit*>(obj));
+		if(itr != _units.end())
+		{
+			*itr = _units.back();
+			_units.pop_back();
+		}
+	}
 }
 
 void MapCell::SetActivity(bool state)
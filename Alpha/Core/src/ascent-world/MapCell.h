@@ -37,6 +37,7 @@ public:
 	~MapCell();
 
 	typedef std::set<Object*> ObjectSet;
+	typedef std::vector<Unit*> UnitVector;
 
 	//Init
 	void Init(uint32 x, uint32 y, uint32 mapid, MapMgr *mapmgr);
@@ -51,6 +52,9 @@ public:
 	ASCENT_INLINE ObjectSet::iterator Begin() { return _objects.begin(); }
 	ASCENT_INLINE ObjectSet::iterator End() { return _objects.end(); }
 
+	/* Units and players of the cell in no particular order, for MapMgr::GetUnitsInRange. */
+	ASCENT_INLINE UnitVector & GetUnits() { return _units; }
+
 	//State Related
 	void SetActivity(bool state);
 
@@ -72,6 +76,7 @@ public:
 private:
 	uint16 _x,_y;
 	ObjectSet _objects;
+	UnitVector _units;
 	bool _active, _loaded;
 	bool _unloadpending;
 
@@ -27,6 +27,39 @@
 #include <math.h>
 extern bool bServerShutdown;
 
+#ifdef WIN32
+#define MAP_TLS __declspec(thread)
+#else
+#define MAP_TLS __thread
+#endif
+
+// region the current thread is updating, NULL outside of _UpdateRegion
+static MAP_TLS MapRegion * t_mapRegion = NULL;
+
+/* Grows a storage array indexed by guid to at least needed entries. The region workers
+ * read the arrays without the lock, so during a parallel phase the old array is kept
+ * until the merge instead of being realloc'd from under them.
+ */
+template<class T> static void ExpandStorage(T **& storage, uint32 & size, uint32 needed, vector<void*> * retired)
+{
+	uint32 newSize = size;
+	while(newSize < needed)
+		newSize += RESERVE_EXPAND_SIZE;
+
+	if(retired == NULL)
+		storage = (T**)realloc(storage, sizeof(T*) * newSize);
+	else
+	{
+		T ** copy = (T**)malloc(sizeof(T*) * newSize);
+		memcpy(copy, storage, sizeof(T*) * size);
+		retired->push_back(storage);
+		storage = copy;
+	}
+
+	memset(&storage[size], 0, (newSize - size) * sizeof(T*));
+	size = newSize;
+}
+
 MapMgr::MapMgr(Map *map, uint32 mapId, uint32 instanceid) : CellHandler<MapCell>(map), _mapId(mapId), eventHolder(instanceid)
 {
 	_shutdown = false;
@@ -43,6 +76,8 @@ MapMgr::MapMgr(Map *map, uint32 mapId, uint32 instanceid) : CellHandler<MapCell>
 
 	iInstanceMode = 0;
 
+	periodicAuras.SetHandler(this);
+
 	// Create script interface
 	ScriptInterface = new MapScriptInterface(*this);
 
@@ -71,6 +106,24 @@ MapMgr::MapMgr(Map *map, uint32 mapId, uint32 instanceid) : CellHandler<MapCell>
 	pInstance = NULL;
 	thread_kill_only = false;
 	thread_running = false;
+
+	memset(m_creatureTiers, 0, sizeof(m_creatureTiers));
+	m_creaturesInWorld = 0;
+
+	m_parallelPhase = false;
+	m_regionsUsed = 0;
+	m_regionBatch.mgr = this;
+	m_regionCells = 0;
+
+	// Continents can have their creatures/players updated by the region workers. Regions of
+	// the same colour have to be more than two halos apart so they never share objects.
+	if(pMapInfo->type == INSTANCE_NULL && sWorld.map_parallel_region_cells)
+	{
+		uint32 halo = (m_CellUpdateRadius > MAP_REGION_MIN_HALO) ? (uint32)m_CellUpdateRadius : MAP_REGION_MIN_HALO;
+		m_regionCells = sWorld.map_parallel_region_cells;
+		if(m_regionCells <= halo * 2)
+			m_regionCells = halo * 2 + 1;
+	}
 }
 
 
@@ -109,6 +162,11 @@ MapMgr::~MapMgr()
 
 	free(m_GOStorage);
 	free(m_CreatureStorage);
+	for(vector<void*>::iterator itr = m_retiredStorage.begin(); itr != m_retiredStorage.end(); ++itr)
+		free(*itr);
+
+	for(vector<MapRegion*>::iterator itr = m_regionPool.begin(); itr != m_regionPool.end(); ++itr)
+		delete (*itr);
 
 	Corpse * pCorpse;
 	for(set<Corpse*>::iterator itr = m_corpses.begin(); itr != m_corpses.end();)
@@ -197,6 +255,7 @@ void MapMgr::PushObject(Object *obj)
 	// Assertions
 	/////////////
 	ASSERT(obj);
+	MapParallelGuard guard(this);
 	
 	// That object types are not map objects. TODO: add AI groups here?
 	if(obj->GetTypeId() == TYPEID_ITEM || obj->GetTypeId() == TYPEID_CONTAINER)
@@ -348,6 +407,7 @@ void MapMgr::PushObject(Object *obj)
 			{
 				ASSERT((obj->GetUIdFromGUID()) <= m_CreatureHighGuid);
 				m_CreatureStorage[obj->GetUIdFromGUID()] = (Creature*)obj;
+				++m_creaturesInWorld;
 				if(((Creature*)obj)->m_spawn != NULL)
 				{
 					_sqlids_creatures.insert(make_pair( ((Creature*)obj)->m_spawn->id, ((Creature*)obj) ) );
@@ -437,6 +497,14 @@ void MapMgr::RemoveObject(Object *obj, bool free_guid)
 	//ASSERT(obj->GetPositionY() > _minY && obj->GetPositionY() < _maxY);
 	ASSERT(_cells);
 
+	MapParallelGuard guard(this);
+	if(t_mapRegion != NULL)
+	{
+		// the region update loop must not touch this object again during this phase,
+		// regions never share objects so it can only be in the one this thread updates
+		t_mapRegion->removed.insert(obj->GetGUID());
+	}
+
 	if(obj->Active)
 		obj->Deactivate(this);
 
@@ -453,6 +521,8 @@ void MapMgr::RemoveObject(Object *obj, bool free_guid)
 		case HIGHGUID_TYPE_UNIT:
 			ASSERT(obj->GetUIdFromGUID() <= m_CreatureHighGuid);
 			m_CreatureStorage[obj->GetUIdFromGUID()] = 0;
+			if(m_creaturesInWorld)
+				--m_creaturesInWorld;
 			if(((Creature*)obj)->m_spawn != NULL)
 			{
 				_sqlids_creatures.erase(((Creature*)obj)->m_spawn->id);
@@ -528,18 +598,21 @@ void MapMgr::RemoveObject(Object *obj, bool free_guid)
 		static_cast< Player* >( obj )->ClearAllPendingUpdates();
 	}
 	
-	// Remove object from all objects 'seeing' him
-	for (Object::InRangeSet::iterator iter = obj->GetInRangeSetBegin();
-		iter != obj->GetInRangeSetEnd(); ++iter)
-	{
-		if( (*iter) )
+	// Remove object from all objects 'seeing' him. Their callbacks can remove
+	// more objects from our set, so take the first one until it is empty.
+	Object * curObj;
+	while( obj->HasInRangeObjects() )
+	{
+		curObj = *obj->GetInRangeSetBegin();
+		obj->RemoveIfInRange( curObj );
+		if( curObj )
 		{
-			if( (*iter)->GetTypeId() == TYPEID_PLAYER )
+			if( curObj->GetTypeId() == TYPEID_PLAYER )
 			{
-				if( static_cast< Player* >( *iter )->IsVisible( obj ) && static_cast< Player* >( *iter )->m_TransporterGUID != obj->GetGUID() )
-					static_cast< Player* >( *iter )->PushOutOfRange(obj->GetNewGUID());
+				if( static_cast< Player* >( curObj )->IsVisible( obj ) && static_cast< Player* >( curObj )->m_TransporterGUID != obj->GetGUID() )
+					static_cast< Player* >( curObj )->PushOutOfRange(obj->GetNewGUID());
 			}
-			(*iter)->RemoveInRangeObject(obj);
+			curObj->RemoveInRangeObject(obj);
 		}
 	}
 	
@@ -686,11 +759,10 @@ void MapMgr::ChangeObjectLocation( Object *obj )
 #undef END_IN_RANGE_LOOP*/
 
 	if(obj->HasInRangeObjects()) {
-		for (Object::InRangeSet::iterator iter = obj->GetInRangeSetBegin(), iter2;
+		for (Object::InRangeSet::iterator iter = obj->GetInRangeSetBegin();
 			iter != obj->GetInRangeSetEnd();)
 		{
 			curObj = *iter;
-			iter2 = iter++;
 			if( curObj->IsPlayer() && obj->IsPlayer() && plObj->m_TransporterGUID && plObj->m_TransporterGUID == static_cast< Player* >( curObj )->m_TransporterGUID )
 				fRange = 0.0f; // unlimited distance for people on same boat
 			else if( curObj->GetTypeFromGUID() == HIGHGUID_TYPE_TRANSPORTER )
@@ -713,8 +785,10 @@ void MapMgr::ChangeObjectLocation( Object *obj )
 					/* Something removed us. */
 					return;
 				}
-				obj->RemoveInRangeObject(iter2);
+				iter = obj->RemoveInRangeObject(iter);
+				continue;
 			}
+			++iter;
 		}
 	}
 
@@ -766,6 +840,7 @@ void MapMgr::ChangeObjectLocation( Object *obj )
 	MapCell * pOldCell = obj->GetMapCell();
 	if (!objCell)
 	{
+		MapParallelGuard guard(this);
 		objCell = Create(cellX,cellY);
 		objCell->Init(cellX, cellY, _mapId, this);
 	}
@@ -844,7 +919,7 @@ void MapMgr::UpdateInRangeSet( Object *obj, Player *plObj, MapCell* cell, ByteBu
 	Player* plObj2;
 	int count;
 	ObjectSet::iterator iter = cell->Begin();
-	ObjectSet::iterator itr;
+	Object::InRangeSet::iterator itr;
 	float fRange;
 	bool cansee, isvisible;
 
@@ -1095,8 +1170,9 @@ void MapMgr::_UpdateObjects()
 	Object *pObj;
 	Player *pOwner;
 	//std::set<Object*>::iterator it_start, it_end, itr;
-	std::set<Player*>::iterator it_start, it_end, itr;
+	Object::InRangePlayerSet::iterator it_start, it_end, itr;
 	Player * lplr;
+	SharedUpdateBlock * block;
 	ByteBuffer update(2500);
 	uint32 count = 0;
 	
@@ -1149,6 +1225,8 @@ void MapMgr::_UpdateObjects()
 
 				if( count )
 				{
+					// the block is built once and only referenced by every viewer
+					block = NULL;
 					it_start = pObj->GetInRangePlayerSetBegin();
 					it_end = pObj->GetInRangePlayerSetEnd();
 					for(itr = it_start; itr != it_end;)
@@ -1157,8 +1235,16 @@ void MapMgr::_UpdateObjects()
 						++itr;
 						// Make sure that the target player can see us.
 						if( lplr->GetTypeId() == TYPEID_PLAYER && lplr->IsVisible( pObj ) )
-							lplr->PushUpdateData( &update, count );
+						{
+							if( block == NULL )
+								block = SharedUpdateBlock::Create( update, count );
+
+							lplr->PushUpdateBlock( block );
+						}
 					}
+
+					if( block != NULL )
+						block->DecRef();
 					update.clear();
 				}
 			}
@@ -1168,6 +1254,13 @@ void MapMgr::_UpdateObjects()
 	_updates.clear();
 	m_updateMutex.Release();
 	
+	// compress everybody's packets at the same time if we have a compressor pool
+	if( _processQueue.size() > 1 && sUpdateCompressor.IsRunning() )
+	{
+		_CompressPendingUpdates();
+		return;
+	}
+
 	// generate pending a9packets and send to clients.
 	Player *plyr;
 	for(it = _processQueue.begin(); it != _processQueue.end();)
@@ -1180,6 +1273,45 @@ void MapMgr::_UpdateObjects()
 			plyr->ProcessPendingUpdates();
 	}
 }
+void MapMgr::_CompressPendingUpdates()
+{
+	PUpdateQueue::iterator it, eit;
+	vector<UpdatePacketJob*>::iterator itr;
+	UpdatePacketJob * jobs[2];
+	Player * plyr;
+	uint32 count;
+
+	m_compressBatch.jobs.clear();
+	m_compressPlayers.clear();
+	for(it = _processQueue.begin(); it != _processQueue.end();)
+	{
+		plyr = *it;
+		eit = it;
+		++it;
+		_processQueue.erase(eit);
+		if(plyr->GetMapMgr() != this)
+			continue;
+
+		count = plyr->TakePendingUpdates(jobs);
+		for(uint32 i = 0; i < count; ++i)
+			m_compressBatch.jobs.push_back(jobs[i]);
+
+		if(count)
+			m_compressPlayers.push_back(plyr);
+	}
+
+	sUpdateCompressor.Execute(&m_compressBatch);
+
+	// sending stays on this thread, in the same order as before
+	for(itr = m_compressBatch.jobs.begin(); itr != m_compressBatch.jobs.end(); ++itr)
+		(*itr)->player->SendUpdatePacket(*itr);
+
+	for(vector<Player*>::iterator pitr = m_compressPlayers.begin(); pitr != m_compressPlayers.end(); ++pitr)
+		(*pitr)->SendDelayedPackets();
+
+	m_compressBatch.jobs.clear();
+}
+
 void MapMgr::LoadAllCells()
 {
 	// eek
@@ -1232,6 +1364,18 @@ void MapMgr::LoadAllCells()
 
 void MapMgr::UpdateCellActivity(uint32 x, uint32 y, int radius)
 {
+	if(m_parallelPhase)
+	{
+		// loading cells spawns objects all over the map, leave it to the merge phase
+		MapParallelGuard guard(this);
+		DeferredCellActivity d;
+		d.x = x;
+		d.y = y;
+		d.radius = radius;
+		m_deferredCellActivity.push_back(d);
+		return;
+	}
+
 	CellSpawns * sp;
 	uint32 endX = (x + radius) <= _sizeX ? x + radius : (_sizeX-1);
 	uint32 endY = (y + radius) <= _sizeY ? y + radius : (_sizeY-1);
@@ -1341,9 +1485,22 @@ void MapMgr::ObjectUpdated(Object *obj)
 
 void MapMgr::PushToProcessed(Player* plr)
 {
+	MapParallelGuard guard(this);
 	_processQueue.insert(plr);
 }
 
+void MapMgr::AddCombatInProgress(uint64 guid)
+{
+	MapParallelGuard guard(this);
+	_combatProgress.insert(guid);
+}
+
+void MapMgr::RemoveCombatInProgress(uint64 guid)
+{
+	MapParallelGuard guard(this);
+	_combatProgress.erase(guid);
+}
+
 
 void MapMgr::ChangeFarsightLocation(Player *plr, DynamicObject *farsight)
 {
@@ -1401,6 +1558,108 @@ void MapMgr::ChangeFarsightLocation(Player *plr, DynamicObject *farsight)
 	}
 }
 
+// objects only change cells after moving a few yards, look that far into the neighbours
+#define UNIT_QUERY_CELL_SLACK 5.0f
+
+/* Scratch buffers of GetUnitsInRange. Spells cast by the region workers query at the
+ * same time, so every thread gets its own, kept for the lifetime of the thread.
+ */
+struct UnitRangeQuery
+{
+	vector<Unit*> units;
+	vector<float> x;
+	vector<float> y;
+	vector<float> z;
+	vector<uint8> hit;
+	vector<Unit*> result;
+};
+
+static MAP_TLS UnitRangeQuery * t_unitQuery = NULL;
+
+vector<Unit*> & MapMgr::GetUnitsInRange(Object * caster, float x, float y, float z, float radius)
+{
+	if(t_unitQuery == NULL)
+		t_unitQuery = new UnitRangeQuery;
+
+	UnitRangeQuery & q = *t_unitQuery;
+	q.units.clear();
+	q.result.clear();
+
+	float pad = radius + UNIT_QUERY_CELL_SLACK;
+	float minX = max(x - pad, (float)_minX);
+	float maxX = min(x + pad, (float)_maxX);
+	float minY = max(y - pad, (float)_minY);
+	float maxY = min(y + pad, (float)_maxY);
+	if(!(minX <= maxX && minY <= maxY))
+		return q.result;
+
+	// cell numbers grow towards the smaller coordinates
+	uint32 startX = GetPosX(maxX);
+	uint32 endX = min(GetPosX(minX), (uint32)(_sizeX - 1));
+	uint32 startY = GetPosY(maxY);
+	uint32 endY = min(GetPosY(minY), (uint32)(_sizeY - 1));
+
+	// Nothing outside the cells around the caster can be in its in-range set. This also
+	// keeps the query inside the halo of the region a worker is updating, cells further
+	// away may belong to another worker.
+	uint32 casterX, casterY;
+	if(caster->GetMapCell() != NULL)
+	{
+		casterX = caster->GetMapCell()->_x;
+		casterY = caster->GetMapCell()->_y;
+	}
+	else
+	{
+		casterX = GetPosX(caster->GetPositionX());
+		casterY = GetPosY(caster->GetPositionY());
+	}
+
+	startX = max(startX, casterX > 0 ? casterX - 1 : 0);
+	endX = min(endX, casterX + 1);
+	startY = max(startY, casterY > 0 ? casterY - 1 : 0);
+	endY = min(endY, casterY + 1);
+	MapCell * cell;
+
+	for(uint32 cx = startX; cx <= endX; ++cx)
+	{
+		for(uint32 cy = startY; cy <= endY; ++cy)
+		{
+			cell = GetCell(cx, cy);
+			if(cell != NULL && cell->GetUnits().size())
+				q.units.insert(q.units.end(), cell->GetUnits().begin(), cell->GetUnits().end());
+		}
+	}
+
+	size_t count = q.units.size();
+	if(count == 0)
+		return q.result;
+
+	if(q.x.size() < count)
+	{
+		q.x.resize(count);
+		q.y.resize(count);
+		q.z.resize(count);
+		q.hit.resize(count);
+	}
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		q.x[i] = q.units[i]->GetPositionX();
+		q.y[i] = q.units[i]->GetPositionY();
+		q.z[i] = q.units[i]->GetPositionZ();
+	}
+
+	FilterPointsInRange(&q.x[0], &q.y[0], &q.z[0], count, x, y, z, radius, &q.hit[0]);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(q.hit[i] && (q.units[i] == caster || caster->IsInRangeSet(q.units[i])))
+			q.result.push_back(q.units[i]);
+	}
+
+	return q.result;
+}
+
 /* new stuff
 */
 
@@ -1499,6 +1758,7 @@ bool MapMgr::Do()
 	thread_running = true;
 	ThreadState =THREADSTATE_BUSY;
 	SetThreadName("Map mgr - M%u|I%u",this->_mapId ,this->m_instanceID);
+	queryCompletions.Bind();
 	ObjectSet::iterator i;
 	uint32 last_exec=getMSTime();
 
@@ -1548,7 +1808,8 @@ bool MapMgr::Do()
 		m_objectinsertlock.Release();//>>>>>>>>>>>>>>>>
 		//-------------------------------------------------------
 				
-		//Now update sessions of this map + objects
+		// finish async queries queued by this map, then update sessions of this map + objects
+		queryCompletions.Process();
 		_PerformObjectDuties();
 
 		last_exec=getMSTime();
@@ -1578,6 +1839,10 @@ bool MapMgr::Do()
 			break;
 	}
 
+	// callbacks still refer to our objects, run them before they are gone
+	queryCompletions.Drain();
+	AsyncQueryCompletionQueue::Unbind();
+
 	// Clear the instance's reference to us.
 	if(m_battleground)
 	{
@@ -1729,18 +1994,26 @@ void MapMgr::_PerformObjectDuties()
 	if(difftime > 500)
 		difftime = 500;
 
+	bool parallel = _UseParallelUpdate();
+
 	// Update creatures.
+	_ScheduleCreatureUpdates(difftime);
+	if(parallel)
+		_UpdateRegions(false, difftime);
+	else
 	{
 		CreatureSet::iterator itr = activeCreatures.begin();
 		PetStorageMap::iterator it2 = m_PetStorage.begin();
 		Creature * ptr;
 		Pet * ptr2;
+		uint32 p_time;
 
 		for(; itr != activeCreatures.end();)
 		{
 			ptr = *itr;
 			++itr;
-			ptr->Update(difftime);
+			if(_GetCreatureUpdateTime(ptr, difftime, &p_time))
+				ptr->Update(p_time);
 		}
 
 		for(; it2 != m_PetStorage.end();)
@@ -1754,8 +2027,15 @@ void MapMgr::_PerformObjectDuties()
 
 	// Update any events.
 	eventHolder.Update(difftime);
+	periodicAuras.Update(difftime);
 
 	// Update players.
+	if(parallel)
+	{
+		_UpdateRegions(true, difftime);
+		lastUnitUpdate = mstime;
+	}
+	else
 	{
 		PlayerStorageMap::iterator itr = m_PlayerStorage.begin();
 		Player* ptr;
@@ -1830,6 +2110,264 @@ void MapMgr::_PerformObjectDuties()
 	_UpdateObjects();
 }
 
+static Mutex m_creatureTierLock;
+static uint64 m_creatureTierLoops;
+static uint64 m_creatureTierTotals[CREATURE_TIER_COUNT];
+
+static bool CreatureNeedsFullUpdate(Creature * ptr)
+{
+	if(ptr->IsTotem() || ptr->GetInRangePlayersCount() != 0)
+		return true;
+
+	if(ptr->CombatStatus.IsInCombat() || ptr->GetCurrentSpell() != NULL)
+		return true;
+
+	// fleeing, evading, following, confused and scripted creatures depend on their timers
+	AIInterface * ai = ptr->GetAIInterface();
+	return (ai != NULL && ai->getAIState() != STATE_IDLE);
+}
+
+void MapMgr::_ScheduleCreatureUpdates(uint32 difftime)
+{
+	uint32 interval = sWorld.creature_idle_update_interval / MAP_MGR_UPDATE_PERIOD;
+	size_t total = m_creaturesInWorld;
+	Creature * ptr;
+
+	memset(m_creatureTiers, 0, sizeof(m_creatureTiers));
+	for(CreatureSet::iterator itr = activeCreatures.begin(); itr != activeCreatures.end(); ++itr)
+	{
+		ptr = *itr;
+		ptr->m_lodTick = mLoopCounter;
+
+		if(interval <= 1 || CreatureNeedsFullUpdate(ptr))
+		{
+			// hand over whatever it skipped while it was idle
+			ptr->m_lodUpdateTime = ptr->m_lodElapsed + difftime;
+			ptr->m_lodElapsed = 0;
+			ptr->m_lodRun = true;
+			++m_creatureTiers[CREATURE_TIER_FULL];
+			continue;
+		}
+
+		// The AI replays the movement of the loops it skipped, see AIInterface::_CatchUpMovement.
+		// The guid spreads the idle creatures evenly over the interval.
+		ptr->m_lodElapsed += difftime;
+		if(((mLoopCounter + ptr->GetLowGUID()) % interval) == 0)
+		{
+			ptr->m_lodUpdateTime = ptr->m_lodElapsed;
+			ptr->m_lodElapsed = 0;
+			ptr->m_lodRun = true;
+			++m_creatureTiers[CREATURE_TIER_REDUCED];
+		}
+		else
+		{
+			ptr->m_lodRun = false;
+			++m_creatureTiers[CREATURE_TIER_DEFERRED];
+		}
+	}
+
+	// pets are not in activeCreatures, they are updated every loop
+	m_creatureTiers[CREATURE_TIER_FULL] += (uint32)m_PetStorage.size();
+
+	if(total > activeCreatures.size())
+		m_creatureTiers[CREATURE_TIER_SLEEPING] = (uint32)(total - activeCreatures.size());
+
+	m_creatureTierLock.Acquire();
+	++m_creatureTierLoops;
+	for(uint32 i = 0; i < CREATURE_TIER_COUNT; ++i)
+		m_creatureTierTotals[i] += m_creatureTiers[i];
+	m_creatureTierLock.Release();
+}
+
+bool MapMgr::_GetCreatureUpdateTime(Creature * ptr, uint32 difftime, uint32 * p_time)
+{
+	// activated after this loop was scheduled
+	if(ptr->m_lodTick != mLoopCounter)
+	{
+		*p_time = difftime;
+		return true;
+	}
+
+	*p_time = ptr->m_lodUpdateTime;
+	return ptr->m_lodRun;
+}
+
+void MapMgr::GetCreatureTierStatistics(uint64 * loops, uint64 * counts)
+{
+	m_creatureTierLock.Acquire();
+	*loops = m_creatureTierLoops;
+	for(uint32 i = 0; i < CREATURE_TIER_COUNT; ++i)
+		counts[i] = m_creatureTierTotals[i];
+	m_creatureTierLock.Release();
+}
+
+bool MapMgr::_UseParallelUpdate()
+{
+	if(!m_regionCells || MapUpdateWorkerPool::getSingletonPtr() == NULL || !sMapUpdateWorkerPool.IsRunning())
+		return false;
+
+	return (m_PlayerStorage.size() >= sWorld.map_parallel_min_players);
+}
+
+void MapMgr::_UpdateRegions(bool players, uint32 difftime)
+{
+	// Objects without a cell can't be placed in a region, the map thread updates them alone.
+	if(players)
+	{
+		PlayerStorageMap::iterator itr = m_PlayerStorage.begin();
+		Player * ptr;
+		for(; itr != m_PlayerStorage.end(); )
+		{
+			ptr = itr->second;
+			++itr;
+			if(ptr != NULL && ptr->GetMapCell() == NULL)
+				ptr->Update(difftime);
+		}
+	}
+	else
+	{
+		CreatureSet::iterator itr = activeCreatures.begin();
+		Creature * ptr;
+		uint32 p_time;
+		for(; itr != activeCreatures.end(); )
+		{
+			ptr = *itr;
+			++itr;
+			if(ptr->GetMapCell() == NULL && _GetCreatureUpdateTime(ptr, difftime, &p_time))
+				ptr->Update(p_time);
+		}
+	}
+
+	// Regions are rebuilt for every phase, as the previous phase may have added,
+	// moved or deleted objects. Objects which already were in a region this loop
+	// are skipped, so one which moved into a region of a later phase is not
+	// updated twice.
+	m_regionBatch.difftime = difftime;
+	for(uint32 phase = 0; phase < MAP_REGION_PHASES; ++phase)
+	{
+		_BuildRegions(players, phase);
+		if(m_regionBatch.regions.empty())
+			continue;
+
+		// leave room for the objects spawned during the phase, so the arrays
+		// are only copied if a phase spawns more than that
+		if(m_CreatureHighGuid + RESERVE_EXPAND_SIZE >= m_CreatureArraySize)
+			ExpandStorage(m_CreatureStorage, m_CreatureArraySize, m_CreatureHighGuid + RESERVE_EXPAND_SIZE + 1, NULL);
+		if(m_GOHighGuid + RESERVE_EXPAND_SIZE >= m_GOArraySize)
+			ExpandStorage(m_GOStorage, m_GOArraySize, m_GOHighGuid + RESERVE_EXPAND_SIZE + 1, NULL);
+
+		m_parallelPhase = true;
+		sMapUpdateWorkerPool.Execute(&m_regionBatch, m_regionBatch.regions.size());
+		m_parallelPhase = false;
+
+		_MergeRegionUpdates();
+	}
+}
+
+void MapMgr::_BuildRegions(bool players, uint32 phase)
+{
+	m_regionBatch.regions.clear();
+	m_regionIndex.clear();
+	m_regionsUsed = 0;
+
+	if(players)
+	{
+		for(PlayerStorageMap::iterator itr = m_PlayerStorage.begin(); itr != m_PlayerStorage.end(); ++itr)
+		{
+			if(itr->second != NULL)
+				_AddToRegion(itr->second, phase);
+		}
+	}
+	else
+	{
+		uint32 p_time;
+		for(CreatureSet::iterator itr = activeCreatures.begin(); itr != activeCreatures.end(); ++itr)
+		{
+			if(_GetCreatureUpdateTime(*itr, m_regionBatch.difftime, &p_time))
+				_AddToRegion(*itr, phase);
+		}
+
+		for(PetStorageMap::iterator itr = m_PetStorage.begin(); itr != m_PetStorage.end(); ++itr)
+			_AddToRegion(itr->second, phase);
+	}
+}
+
+void MapMgr::_AddToRegion(Object * obj, uint32 phase)
+{
+	MapCell * cell = obj->GetMapCell();
+	if(cell == NULL || obj->m_regionTick == mLoopCounter)
+		return;
+
+	uint32 tileX = cell->_x / m_regionCells;
+	uint32 tileY = cell->_y / m_regionCells;
+	if(((tileX & 1) | ((tileY & 1) << 1)) != phase)
+		return;
+
+	uint32 key = (tileX << 16) | tileY;
+	MapRegion * region;
+	unordered_map<uint32, MapRegion*>::iterator itr = m_regionIndex.find(key);
+	if(itr == m_regionIndex.end())
+	{
+		if(m_regionsUsed == m_regionPool.size())
+			m_regionPool.push_back(new MapRegion);
+
+		region = m_regionPool[m_regionsUsed++];
+		region->key = key;
+		region->objects.clear();
+		region->guids.clear();
+		region->removed.clear();
+		m_regionIndex.insert(make_pair(key, region));
+		m_regionBatch.regions.push_back(region);
+	}
+	else
+		region = itr->second;
+
+	obj->m_regionTick = mLoopCounter;
+	region->objects.push_back(obj);
+	region->guids.push_back(obj->GetGUID());
+}
+
+void MapMgr::_UpdateRegion(MapRegion * region, uint32 difftime)
+{
+	Object * ptr;
+	uint32 p_time;
+	t_mapRegion = region;
+	for(size_t i = 0; i < region->objects.size(); ++i)
+	{
+		// something earlier in this region may have removed (and deleted) it, so
+		// look it up by the guid taken when the region was built
+		if(region->removed.size() && region->removed.find(region->guids[i]) != region->removed.end())
+			continue;
+
+		ptr = region->objects[i];
+
+		// idle creatures were only added on their turn
+		if(ptr->GetTypeId() == TYPEID_UNIT)
+		{
+			_GetCreatureUpdateTime(static_cast<Creature*>(ptr), difftime, &p_time);
+			ptr->Update(p_time);
+		}
+		else
+			ptr->Update(difftime);
+	}
+	t_mapRegion = NULL;
+}
+
+void MapMgr::_MergeRegionUpdates()
+{
+	// Replay the cell activity changes requested by players who crossed cells. This
+	// loads spawns and touches the active sets, so it can only run on the map thread.
+	for(size_t i = 0; i < m_deferredCellActivity.size(); ++i)
+		UpdateCellActivity(m_deferredCellActivity[i].x, m_deferredCellActivity[i].y, m_deferredCellActivity[i].radius);
+
+	m_deferredCellActivity.clear();
+
+	// nothing reads the arrays replaced during the phase any more
+	for(vector<void*>::iterator itr = m_retiredStorage.begin(); itr != m_retiredStorage.end(); ++itr)
+		free(*itr);
+	m_retiredStorage.clear();
+}
+
 void MapMgr::EventCorpseDespawn(uint64 guid)
 {
 	Corpse * pCorpse = objmgr.GetCorpse((uint32)guid);
@@ -1914,6 +2452,7 @@ void MapMgr::SendMessageToCellPlayers(Object * obj, WorldPacket * packet, uint32
 	uint32 posX, posY;
 	MapCell *cell;
 	MapCell::ObjectSet::iterator iter, iend;
+	PacketBroadcast broadcast(packet);
 	for (posX = startX; posX <= endX; ++posX )
 	{
 		for (posY = startY; posY <= endY; ++posY )
@@ -1927,7 +2466,7 @@ void MapMgr::SendMessageToCellPlayers(Object * obj, WorldPacket * packet, uint32
 				{
 					if((*iter)->IsPlayer())
 					{
-						static_cast< Player* >(*iter)->GetSession()->SendPacket(packet);
+						broadcast.Send(static_cast< Player* >(*iter)->GetSession());
 					}
 				}
 			}
@@ -1971,12 +2510,14 @@ void MapMgr::SendChatMessageToCellPlayers(Object * obj, WorldPacket * packet, ui
 
 Creature * MapMgr::GetSqlIdCreature(uint32 sqlid)
 {
+	MapParallelGuard guard(this);
 	CreatureSqlIdMap::iterator itr = _sqlids_creatures.find(sqlid);
 	return (itr == _sqlids_creatures.end()) ? NULL : itr->second;
 }
 
 GameObject * MapMgr::GetSqlIdGameObject(uint32 sqlid)
 {
+	MapParallelGuard guard(this);
 	GameObjectSqlIdMap::iterator itr = _sqlids_gameobjects.find(sqlid);
 	return (itr == _sqlids_gameobjects.end()) ? NULL : itr->second;
 }
@@ -2004,6 +2545,7 @@ void MapMgr::HookOnAreaTrigger(Player * plr, uint32 id)
 
 Creature * MapMgr::CreateCreature(uint32 entry)
 {
+	MapParallelGuard guard(this);
 	uint64 newguid = (uint64)HIGHGUID_TYPE_UNIT << 32;
 	char * pHighGuid = (char*)&newguid;
 	char * pEntry = (char*)&entry;
@@ -2021,20 +2563,17 @@ Creature * MapMgr::CreateCreature(uint32 entry)
 		return new Creature(newguid);
 	}
 
-	if(++m_CreatureHighGuid  >= m_CreatureArraySize)
-	{
-		// Reallocate array with larger size.
-		m_CreatureArraySize += RESERVE_EXPAND_SIZE;
-		m_CreatureStorage = (Creature**)realloc(m_CreatureStorage, sizeof(Creature*) * m_CreatureArraySize);
-		memset(&m_CreatureStorage[m_CreatureHighGuid],0,(m_CreatureArraySize-m_CreatureHighGuid)*sizeof(Creature*));
-	}
+	// grow the array before the guid is handed out, GetCreature checks the guid first
+	if(m_CreatureHighGuid + 1 >= m_CreatureArraySize)
+		ExpandStorage(m_CreatureStorage, m_CreatureArraySize, m_CreatureHighGuid + 2, m_parallelPhase ? &m_retiredStorage : NULL);
 
-	newguid |= m_CreatureHighGuid;
+	newguid |= ++m_CreatureHighGuid;
 	return new Creature(newguid);
 }
 
 GameObject * MapMgr::CreateGameObject(uint32 entry)
 {
+	MapParallelGuard guard(this);
 	if(_reusable_guids_gameobject.size())
 	{
 		uint32 guid = _reusable_guids_gameobject.front();
@@ -2042,18 +2581,27 @@ GameObject * MapMgr::CreateGameObject(uint32 entry)
 		return new GameObject((uint64)HIGHGUID_TYPE_GAMEOBJECT<<32 | guid);
 	}
 
-	if(++m_GOHighGuid  >= m_GOArraySize)
-	{
-		// Reallocate array with larger size.
-		m_GOArraySize += RESERVE_EXPAND_SIZE;
-		m_GOStorage = (GameObject**)realloc(m_GOStorage, sizeof(GameObject*) * m_GOArraySize);
-		memset(&m_GOStorage[m_GOHighGuid],0,(m_GOArraySize-m_GOHighGuid)*sizeof(GameObject*));
-	}
-	return new GameObject((uint64)HIGHGUID_TYPE_GAMEOBJECT<<32 | m_GOHighGuid);
+	if(m_GOHighGuid + 1 >= m_GOArraySize)
+		ExpandStorage(m_GOStorage, m_GOArraySize, m_GOHighGuid + 2, m_parallelPhase ? &m_retiredStorage : NULL);
+
+	return new GameObject((uint64)HIGHGUID_TYPE_GAMEOBJECT<<32 | ++m_GOHighGuid);
 }
 
 DynamicObject * MapMgr::CreateDynamicObject()
 {
+	MapParallelGuard guard(this);
 	return new DynamicObject(HIGHGUID_TYPE_DYNAMICOBJECT,(++m_DynamicObjectHighGuid));
 }
 
+void MapMgr::FirePeriodicTick(Aura * aura, uint8 tick)
+{
+	aura->FirePeriodicTick(tick);
+}
+
+void MapMgr::SendPeriodicAuraLog(const uint64 & sender, WorldPacket * data)
+{
+	// the sender may have left the map since it logged
+	Unit * u = GetUnit(sender);
+	if(u != NULL)
+		u->SendMessageToSet(data, true);
+}
@@ -37,6 +37,7 @@ class Transporter;
 class Corpse;
 class CBattleground;
 class Instance;
+class MapMgr;
 
 
 enum MapMgrTimers
@@ -56,6 +57,16 @@ enum ObjectActiveState
 	OBJECT_STATE_ACTIVE   = 2,
 };
 
+/* How the creatures of a map were updated in one loop, see MapMgr::_ScheduleCreatureUpdates */
+enum CreatureUpdateTier
+{
+	CREATURE_TIER_FULL		= 0,	// in combat, busy or seen by a player, updated every loop
+	CREATURE_TIER_REDUCED	= 1,	// idle and unseen, had its turn this loop
+	CREATURE_TIER_DEFERRED	= 2,	// idle and unseen, waiting for its turn
+	CREATURE_TIER_SLEEPING	= 3,	// in an idle cell, not updated at all
+	CREATURE_TIER_COUNT		= 4,
+};
+
 typedef std::set<Object*> ObjectSet;
 typedef std::set<Object*> UpdateQueue;
 typedef std::set<Player*> PUpdateQueue;
@@ -72,12 +83,27 @@ typedef unordered_map<uint32, GameObject*> GameObjectSqlIdMap;
 class Transporter;
 #define RESERVE_EXPAND_SIZE 1024
 
-class SERVER_DECL MapMgr : public CellHandler <MapCell>, public EventableObject,public CThread
+/** Serialises map-wide bookkeeping (storage maps, cell creation, active sets)
+ * while the region workers of a map are running. Does nothing otherwise.
+ */
+class MapParallelGuard
+{
+public:
+	MapParallelGuard(MapMgr * mgr);
+	~MapParallelGuard();
+
+private:
+	MapMgr * m_mgr;
+};
+
+class SERVER_DECL MapMgr : public CellHandler <MapCell>, public EventableObject,public CThread, public PeriodicAuraHandler
 {
 	friend class UpdateObjectThread;
 	friend class ObjectUpdaterThread;
 	friend class MapCell;
 	friend class MapScriptInterface;
+	friend class MapRegionBatch;
+	friend class MapParallelGuard;
 public:
 		
 	//This will be done in regular way soon
@@ -127,6 +153,7 @@ public:
 	
 	ASCENT_INLINE DynamicObject * GetDynamicObject(uint32 guid)
 	{
+		MapParallelGuard guard(this);
 		DynamicObjectStorageMap::iterator itr = m_DynamicObjectStorage.find(guid);
 		return (itr != m_DynamicObjectStorage.end()) ? itr->second : 0;
 	}
@@ -138,6 +165,7 @@ public:
 	PetStorageMap m_PetStorage;
 	__inline Pet * GetPet(uint32 guid)
 	{
+		MapParallelGuard guard(this);
 		PetStorageMap::iterator itr = m_PetStorage.find(guid);
 		return (itr != m_PetStorage.end()) ? itr->second : 0;
 	}
@@ -151,6 +179,7 @@ public:
 	PlayerStorageMap m_PlayerStorage;
 	__inline Player * GetPlayer(uint32 guid)
 	{
+		MapParallelGuard guard(this);
 		PlayerStorageMap::iterator itr = m_PlayerStorage.find(guid);
 		return (itr != m_PlayerStorage.end()) ? itr->second : 0;
 	}
@@ -159,14 +188,8 @@ public:
 // Local (mapmgr) storage of combats in progress
 ////////////////////////////////
 	CombatProgressMap _combatProgress;
-	void AddCombatInProgress(uint64 guid)
-	{
-		_combatProgress.insert(guid);
-	}
-	void RemoveCombatInProgress(uint64 guid)
-	{
-		_combatProgress.erase(guid);
-	}
+	void AddCombatInProgress(uint64 guid);
+	void RemoveCombatInProgress(uint64 guid);
 
 //////////////////////////////////////////////////////////
 // Lookup Wrappers
@@ -174,6 +197,10 @@ public:
 	Unit * GetUnit(const uint64 & guid);
 	Object * _GetObject(const uint64 & guid);
 
+	// PeriodicAuraHandler of periodicAuras
+	void FirePeriodicTick(Aura * aura, uint8 tick);
+	void SendPeriodicAuraLog(const uint64 & sender, WorldPacket * data);
+
 	bool run();
 	bool Do();
 
@@ -196,6 +223,31 @@ public:
 	ASCENT_INLINE uint8  GetWaterType(float x, float y) { return GetBaseMap()->GetWaterType(x, y); }
 	ASCENT_INLINE uint8  GetWalkableState(float x, float y) { return GetBaseMap()->GetWalkableState(x, y); }
 	ASCENT_INLINE uint16 GetAreaID(float x, float y) { return GetBaseMap()->GetAreaID(x, y); }
+	ASCENT_INLINE void   GetTerrainInfo(uint32 count, const float * x, const float * y, float * heights, float * waterHeights, uint16 * areas) { GetBaseMap()->GetTerrainInfo(count, x, y, heights, waterHeights, areas); }
+
+	/* Units of caster's in-range set within radius of (x, y, z), taken from the cells the
+	 * circle overlaps instead of walking the whole set. Only the cells next to the caster
+	 * are read, the ones its in-range set is built from. The vector is a per-thread buffer
+	 * which the next query on the same thread overwrites, do not keep it or query again
+	 * while iterating it.
+	 */
+	vector<Unit*> & GetUnitsInRange(Object * caster, float x, float y, float z, float radius);
+
+	/* Sets hit[i] to whether point i of the packed arrays is within radius of (x, y, z).
+	 * Same test as Object::GetDistanceSq, without branches so the compiler can vectorize it.
+	 */
+	static ASCENT_INLINE void FilterPointsInRange(const float * px, const float * py, const float * pz, size_t count, float x, float y, float z, float radius, uint8 * hit)
+	{
+		float r = radius * radius;
+		float dx, dy, dz;
+		for(size_t i = 0; i < count; ++i)
+		{
+			dx = x - px[i];
+			dy = y - py[i];
+			dz = z - pz[i];
+			hit[i] = (uint8)(dx*dx + dy*dy + dz*dz <= r);
+		}
+	}
 
 	ASCENT_INLINE uint32 GetMapId() { return _mapId; }
 
@@ -218,6 +270,13 @@ public:
 	uint32 GetTeamPlayersCount(uint32 teamId);
 
 	void _PerformObjectDuties();
+	ASCENT_INLINE bool InParallelUpdate() { return m_parallelPhase; }
+
+	/* Creature counts of the last loop, indexed by CreatureUpdateTier. */
+	ASCENT_INLINE uint32 GetCreatureTierCount(uint32 tier) { return m_creatureTiers[tier]; }
+
+	/* Creature counts of all maps added up over all loops, and the number of loops. */
+	static void GetCreatureTierStatistics(uint64 * loops, uint64 * counts);
 	uint32 mLoopCounter;
 	uint32 lastGameobjectUpdate;
 	uint32 lastUnitUpdate;
@@ -267,6 +326,7 @@ protected:
 
 	//! Collect and send updates to clients
 	void _UpdateObjects();
+	void _CompressPendingUpdates();
 
 private:
 	//! Objects that exist on map
@@ -281,6 +341,39 @@ private:
 
 	WorldPacket* BuildInitialWorldState();
 
+	/* Parallel region update */
+	struct DeferredCellActivity
+	{
+		uint32 x;
+		uint32 y;
+		int radius;
+	};
+
+	/* AI level of detail */
+	void _ScheduleCreatureUpdates(uint32 difftime);
+	bool _GetCreatureUpdateTime(Creature * ptr, uint32 difftime, uint32 * p_time);
+
+	uint32 m_creatureTiers[CREATURE_TIER_COUNT];
+	uint32 m_creaturesInWorld;
+
+	bool _UseParallelUpdate();
+	void _UpdateRegions(bool players, uint32 difftime);
+	void _BuildRegions(bool players, uint32 phase);
+	void _AddToRegion(Object * obj, uint32 phase);
+	void _UpdateRegion(MapRegion * region, uint32 difftime);
+	void _MergeRegionUpdates();
+
+	// width of a region in cells, 0 if this map is never updated in parallel
+	uint32 m_regionCells;
+	bool m_parallelPhase;
+	Mutex m_parallelLock;
+	MapRegionBatch m_regionBatch;
+	vector<MapRegion*> m_regionPool;
+	uint32 m_regionsUsed;
+	unordered_map<uint32, MapRegion*> m_regionIndex;
+	vector<DeferredCellActivity> m_deferredCellActivity;
+	vector<void*> m_retiredStorage;
+
 public:
 	// Distance a Player can "see" other objects and receive updates from them (!! ALREADY dist*dist !!)
 	float m_UpdateDistance;
@@ -294,6 +387,8 @@ private:
 	FastMutex m_updateMutex;		// use a user-mode mutex for extra speed
 	UpdateQueue _updates;
 	PUpdateQueue _processQueue;
+	UpdateCompressionBatch m_compressBatch;
+	vector<Player*> m_compressPlayers;
 
 	/* Sessions */
 	
@@ -313,6 +408,8 @@ public:
 	GameObjectSet activeGameObjects;
 	CreatureSet activeCreatures;
 	EventableObjectHolder eventHolder;
+	PeriodicAuraScheduler periodicAuras;
+	AsyncQueryCompletionQueue queryCompletions;
 	CBattleground * m_battleground;
 	set<Corpse*> m_corpses;
 	CreatureSqlIdMap _sqlids_creatures;
@@ -328,4 +425,16 @@ public:
 	bool thread_running;
 };
 
+ASCENT_INLINE MapParallelGuard::MapParallelGuard(MapMgr * mgr) : m_mgr((mgr != NULL && mgr->m_parallelPhase) ? mgr : NULL)
+{
+	if(m_mgr != NULL)
+		m_mgr->m_parallelLock.Acquire();
+}
+
+ASCENT_INLINE MapParallelGuard::~MapParallelGuard()
+{
+	if(m_mgr != NULL)
+		m_mgr->m_parallelLock.Release();
+}
+
 #endif
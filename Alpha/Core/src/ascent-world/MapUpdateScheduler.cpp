@@ -0,0 +1,180 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// MapUpdateScheduler.cpp
+//
+
+#include "StdAfx.h"
+initialiseSingleton(MapUpdateWorkerPool);
+
+MapUpdateWorkerPool::MapUpdateWorkerPool() : m_cond(&m_lock)
+{
+	m_threadCount = 0;
+	m_activeThreads = 0;
+	m_running = false;
+}
+
+MapUpdateWorkerPool::~MapUpdateWorkerPool()
+{
+	Shutdown();
+}
+
+void MapUpdateWorkerPool::Startup(uint32 thread_count)
+{
+	if(thread_count == 0)
+	{
+#ifdef WIN32
+		SYSTEM_INFO s;
+		GetSystemInfo(&s);
+		thread_count = s.dwNumberOfProcessors;
+#else
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		thread_count = (cpus > 0) ? (uint32)cpus : 1;
+#endif
+		// the map threads work on their own batches too
+		if(thread_count > 1)
+			--thread_count;
+	}
+
+	m_running = true;
+	m_threadCount = thread_count;
+
+	Log.Notice("MapUpdateWorkerPool", "Starting %u map worker threads.", thread_count);
+	for(uint32 i = 0; i < thread_count; ++i)
+		ThreadPool.ExecuteTask(new MapUpdateWorker);
+}
+
+void MapUpdateWorkerPool::Shutdown()
+{
+	m_cond.BeginSynchronized();
+	m_running = false;
+	m_cond.Broadcast();
+	m_cond.EndSynchronized();
+}
+
+void MapRegionBatch::Run(size_t index)
+{
+	mgr->_UpdateRegion(regions[index], difftime);
+}
+
+WorkerBatch * MapUpdateWorkerPool::_GetWork(size_t * index, WorkerBatch * only)
+{
+	WorkerBatch * b;
+	if(only != NULL)
+		b = only;
+	else if(m_batches.size())
+		b = m_batches.front();
+	else
+		return NULL;
+
+	if(b->next >= b->count)
+		return NULL;
+
+	*index = b->next++;
+	if(b->next == b->count)
+	{
+		// nothing left to hand out, stop advertising it to the workers
+		deque<WorkerBatch*>::iterator itr = std::find(m_batches.begin(), m_batches.end(), b);
+		if(itr != m_batches.end())
+			m_batches.erase(itr);
+	}
+
+	return b;
+}
+
+void MapUpdateWorkerPool::_FinishWork(WorkerBatch * batch)
+{
+	if(++batch->done == batch->count)
+		m_cond.Broadcast();
+}
+
+void MapUpdateWorkerPool::Execute(WorkerBatch * batch, size_t count)
+{
+	size_t index;
+
+	batch->count = count;
+	batch->next = 0;
+	batch->done = 0;
+	if(count == 0)
+		return;
+
+	m_cond.BeginSynchronized();
+	if(m_running && m_activeThreads && count > 1)
+	{
+		m_batches.push_back(batch);
+		m_cond.Broadcast();
+	}
+
+	while(_GetWork(&index, batch) != NULL)
+	{
+		m_cond.EndSynchronized();
+		batch->Run(index);
+		m_cond.BeginSynchronized();
+		_FinishWork(batch);
+	}
+
+	// wait for whatever is still running on the workers
+	while(batch->done < batch->count)
+		m_cond.Wait();
+
+	m_cond.EndSynchronized();
+}
+
+void MapUpdateWorkerPool::WorkerLoop()
+{
+	WorkerBatch * batch;
+	size_t index;
+
+	m_cond.BeginSynchronized();
+	++m_activeThreads;
+	while(m_running)
+	{
+		batch = _GetWork(&index, NULL);
+		if(batch == NULL)
+		{
+			m_cond.Wait();
+			continue;
+		}
+
+		m_cond.EndSynchronized();
+		batch->Run(index);
+		m_cond.BeginSynchronized();
+		_FinishWork(batch);
+	}
+	--m_activeThreads;
+	m_cond.EndSynchronized();
+}
+
+bool MapUpdateWorker::run()
+{
+	SetThreadName("Map worker");
+	THREAD_TRY_EXECUTION
+	{
+		sMapUpdateWorkerPool.WorkerLoop();
+	}
+	THREAD_HANDLE_CRASH
+	return true;
+}
+
+void MapUpdateWorker::OnShutdown()
+{
+	if(MapUpdateWorkerPool::getSingletonPtr() != NULL)
+		sMapUpdateWorkerPool.Shutdown();
+}
@@ -0,0 +1,127 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// MapUpdateScheduler.h
+//
+
+#ifndef __MAPUPDATESCHEDULER_H
+#define __MAPUPDATESCHEDULER_H
+
+class MapMgr;
+class Object;
+
+/** Regions are coloured like a 2x2 checkerboard. All regions of one colour are
+ * updated at the same time, every other colour is idle during that phase.
+ */
+#define MAP_REGION_PHASES 4
+
+/** Minimum distance (in cells) an update can reach outside of its own region:
+ * in-range sets are built from the neighbouring cells, and a moving object can
+ * cross one more cell boundary during a tick.
+ */
+#define MAP_REGION_MIN_HALO 2
+
+/** One tile of the cell grid and the objects to update in it for the current phase.
+ */
+struct MapRegion
+{
+	uint32 key;
+	vector<Object*> objects;
+	vector<uint64> guids;		// of objects, taken when the region was built
+	set<uint64> removed;		// objects removed from the map during the phase
+};
+
+/** Independent work items handed to the worker pool as a unit. Run is called
+ * once for every item, on the submitting thread or on any of the workers.
+ */
+class WorkerBatch
+{
+public:
+	WorkerBatch() : count(0), next(0), done(0) {}
+	virtual ~WorkerBatch() {}
+
+	virtual void Run(size_t index) = 0;
+
+	// protected by the pool lock
+	size_t count;
+	size_t next;
+	size_t done;
+};
+
+/** The regions of one MapMgr phase.
+ */
+class MapRegionBatch : public WorkerBatch
+{
+public:
+	MapRegionBatch() : mgr(NULL), difftime(0) {}
+
+	void Run(size_t index);
+
+	MapMgr * mgr;
+	uint32 difftime;
+	vector<MapRegion*> regions;
+};
+
+/** Worker threads shared by every map thread, which hand them the regions of a
+ * phase and the update packets to compress.
+ */
+class SERVER_DECL MapUpdateWorkerPool : public Singleton<MapUpdateWorkerPool>
+{
+public:
+	MapUpdateWorkerPool();
+	~MapUpdateWorkerPool();
+
+	void Startup(uint32 thread_count);
+	void Shutdown();
+
+	ASCENT_INLINE bool IsRunning() { return m_running; }
+	ASCENT_INLINE uint32 GetThreadCount() { return m_threadCount; }
+
+	/** Runs the first count items of the batch and returns once every one of them has
+	 * finished. The calling thread takes part in the work, so this never blocks on idle workers.
+	 */
+	void Execute(WorkerBatch * batch, size_t count);
+
+	/** Main loop of a worker thread. Returns when the pool is shut down.
+	 */
+	void WorkerLoop();
+
+private:
+	WorkerBatch * _GetWork(size_t * index, WorkerBatch * only);
+	void _FinishWork(WorkerBatch * batch);
+
+	Mutex m_lock;
+	Condition m_cond;
+	deque<WorkerBatch*> m_batches;
+	uint32 m_threadCount;
+	uint32 m_activeThreads;
+	bool m_running;
+};
+
+class MapUpdateWorker : public ThreadBase
+{
+public:
+	bool run();
+	void OnShutdown();
+};
+
+#define sMapUpdateWorkerPool MapUpdateWorkerPool::getSingleton()
+
+#endif
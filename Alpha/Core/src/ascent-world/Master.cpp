@@ -118,6 +118,7 @@ bool Master::Run(int argc, char ** argv)
 	int do_version = 0;
 	int do_cheater_check = 0;
 	int do_database_clean = 0;
+	int do_rebuild_spell_cache = 0;
 	time_t curTime;
 
 	struct ascent_option longopts[] =
@@ -130,6 +131,7 @@ bool Master::Run(int argc, char ** argv)
 		{ "realmconf",			ascent_required_argument,		NULL,					'r'		},
 		{ "databasecleanup",	ascent_no_argument,				&do_database_clean,		1		},
 		{ "cheatercheck",		ascent_no_argument,				&do_cheater_check,		1		},
+		{ "rebuild-spell-cache",	ascent_no_argument,			&do_rebuild_spell_cache,	1		},
 		{ 0, 0, 0, 0 }
 	};
 
@@ -153,7 +155,7 @@ bool Master::Run(int argc, char ** argv)
 		default:
 			sLog.m_fileLogLevel = -1;
 			sLog.m_screenLogLevel = 3;
-			printf("Usage: %s [--checkconf] [--screenloglevel <level>] [--fileloglevel <level>] [--conf <filename>] [--realmconf <filename>] [--version] [--databasecleanup] [--cheatercheck]\n", argv[0]);
+			printf("Usage: %s [--checkconf] [--screenloglevel <level>] [--fileloglevel <level>] [--conf <filename>] [--realmconf <filename>] [--version] [--databasecleanup] [--cheatercheck] [--rebuild-spell-cache]\n", argv[0]);
 			return true;
 		}
 	}
@@ -299,6 +301,7 @@ bool Master::Run(int argc, char ** argv)
 
 	new EventMgr;
 	new World;
+	sWorld.m_rebuildSpellCache = (do_rebuild_spell_cache != 0);
 
 	// open cheat log file
 	Anticheat_Log = new SessionLogWriter(FormatOutputString( "logs", "cheaters", false).c_str(), false );
@@ -634,6 +637,7 @@ bool Master::_StartDB()
 	}
 
 	// Initialize it
+	WorldDatabase.SetAsyncThreadCount( Config.MainConfig.GetIntDefault( "WorldDatabase", "AsyncThreads", 0 ) );
 	if( !WorldDatabase.Initialize(hostname.c_str(), (unsigned int)port, username.c_str(),
 		password.c_str(), database.c_str(), Config.MainConfig.GetIntDefault( "WorldDatabase", "ConnectionCount", 3 ), 16384 ) )
 	{
@@ -656,6 +660,7 @@ bool Master::_StartDB()
 	}
 
 	// Initialize it
+	CharacterDatabase.SetAsyncThreadCount( Config.MainConfig.GetIntDefault( "CharacterDatabase", "AsyncThreads", 2 ) );
 	if( !CharacterDatabase.Initialize( hostname.c_str(), (unsigned int)port, username.c_str(),
 		password.c_str(), database.c_str(), Config.MainConfig.GetIntDefault( "CharacterDatabase", "ConnectionCount", 5 ), 16384 ) )
 	{
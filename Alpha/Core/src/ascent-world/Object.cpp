@@ -53,6 +53,7 @@ Object::Object() : m_position(0,0,0,0), m_spawnLocation(0,0,0,0)
 
 	m_mapMgr = 0;
 	m_mapCell = 0;
+	m_regionTick = 0;
 
 	mSemaphoreTeleport = false;
 
@@ -829,8 +830,8 @@ void Object::OutPacketToSet(uint16 Opcode, uint16 Len, const void * Data, bool s
 	if(!IsInWorld())
 		return;
 
-	std::set<Player*>::iterator itr = m_inRangePlayers.begin();
-	std::set<Player*>::iterator it_end = m_inRangePlayers.end();
+	InRangePlayerSet::iterator itr = m_inRangePlayers.begin();
+	InRangePlayerSet::iterator it_end = m_inRangePlayers.end();
 	int gm = ( m_objectTypeId == TYPEID_PLAYER ? static_cast< Player* >( this )->m_isGmInvisible : 0 );
 	for(; itr != it_end; ++itr)
 	{
@@ -849,16 +850,19 @@ void Object::OutPacketToSet(uint16 Opcode, uint16 Len, const void * Data, bool s
 
 void Object::SendMessageToSet(WorldPacket *data, bool bToSelf,bool myteam_only)
 {
+	// the payload is shared between all receivers, only the headers are built per socket
+	PacketBroadcast broadcast(data);
+
 	if(bToSelf && m_objectTypeId == TYPEID_PLAYER)
 	{
-		static_cast< Player* >( this )->GetSession()->SendPacket(data);		
+		broadcast.Send(static_cast< Player* >( this )->GetSession());
 	}
 
 	if(!IsInWorld())
 		return;
 
-	std::set<Player*>::iterator itr = m_inRangePlayers.begin();
-	std::set<Player*>::iterator it_end = m_inRangePlayers.end();
+	InRangePlayerSet::iterator itr = m_inRangePlayers.begin();
+	InRangePlayerSet::iterator it_end = m_inRangePlayers.end();
 	bool gminvis = (m_objectTypeId == TYPEID_PLAYER ? static_cast< Player* >( this )->m_isGmInvisible : false);
 	//Zehamster: Splitting into if/else allows us to avoid testing "gminvis==true" at each loop...
 	//		   saving cpu cycles. Chat messages will be sent to everybody even if player is invisible.
@@ -871,7 +875,7 @@ void Object::SendMessageToSet(WorldPacket *data, bool bToSelf,bool myteam_only)
 			{
 				ASSERT((*itr)->GetSession());
 				if((*itr)->GetSession()->GetPermissionCount() > 0 && (*itr)->GetTeam()==myteam)
-					(*itr)->GetSession()->SendPacket(data);
+					broadcast.Send((*itr)->GetSession());
 			}
 		}
 		else
@@ -880,7 +884,7 @@ void Object::SendMessageToSet(WorldPacket *data, bool bToSelf,bool myteam_only)
 			{
 				ASSERT((*itr)->GetSession());
 				if((*itr)->GetTeam()==myteam)
-					(*itr)->GetSession()->SendPacket(data);
+					broadcast.Send((*itr)->GetSession());
 			}
 		}
 	}
@@ -892,7 +896,7 @@ void Object::SendMessageToSet(WorldPacket *data, bool bToSelf,bool myteam_only)
 			{
 				ASSERT((*itr)->GetSession());
 				if((*itr)->GetSession()->GetPermissionCount() > 0)
-					(*itr)->GetSession()->SendPacket(data);
+					broadcast.Send((*itr)->GetSession());
 			}
 		}
 		else
@@ -900,7 +904,7 @@ void Object::SendMessageToSet(WorldPacket *data, bool bToSelf,bool myteam_only)
 			for(; itr != it_end; ++itr)
 			{
 				ASSERT((*itr)->GetSession());
-				(*itr)->GetSession()->SendPacket(data);
+				broadcast.Send((*itr)->GetSession());
 			}
 		}
 	}
@@ -1677,7 +1681,7 @@ void Object::DealDamage(Unit *pVictim, uint32 damage, uint32 targetEvent, uint32
 				pVictim->BuildFieldUpdatePacket(&buf, UNIT_DYNAMIC_FLAGS, pVictim->m_uint32Values[UNIT_DYNAMIC_FLAGS]);
 
 				// Loop inrange set, append to their update data.
-				for(std::set<Player*>::iterator itr = m_inRangePlayers.begin(); itr != m_inRangePlayers.end(); ++itr)
+				for(InRangePlayerSet::iterator itr = m_inRangePlayers.begin(); itr != m_inRangePlayers.end(); ++itr)
 				{
 					if (static_cast< Player* >(plr)->InGroup())
 					{
@@ -1952,7 +1956,7 @@ void Object::DealDamage(Unit *pVictim, uint32 damage, uint32 targetEvent, uint32
 		pVictim->DropAurasOnDeath();
 
 		/* Stop players from casting */
-		std::set<Player*>::iterator itr;
+		InRangePlayerSet::iterator itr;
 		for( itr = pVictim->GetInRangePlayerSetBegin() ; itr != pVictim->GetInRangePlayerSetEnd() ; itr ++ )
 		{
 			//if player has selection on us
@@ -2676,6 +2680,7 @@ bool Object::CanActivate()
 
 void Object::Activate(MapMgr * mgr)
 {
+	MapParallelGuard guard(mgr);
 	switch(m_objectTypeId)
 	{
 	case TYPEID_UNIT:
@@ -2692,6 +2697,7 @@ void Object::Activate(MapMgr * mgr)
 
 void Object::Deactivate(MapMgr * mgr)
 {
+	MapParallelGuard guard(mgr);
 	switch(m_objectTypeId)
 	{
 	case TYPEID_UNIT:
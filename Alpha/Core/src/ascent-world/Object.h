@@ -108,7 +108,8 @@ class MapMgr;
 class SERVER_DECL Object : public EventableObject
 {
 public:
-	typedef std::set<Object*> InRangeSet;
+	typedef IndexedObjectSet<Object> InRangeSet;
+	typedef IndexedObjectSet<Player> InRangePlayerSet;
 	typedef std::map<string, void*> ExtensionSet;
 
 	virtual ~Object ( );
@@ -401,10 +402,19 @@ public:
 	ASCENT_INLINE InRangeSet::iterator GetInRangeSetEnd() { return m_objectsInRange.end(); }
 	ASCENT_INLINE InRangeSet::iterator FindInRangeSet(Object * obj) { return m_objectsInRange.find(obj); }
 
-	void RemoveInRangeObject(InRangeSet::iterator itr)
+	/** Returns the iterator to continue with, erasing moves the last member into itr.
+	 */
+	InRangeSet::iterator RemoveInRangeObject(InRangeSet::iterator itr)
 	{ 
-		OnRemoveInRangeObject(*itr);
-		m_objectsInRange.erase(itr);
+		Object * pObj = *itr;
+		OnRemoveInRangeObject(pObj);
+
+		// the callback can remove objects itself, don't erase whatever got moved into itr
+		if( itr != m_objectsInRange.end() && *itr == pObj )
+			return m_objectsInRange.erase(itr);
+
+		m_objectsInRange.erase(pObj);
+		return itr;
 	}
 
 	ASCENT_INLINE bool RemoveIfInRange( Object * obj )
@@ -432,17 +442,17 @@ public:
 
 	bool IsInRangeSameFactSet(Object* pObj) { return (m_sameFactsInRange.count(pObj) > 0); }
 	void UpdateSameFactionSet();
-	ASCENT_INLINE std::set<Object*>::iterator GetInRangeSameFactsSetBegin() { return m_sameFactsInRange.begin(); }
-	ASCENT_INLINE std::set<Object*>::iterator GetInRangeSameFactsSetEnd() { return m_sameFactsInRange.end(); }
+	ASCENT_INLINE InRangeSet::iterator GetInRangeSameFactsSetBegin() { return m_sameFactsInRange.begin(); }
+	ASCENT_INLINE InRangeSet::iterator GetInRangeSameFactsSetEnd() { return m_sameFactsInRange.end(); }
 
 	bool IsInRangeOppFactSet(Object* pObj) { return (m_oppFactsInRange.count(pObj) > 0); }
 	void UpdateOppFactionSet();
 	ASCENT_INLINE size_t GetInRangeOppFactsSize(){ return m_oppFactsInRange.size(); }
-	ASCENT_INLINE std::set<Object*>::iterator GetInRangeOppFactsSetBegin() { return m_oppFactsInRange.begin(); }
-	ASCENT_INLINE std::set<Object*>::iterator GetInRangeOppFactsSetEnd() { return m_oppFactsInRange.end(); }
-	ASCENT_INLINE std::set<Player*>::iterator GetInRangePlayerSetBegin() { return m_inRangePlayers.begin(); }
-	ASCENT_INLINE std::set<Player*>::iterator GetInRangePlayerSetEnd() { return m_inRangePlayers.end(); }
-	ASCENT_INLINE std::set<Player*> * GetInRangePlayerSet() { return &m_inRangePlayers; };
+	ASCENT_INLINE InRangeSet::iterator GetInRangeOppFactsSetBegin() { return m_oppFactsInRange.begin(); }
+	ASCENT_INLINE InRangeSet::iterator GetInRangeOppFactsSetEnd() { return m_oppFactsInRange.end(); }
+	ASCENT_INLINE InRangePlayerSet::iterator GetInRangePlayerSetBegin() { return m_inRangePlayers.begin(); }
+	ASCENT_INLINE InRangePlayerSet::iterator GetInRangePlayerSetEnd() { return m_inRangePlayers.end(); }
+	ASCENT_INLINE InRangePlayerSet * GetInRangePlayerSet() { return &m_inRangePlayers; };
 
 	void __fastcall SendMessageToSet(WorldPacket *data, bool self,bool myteam_only=false);
 	ASCENT_INLINE void SendMessageToSet(StackBufferBase * data, bool self) { OutPacketToSet(data->GetOpcode(), data->GetSize(), data->GetBufferPointer(), self); }
@@ -562,10 +572,10 @@ protected:
 
 	//! Set of Objects in range.
 	//! TODO: that functionality should be moved into WorldServer.
-	std::set<Object*> m_objectsInRange;
-	std::set<Player*> m_inRangePlayers;
-	std::set<Object*> m_oppFactsInRange;
-	std::set<Object*> m_sameFactsInRange;
+	InRangeSet m_objectsInRange;
+	InRangePlayerSet m_inRangePlayers;
+	InRangeSet m_oppFactsInRange;
+	InRangeSet m_sameFactsInRange;
    
   
 	//! Remove object from map
@@ -600,6 +610,7 @@ public:
 	}
 
 	bool m_loadedFromDB;
+	uint32 m_regionTick;		// map loop the object was last put into an update region
 };
 
 #endif
@@ -490,12 +490,13 @@ void ObjectMgr::LoadExtraItemStuff()
 	}
 }
 
-#define make_task(storage, itype, storagetype, tablename, format) tl.AddTask( new Task( \
+#define make_task(storage, itype, storagetype, tablename, format) storage_tasks.push_back( tl.AddTask( new Task( \
 	new CallbackP2< SQLStorage< itype, storagetype< itype > >, const char *, const char *> \
-    (&storage, &SQLStorage< itype, storagetype< itype > >::Load, tablename, format) ) )
+    (&storage, &SQLStorage< itype, storagetype< itype > >::Load, tablename, format) ) ) )
 
-void Storage_FillTaskList(TaskList & tl)
+Task * Storage_FillTaskList(TaskList & tl)
 {
+	vector<Task*> storage_tasks;
 	make_task(ItemPrototypeStorage, ItemPrototype, ArrayStorageContainer, "items", gItemPrototypeFormat);
 	make_task(CreatureNameStorage, CreatureInfo, HashMapStorageContainer, "creature_names", gCreatureNameFormat);
 	make_task(GameObjectNameStorage, GameObjectInfo, HashMapStorageContainer, "gameobject_names", gGameObjectNameFormat);
@@ -510,6 +511,13 @@ void Storage_FillTaskList(TaskList & tl)
 	make_task(WorldMapInfoStorage, MapInfo, ArrayStorageContainer, "worldmap_info", gWorldMapInfoFormat);
 	make_task(ZoneGuardStorage, ZoneGuardEntry, HashMapStorageContainer, "zoneguards", gZoneGuardsFormat);
 	make_task(UnitModelSizeStorage, UnitModelSizeEntry, HashMapStorageContainer, "unit_display_sizes", gUnitModelSizeFormat);
+
+	// additional tables are appended to the storages above
+	Task * additional = tl.AddTask(new Task(new CallbackFunctionP0(&Storage_LoadAdditionalTables)));
+	for(vector<Task*>::iterator itr = storage_tasks.begin(); itr != storage_tasks.end(); ++itr)
+		additional->DependsOn(*itr);
+
+	return additional;
 }
 
 void Storage_Cleanup()
@@ -35,7 +35,9 @@ extern SERVER_DECL SQLStorage<MapInfo, ArrayStorageContainer<MapInfo> >							Wo
 extern SERVER_DECL SQLStorage<ZoneGuardEntry, HashMapStorageContainer<ZoneGuardEntry> >			ZoneGuardStorage;
 extern SERVER_DECL SQLStorage<UnitModelSizeEntry, HashMapStorageContainer<UnitModelSizeEntry> >	UnitModelSizeStorage;
 
-void Storage_FillTaskList(TaskList & tl);
+/** Adds the storage loaders to the list, returns the task which completes once every storage is loaded.
+ */
+Task * Storage_FillTaskList(TaskList & tl);
 void Storage_Cleanup();
 bool Storage_ReloadTable(const char * TableName);
 void Storage_LoadAdditionalTables();
@@ -0,0 +1,257 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// PeriodicAuraScheduler.cpp
+//
+
+#include "StdAfx.h"
+
+static Mutex m_periodicStatsLock;
+static uint64 m_periodicTicks;
+static uint64 m_periodicLogEntries;
+static uint64 m_periodicLogPackets;
+
+PeriodicAuraScheduler::PeriodicAuraScheduler() : m_log(SMSG_PERIODICAURALOG, 128)
+{
+	m_handler = NULL;
+	m_time = 0;
+	m_logging = false;
+	m_logSender = 0;
+	m_logTarget = 0;
+	m_logCaster = 0;
+	m_logSpell = 0;
+	m_logCount = 0;
+	m_logCountPos = 0;
+	m_fired = 0;
+	m_logEntries = 0;
+	m_logPackets = 0;
+}
+
+void PeriodicAuraScheduler::_Insert(uint32 index)
+{
+	PeriodicAuraBucketItem item;
+	item.index = index;
+	item.serial = m_entries[index].serial;
+	m_buckets[(m_entries[index].due >> PERIODIC_AURA_BUCKET_SHIFT) & PERIODIC_AURA_BUCKET_MASK].push_back(item);
+}
+
+uint32 PeriodicAuraScheduler::Add(Aura * aura, uint8 tick, uint32 delay, uint32 period)
+{
+	uint32 index;
+
+	m_lock.Acquire();
+	if(m_free.size())
+	{
+		index = m_free.back();
+		m_free.pop_back();
+	}
+	else
+	{
+		index = (uint32)m_entries.size();
+		m_entries.push_back(PeriodicAuraEntry());
+		m_entries[index].serial = 0;
+	}
+
+	PeriodicAuraEntry & e = m_entries[index];
+	e.aura = aura;
+	e.tick = tick;
+	e.period = period;
+	e.due = m_time + (delay ? delay : 1);
+	_Insert(index);
+	m_lock.Release();
+
+	return index;
+}
+
+void PeriodicAuraScheduler::Remove(uint32 handle)
+{
+	m_lock.Acquire();
+	PeriodicAuraEntry & e = m_entries[handle];
+	e.aura = NULL;
+	++e.serial;
+	m_free.push_back(handle);
+	m_lock.Release();
+}
+
+uint32 PeriodicAuraScheduler::GetTimeLeft(uint32 handle)
+{
+	m_lock.Acquire();
+	int32 left = (int32)(m_entries[handle].due - m_time);
+	m_lock.Release();
+
+	return (left > 0) ? (uint32)left : 0;
+}
+
+void PeriodicAuraScheduler::Update(uint32 time_difference)
+{
+	PeriodicAuraEntry * e;
+	Aura * aura;
+	Aura * last_aura = NULL;
+	PeriodicAuraBucketItem last_item;
+	uint8 tick;
+	size_t i, keep;
+
+	m_lock.Acquire();
+	uint32 bucket = m_time >> PERIODIC_AURA_BUCKET_SHIFT;
+	m_time += time_difference;
+	uint32 buckets = (m_time >> PERIODIC_AURA_BUCKET_SHIFT) - bucket + 1;
+	if(buckets > PERIODIC_AURA_BUCKETS)
+		buckets = PERIODIC_AURA_BUCKETS;
+
+	// Collect everything that is due from the buckets the clock went through. Buckets come
+	// in time order and the ticks of an aura are added one after another, so they stay next
+	// to each other for the log without sorting.
+	m_firing.clear();
+	for(; buckets > 0; --buckets, ++bucket)
+	{
+		PeriodicAuraBucket & b = m_buckets[bucket & PERIODIC_AURA_BUCKET_MASK];
+		for(i = 0, keep = 0; i < b.size(); ++i)
+		{
+			e = &m_entries[b[i].index];
+			if(e->serial != b[i].serial)
+				continue;
+
+			if((int32)(e->due - m_time) > 0)
+				b[keep++] = b[i];		// due in a later turn of the wheel
+			else
+				m_firing.push_back(b[i]);
+		}
+		b.resize(keep);
+	}
+
+	if(m_firing.empty())
+	{
+		m_lock.Release();
+		return;
+	}
+
+	m_logging = true;
+	m_lock.Release();
+
+	// the lock is only held between the ticks, a tick may add or remove ticks of any aura
+	for(i = 0; i < m_firing.size(); ++i)
+	{
+		PeriodicAuraBucketItem item = m_firing[i];
+
+		m_lock.Acquire();
+		e = &m_entries[item.index];
+		if(e->serial != item.serial)
+		{
+			// removed by an earlier tick
+			m_lock.Release();
+			continue;
+		}
+
+		aura = e->aura;
+		tick = e->tick;
+
+		// The log of an aura goes out before a tick of any other aura fires. The serial catches
+		// an aura removed by its last tick whose memory went to the next aura being fired.
+		if(last_aura != NULL && (aura != last_aura || m_entries[last_item.index].serial != last_item.serial))
+			_FlushLog();
+		last_aura = aura;
+		last_item = item;
+
+		// a tick with no period fires once per update, one which fell behind catches up in this one
+		e->due = e->period ? e->due + e->period : m_time + 1;
+		if((int32)(e->due - m_time) > 0)
+			_Insert(item.index);
+		else
+			m_firing.push_back(item);
+
+		++m_fired;
+		m_lock.Release();
+
+		m_handler->FirePeriodicTick(aura, tick);
+	}
+
+	m_lock.Acquire();
+	_FlushLog();
+	m_logging = false;
+
+	m_periodicStatsLock.Acquire();
+	m_periodicTicks += m_fired;
+	m_periodicLogEntries += m_logEntries;
+	m_periodicLogPackets += m_logPackets;
+	m_periodicStatsLock.Release();
+
+	m_fired = 0;
+	m_logEntries = 0;
+	m_logPackets = 0;
+	m_lock.Release();
+}
+
+bool PeriodicAuraScheduler::AddLogEntry(Unit * sender, Unit * target, const uint64 & caster, uint32 spell, const uint32 * entry, uint32 words)
+{
+	m_lock.Acquire();
+	if(!m_logging)
+	{
+		m_lock.Release();
+		return false;
+	}
+
+	// one packet carries the entries of one target, caster and spell
+	if(m_logCount && (m_logSender != sender->GetGUID() || m_logTarget != target->GetGUID() || m_logCaster != caster || m_logSpell != spell))
+		_FlushLog();
+
+	if(!m_logCount)
+	{
+		m_log.Initialize(SMSG_PERIODICAURALOG);
+		m_log << target->GetNewGUID();
+		FastGUIDPack(m_log, caster);
+		m_log << spell;
+		m_logCountPos = m_log.wpos();
+		m_log << uint32(0);
+
+		m_logSender = sender->GetGUID();
+		m_logTarget = target->GetGUID();
+		m_logCaster = caster;
+		m_logSpell = spell;
+	}
+
+	for(uint32 i = 0; i < words; ++i)
+		m_log << entry[i];
+
+	++m_logCount;
+	++m_logEntries;
+	m_lock.Release();
+	return true;
+}
+
+void PeriodicAuraScheduler::_FlushLog()
+{
+	if(!m_logCount)
+		return;
+
+	m_log.put<uint32>(m_logCountPos, m_logCount);
+	m_handler->SendPeriodicAuraLog(m_logSender, &m_log);
+
+	m_logCount = 0;
+	++m_logPackets;
+}
+
+void PeriodicAuraScheduler::GetStatistics(uint64 * ticks, uint64 * log_entries, uint64 * log_packets)
+{
+	m_periodicStatsLock.Acquire();
+	*ticks = m_periodicTicks;
+	*log_entries = m_periodicLogEntries;
+	*log_packets = m_periodicLogPackets;
+	m_periodicStatsLock.Release();
+}
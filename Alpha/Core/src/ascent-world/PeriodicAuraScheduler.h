@@ -0,0 +1,174 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// PeriodicAuraScheduler.h
+//
+
+#ifndef __PERIODICAURASCHEDULER_H
+#define __PERIODICAURASCHEDULER_H
+
+class Aura;
+class Unit;
+struct SpellEntry;
+
+/** Which Aura::EventPeriodic* function a tick calls.
+ */
+enum PeriodicAuraTickType
+{
+	PERIODIC_TICK_NONE,
+	PERIODIC_TICK_DAMAGE,
+	PERIODIC_TICK_DAMAGE_PERCENT,
+	PERIODIC_TICK_HEAL,
+	PERIODIC_TICK_HEAL1,
+	PERIODIC_TICK_TRIGGER_SPELL,
+	PERIODIC_TICK_ENERGIZE,
+	PERIODIC_TICK_LEECH,
+	PERIODIC_TICK_BURN,
+	PERIODIC_TICK_HEALTH_FUNNEL,
+	PERIODIC_TICK_MANA_LEECH,
+	PERIODIC_TICK_HEAL_PCT,
+	PERIODIC_TICK_MANA_PCT,
+	PERIODIC_TICK_DRINK,
+	PERIODIC_TICK_REGEN_MANA_STAT_PCT
+};
+
+#define MAX_AURA_PERIODIC_TICKS 3
+#define PERIODIC_AURA_INVALID_HANDLE 0xFFFFFFFF
+
+/** One periodic effect of an aura. eventType is the EVENT_AURA_* id the tick used
+ * to be registered with, lookups and removals still go by it.
+ */
+struct PeriodicAuraTick
+{
+	uint8 type;
+	uint32 eventType;
+	uint32 period;
+
+	uint32 handle;		// entry in the scheduler, PERIODIC_AURA_INVALID_HANDLE while parked
+	uint32 timeLeft;	// time to the next tick while parked
+
+	uint32 amount;
+	uint32 misc;
+	float pct;
+	SpellEntry * spell;
+};
+
+/** The buckets are 128ms wide, one turn of the wheel covers 32 seconds. Ticks further
+ * away stay in their bucket until the turn they are due in.
+ */
+#define PERIODIC_AURA_BUCKET_SHIFT 7
+#define PERIODIC_AURA_BUCKETS 256
+#define PERIODIC_AURA_BUCKET_MASK (PERIODIC_AURA_BUCKETS - 1)
+
+struct PeriodicAuraEntry
+{
+	Aura * aura;
+	uint32 due;
+	uint32 period;
+	uint16 serial;
+	uint8 tick;
+};
+
+/** Entries are not taken out of their bucket when they are removed, the serial
+ * of a removed or reused entry no longer matches and the item is dropped.
+ */
+struct PeriodicAuraBucketItem
+{
+	uint32 index;
+	uint16 serial;
+};
+
+typedef vector<PeriodicAuraBucketItem> PeriodicAuraBucket;
+
+/** Fires the ticks and sends the logs of a PeriodicAuraScheduler, the map it
+ * belongs to for the world server.
+ */
+class PeriodicAuraHandler
+{
+public:
+	virtual ~PeriodicAuraHandler() {}
+
+	virtual void FirePeriodicTick(Aura * aura, uint8 tick) = 0;
+	virtual void SendPeriodicAuraLog(const uint64 & sender, WorldPacket * data) = 0;
+};
+
+/** Ticks of the periodic auras of every unit on one MapMgr. The ticks are kept in
+ * a flat pool and bucketed by due time, MapMgr fires everything that is due once
+ * per update. Ticks of an aura which are due together fire back to back and their
+ * SMSG_PERIODICAURALOG entries are sent as one packet.
+ */
+class PeriodicAuraScheduler
+{
+public:
+	PeriodicAuraScheduler();
+
+	ASCENT_INLINE void SetHandler(PeriodicAuraHandler * handler) { m_handler = handler; }
+
+	/** Schedules tick of aura to fire in delay ms and every period ms after that.
+	 */
+	uint32 Add(Aura * aura, uint8 tick, uint32 delay, uint32 period);
+	void Remove(uint32 handle);
+	uint32 GetTimeLeft(uint32 handle);
+
+	void Update(uint32 time_difference);
+
+	/** Adds an entry to the SMSG_PERIODICAURALOG of the aura being fired, returns
+	 * false if the caller has to send the packet itself. The log is sent before a
+	 * tick of another aura fires.
+	 */
+	bool AddLogEntry(Unit * sender, Unit * target, const uint64 & caster, uint32 spell, const uint32 * entry, uint32 words);
+
+	ASCENT_INLINE uint32 GetScheduledCount() { return (uint32)(m_entries.size() - m_free.size()); }
+
+	/** Totals of every scheduler: ticks fired, log entries and the packets they were sent in.
+	 */
+	static void GetStatistics(uint64 * ticks, uint64 * log_entries, uint64 * log_packets);
+
+private:
+	void _Insert(uint32 index);
+	void _FlushLog();
+
+	Mutex m_lock;
+	PeriodicAuraHandler * m_handler;
+
+	// ms processed so far, ticks fire once it reaches their due time
+	uint32 m_time;
+	vector<PeriodicAuraEntry> m_entries;
+	vector<uint32> m_free;
+	PeriodicAuraBucket m_buckets[PERIODIC_AURA_BUCKETS];
+	PeriodicAuraBucket m_firing;
+
+	// log of the aura being fired
+	bool m_logging;
+	WorldPacket m_log;
+	uint64 m_logSender;		// resolved by the handler when the log is sent
+	uint64 m_logTarget;
+	uint64 m_logCaster;
+	uint32 m_logSpell;
+	uint32 m_logCount;
+	size_t m_logCountPos;
+
+	// statistics of the current update
+	uint32 m_fired;
+	uint32 m_logEntries;
+	uint32 m_logPackets;
+};
+
+#endif
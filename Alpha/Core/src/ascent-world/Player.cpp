@@ -271,6 +271,7 @@ Player::Player( uint32 guid ) : m_mailBox(guid)
 	pctReputationMod		= 0;
 	roll					= 0;
 	mUpdateCount			= 0;
+	mUpdateSize				= 0;
     mCreationCount          = 0;
     bCreationBuffer.reserve(40000);
 	bUpdateBuffer.reserve(30000);//ought to be > than enough ;)
@@ -290,6 +291,8 @@ Player::Player( uint32 guid ) : m_mailBox(guid)
 
 	m_AreaID				= 0;
 	m_actionsDirty		  = false;
+	m_cooldownsDirty		= false;
+	m_savedColumns		  = new CharacterSaveHashes;
 	cannibalizeCount		= 0;
 	rageFromDamageDealt	 = 0;
 
@@ -327,6 +330,7 @@ Player::Player( uint32 guid ) : m_mailBox(guid)
 	rename_pending = false;
 	iInstanceType		   = 0;
 	memset(reputationByListId, 0, sizeof(FactionReputation*) * 128);
+	memset(m_hostileReputation, 0, sizeof(m_hostileReputation));
 
 	m_comboTarget = 0;
 	m_comboPoints = 0;
@@ -419,6 +423,12 @@ Player::~Player ( )
 	// performs a lot of cleanup that can be touched by scheduled callbacks.
 	sEventMgr.RemoveEvents(this);
 
+	// drop our references to shared update blocks
+	_ClearUpdateSegments();
+
+	// saves still queued keep their own reference
+	m_savedColumns->Release();
+
 	if(!ok_to_remove)
 	{
 		printf("Player deleted from non-logoutplayer!\n");
@@ -2020,10 +2030,146 @@ void Player::DestroyForPlayer( Player *target ) const
 
 #define IS_ARENA(x) ( (x) >= BATTLEGROUND_ARENA_2V2 && (x) <= BATTLEGROUND_ARENA_5V5 )
 
+void CharacterSaveHashes::AddRef()
+{
+	m_lock.Acquire();
+	++m_refs;
+	m_lock.Release();
+}
+
+void CharacterSaveHashes::Release()
+{
+	m_lock.Acquire();
+	uint32 refs = --m_refs;
+	m_lock.Release();
+
+	if(refs == 0)
+		delete this;
+}
+
+bool CharacterSaveHashes::Get(uint32 * hashes)
+{
+	m_lock.Acquire();
+	bool valid = m_valid;
+	if(valid)
+		memcpy(hashes, m_hashes, sizeof(m_hashes));
+	m_lock.Release();
+	return valid;
+}
+
+void CharacterSaveHashes::Set(const uint32 * hashes)
+{
+	m_lock.Acquire();
+	memcpy(m_hashes, hashes, sizeof(m_hashes));
+	m_valid = true;
+	m_lock.Release();
+}
+
+void CharacterSaveHashes::Invalidate()
+{
+	m_lock.Acquire();
+	m_valid = false;
+	m_lock.Release();
+}
+
+/** Commits the hashes of a periodic save once its query buffer is written. A failed
+ * save may have left any of the columns behind, so the next one writes all of them.
+ */
+class CharacterSaveCallback : public QueryBufferCallback
+{
+public:
+	CharacterSaveCallback(CharacterSaveHashes * saved, const uint32 * hashes) : m_saved(saved)
+	{
+		m_saved->AddRef();
+		memcpy(m_hashes, hashes, sizeof(m_hashes));
+	}
+
+	~CharacterSaveCallback()
+	{
+		m_saved->Release();
+	}
+
+	void OnComplete(bool success)
+	{
+		if(success)
+			m_saved->Set(m_hashes);
+		else
+			m_saved->Invalidate();
+	}
+
+private:
+	CharacterSaveHashes * m_saved;
+	uint32 m_hashes[NUM_CHARACTER_SAVE_COLUMNS];
+};
+
+/** Builds the characters row, either as the values of a REPLACE INTO for new characters
+ * or as the assignments of an UPDATE which leaves out the text columns that match the
+ * committed hashes. The hashes of every text column end up in hashes.
+ */
+class CharacterSaveStatement
+{
+public:
+	CharacterSaveStatement(bool update, const uint32 * committed, uint32 * hashes) : m_update(update), m_first(true), m_committed(committed), m_hashes(hashes) {}
+
+	template<typename T>
+	void Column(const char * name, const T & value)
+	{
+		_Next(name);
+		m_ss << value;
+	}
+
+	void Text(const char * name, const string & value)
+	{
+		_Next(name);
+		m_ss << "'" << value << "'";
+	}
+
+	/** Text column which is skipped by an update if its contents match the last save.
+	 */
+	void TrackedText(const char * name, uint32 column, const string & value)
+	{
+		uint32 hash = (uint32)crc32((const unsigned char*)value.data(), (unsigned int)value.size());
+		m_hashes[column] = hash;
+		if(m_update && m_committed != NULL && m_committed[column] == hash)
+			return;
+
+		Text(name, value);
+	}
+
+	string Finish(uint32 guid)
+	{
+		if(m_update)
+			m_ss << " WHERE guid = " << guid;
+		else
+			m_ss << ")";
+		return m_ss.str();
+	}
+
+private:
+	void _Next(const char * name)
+	{
+		if(m_first)
+			m_ss << (m_update ? "UPDATE characters SET " : "REPLACE INTO characters VALUES (");
+		else
+			m_ss << ",";
+
+		if(m_update)
+			m_ss << name << "=";
+		m_first = false;
+	}
+
+	std::stringstream m_ss;
+	bool m_update;
+	bool m_first;
+	const uint32 * m_committed;
+	uint32 * m_hashes;
+};
+
 void Player::SaveToDB(bool bNewCharacter /* =false */)
 {
 	bool in_arena = false;
 	QueryBuffer * buf = NULL;
+	uint32 start = getMSTime();
 	if(!bNewCharacter)
 		buf = new QueryBuffer;
 
@@ -2039,33 +2185,40 @@ void Player::SaveToDB(bool bNewCharacter /* =false */)
 	m_playedtime[1] += playedt;
 	m_playedtime[2] += playedt;
 	
+	// the row of a new character is written as a whole, after that only what changed
+	// since the last save that made it to the database
+	uint32 committed[NUM_CHARACTER_SAVE_COLUMNS];
+	uint32 hashes[NUM_CHARACTER_SAVE_COLUMNS];
+	bool have_committed = !bNewCharacter && m_savedColumns->Get(committed);
+	CharacterSaveStatement stmt(!bNewCharacter, have_committed ? committed : NULL, hashes);
 	std::stringstream ss;
-	ss << "REPLACE INTO characters VALUES ("
-		
-	<< GetLowGUID() << ", "
-	<< GetSession()->GetAccountId() << ","
+
+	if(bNewCharacter)
+	{
+		stmt.Column("guid", GetLowGUID());
+		stmt.Column("acct", GetSession()->GetAccountId());
+	}
 
 	// stat saving
-	<< "'" << m_name << "', "
-	<< uint32(getRace()) << ","
-	<< uint32(getClass()) << ","
-	<< uint32(getGender()) << ",";
+	stmt.Text("name", m_name);
+	stmt.Column("race", uint32(getRace()));
+	stmt.Column("class", uint32(getClass()));
+	stmt.Column("gender", uint32(getGender()));
 
 	if(m_uint32Values[UNIT_FIELD_FACTIONTEMPLATE] != info->factiontemplate)
-		ss << m_uint32Values[UNIT_FIELD_FACTIONTEMPLATE] << ",";
+		stmt.Column("custom_faction", m_uint32Values[UNIT_FIELD_FACTIONTEMPLATE]);
 	else
-		ss << "0,";
+		stmt.Column("custom_faction", 0);
 
-	ss << uint32(getLevel()) << ","
-	<< m_uint32Values[PLAYER_XP] << ","
+	stmt.Column("level", uint32(getLevel()));
+	stmt.Column("xp", m_uint32Values[PLAYER_XP]);
 	
 	// dump exploration data
-	<< "'";
-
 	for(uint32 i = 0; i < 64; ++i)
 		ss << m_uint32Values[PLAYER_EXPLORED_ZONES_1 + i] << ",";
 
-	ss << "','";
+	stmt.TrackedText("exploration_data", CHARACTER_SAVE_EXPLORATION, ss.str());
+	ss.str("");
 
 	// dump skill data
 	/*for(uint32 i=PLAYER_SKILL_INFO_1_1;i<PLAYER_CHARACTER_POINTS1;i+=3)
@@ -2091,6 +2244,9 @@ void Player::SaveToDB(bool bNewCharacter /* =false */)
 		}
 	}
 
+	stmt.TrackedText("skills", CHARACTER_SAVE_SKILLS, ss.str());
+	ss.str("");
+
 	uint32 player_flags = m_uint32Values[PLAYER_FLAGS];
 	{
 		// Remove un-needed and problematic player flags from being saved :p
@@ -2108,114 +2264,112 @@ void Player::SaveToDB(bool bNewCharacter /* =false */)
 			player_flags &= ~PLAYER_FLAG_FREE_FOR_ALL_PVP;
 	}
 
-	ss << "', "
-	<< m_uint32Values[PLAYER_FIELD_WATCHED_FACTION_INDEX] << ","
-	<< m_uint32Values[PLAYER_CHOSEN_TITLE] << ","
-	<< m_uint32Values[PLAYER__FIELD_KNOWN_TITLES] << ","
-	<< m_uint32Values[PLAYER_FIELD_COINAGE] << ","
-	<< m_uint32Values[PLAYER_AMMO_ID] << ","
-	<< m_uint32Values[PLAYER_CHARACTER_POINTS2] << ",";
+	stmt.Column("watched_faction_index", m_uint32Values[PLAYER_FIELD_WATCHED_FACTION_INDEX]);
+	stmt.Column("selected_pvp_title", m_uint32Values[PLAYER_CHOSEN_TITLE]);
+	stmt.Column("available_pvp_titles", m_uint32Values[PLAYER__FIELD_KNOWN_TITLES]);
+	stmt.Column("gold", m_uint32Values[PLAYER_FIELD_COINAGE]);
+	stmt.Column("ammo_id", m_uint32Values[PLAYER_AMMO_ID]);
+	stmt.Column("available_prof_points", m_uint32Values[PLAYER_CHARACTER_POINTS2]);
 
 	if (m_uint32Values[PLAYER_CHARACTER_POINTS1] > 61 &&  ! GetSession()->HasGMPermissions())
             SetUInt32Value(PLAYER_CHARACTER_POINTS1, 61);
-	ss << m_uint32Values[PLAYER_CHARACTER_POINTS1] << ","
-	<< load_health << ","
-	<< load_mana << ","
-	<< uint32(GetPVPRank()) << ","
-	<< m_uint32Values[PLAYER_BYTES] << ","
-	<< m_uint32Values[PLAYER_BYTES_2] << ","
-	<< player_flags << ","
-	<< m_uint32Values[PLAYER_FIELD_BYTES] << ",";
+	stmt.Column("available_talent_points", m_uint32Values[PLAYER_CHARACTER_POINTS1]);
+	stmt.Column("current_hp", load_health);
+	stmt.Column("current_power", load_mana);
+	stmt.Column("pvprank", uint32(GetPVPRank()));
+	stmt.Column("bytes", m_uint32Values[PLAYER_BYTES]);
+	stmt.Column("bytes2", m_uint32Values[PLAYER_BYTES_2]);
+	stmt.Column("player_flags", player_flags);
+	stmt.Column("player_bytes", m_uint32Values[PLAYER_FIELD_BYTES]);
 
 	if( in_arena )
 	{
 		// if its an arena, save the entry coords instead
-		ss << m_bgEntryPointX << ", ";
-		ss << m_bgEntryPointY << ", ";
-		ss << m_bgEntryPointZ << ", ";
-		ss << m_bgEntryPointO << ", ";
-		ss << m_bgEntryPointMap << ", ";
+		stmt.Column("positionX", m_bgEntryPointX);
+		stmt.Column("positionY", m_bgEntryPointY);
+		stmt.Column("positionZ", m_bgEntryPointZ);
+		stmt.Column("orientation", m_bgEntryPointO);
+		stmt.Column("mapId", m_bgEntryPointMap);
 	}
 	else
 	{
 		// save the normal position
-		ss << m_position.x << ", "
-			<< m_position.y << ", "
-			<< m_position.z << ", "
-			<< m_position.o << ", "
-			<< m_mapId << ", ";
+		stmt.Column("positionX", m_position.x);
+		stmt.Column("positionY", m_position.y);
+		stmt.Column("positionZ", m_position.z);
+		stmt.Column("orientation", m_position.o);
+		stmt.Column("mapId", m_mapId);
 	}
 
-	ss << m_zoneId << ", '";
+	stmt.Column("zoneId", m_zoneId);
 		
 	for(uint32 i = 0; i < 8; i++ )
 		ss << m_taximask[i] << " ";
-	ss << "', "
+
+	stmt.TrackedText("taximask", CHARACTER_SAVE_TAXIMASK, ss.str());
+	ss.str("");
 	
-	<< m_banned << ", '"
-	<< CharacterDatabase.EscapeString(m_banreason) << "', "
-	<< (uint32)UNIXTIME << ",";
+	stmt.Column("banned", m_banned);
+	stmt.Text("banReason", CharacterDatabase.EscapeString(m_banreason));
+	stmt.Column("timestamp", (uint32)UNIXTIME);
 	
 	//online state
 	if(GetSession()->_loggingOut || bNewCharacter)
-	{
-		ss << "0,";
-	}else
-	{
-		ss << "1,";
-	}
+		stmt.Column("online", 0);
+	else
+		stmt.Column("online", 1);
 
-	ss	 
-	<< m_bind_pos_x			 << ", "
-	<< m_bind_pos_y			 << ", "
-	<< m_bind_pos_z			 << ", "
-	<< m_bind_mapid			 << ", "
-	<< m_bind_zoneid			<< ", "
+	stmt.Column("bindpositionX", m_bind_pos_x);
+	stmt.Column("bindpositionY", m_bind_pos_y);
+	stmt.Column("bindpositionZ", m_bind_pos_z);
+	stmt.Column("bindmapId", m_bind_mapid);
+	stmt.Column("bindzoneId", m_bind_zoneid);
 		
-	<< uint32(m_isResting)	  << ", "
-	<< uint32(m_restState)	  << ", "
-	<< uint32(m_restAmount)	 << ", '"
+	stmt.Column("isResting", uint32(m_isResting));
+	stmt.Column("restState", uint32(m_restState));
+	stmt.Column("restTime", uint32(m_restAmount));
 	  
-	<< uint32(m_playedtime[0])  << " "
-	<< uint32(m_playedtime[1])  << " "
-	<< uint32(playedt)		  << " ', "
-	<< uint32(m_deathState)	 << ", "
-
-	<< m_talentresettimes	   << ", "
-	<< m_FirstLogin			 << ", "
-	<< rename_pending
-	<< "," << m_arenaPoints << ","
-		<< (uint32)m_StableSlotCount << ",";
+	ss << uint32(m_playedtime[0]) << " "
+		<< uint32(m_playedtime[1]) << " "
+		<< uint32(playedt) << " ";
+	stmt.Text("playedtime", ss.str());
+	ss.str("");
+
+	stmt.Column("deathstate", uint32(m_deathState));
+	stmt.Column("TalentResetTimes", m_talentresettimes);
+	stmt.Column("first_login", m_FirstLogin);
+	stmt.Column("forced_rename_pending", rename_pending);
+	stmt.Column("arenaPoints", m_arenaPoints);
+	stmt.Column("totalstableslots", (uint32)m_StableSlotCount);
 	
 	// instances
 	if( in_arena )
-	{
-		ss << m_bgEntryPointInstance << ", ";
-	}
+		stmt.Column("instance_id", m_bgEntryPointInstance);
 	else
-	{
-		ss << m_instanceId		   << ", ";
-	}
+		stmt.Column("instance_id", m_instanceId);
 
-	ss << m_bgEntryPointMap	  << ", " 
-	<< m_bgEntryPointX		<< ", " 
-	<< m_bgEntryPointY		<< ", " 
-	<< m_bgEntryPointZ		<< ", "
-	<< m_bgEntryPointO		<< ", "
-	<< m_bgEntryPointInstance << ", ";
+	stmt.Column("entrypointmap", m_bgEntryPointMap);
+	stmt.Column("entrypointx", m_bgEntryPointX);
+	stmt.Column("entrypointy", m_bgEntryPointY);
+	stmt.Column("entrypointz", m_bgEntryPointZ);
+	stmt.Column("entrypointo", m_bgEntryPointO);
+	stmt.Column("entrypointinstance", m_bgEntryPointInstance);
 
 	// taxi
 	if(m_onTaxi&&m_CurrentTaxiPath) {
-		ss << m_CurrentTaxiPath->GetID() << ", ";
-		ss << lastNode << ", ";
-		ss << GetUInt32Value(UNIT_FIELD_MOUNTDISPLAYID);
+		stmt.Column("taxi_path", m_CurrentTaxiPath->GetID());
+		stmt.Column("taxi_lastnode", lastNode);
+		stmt.Column("taxi_mountid", GetUInt32Value(UNIT_FIELD_MOUNTDISPLAYID));
 	} else {
-		ss << "0, 0, 0";
+		stmt.Column("taxi_path", 0);
+		stmt.Column("taxi_lastnode", 0);
+		stmt.Column("taxi_mountid", 0);
 	}
 	
-	ss << "," << (m_CurrentTransporter ? m_CurrentTransporter->GetEntry() : (uint32)0);
-	ss << ",'" << m_TransporterX << "','" << m_TransporterY << "','" << m_TransporterZ << "'";
-	ss << ",'";
+	stmt.Column("transporter", (m_CurrentTransporter ? m_CurrentTransporter->GetEntry() : (uint32)0));
+	stmt.Column("transporter_xdiff", m_TransporterX);
+	stmt.Column("transporter_ydiff", m_TransporterY);
+	stmt.Column("transporter_zdiff", m_TransporterZ);
 
 	// Dump spell data to stringstream
 	SpellSet::iterator spellItr = mSpells.begin();
@@ -2223,22 +2377,26 @@ void Player::SaveToDB(bool bNewCharacter /* =false */)
 	{
 		ss << uint32(*spellItr) << ",";
 	}
-	ss << "','";
+	stmt.TrackedText("spells", CHARACTER_SAVE_SPELLS, ss.str());
+	ss.str("");
+
 	// Dump deleted spell data to stringstream
 	spellItr = mDeletedSpells.begin();
 	for(; spellItr != mDeletedSpells.end(); ++spellItr)
 	{
 		ss << uint32(*spellItr) << ",";
 	}
+	stmt.TrackedText("deleted_spells", CHARACTER_SAVE_DELETED_SPELLS, ss.str());
+	ss.str("");
 
-	ss << "','";
 	// Dump reputation data
 	ReputationMap::iterator iter = m_reputation.begin();
 	for(; iter != m_reputation.end(); ++iter)
 	{
 		ss << int32(iter->first) << "," << int32(iter->second->flag) << "," << int32(iter->second->baseStanding) << "," << int32(iter->second->standing) << ",";
 	}
-	ss << "','";
+	stmt.TrackedText("reputation", CHARACTER_SAVE_REPUTATION, ss.str());
+	ss.str("");
 	
 	// Add player action bars
 	for(uint32 i = 0; i < 120; ++i)
@@ -2247,13 +2405,15 @@ void Player::SaveToDB(bool bNewCharacter /* =false */)
 			<< uint32(mActions[i].Misc) << ","
 			<< uint32(mActions[i].Type) << ",";
 	}
-	ss << "','";
+	stmt.TrackedText("actions", CHARACTER_SAVE_ACTIONS, ss.str());
+	ss.str("");
 
 	if(!bNewCharacter)
 		SaveAuras(ss);
 
 //	ss << LoadAuras;
-	ss << "','";
+	stmt.TrackedText("auras", CHARACTER_SAVE_AURAS, ss.str());
+	ss.str("");
 
 	// Add player finished quests
 	set<uint32>::iterator fq = m_finishedQuests.begin();
@@ -2261,8 +2421,9 @@ void Player::SaveToDB(bool bNewCharacter /* =false */)
 	{
 		ss << (*fq) << ",";
 	}
+	stmt.TrackedText("finished_quests", CHARACTER_SAVE_FINISHED_QUESTS, ss.str());
+	ss.str("");
 
-	ss << "', '";
 	DailyMutex.Acquire();
 	set<uint32>::iterator fdq = m_finishedDailies.begin();
 	for(; fdq != m_finishedDailies.end(); fdq++)
@@ -2270,17 +2431,28 @@ void Player::SaveToDB(bool bNewCharacter /* =false */)
 		ss << (*fdq) << ",";
 	}
 	DailyMutex.Release();
-	ss << "', ";
-	ss << m_honorRolloverTime << ", ";
-	ss << m_killsToday << ", " << m_killsYesterday << ", " << m_killsLifetime << ", ";
-	ss << m_honorToday << ", " << m_honorYesterday << ", ";
-	ss << m_honorPoints << ", ";
-    ss << iInstanceType << ")";
+	stmt.TrackedText("finisheddailies", CHARACTER_SAVE_FINISHED_DAILIES, ss.str());
+	ss.str("");
+
+	stmt.Column("honorRolloverTime", m_honorRolloverTime);
+	stmt.Column("killsToday", m_killsToday);
+	stmt.Column("killsYesterday", m_killsYesterday);
+	stmt.Column("killsLifeTime", m_killsLifetime);
+	stmt.Column("honorToday", m_honorToday);
+	stmt.Column("honorYesterday", m_honorYesterday);
+	stmt.Column("honorPoints", m_honorPoints);
+	stmt.Column("difficulty", iInstanceType);
 	
 	if(bNewCharacter)
-		CharacterDatabase.WaitExecuteNA(ss.str().c_str());
+	{
+		if(CharacterDatabase.WaitExecuteNA(stmt.Finish(GetLowGUID()).c_str()))
+			m_savedColumns->Set(hashes);
+	}
 	else
-		buf->AddQueryStr(ss.str());
+	{
+		buf->AddQueryStr(stmt.Finish(GetLowGUID()));
+		buf->SetCallback(new CharacterSaveCallback(m_savedColumns, hashes));
+	}
 
 	//Save Other related player stuff
 
@@ -2308,26 +2480,50 @@ void Player::SaveToDB(bool bNewCharacter /* =false */)
 	m_nextSave = getMSTime() + sWorld.getIntRate(INTRATE_SAVE);
 
 	if(buf)
+	{
+		sWorld.AddSaveStatistics(getMSTime() - start, (uint32)buf->GetSize(), (uint32)buf->GetCount());
 		CharacterDatabase.AddQueryBuffer(buf);
+	}
 }
 
 void Player::_SaveQuestLogEntry(QueryBuffer * buf)
 {
-	for(std::set<uint32>::iterator itr = m_removequests.begin(); itr != m_removequests.end(); ++itr)
+	std::stringstream ss;
+	if(m_removequests.size())
 	{
+		ss << "DELETE FROM questlog WHERE player_guid=" << GetLowGUID() << " AND quest_id IN(";
+		for(std::set<uint32>::iterator itr = m_removequests.begin(); itr != m_removequests.end(); ++itr)
+			ss << (itr == m_removequests.begin() ? "" : ",") << (*itr);
+		ss << ")";
+
 		if(buf == NULL)
-			CharacterDatabase.Execute("DELETE FROM questlog WHERE player_guid=%u AND quest_id=%u", GetLowGUID(), (*itr));
+			CharacterDatabase.Execute(ss.str().c_str());
 		else
-			buf->AddQuery("DELETE FROM questlog WHERE player_guid=%u AND quest_id=%u", GetLowGUID(), (*itr));
+			buf->AddQueryStr(ss.str());
+
+		ss.str("");
 	}
 
 	m_removequests.clear();
 
+	// all changed entries go out in one statement
+	uint32 count = 0;
 	for(int i = 0; i < 25; ++i)
 	{
-		if(m_questlog[i] != NULL)
-			m_questlog[i]->SaveToDB(buf);
+		if(m_questlog[i] == NULL || !m_questlog[i]->IsDirty())
+			continue;
+
+		ss << (count++ ? "," : "REPLACE INTO questlog VALUES");
+		m_questlog[i]->BuildSaveValues(ss);
 	}
+
+	if(count == 0)
+		return;
+
+	if(buf == NULL)
+		CharacterDatabase.Execute(ss.str().c_str());
+	else
+		buf->AddQueryStr(ss.str());
 }
 
 bool Player::canCast(SpellEntry *m_spellInfo)
@@ -2927,7 +3123,10 @@ void Player::LoadFromDBProc(QueryResultVector & results)
 
 		// do listid stuff
 		if(factdbc->RepListId >= 0)
+		{
 			reputationByListId[factdbc->RepListId] = rep;
+			_UpdateHostileReputation(factdbc->RepListId);
+		}
 	}
 
 	if(!m_reputation.size())
@@ -3738,7 +3937,7 @@ void Player::_ApplyItemMods(Item* item, int8 slot, bool apply, bool justdrokedow
 				ts.caster = this->GetGUID();
 				ts.procFlags = PROC_ON_MELEE_ATTACK;
 				ts.deleted = false;
-				m_procSpells.push_front( ts );			
+				AddProcTriggerSpell( ts );			
 			}
 		}
 	}
@@ -6719,6 +6918,7 @@ void Player::ClearCooldownForSpell(uint32 spell_id)
 				( i == COOLDOWN_TYPE_SPELL && itr2->first == spe->Id ) )
 			{
 				m_cooldownMap[i].erase( itr2 );
+				m_cooldownsDirty = true;
 			}
 		}
 	}
@@ -6814,10 +7014,11 @@ void Player::PushUpdateData(ByteBuffer *data, uint32 updatecount)
 	// that will fit into 2^16 bytes ( stupid client limitation on server packets )
 	// so if we get more than 63KB of update data, force an update and then append it
 	// to the clean buffer.
-	if( (data->size() + bUpdateBuffer.size() ) >= 63000 )
+	if( (data->size() + mUpdateSize ) >= 63000 )
 		ProcessPendingUpdates();
 
 	mUpdateCount += updatecount;
+	_AddUpdateSegment(NULL, bUpdateBuffer.size(), data->size());
 	bUpdateBuffer.append(*data);
 
 	// add to process queue
@@ -6830,6 +7031,61 @@ void Player::PushUpdateData(ByteBuffer *data, uint32 updatecount)
 	_bufferS.Release();
 }
 
+void Player::PushUpdateBlock(SharedUpdateBlock * block)
+{
+	_bufferS.Acquire();
+
+	// same 2^16 client limit as in PushUpdateData
+	if( (block->GetSize() + mUpdateSize ) >= 63000 )
+		ProcessPendingUpdates();
+
+	// only the reference is queued, the data is shared with all other viewers
+	block->AddRef();
+	mUpdateCount += block->GetCount();
+	_AddUpdateSegment(block, 0, block->GetSize());
+
+	// add to process queue
+	if(m_mapMgr && !bProcessPending)
+	{
+		bProcessPending = true;
+		m_mapMgr->PushToProcessed(this);
+	}
+
+	_bufferS.Release();
+}
+
+void Player::_AddUpdateSegment(SharedUpdateBlock * block, size_t offset, size_t size)
+{
+	mUpdateSize += size;
+
+	// consecutive private data is sent as one segment
+	if(block == NULL && mUpdateSegments.size() && mUpdateSegments.back().block == NULL)
+	{
+		mUpdateSegments.back().size += size;
+		return;
+	}
+
+	PendingUpdateSegment seg;
+	seg.block = block;
+	seg.offset = offset;
+	seg.size = size;
+	mUpdateSegments.push_back(seg);
+}
+
+void Player::_ClearUpdateSegments()
+{
+	for(std::vector<PendingUpdateSegment>::iterator itr = mUpdateSegments.begin(); itr != mUpdateSegments.end(); ++itr)
+	{
+		if(itr->block != NULL)
+			itr->block->DecRef();
+	}
+
+	mUpdateSegments.clear();
+	bUpdateBuffer.clear();
+	mUpdateSize = 0;
+	mUpdateCount = 0;
+}
+
 void Player::PushOutOfRange(const WoWGuid & guid)
 {
 	_bufferS.Acquire();
@@ -6871,88 +7127,115 @@ void Player::PushCreationData(ByteBuffer *data, uint32 updatecount)
 
 }
 
-void Player::ProcessPendingUpdates()
+uint32 Player::_BuildUpdatePackets(UpdatePacketJob ** jobs)
 {
-	_bufferS.Acquire();
-    if(!bUpdateBuffer.size() && !mOutOfRangeIds.size() && !bCreationBuffer.size())
+	UpdatePacketJob * job;
+	PendingUpdateSegment seg;
+	uint32 count = 0;
+
+	//build out of range updates if creation updates are queued
+	if(bCreationBuffer.size() || mOutOfRangeIdCount)
 	{
-		_bufferS.Release();
-		return;
+		job = sUpdateCompressor.AllocateJob();
+		job->player = this;
+		job->header << uint32((mOutOfRangeIds.size() > 0) ? (mCreationCount + 1) : mCreationCount);
+		job->header << uint8(1);
+
+		// append any out of range updates
+		if(mOutOfRangeIdCount)
+		{
+			job->header << uint8(UPDATETYPE_OUT_OF_RANGE_OBJECTS);
+			job->header << mOutOfRangeIdCount;
+			job->header.append(mOutOfRangeIds);
+			mOutOfRangeIds.clear();
+			mOutOfRangeIdCount = 0;
+		}
+
+		// the packet takes over our buffer, we get its empty one back
+		if(bCreationBuffer.size())
+		{
+			job->data.swap(bCreationBuffer);
+			seg.block = NULL;
+			seg.offset = 0;
+			seg.size = job->data.size();
+			job->segments.push_back(seg);
+		}
+
+		job->size = (uint32)(job->header.size() + job->data.size());
+		mCreationCount = 0;
+		jobs[count++] = job;
 	}
 
-	size_t bBuffer_size =  (bCreationBuffer.size() > bUpdateBuffer.size() ? bCreationBuffer.size() : bUpdateBuffer.size()) + 10 + (mOutOfRangeIds.size() * 9);
-    uint8 * update_buffer = new uint8[bBuffer_size];
-	size_t c = 0;
+	if(mUpdateSize)
+	{
+		job = sUpdateCompressor.AllocateJob();
+		job->player = this;
+		job->header << mUpdateCount;
+		job->header << uint8(1);
+		job->data.swap(bUpdateBuffer);
+		job->segments.swap(mUpdateSegments);
+		job->size = (uint32)(job->header.size() + mUpdateSize);
 
-    //build out of range updates if creation updates are queued
-    if(bCreationBuffer.size() || mOutOfRangeIdCount)
-    {
-        #ifdef USING_BIG_ENDIAN
-	        *(uint32*)&update_buffer[c] = swap32(uint32(((mOutOfRangeIds.size() > 0) ? (mCreationCount + 1) : mCreationCount)));	c += 4;
-        #else
-	        *(uint32*)&update_buffer[c] = ((mOutOfRangeIds.size() > 0) ? (mCreationCount + 1) : mCreationCount);	c += 4;
-        #endif
-	        update_buffer[c] = 1;																			   ++c;
-
-            // append any out of range updates
-	    if(mOutOfRangeIdCount)
-	    {
-		    update_buffer[c]				= UPDATETYPE_OUT_OF_RANGE_OBJECTS;			 ++c;
-            #ifdef USING_BIG_ENDIAN
-		            *(uint32*)&update_buffer[c]	 = swap32(mOutOfRangeIdCount);						  c += 4;
-            #else
-		            *(uint32*)&update_buffer[c]	 = mOutOfRangeIdCount;						  c += 4;
-            #endif
-		    memcpy(&update_buffer[c], mOutOfRangeIds.contents(), mOutOfRangeIds.size());   c += mOutOfRangeIds.size();
-		    mOutOfRangeIds.clear();
-		    mOutOfRangeIdCount = 0;
-	    }
+		mUpdateSize = 0;
+		mUpdateCount = 0;
+		jobs[count++] = job;
+	}
 
-        if(bCreationBuffer.size())
-			memcpy(&update_buffer[c], bCreationBuffer.contents(), bCreationBuffer.size());  c += bCreationBuffer.size();
+	return count;
+}
 
-        // clear our update buffer
-	    bCreationBuffer.clear();
-	    mCreationCount = 0;
+uint32 Player::TakePendingUpdates(UpdatePacketJob ** jobs)
+{
+	_bufferS.Acquire();
+	uint32 count = _BuildUpdatePackets(jobs);
+	if(count)
+		bProcessPending = false;
+	_bufferS.Release();
 
-        // compress update packet
-	    // while we said 350 before, i'm gonna make it 500 :D
-	    if(c < (size_t)sWorld.compression_threshold || !CompressAndSendUpdateBuffer((uint32)c, update_buffer))
-	    {
-		    // send uncompressed packet -> because we failed
-		    m_session->OutPacket(SMSG_UPDATE_OBJECT, (uint16)c, update_buffer);
-	    }
-    }
+	return count;
+}
 
-	if(bUpdateBuffer.size())
+void Player::SendUpdatePacket(UpdatePacketJob * job)
+{
+	if(job->output_size)
+		m_session->OutPacket(SMSG_COMPRESSED_UPDATE_OBJECT, (uint16)job->output_size, &job->output[0]);
+	else
 	{
-		c = 0;
+		// send uncompressed packet -> below the threshold or compression failed
+		job->CopyTo(job->output);
+		m_session->OutPacket(SMSG_UPDATE_OBJECT, (uint16)job->size, &job->output[0]);
+	}
 
-		#ifdef USING_BIG_ENDIAN
-			*(uint32*)&update_buffer[c] = swap32(uint32(((mOutOfRangeIds.size() > 0) ? (mUpdateCount + 1) : mUpdateCount)));	c += 4;
-		#else
-			*(uint32*)&update_buffer[c] = ((mOutOfRangeIds.size() > 0) ? (mUpdateCount + 1) : mUpdateCount);	c += 4;
-		#endif
-		update_buffer[c] = 1;																			   ++c;
-		memcpy(&update_buffer[c], bUpdateBuffer.contents(), bUpdateBuffer.size());  c += bUpdateBuffer.size();
+	sUpdateCompressor.FreeJob(job);
+}
 
-		// clear our update buffer
-		bUpdateBuffer.clear();
-		mUpdateCount = 0;
+void Player::ProcessPendingUpdates()
+{
+	UpdatePacketJob * jobs[2];
+	uint32 count;
 
-		// compress update packet
-		// while we said 350 before, i'm gonna make it 500 :D
-		if(c < (size_t)sWorld.compression_threshold || !CompressAndSendUpdateBuffer((uint32)c, update_buffer))
-		{
-			// send uncompressed packet -> because we failed
-			m_session->OutPacket(SMSG_UPDATE_OBJECT, (uint16)c, update_buffer);
-		}
+	_bufferS.Acquire();
+	count = _BuildUpdatePackets(jobs);
+	if(!count)
+	{
+		_bufferS.Release();
+		return;
 	}
-	
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		sUpdateCompressor.Compress(jobs[i]);
+		SendUpdatePacket(jobs[i]);
+	}
+
 	bProcessPending = false;
 	_bufferS.Release();
-	delete [] update_buffer;
 
+	SendDelayedPackets();
+}
+
+void Player::SendDelayedPackets()
+{
 	// send any delayed packets
 	WorldPacket * pck;
 	while(delayedPackets.size())
@@ -6972,81 +7255,11 @@ void Player::ProcessPendingUpdates()
 	}
 }
 
-bool Player::CompressAndSendUpdateBuffer(uint32 size, const uint8* update_buffer)
-{
-	uint32 destsize = size + size/10 + 16;
-	int rate = sWorld.getIntRate(INTRATE_COMPRESSION);
-	if(size >= 40000 && rate < 6)
-		rate = 6;
-
-	// set up stream
-	z_stream stream;
-	stream.zalloc = 0;
-	stream.zfree  = 0;
-	stream.opaque = 0;
-	
-	if(deflateInit(&stream, rate) != Z_OK)
-	{
-		sLog.outError("deflateInit failed.");
-		return false;
-	}
-
-	uint8 *buffer = new uint8[destsize];
-	//memset(buffer,0,destsize);	/* fix umr - burlex */
-	
-	// set up stream pointers
-	stream.next_out  = (Bytef*)buffer+4;
-	stream.avail_out = destsize;
-	stream.next_in   = (Bytef*)update_buffer;
-	stream.avail_in  = size;
-
-	// call the actual process
-	if(deflate(&stream, Z_NO_FLUSH) != Z_OK ||
-		stream.avail_in != 0)
-	{
-		sLog.outError("deflate failed.");
-		delete [] buffer;
-		return false;
-	}
-
-	// finish the deflate
-	if(deflate(&stream, Z_FINISH) != Z_STREAM_END)
-	{
-		sLog.outError("deflate failed: did not end stream");
-		delete [] buffer;
-		return false;
-	}
-
-	// finish up
-	if(deflateEnd(&stream) != Z_OK)
-	{
-		sLog.outError("deflateEnd failed.");
-		delete [] buffer;
-		return false;
-	}
-
-	// fill in the full size of the compressed stream
-#ifdef USING_BIG_ENDIAN
-	*(uint32*)&buffer[0] = swap32(size);
-#else
-	*(uint32*)&buffer[0] = size;
-#endif
-
-	// send it
-	m_session->OutPacket(SMSG_COMPRESSED_UPDATE_OBJECT, (uint16)stream.total_out + 4, buffer);
-
-	// cleanup memory
-	delete [] buffer;
-	
-	return true;
-}
-
 void Player::ClearAllPendingUpdates()
 {
 	_bufferS.Acquire();
 	bProcessPending = false;
-	mUpdateCount = 0;
-	bUpdateBuffer.clear();
+	_ClearUpdateSegments();
 	_bufferS.Release();
 }
 
@@ -10106,6 +10319,7 @@ void Player::_Cooldown_Add(uint32 Type, uint32 Misc, uint32 Time, uint32 SpellId
 
 		m_cooldownMap[Type].insert( make_pair( Misc, cd ) );
 	}
+	m_cooldownsDirty = true;
 
 #ifdef _DEBUG
 	Log.Debug("Cooldown", "added cooldown for type %u misc %u time %u item %u spell %u", Type, Misc, Time - getMSTime(), ItemId, SpellId);
@@ -10378,9 +10592,15 @@ void Player::_SavePlayerCooldowns(QueryBuffer * buf)
 	PlayerCooldownMap::iterator itr2;
 	uint32 i;
 	uint32 seconds;
+	uint32 count = 0;
 	uint32 mstime = getMSTime();
+	std::stringstream ss;
 
-	// clear them (this should be replaced with an update queue later)
+	// cooldowns that merely ran out do not have to be removed, they are skipped on load
+	if( !m_cooldownsDirty )
+		return;
+
+	// clear them and write the remaining ones in one statement
 	if( buf != NULL )
 		buf->AddQuery("DELETE FROM playercooldowns WHERE player_guid = %u", m_uint32Values[OBJECT_FIELD_GUID] );		// 0 is guid always
 	else
@@ -10412,18 +10632,20 @@ void Player::_SavePlayerCooldowns(QueryBuffer * buf)
 			seconds = (itr2->second.ExpireTime - mstime) / 1000;
 			// this shouldnt ever be nonzero because of our check before, so no check needed
 			
-			if( buf != NULL )
-			{
-				buf->AddQuery( "INSERT INTO playercooldowns VALUES(%u, %u, %u, %u, %u, %u)", m_uint32Values[OBJECT_FIELD_GUID],
-					i, itr2->first, seconds + (uint32)UNIXTIME, itr2->second.SpellId, itr2->second.ItemId );
-			}
-			else
-			{
-				CharacterDatabase.Execute( "INSERT INTO playercooldowns VALUES(%u, %u, %u, %u, %u, %u)", m_uint32Values[OBJECT_FIELD_GUID],
-					i, itr2->first, seconds + (uint32)UNIXTIME, itr2->second.SpellId, itr2->second.ItemId );
-			}
+			ss << (count++ ? "," : "INSERT INTO playercooldowns VALUES");
+			ss << "(" << m_uint32Values[OBJECT_FIELD_GUID] << "," << i << "," << itr2->first << "," << seconds + (uint32)UNIXTIME << ","
+				<< itr2->second.SpellId << "," << itr2->second.ItemId << ")";
 		}
 	}
+
+	m_cooldownsDirty = false;
+	if( count == 0 )
+		return;
+
+	if( buf != NULL )
+		buf->AddQueryStr( ss.str() );
+	else
+		CharacterDatabase.Execute( ss.str().c_str() );
 }
 
 void Player::_LoadPlayerCooldowns(QueryResult * result)
@@ -77,6 +77,48 @@ enum Races
 	RACE_DRAENEI = 11,
 };
 
+/** Text columns of the characters row. A periodic save only rewrites the ones whose
+ * contents changed since they were last written.
+ */
+enum CharacterSaveColumns
+{
+	CHARACTER_SAVE_EXPLORATION,
+	CHARACTER_SAVE_SKILLS,
+	CHARACTER_SAVE_TAXIMASK,
+	CHARACTER_SAVE_SPELLS,
+	CHARACTER_SAVE_DELETED_SPELLS,
+	CHARACTER_SAVE_REPUTATION,
+	CHARACTER_SAVE_ACTIONS,
+	CHARACTER_SAVE_AURAS,
+	CHARACTER_SAVE_FINISHED_QUESTS,
+	CHARACTER_SAVE_FINISHED_DAILIES,
+	NUM_CHARACTER_SAVE_COLUMNS,
+};
+
+/** crc32 of the text columns as they were last committed. The callbacks of pending saves
+ * hold a reference too, as they can complete after the player is gone.
+ */
+class CharacterSaveHashes
+{
+public:
+	CharacterSaveHashes() : m_refs(1), m_valid(false) {}
+
+	void AddRef();
+	void Release();
+
+	/** Copies the committed hashes, returns false if nothing was committed yet.
+	 */
+	bool Get(uint32 * hashes);
+	void Set(const uint32 * hashes);
+	void Invalidate();
+
+private:
+	Mutex m_lock;
+	uint32 m_refs;
+	bool m_valid;
+	uint32 m_hashes[NUM_CHARACTER_SAVE_COLUMNS];
+};
+
 enum PlayerStatus
 {
 	NONE			 = 0,
@@ -947,6 +989,7 @@ public:
 	bool                IsAtWar(uint32 Faction);
 	Standing            GetStandingRank(uint32 Faction);
 	bool                IsHostileBasedOnReputation(FactionDBC * dbc);
+	void                _UpdateHostileReputation(int32 ListId);
 	void                UpdateInrangeSetsBasedOnReputation();
 	void                Reputation_OnKilledUnit(Unit * pUnit, bool InnerLoop);
 	void                Reputation_OnTalk(FactionDBC * dbc);
@@ -1281,7 +1324,7 @@ public:
 		if(itr == m_visibleObjects.end())
 			return;
 
-		m_visibleObjects.erase(obj);
+		m_visibleObjects.erase(itr);
 		PushOutOfRange(obj->GetNewGUID());
 	}
 
@@ -1458,10 +1501,13 @@ public:
 	bool bProcessPending;
 	Mutex _bufferS;
 	void PushUpdateData(ByteBuffer *data, uint32 updatecount);
+	void PushUpdateBlock(SharedUpdateBlock * block);
     void PushCreationData(ByteBuffer *data, uint32 updatecount);
 	void PushOutOfRange(const WoWGuid & guid);
 	void ProcessPendingUpdates();
-	bool __fastcall CompressAndSendUpdateBuffer(uint32 size, const uint8* update_buffer);
+	uint32 TakePendingUpdates(UpdatePacketJob ** jobs);
+	void SendUpdatePacket(UpdatePacketJob * job);
+	void SendDelayedPackets();
 	void ClearAllPendingUpdates();
 	
 	uint32 GetArmorProficiency() { return armor_proficiency; }
@@ -1585,6 +1631,8 @@ public:
 	ASCENT_INLINE void LastHonorResetTime(uint32 val) { m_lastHonorResetTime = val; }
 	uint32 OnlineTime;
 	bool tutorialsDirty;
+	bool m_cooldownsDirty;
+	CharacterSaveHashes * m_savedColumns;
 	LevelInfo * lvlinfo;
 	void CalculateBaseStats();
 	uint32 load_health;
@@ -1608,6 +1656,7 @@ public:
 	// spell to (delay, last time)
 	
 	FactionReputation * reputationByListId[128];
+	uint32 m_hostileReputation[4];	// bit per reputation list id, at war or hostile standing
 	
 	uint64 m_comboTarget;
 	int8 m_comboPoints;
@@ -1751,11 +1800,16 @@ protected:
 	/* Update system components */
 	ByteBuffer bUpdateBuffer;
     ByteBuffer bCreationBuffer;
+	std::vector<PendingUpdateSegment> mUpdateSegments;
+	size_t mUpdateSize;
 	uint32 mUpdateCount;
     uint32 mCreationCount;
 	uint32 mOutOfRangeIdCount;
 	ByteBuffer mOutOfRangeIds;
 	SplineMap _splineMap;
+	void _AddUpdateSegment(SharedUpdateBlock * block, size_t offset, size_t size);
+	void _ClearUpdateSegments();
+	uint32 _BuildUpdatePackets(UpdatePacketJob ** jobs);
 	/* End update system */
 
 	void _LoadTutorials(QueryResult * result);
@@ -1857,7 +1911,7 @@ protected:
 	// Channels
 	std::set<Channel*> m_channels;
 	// Visible objects
-	std::set<Object*> m_visibleObjects;
+	InRangeSet m_visibleObjects;
 	// Groups/Raids
 	uint32 m_GroupInviter;
 	uint8 m_StableSlotCount;
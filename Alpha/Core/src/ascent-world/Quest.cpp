@@ -221,7 +221,19 @@ void QuestLogEntry::SaveToDB(QueryBuffer * buf)
 	//Made this into a replace not an insert
 	//CharacterDatabase.Execute("DELETE FROM questlog WHERE player_guid=%u AND quest_id=%u", m_plr->GetGUIDLow(), m_quest->id);
 	std::stringstream ss;
-	ss << "REPLACE INTO questlog VALUES(";
+	ss << "REPLACE INTO questlog VALUES";
+	BuildSaveValues(ss);
+	
+	if( buf == NULL )
+		CharacterDatabase.Execute( ss.str().c_str() );
+	else
+		buf->AddQueryStr(ss.str());
+}
+
+void QuestLogEntry::BuildSaveValues(std::stringstream & ss)
+{
+	ASSERT(m_slot != -1);
+	ss << "(";
 	ss << m_plr->GetLowGUID() << "," << m_quest->id << "," << m_slot << "," << m_time_left;
 	for(int i = 0; i < 4; ++i)
 		ss << "," << m_explored_areas[i];
@@ -230,11 +242,7 @@ void QuestLogEntry::SaveToDB(QueryBuffer * buf)
 		ss << "," << m_mobcount[i];
 
 	ss << ")";
-	
-	if( buf == NULL )
-		CharacterDatabase.Execute( ss.str().c_str() );
-	else
-		buf->AddQueryStr(ss.str());
+	mDirty = false;
 }
 
 bool QuestLogEntry::LoadFromDB(Field *fields)
@@ -307,6 +315,8 @@ void QuestLogEntry::SubtractTime(uint32 value)
 		m_time_left = 0;
 	else
 		m_time_left-=value;
+
+	mDirty = true;
 }
 
 void QuestLogEntry::SetMobCount(uint32 i, uint32 count)
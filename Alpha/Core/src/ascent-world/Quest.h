@@ -218,6 +218,10 @@ public:
 	bool CanBeFinished();
 	void SubtractTime(uint32 value);
 	void SaveToDB(QueryBuffer * buf);
+	ASCENT_INLINE bool IsDirty() { return mDirty; }
+	/** Appends the (...) values of the questlog row and clears the dirty flag.
+	 */
+	void BuildSaveValues(std::stringstream & ss);
 	bool LoadFromDB(Field *fields);
 	void UpdatePlayerFields();
 
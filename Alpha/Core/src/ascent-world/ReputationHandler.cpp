@@ -156,6 +156,7 @@ void Player::_InitialReputation()
 			}				 
 				
 			reputationByListId[f->RepListId] = rep;
+			_UpdateHostileReputation(f->RepListId);
 		}
 		else
 		{
@@ -204,6 +205,7 @@ void Player::SetStanding(uint32 Faction, int32 Value)
 		if(RankChangedFlat(itr->second->standing, Value))
 		{
 			itr->second->standing = Value;
+			_UpdateHostileReputation(dbc->RepListId);
 			UpdateInrangeSetsBasedOnReputation();
 		}
 		else
@@ -241,6 +243,8 @@ void Player::SetStanding(uint32 Faction, int32 Value)
 		}
 	}
 
+	_UpdateHostileReputation(dbc->RepListId);
+
 #ifdef OPTIMIZED_PLAYER_SAVING
 	save_Reputation();
 #endif
@@ -256,8 +260,8 @@ bool Player::IsHostileBasedOnReputation(FactionDBC * dbc)
 	if(dbc->RepListId < 0 || dbc->RepListId >= 128)
 		return false;
 
-	FactionReputation * rep = reputationByListId[dbc->RepListId];
-	if(!rep) return false;
+	if(reputationByListId[dbc->RepListId] == NULL)
+		return false;
 
 	// forced reactions take precedence
 	if( m_forcedReactions.size() )
@@ -267,10 +271,8 @@ bool Player::IsHostileBasedOnReputation(FactionDBC * dbc)
 			return ( itr->second <= STANDING_HOSTILE ) ? true : false;
 	}
 
-	if(rep->flag & FACTION_FLAG_AT_WAR || GetReputationRankFromStanding(rep->standing) <= STANDING_HOSTILE)
-		return true;
-	else
-		return false;
+	// at war or hostile standing, kept up to date by _UpdateHostileReputation
+	return ( m_hostileReputation[dbc->RepListId >> 5] & (1 << (dbc->RepListId & 31)) ) ? true : false;
 
 	/*map<uint32, FactionReputation>::iterator itr = m_reputation.find(Faction);
 	if(itr == m_reputation.end()) return false;
@@ -280,6 +282,19 @@ bool Player::IsHostileBasedOnReputation(FactionDBC * dbc)
 		return false;*/
 }
 
+void Player::_UpdateHostileReputation(int32 ListId)
+{
+	if(ListId < 0 || ListId >= 128)
+		return;
+
+	FactionReputation * rep = reputationByListId[ListId];
+	uint32 bit = 1 << (ListId & 31);
+	if(rep != NULL && (AtWar(rep->flag) || GetReputationRankFromStanding(rep->standing) <= STANDING_HOSTILE))
+		m_hostileReputation[ListId >> 5] |= bit;
+	else
+		m_hostileReputation[ListId >> 5] &= ~bit;
+}
+
 void Player::ModStanding(uint32 Faction, int32 Value)
 {
 	ReputationMap::iterator itr = m_reputation.find(Faction);
@@ -310,6 +325,7 @@ void Player::ModStanding(uint32 Faction, int32 Value)
 		if(RankChanged(itr->second->standing, Value))
 		{
 			itr->second->standing += Value;
+			_UpdateHostileReputation(dbc->RepListId);
 			UpdateInrangeSetsBasedOnReputation();
 		}
 		else
@@ -344,6 +360,8 @@ void Player::ModStanding(uint32 Faction, int32 Value)
 		}
    }
 
+	_UpdateHostileReputation(dbc->RepListId);
+
 #ifdef OPTIMIZED_PLAYER_SAVING
 	save_Reputation();
 #endif
@@ -365,6 +383,7 @@ void Player::SetAtWar(uint32 Faction, bool Set)
 		if(!AtWar(rep->flag))
 			SetFlagAtWar(rep->flag);
 
+		_UpdateHostileReputation(Faction);
 		UpdateInrangeSetsBasedOnReputation();
 	}
 	else
@@ -372,6 +391,7 @@ void Player::SetAtWar(uint32 Faction, bool Set)
 		if(AtWar(rep->flag))
 			UnsetFlagAtWar(rep->flag);
 
+		_UpdateHostileReputation(Faction);
 		UpdateInrangeSetsBasedOnReputation();
 	}
 
@@ -0,0 +1,87 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// SharedUpdateBlock.h
+//
+
+#ifndef __SHAREDUPDATEBLOCK_H
+#define __SHAREDUPDATEBLOCK_H
+
+/** Values update of one object, built once per tick by the MapMgr and referenced
+ * by the pending update queue of every player that can see the object.
+ * The block is freed when the last player has sent it.
+ */
+class SharedUpdateBlock
+{
+public:
+	/** Copies the contents of data, the returned block holds one reference for the caller.
+	 */
+	static SharedUpdateBlock * Create(const ByteBuffer & data, uint32 count)
+	{
+		SharedUpdateBlock * block = new SharedUpdateBlock;
+		block->m_size = data.size();
+		block->m_count = count;
+		block->m_data = new uint8[block->m_size];
+		memcpy(block->m_data, data.contents(), block->m_size);
+		return block;
+	}
+
+	ASCENT_INLINE const uint8 * GetData() const { return m_data; }
+	ASCENT_INLINE size_t GetSize() const { return m_size; }
+	ASCENT_INLINE uint32 GetCount() const { return m_count; }
+
+	// references are dropped by whichever thread flushes a player's updates
+#ifdef WIN32
+	ASCENT_INLINE void AddRef() { InterlockedIncrement(&m_refs); }
+	ASCENT_INLINE void DecRef()
+	{
+		if(InterlockedDecrement(&m_refs) == 0)
+			delete this;
+	}
+#else
+	ASCENT_INLINE void AddRef() { __sync_add_and_fetch(&m_refs, 1); }
+	ASCENT_INLINE void DecRef()
+	{
+		if(__sync_sub_and_fetch(&m_refs, 1) == 0)
+			delete this;
+	}
+#endif
+
+private:
+	SharedUpdateBlock() : m_refs(1), m_data(NULL), m_size(0), m_count(0) {}
+	~SharedUpdateBlock() { delete [] m_data; }
+
+	volatile long m_refs;
+	uint8 * m_data;
+	size_t m_size;
+	uint32 m_count;
+};
+
+/** Part of a player's pending values update. Segments either reference a shared
+ * block or a range of the player's own update buffer, and are sent in order.
+ */
+struct PendingUpdateSegment
+{
+	SharedUpdateBlock * block;
+	size_t offset;
+	size_t size;
+};
+
+#endif
@@ -255,54 +255,59 @@ void Spell::FillSpecifiedTargetsInArea(uint32 i,float srcx,float srcy,float srcz
 {
 	TargetsList *tmpMap=&m_targetUnits[i];
     //IsStealth()
-    float r = range * range;
 	uint8 did_hit_result;
-    for(std::set<Object*>::iterator itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
+	Unit * target;
+
+	// objects out of the world have no in-range objects either
+	if( !m_caster->IsInWorld() )
+		return;
+
+	vector<Unit*> & units = m_caster->GetMapMgr()->GetUnitsInRange( m_caster, srcx, srcy, srcz, range );
+    for( vector<Unit*>::iterator itr = units.begin(); itr != units.end(); itr++ )
     {
-        // don't add objects that are not units and that are dead
-        if( !( (*itr)->IsUnit() ) || ! static_cast< Unit* >( *itr )->isAlive())
+        target = *itr;
+
+        // don't add the caster and units that are dead
+        if( target == m_caster || !target->isAlive() )
             continue;
         
-        //static_cast< Unit* >( *itr )->IsStealth()
+        //target->IsStealth()
         if( m_spellInfo->TargetCreatureType)
         {
-            if((*itr)->GetTypeId()!= TYPEID_UNIT)
+            if(target->GetTypeId()!= TYPEID_UNIT)
                 continue;
-            CreatureInfo *inf = ((Creature*)(*itr))->GetCreatureName();
+            CreatureInfo *inf = static_cast< Creature* >( target )->GetCreatureName();
             if(!inf || !(1<<(inf->Type-1) & m_spellInfo->TargetCreatureType))
                 continue;
         }
 
-        if(IsInrange(srcx,srcy,srcz,(*itr),r))
+        if( u_caster != NULL )
         {
-            if( u_caster != NULL )
+            if( isAttackable( u_caster, target, !(m_spellInfo->c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
             {
-                if( isAttackable( u_caster, static_cast< Unit* >( *itr ),!(m_spellInfo->c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
-                {
-					did_hit_result = DidHit(i, static_cast< Unit* >( *itr ) );
-					if( did_hit_result != SPELL_DID_HIT_SUCCESS )
-						ModeratedTargets.push_back(SpellTargetMod((*itr)->GetGUID(), did_hit_result));
-					else
-						tmpMap->push_back((*itr)->GetGUID());
-                }
-
-            }
-            else //cast from GO
-            {
-                if(g_caster && g_caster->GetUInt32Value(OBJECT_FIELD_CREATED_BY) && g_caster->m_summoner)
-                {
-                    //trap, check not to attack owner and friendly
-                    if(isAttackable(g_caster->m_summoner,(Unit*)(*itr),!(m_spellInfo->c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
-                        tmpMap->push_back((*itr)->GetGUID());
-                }
-                else
-                    tmpMap->push_back((*itr)->GetGUID());
+				did_hit_result = DidHit(i, target );
+				if( did_hit_result != SPELL_DID_HIT_SUCCESS )
+					ModeratedTargets.push_back(SpellTargetMod(target->GetGUID(), did_hit_result));
+				else
+					tmpMap->push_back(target->GetGUID());
             }
-            if( m_spellInfo->MaxTargets)
+
+        }
+        else //cast from GO
+        {
+            if(g_caster && g_caster->GetUInt32Value(OBJECT_FIELD_CREATED_BY) && g_caster->m_summoner)
             {
-                if( m_spellInfo->MaxTargets >= tmpMap->size())
-                    return;
+                //trap, check not to attack owner and friendly
+                if(isAttackable(g_caster->m_summoner,target,!(m_spellInfo->c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED)))
+                    tmpMap->push_back(target->GetGUID());
             }
+            else
+                tmpMap->push_back(target->GetGUID());
+        }
+        if( m_spellInfo->MaxTargets)
+        {
+            if( m_spellInfo->MaxTargets >= tmpMap->size())
+                return;
         }
     }
 }
@@ -320,49 +325,53 @@ void Spell::FillAllTargetsInArea(float srcx,float srcy,float srcz,uint32 ind)
 void Spell::FillAllTargetsInArea(uint32 i,float srcx,float srcy,float srcz, float range)
 {
 	TargetsList *tmpMap=&m_targetUnits[i];
-	float r = range*range;
 	uint8 did_hit_result;
-	for( std::set<Object*>::iterator itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
+	Unit * target;
+
+	if( !m_caster->IsInWorld() )
+		return;
+
+	vector<Unit*> & units = m_caster->GetMapMgr()->GetUnitsInRange( m_caster, srcx, srcy, srcz, range );
+	for( vector<Unit*>::iterator itr = units.begin(); itr != units.end(); itr++ )
 	{
-		if( !( (*itr)->IsUnit() ) || ! static_cast< Unit* >( *itr )->isAlive() || ( static_cast< Creature* >( *itr )->IsTotem() && !static_cast< Unit* >( *itr )->IsPlayer() ) )
+		target = *itr;
+		if( target == m_caster || !target->isAlive() || ( static_cast< Creature* >( target )->IsTotem() && !target->IsPlayer() ) )
 			continue;
 
 		if( m_spellInfo->TargetCreatureType )
 		{
-			if( (*itr)->GetTypeId()!= TYPEID_UNIT )
+			if( target->GetTypeId()!= TYPEID_UNIT )
 				continue;
-			CreatureInfo *inf = ((Creature*)(*itr))->GetCreatureName();
+			CreatureInfo *inf = static_cast< Creature* >( target )->GetCreatureName();
 			if( !inf || !( 1 << (inf->Type-1) & m_spellInfo->TargetCreatureType ) )
 				continue;
 		}
-		if( IsInrange( srcx, srcy, srcz, (*itr), r ) )
+
+		if( u_caster != NULL )
 		{
-			if( u_caster != NULL )
+			if( isAttackable( u_caster, target, !(m_spellInfo->c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED) ) )
 			{
-				if( isAttackable( u_caster, static_cast< Unit* >( *itr ), !(m_spellInfo->c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED) ) )
-				{
-					did_hit_result = DidHit(i, static_cast< Unit* >( *itr ) );
-					if( did_hit_result == SPELL_DID_HIT_SUCCESS )
-						tmpMap->push_back( (*itr)->GetGUID() );
-					else
-						ModeratedTargets.push_back( SpellTargetMod( (*itr)->GetGUID(), did_hit_result ) );
-				}
-			}
-			else //cast from GO
-			{
-				if( g_caster != NULL && g_caster->GetUInt32Value( OBJECT_FIELD_CREATED_BY ) && g_caster->m_summoner != NULL )
-				{
-					//trap, check not to attack owner and friendly
-					if( isAttackable( g_caster->m_summoner, static_cast< Unit* >( *itr ), !(m_spellInfo->c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED) ) )
-						tmpMap->push_back( (*itr)->GetGUID() );
-				}
+				did_hit_result = DidHit(i, target );
+				if( did_hit_result == SPELL_DID_HIT_SUCCESS )
+					tmpMap->push_back( target->GetGUID() );
 				else
-					tmpMap->push_back( (*itr)->GetGUID() );
-			}			
-			if( m_spellInfo->MaxTargets )
-				if( m_spellInfo->MaxTargets == tmpMap->size() )
-					return;
+					ModeratedTargets.push_back( SpellTargetMod( target->GetGUID(), did_hit_result ) );
+			}
 		}
+		else //cast from GO
+		{
+			if( g_caster != NULL && g_caster->GetUInt32Value( OBJECT_FIELD_CREATED_BY ) && g_caster->m_summoner != NULL )
+			{
+				//trap, check not to attack owner and friendly
+				if( isAttackable( g_caster->m_summoner, target, !(m_spellInfo->c_is_flags & SPELL_FLAG_IS_TARGETINGSTEALTHED) ) )
+					tmpMap->push_back( target->GetGUID() );
+			}
+			else
+				tmpMap->push_back( target->GetGUID() );
+		}			
+		if( m_spellInfo->MaxTargets )
+			if( m_spellInfo->MaxTargets == tmpMap->size() )
+				return;
 	}	
 }
 
@@ -370,50 +379,53 @@ void Spell::FillAllTargetsInArea(uint32 i,float srcx,float srcy,float srcz, floa
 void Spell::FillAllFriendlyInArea( uint32 i, float srcx, float srcy, float srcz, float range )
 {
 	TargetsList *tmpMap=&m_targetUnits[i];
-	float r = range * range;
 	uint8 did_hit_result;
-	for( std::set<Object*>::iterator itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
+	Unit * target;
+
+	if( !m_caster->IsInWorld() )
+		return;
+
+	vector<Unit*> & units = m_caster->GetMapMgr()->GetUnitsInRange( m_caster, srcx, srcy, srcz, range );
+	for( vector<Unit*>::iterator itr = units.begin(); itr != units.end(); itr++ )
 	{
-		if( !((*itr)->IsUnit()) || !static_cast< Unit* >( *itr )->isAlive() )
+		target = *itr;
+		if( target == m_caster || !target->isAlive() )
 			continue;
 
 		if( m_spellInfo->TargetCreatureType )
 		{
-			if((*itr)->GetTypeId()!= TYPEID_UNIT)
+			if(target->GetTypeId()!= TYPEID_UNIT)
 				continue;
-			CreatureInfo *inf = ((Creature*)(*itr))->GetCreatureName();
+			CreatureInfo *inf = static_cast< Creature* >( target )->GetCreatureName();
 			if(!inf || !(1<<(inf->Type-1) & m_spellInfo->TargetCreatureType))
 				continue;
 		}
 
-		if( IsInrange( srcx, srcy, srcz, (*itr), r ) )
+		if( u_caster != NULL )
 		{
-			if( u_caster != NULL )
+			if( isFriendly( u_caster, target ) )
 			{
-				if( isFriendly( u_caster, static_cast< Unit* >( *itr ) ) )
-				{
-					did_hit_result = DidHit(i, static_cast< Unit* >( *itr ) );
-					if( did_hit_result == SPELL_DID_HIT_SUCCESS )
-						tmpMap->push_back( (*itr)->GetGUID() );
-					else
-						ModeratedTargets.push_back( SpellTargetMod( (*itr)->GetGUID(), did_hit_result ) );
-				}
-			}
-			else //cast from GO
-			{
-				if( g_caster != NULL && g_caster->GetUInt32Value( OBJECT_FIELD_CREATED_BY ) && g_caster->m_summoner != NULL )
-				{
-					//trap, check not to attack owner and friendly
-					if( isFriendly( g_caster->m_summoner, static_cast< Unit* >( *itr ) ) )
-						tmpMap->push_back( (*itr)->GetGUID() );
-				}
+				did_hit_result = DidHit(i, target );
+				if( did_hit_result == SPELL_DID_HIT_SUCCESS )
+					tmpMap->push_back( target->GetGUID() );
 				else
-					tmpMap->push_back( (*itr)->GetGUID() );
-			}			
-			if( m_spellInfo->MaxTargets )
-				if( m_spellInfo->MaxTargets == tmpMap->size() )
-					return;
+					ModeratedTargets.push_back( SpellTargetMod( target->GetGUID(), did_hit_result ) );
+			}
 		}
+		else //cast from GO
+		{
+			if( g_caster != NULL && g_caster->GetUInt32Value( OBJECT_FIELD_CREATED_BY ) && g_caster->m_summoner != NULL )
+			{
+				//trap, check not to attack owner and friendly
+				if( isFriendly( g_caster->m_summoner, target ) )
+					tmpMap->push_back( target->GetGUID() );
+			}
+			else
+				tmpMap->push_back( target->GetGUID() );
+		}			
+		if( m_spellInfo->MaxTargets )
+			if( m_spellInfo->MaxTargets == tmpMap->size() )
+				return;
 	}	
 }
 
@@ -432,7 +444,7 @@ uint64 Spell::GetSinglePossibleEnemy(uint32 i,float prange)
 		}
 	}
 	float srcx = m_caster->GetPositionX(), srcy = m_caster->GetPositionY(), srcz = m_caster->GetPositionZ();
-	for( std::set<Object*>::iterator itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
+	for( Object::InRangeSet::iterator itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
 	{
 		if( !( (*itr)->IsUnit() ) || !static_cast< Unit* >( *itr )->isAlive() )
 			continue;
@@ -481,7 +493,7 @@ uint64 Spell::GetSinglePossibleFriend(uint32 i,float prange)
 		}
 	}
 	float srcx=m_caster->GetPositionX(),srcy=m_caster->GetPositionY(),srcz=m_caster->GetPositionZ();
-	for(std::set<Object*>::iterator itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
+	for(Object::InRangeSet::iterator itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
 	{
 		if( !( (*itr)->IsUnit() ) || !static_cast< Unit* >( *itr )->isAlive() )
 			continue;
@@ -857,7 +869,7 @@ void Spell::GenerateTargets(SpellCastTargets *store_buff)
 						if ( u_caster != NULL && u_caster->IsCreature() )
 						{
 							//target friendly npcs
-							for( std::set<Object*>::iterator itr = u_caster->GetInRangeSameFactsSetBegin(); itr != u_caster->GetInRangeSameFactsSetEnd(); itr++ )
+							for( Object::InRangeSet::iterator itr = u_caster->GetInRangeSameFactsSetBegin(); itr != u_caster->GetInRangeSameFactsSetEnd(); itr++ )
 							{
 								if ( (*itr) != NULL && ((*itr)->GetTypeId() == TYPEID_UNIT || (*itr)->GetTypeId() == TYPEID_PLAYER) && (*itr)->IsInWorld() && ((Unit*)*itr)->isAlive() && IsInrange(u_caster, (*itr), r) )
 								{
@@ -884,7 +896,7 @@ void Spell::GenerateTargets(SpellCastTargets *store_buff)
 							 else
 							 {
 								//target friendly npcs
-								for( std::set<Object*>::iterator itr = u_caster->GetInRangeSameFactsSetBegin(); itr != u_caster->GetInRangeSameFactsSetEnd(); itr++ )
+								for( Object::InRangeSet::iterator itr = u_caster->GetInRangeSameFactsSetBegin(); itr != u_caster->GetInRangeSameFactsSetEnd(); itr++ )
 								{
 									if ( (*itr) != NULL && ((*itr)->GetTypeId() == TYPEID_UNIT || (*itr)->GetTypeId() == TYPEID_PLAYER) && (*itr)->IsInWorld() && ((Unit*)*itr)->isAlive() && IsInrange(u_caster, (*itr), r) )
 									{
@@ -981,7 +993,7 @@ void Spell::GenerateTargets(SpellCastTargets *store_buff)
 						if ( u_caster != NULL && u_caster->IsCreature() )
 						{
 							//target friendly npcs
-							for( std::set<Object*>::iterator itr = u_caster->GetInRangeSameFactsSetBegin(); itr != u_caster->GetInRangeSameFactsSetEnd(); itr++ )
+							for( Object::InRangeSet::iterator itr = u_caster->GetInRangeSameFactsSetBegin(); itr != u_caster->GetInRangeSameFactsSetEnd(); itr++ )
 							{
 								if ( (*itr) != NULL && ((*itr)->GetTypeId() == TYPEID_UNIT || (*itr)->GetTypeId() == TYPEID_PLAYER) && (*itr)->IsInWorld() && ((Unit*)*itr)->isAlive() && IsInrange(u_caster, (*itr), r) )								{
 									store_buff->m_unitTarget = (*itr)->GetGUID();
@@ -3103,7 +3115,7 @@ uint8 Spell::CanCast(bool tolerate)
 		{
 			bool found = false;
 
-            for(std::set<Object*>::iterator itr = p_caster->GetInRangeSetBegin(); itr != p_caster->GetInRangeSetEnd(); itr++ )
+            for(Object::InRangeSet::iterator itr = p_caster->GetInRangeSetBegin(); itr != p_caster->GetInRangeSetEnd(); itr++ )
 			{
 				if((*itr)->GetTypeId() != TYPEID_GAMEOBJECT)
 					continue;
@@ -4519,7 +4531,7 @@ void Spell::Heal(int32 amount, bool ForceCrit)
 
 			target_threat.reserve(u_caster->GetInRangeCount()); // this helps speed
 
-			for(std::set<Object*>::iterator itr = u_caster->GetInRangeSetBegin(); itr != u_caster->GetInRangeSetEnd(); ++itr)
+			for(Object::InRangeSet::iterator itr = u_caster->GetInRangeSetBegin(); itr != u_caster->GetInRangeSetEnd(); ++itr)
 			{
 				if((*itr)->GetTypeId() != TYPEID_UNIT)
 					continue;
@@ -363,6 +363,10 @@ Aura::Aura( SpellEntry* proto, int32 duration, Object* caster, Unit* target )
 	m_dynamicValue = 0;
 	m_areaAura = false;
 
+	m_periodicScheduler = NULL;
+	for( uint32 i = 0; i < MAX_AURA_PERIODIC_TICKS; ++i )
+		m_periodicTicks[i].type = PERIODIC_TICK_NONE;
+
 	if( m_spellProto->c_is_flags & SPELL_FLAG_IS_FORCEDDEBUFF )
 		SetNegative( 100 );
 	else if( m_spellProto->c_is_flags & SPELL_FLAG_IS_FORCEDBUFF )
@@ -419,6 +423,7 @@ Aura::Aura( SpellEntry* proto, int32 duration, Object* caster, Unit* target )
 Aura::~Aura()
 {
 	sEventMgr.RemoveEvents( this );
+	RemovePeriodicTicks();
 }
 
 void Aura::Remove()
@@ -428,6 +433,7 @@ void Aura::Remove()
 
 	m_deleted = true;
 	sEventMgr.RemoveEvents( this );
+	RemovePeriodicTicks();
 
 	if( !IsPassive() || IsPassive() && m_spellProto->AttributesEx & 1024 )
 		RemoveAuraVisual();
@@ -629,7 +635,7 @@ void Aura::ApplyModifiers( bool apply )
 			pts.procCharges = GetSpellProto()->procCharges;
 			pts.LastTrigger = 0;
 			pts.deleted = false;
-			m_target->m_procSpells.push_front(pts);
+			m_target->AddProcTriggerSpell(pts);
 		}
 		else
 		{
@@ -1124,8 +1130,7 @@ void Aura::SpellAuraPeriodicDamage(bool apply)
 		if(dmg<=0)
 			return; //who would want a neagtive dmg here ?
 
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicDamage,(uint32)dmg, 
-			EVENT_AURA_PERIODIC_DAMAGE,GetSpellProto()->EffectAmplitude[mod->i],0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_DAMAGE, EVENT_AURA_PERIODIC_DAMAGE, GetSpellProto()->EffectAmplitude[mod->i], (uint32)dmg);
 
 		/*static_cast< Player* >( c )->GetSession()->SystemMessage("dot will do %u damage every %u seconds (total of %u)", dmg,m_spellProto->EffectAmplitude[mod->i],(GetDuration()/m_spellProto->EffectAmplitude[mod->i])*dmg);
 		printf("dot will do %u damage every %u seconds (total of %u)\n", dmg,m_spellProto->EffectAmplitude[mod->i],(GetDuration()/m_spellProto->EffectAmplitude[mod->i])*dmg);*/
@@ -1174,7 +1179,7 @@ void Aura::EventPeriodicDamage(uint32 amount)
 
 			int amp = m_spellProto->EffectAmplitude[mod->i];
 			if( !amp ) 
-				amp = static_cast< EventableObject* >( this )->event_GetEventPeriod( EVENT_AURA_PERIODIC_DAMAGE );
+				amp = GetPeriodicTickPeriod( EVENT_AURA_PERIODIC_DAMAGE );
 
 			if(GetDuration())
 			{
@@ -1572,7 +1577,7 @@ void Aura::SpellAuraDummy(bool apply)
 			pts.procCharges = GetSpellProto()->procCharges;
 			pts.LastTrigger = 0;
 			pts.deleted = false;
-			m_target->m_procSpells.push_front(pts);
+			m_target->AddProcTriggerSpell(pts);
 			}
 			else
 			{
@@ -1895,7 +1900,7 @@ void Aura::SpellAuraDummy(bool apply)
 				pts.procCharges = GetSpellProto()->procCharges;
 				pts.LastTrigger = 0;
 				pts.deleted = false;
-				m_target->m_procSpells.push_front(pts);
+				m_target->AddProcTriggerSpell(pts);
 			}
 			else
 			{
@@ -1923,9 +1928,9 @@ void Aura::SpellAuraDummy(bool apply)
 			//uint32 duration = GetDuration();
 			//printf("moo\n");
 			if(apply)
-				sEventMgr.AddEvent(this, &Aura::EventPeriodicHeal1, (uint32)mod->m_amount, EVENT_AURA_PERIODIC_HEAL, 2000, 0, EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+				AddPeriodicTick(PERIODIC_TICK_HEAL1, EVENT_AURA_PERIODIC_HEAL, 2000, (uint32)mod->m_amount);
 			else
-				sEventMgr.RemoveEvents(this, EVENT_AURA_PERIODIC_HEAL);
+				RemovePeriodicTicks(EVENT_AURA_PERIODIC_HEAL);
             		
 		}break;
 
@@ -1935,9 +1940,9 @@ void Aura::SpellAuraDummy(bool apply)
 	case 27012:		// hurricane
 		{
 			if(apply)
-				sEventMgr.AddEvent(this, &Aura::EventPeriodicDamage, (uint32)mod->m_amount, EVENT_AURA_PERIODIC_DAMAGE, 1000, 0, EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+				AddPeriodicTick(PERIODIC_TICK_DAMAGE, EVENT_AURA_PERIODIC_DAMAGE, 1000, (uint32)mod->m_amount);
 			else
-				sEventMgr.RemoveEvents(this, EVENT_AURA_PERIODIC_DAMAGE);
+				RemovePeriodicTicks(EVENT_AURA_PERIODIC_DAMAGE);
 		}break;
 
 	case 33763:		// lifebloom
@@ -2281,7 +2286,7 @@ void Aura::SpellAuraPeriodicHeal( bool apply )
 	if( apply )
 	{
 		SetPositive();
-		sEventMgr.AddEvent( this, &Aura::EventPeriodicHeal,(uint32)mod->m_amount, EVENT_AURA_PERIODIC_HEAL, GetSpellProto()->EffectAmplitude[mod->i], 0, EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT );
+		AddPeriodicTick( PERIODIC_TICK_HEAL, EVENT_AURA_PERIODIC_HEAL, GetSpellProto()->EffectAmplitude[mod->i], (uint32)mod->m_amount );
 
 		if( GetSpellProto()->NameHash == SPELL_HASH_REJUVENATION || GetSpellProto()->NameHash == SPELL_HASH_REGROWTH )
 		{
@@ -2358,7 +2363,7 @@ void Aura::EventPeriodicHeal( uint32 amount )
 
 	int amp = m_spellProto->EffectAmplitude[mod->i];
 	if( !amp ) 
-		amp = static_cast< EventableObject* >( this )->event_GetEventPeriod( EVENT_AURA_PERIODIC_HEAL );
+		amp = GetPeriodicTickPeriod( EVENT_AURA_PERIODIC_HEAL );
 
 	if( GetDuration() )
 	{
@@ -2421,7 +2426,7 @@ void Aura::EventPeriodicHeal( uint32 amount )
 		{
 			target_threat.reserve(u_caster->GetInRangeCount()); // this helps speed
 
-			for(std::set<Object*>::iterator itr = u_caster->GetInRangeSetBegin(); itr != u_caster->GetInRangeSetEnd(); ++itr)
+			for(Object::InRangeSet::iterator itr = u_caster->GetInRangeSetBegin(); itr != u_caster->GetInRangeSetEnd(); ++itr)
 			{
 				if((*itr)->GetTypeId() != TYPEID_UNIT)
 					continue;
@@ -2908,8 +2913,7 @@ void Aura::SpellAuraModTotalHealthRegenPct(bool apply)
 	if(apply)
 	{
 		SetPositive();
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicHealPct,(float)mod->m_amount,
-			EVENT_AURA_PERIODIC_HEALPERC,	GetSpellProto()->EffectAmplitude[mod->i],0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_HEAL_PCT, EVENT_AURA_PERIODIC_HEALPERC, GetSpellProto()->EffectAmplitude[mod->i], (float)mod->m_amount);
 	}
 }
 
@@ -2940,8 +2944,7 @@ void Aura::SpellAuraModTotalManaRegenPct(bool apply)
 	if(apply)
 	{
 		SetPositive();
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicManaPct,(float)mod->m_amount,
-			EVENT_AURA_PERIOCIC_MANA,	GetSpellProto()->EffectAmplitude[mod->i],0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_MANA_PCT, EVENT_AURA_PERIOCIC_MANA, GetSpellProto()->EffectAmplitude[mod->i], (float)mod->m_amount);
 	}
 }
 
@@ -3062,15 +3065,13 @@ void Aura::SpellAuraPeriodicTriggerSpell(bool apply)
 
 		if(m_caster->GetUInt64Value(UNIT_FIELD_CHANNEL_OBJECT))
 		{
-			sEventMgr.AddEvent(this, &Aura::EventPeriodicTriggerSpell, spe,
-			EVENT_AURA_PERIODIC_TRIGGERSPELL,GetSpellProto()->EffectAmplitude[mod->i], 0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+			AddPeriodicTick(PERIODIC_TICK_TRIGGER_SPELL, EVENT_AURA_PERIODIC_TRIGGERSPELL, GetSpellProto()->EffectAmplitude[mod->i], spe);
 
             periodic_target = m_caster->GetUInt64Value(UNIT_FIELD_CHANNEL_OBJECT);
 		}
 		else if(m_target)
 		{
-			sEventMgr.AddEvent(this, &Aura::EventPeriodicTriggerSpell, spe, 
-				EVENT_AURA_PERIODIC_TRIGGERSPELL,GetSpellProto()->EffectAmplitude[mod->i], 0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+			AddPeriodicTick(PERIODIC_TICK_TRIGGER_SPELL, EVENT_AURA_PERIODIC_TRIGGERSPELL, GetSpellProto()->EffectAmplitude[mod->i], spe);
 			periodic_target = m_target->GetGUID();
 		}
 	}
@@ -3168,8 +3169,7 @@ void Aura::SpellAuraPeriodicEnergize(bool apply)
 	if(apply)
 	{
 		SetPositive();
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicEnergize,(uint32)mod->m_amount,(uint32)mod->m_miscValue,
-			EVENT_AURA_PERIODIC_ENERGIZE,GetSpellProto()->EffectAmplitude[mod->i],0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_ENERGIZE, EVENT_AURA_PERIODIC_ENERGIZE, GetSpellProto()->EffectAmplitude[mod->i], (uint32)mod->m_amount, (uint32)mod->m_miscValue);
 	}
 }
 
@@ -4078,7 +4078,7 @@ void Aura::SpellAuraProcTriggerSpell(bool apply)
 			sLog.outDebug("Error, could not register procspell %u\n",pts.spellId);
 			return;
 		}*/
-		m_target->m_procSpells.push_front(pts);
+		m_target->AddProcTriggerSpell(pts);
 		sLog.outDebug("%u is registering %u chance %u flags %u charges %u triggeronself %u interval %u\n",pts.origId,pts.spellId,pts.procChance,m_spellProto->procFlags & ~PROC_TARGET_SELF,m_spellProto->procCharges,m_spellProto->procFlags & PROC_TARGET_SELF,m_spellProto->proc_interval);
 	}
 	else
@@ -4259,8 +4259,7 @@ void Aura::SpellAuraPeriodicLeech(bool apply)
 	{
 		SetNegative();
 		uint32 amt = mod->m_amount;
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicLeech,amt,
-			EVENT_AURA_PERIODIC_LEECH,	GetSpellProto()->EffectAmplitude[mod->i],0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_LEECH, EVENT_AURA_PERIODIC_LEECH, GetSpellProto()->EffectAmplitude[mod->i], amt);
 	}
 }
 
@@ -4278,7 +4277,7 @@ void Aura::EventPeriodicLeech(uint32 amount)
 
 		int amp = m_spellProto->EffectAmplitude[mod->i];
 		if( !amp ) 
-			amp = static_cast< EventableObject* >( this )->event_GetEventPeriod( EVENT_AURA_PERIODIC_LEECH );
+			amp = GetPeriodicTickPeriod( EVENT_AURA_PERIODIC_LEECH );
 
 		int bonus = 0;
 
@@ -4553,7 +4552,7 @@ void Aura::SpellAuraTransform(bool apply)
 						m_target->m_currentSpell = 0;
 					}
 
-					sEventMgr.AddEvent(this, &Aura::EventPeriodicHeal1,(uint32)1000,EVENT_AURA_PERIODIC_HEAL,1000,0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+					AddPeriodicTick(PERIODIC_TICK_HEAL1, EVENT_AURA_PERIODIC_HEAL, 1000, (uint32)1000);
 					m_target->polySpell = GetSpellProto()->Id;
 				}
 				else
@@ -4715,8 +4714,7 @@ void Aura::SpellAuraPeriodicHealthFunnel(bool apply)
 	if(apply)
 	{
 		uint32 amt = mod->m_amount;
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicHealthFunnel, amt,
-			EVENT_AURA_PERIODIC_HEALTH_FUNNEL, GetSpellProto()->EffectAmplitude[mod->i], 0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_HEALTH_FUNNEL, EVENT_AURA_PERIODIC_HEALTH_FUNNEL, GetSpellProto()->EffectAmplitude[mod->i], amt);
 	}
 }
 
@@ -4749,8 +4747,7 @@ void Aura::SpellAuraPeriodicManaLeech(bool apply)
 	if(apply)
 	{
 		uint32 amt=mod->m_amount;
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicManaLeech,amt,
-			EVENT_AURA_PERIODIC_LEECH,	 GetSpellProto()->EffectAmplitude[mod->i],0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_MANA_LEECH, EVENT_AURA_PERIODIC_LEECH, GetSpellProto()->EffectAmplitude[mod->i], amt);
 	}
 }
 
@@ -4818,7 +4815,7 @@ void Aura::SpellAuraFeignDeath(bool apply)
 //			pTarget->setDeathState(DEAD);
 
 			//now get rid of mobs agro. pTarget->CombatStatus.AttackersForgetHate() - this works only for already attacking mobs
-		    for(std::set<Object*>::iterator itr = pTarget->GetInRangeSetBegin(); itr != pTarget->GetInRangeSetEnd(); itr++ )
+		    for(Object::InRangeSet::iterator itr = pTarget->GetInRangeSetBegin(); itr != pTarget->GetInRangeSetEnd(); itr++ )
 			{
 				if((*itr)->IsUnit() && ((Unit*)(*itr))->isAlive())
 				{
@@ -5515,8 +5512,7 @@ void Aura::SpellAuraModRegen(bool apply)
 	if(apply)//seems like only positive
 	{
 		SetPositive ();
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicHeal1,(uint32)((this->GetSpellProto()->EffectBasePoints[mod->i]+1)/5)*3,
-			EVENT_AURA_PERIODIC_REGEN,3000,0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_HEAL1, EVENT_AURA_PERIODIC_REGEN, 3000, (uint32)((this->GetSpellProto()->EffectBasePoints[mod->i]+1)/5)*3);
 	}
 }
 
@@ -5525,8 +5521,7 @@ void Aura::SpellAuraDrinkNew(bool apply)
 	if( apply )
 	{
 		SetPositive();
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicDrink, uint32(float2int32(float(mod->m_amount)/5.0f)),
-			EVENT_AURA_PERIODIC_REGEN, 1000, 0, EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_DRINK, EVENT_AURA_PERIODIC_REGEN, 1000, uint32(float2int32(float(mod->m_amount)/5.0f)));
 	}
 }
 
@@ -5698,8 +5693,7 @@ void Aura::SpellAuraPeriodicDamagePercent(bool apply)
 		else*/
 		{
 			uint32 dmg = mod->m_amount;
-			sEventMgr.AddEvent(this, &Aura::EventPeriodicDamagePercent, dmg, 
-				EVENT_AURA_PERIODIC_DAMAGE_PERCENT,GetSpellProto()->EffectAmplitude[mod->i],0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+			AddPeriodicTick(PERIODIC_TICK_DAMAGE_PERCENT, EVENT_AURA_PERIODIC_DAMAGE_PERCENT, GetSpellProto()->EffectAmplitude[mod->i], dmg);
 		}
 		SetNegative();
 	}
@@ -6987,7 +6981,7 @@ void Aura::SpellAuraModHealthRegInCombat(bool apply)
 	// demon armor etc, they all seem to be 5 sec.
 	if(apply)
 	{
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicHeal1, uint32(mod->m_amount), EVENT_AURA_PERIODIC_HEALINCOMB, 5000, 0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_HEAL1, EVENT_AURA_PERIODIC_HEALINCOMB, 5000, uint32(mod->m_amount));
 	}
 }
 
@@ -7017,7 +7011,7 @@ void Aura::SpellAuraPowerBurn(bool apply)
 {
 	//0 mana,1 rage, 3 energy
 	if(apply)
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicBurn, uint32(mod->m_amount), (uint32)mod->m_miscValue, EVENT_AURA_PERIODIC_BURN, GetSpellProto()->EffectAmplitude[mod->i], 0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_BURN, EVENT_AURA_PERIODIC_BURN, GetSpellProto()->EffectAmplitude[mod->i], uint32(mod->m_amount), (uint32)mod->m_miscValue);
 }
 
 void Aura::SpellAuraModCritDmgPhysical(bool apply)
@@ -7732,6 +7726,163 @@ int32 Aura::event_GetInstanceID()
 void Aura::RelocateEvents()
 {
 	event_Relocate();
+
+	// ticks follow the target to its map and keep the time they had left while it is out of the world
+	PeriodicAuraScheduler * scheduler = m_target->IsInWorld() ? &m_target->GetMapMgr()->periodicAuras : NULL;
+	if( scheduler == m_periodicScheduler )
+		return;
+
+	for( uint32 i = 0; i < MAX_AURA_PERIODIC_TICKS; ++i )
+	{
+		PeriodicAuraTick & t = m_periodicTicks[i];
+		if( t.type == PERIODIC_TICK_NONE )
+			continue;
+
+		if( t.handle != PERIODIC_AURA_INVALID_HANDLE )
+		{
+			t.timeLeft = m_periodicScheduler->GetTimeLeft( t.handle );
+			m_periodicScheduler->Remove( t.handle );
+			t.handle = PERIODIC_AURA_INVALID_HANDLE;
+		}
+
+		if( scheduler != NULL )
+			t.handle = scheduler->Add( this, (uint8)i, t.timeLeft, t.period );
+	}
+
+	m_periodicScheduler = scheduler;
+}
+
+PeriodicAuraTick * Aura::_NewPeriodicTick(uint8 type, uint32 eventType, uint32 period)
+{
+	for( uint32 i = 0; i < MAX_AURA_PERIODIC_TICKS; ++i )
+	{
+		PeriodicAuraTick & t = m_periodicTicks[i];
+		if( t.type != PERIODIC_TICK_NONE )
+			continue;
+
+		t.type = type;
+		t.eventType = eventType;
+		t.period = period;
+		t.handle = PERIODIC_AURA_INVALID_HANDLE;
+		t.timeLeft = period;
+		t.amount = 0;
+		t.misc = 0;
+		t.pct = 0.0f;
+		t.spell = NULL;
+		return &t;
+	}
+
+	sLog.outString("Tried to add >%u periodic ticks to spellid %u", MAX_AURA_PERIODIC_TICKS, m_spellProto->Id);
+	return NULL;
+}
+
+void Aura::_StartPeriodicTick(PeriodicAuraTick * t)
+{
+	// not in the world yet, RelocateEvents schedules it once the target is pushed
+	if( m_periodicScheduler == NULL )
+	{
+		if( !m_target->IsInWorld() )
+			return;
+
+		m_periodicScheduler = &m_target->GetMapMgr()->periodicAuras;
+	}
+
+	t->handle = m_periodicScheduler->Add( this, (uint8)(t - m_periodicTicks), t->timeLeft, t->period );
+}
+
+void Aura::AddPeriodicTick(uint8 type, uint32 eventType, uint32 period, uint32 amount, uint32 misc)
+{
+	PeriodicAuraTick * t = _NewPeriodicTick( type, eventType, period );
+	if( t == NULL )
+		return;
+
+	t->amount = amount;
+	t->misc = misc;
+	_StartPeriodicTick( t );
+}
+
+void Aura::AddPeriodicTick(uint8 type, uint32 eventType, uint32 period, float pct)
+{
+	PeriodicAuraTick * t = _NewPeriodicTick( type, eventType, period );
+	if( t == NULL )
+		return;
+
+	t->pct = pct;
+	_StartPeriodicTick( t );
+}
+
+void Aura::AddPeriodicTick(uint8 type, uint32 eventType, uint32 period, SpellEntry * spell)
+{
+	PeriodicAuraTick * t = _NewPeriodicTick( type, eventType, period );
+	if( t == NULL )
+		return;
+
+	t->spell = spell;
+	_StartPeriodicTick( t );
+}
+
+void Aura::RemovePeriodicTicks(uint32 eventType)
+{
+	for( uint32 i = 0; i < MAX_AURA_PERIODIC_TICKS; ++i )
+	{
+		PeriodicAuraTick & t = m_periodicTicks[i];
+		if( t.type == PERIODIC_TICK_NONE || ( eventType != EVENT_REMOVAL_FLAG_ALL && t.eventType != eventType ) )
+			continue;
+
+		if( t.handle != PERIODIC_AURA_INVALID_HANDLE )
+			m_periodicScheduler->Remove( t.handle );
+
+		t.type = PERIODIC_TICK_NONE;
+	}
+}
+
+uint32 Aura::GetPeriodicTickPeriod(uint32 eventType)
+{
+	for( uint32 i = 0; i < MAX_AURA_PERIODIC_TICKS; ++i )
+	{
+		if( m_periodicTicks[i].type != PERIODIC_TICK_NONE && m_periodicTicks[i].eventType == eventType )
+			return m_periodicTicks[i].period;
+	}
+
+	return 0;
+}
+
+void Aura::FirePeriodicTick(uint8 tick)
+{
+	PeriodicAuraTick & t = m_periodicTicks[tick];
+	switch( t.type )
+	{
+	case PERIODIC_TICK_DAMAGE:				EventPeriodicDamage( t.amount ); break;
+	case PERIODIC_TICK_DAMAGE_PERCENT:		EventPeriodicDamagePercent( t.amount ); break;
+	case PERIODIC_TICK_HEAL:				EventPeriodicHeal( t.amount ); break;
+	case PERIODIC_TICK_HEAL1:				EventPeriodicHeal1( t.amount ); break;
+	case PERIODIC_TICK_TRIGGER_SPELL:		EventPeriodicTriggerSpell( t.spell ); break;
+	case PERIODIC_TICK_ENERGIZE:			EventPeriodicEnergize( t.amount, t.misc ); break;
+	case PERIODIC_TICK_LEECH:				EventPeriodicLeech( t.amount ); break;
+	case PERIODIC_TICK_BURN:				EventPeriodicBurn( t.amount, t.misc ); break;
+	case PERIODIC_TICK_HEALTH_FUNNEL:		EventPeriodicHealthFunnel( t.amount ); break;
+	case PERIODIC_TICK_MANA_LEECH:			EventPeriodicManaLeech( t.amount ); break;
+	case PERIODIC_TICK_HEAL_PCT:			EventPeriodicHealPct( t.pct ); break;
+	case PERIODIC_TICK_MANA_PCT:			EventPeriodicManaPct( t.pct ); break;
+	case PERIODIC_TICK_DRINK:				EventPeriodicDrink( t.amount ); break;
+	case PERIODIC_TICK_REGEN_MANA_STAT_PCT:	EventPeriodicRegenManaStatPct( t.amount, t.misc ); break;
+	}
+}
+
+void Aura::SendPeriodicLog(Unit * sender, Unit * target, const uint64 & caster, uint32 spell, const uint32 * entry, uint32 words)
+{
+	if( m_periodicScheduler != NULL && m_periodicScheduler->AddLogEntry( sender, target, caster, spell, entry, words ) )
+		return;
+
+	WorldPacket data( SMSG_PERIODICAURALOG, 46 );
+	data << target->GetNewGUID();
+	FastGUIDPack( data, caster );
+	data << spell;
+	data << uint32( 1 );
+	for( uint32 i = 0; i < words; ++i )
+		data << entry[i];
+
+	sender->SendMessageToSet( &data, true );
 }
 
 void Aura::SpellAuraReduceCritMeleeAttackDmg(bool apply)
@@ -7892,7 +8043,7 @@ void Aura::SpellAuraRegenManaStatPCT(bool apply)
 	if(apply)
 	{
 		SetPositive();
-		sEventMgr.AddEvent(this, &Aura::EventPeriodicRegenManaStatPct,(uint32)mod->m_amount,(uint32)mod->m_miscValue,  EVENT_AURA_REGEN_MANA_STAT_PCT, 5000, 0,EVENT_FLAG_DO_NOT_EXECUTE_IN_WORLD_CONTEXT);
+		AddPeriodicTick(PERIODIC_TICK_REGEN_MANA_STAT_PCT, EVENT_AURA_REGEN_MANA_STAT_PCT, 5000, (uint32)mod->m_amount, (uint32)mod->m_miscValue);
 	}
 }
 void Aura::SpellAuraSpellHealingStatPCT(bool apply)
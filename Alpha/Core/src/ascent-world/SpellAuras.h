@@ -309,7 +309,7 @@ struct DamageSplitTarget
 #ifndef NEW_PROCFLAGS
 struct ProcTriggerSpell
 {
-	//  ProcTriggerSpell() : origId(0), trigger(0), spellId(0), caster(0), procChance(0), procFlags(0), procCharges(0) { }
+	ProcTriggerSpell() : origSpell(NULL), spell(NULL) { }
 	uint32 origId;
 	// uint32 trigger;
 	uint32 spellId;
@@ -322,6 +322,8 @@ struct ProcTriggerSpell
 	uint32 LastTrigger;
 	uint32 ProcType; //0=triggerspell/1=triggerclassspell
 	bool deleted;
+	SpellEntry * origSpell;		// set by Unit::AddProcTriggerSpell
+	SpellEntry * spell;
 };
 #else
 struct ProcTriggerSpell
@@ -606,51 +608,37 @@ public:
 	void RelocateEvents();
 	int32 event_GetInstanceID();
 
+	// Periodic ticks, fired by the PeriodicAuraScheduler of the target's map
+	void AddPeriodicTick(uint8 type, uint32 eventType, uint32 period, uint32 amount, uint32 misc = 0);
+	void AddPeriodicTick(uint8 type, uint32 eventType, uint32 period, float pct);
+	void AddPeriodicTick(uint8 type, uint32 eventType, uint32 period, SpellEntry * spell);
+	void RemovePeriodicTicks(uint32 eventType = EVENT_REMOVAL_FLAG_ALL);
+	uint32 GetPeriodicTickPeriod(uint32 eventType);
+	void FirePeriodicTick(uint8 tick);
+
 	ASCENT_INLINE void SendPeriodicHealAuraLog(uint32 amt)
 	{
-		WorldPacket data(32);
-		data.SetOpcode(SMSG_PERIODICAURALOG);
-		data << m_target->GetNewGUID();
-		FastGUIDPack(data, m_casterGuid);
-		data << GetSpellProto()->Id;
-		data << uint32(1);
-		data << uint32(FLAG_PERIODIC_HEAL);
-		data << uint32(amt);
-		m_target->SendMessageToSet(&data,true);
+		uint32 entry[2] = { FLAG_PERIODIC_HEAL, amt };
+		SendPeriodicLog(m_target, m_target, m_casterGuid, GetSpellProto()->Id, entry, 2);
 	}
 	// log message's
 	ASCENT_INLINE void SendPeriodicAuraLog(Unit * Caster, Unit * Target, uint32 SpellID, uint32 School, uint32 Amount, uint32 abs_dmg, uint32 resisted_damage, uint32 Flags)
 	{
-		WorldPacket data(SMSG_PERIODICAURALOG, 46);
-		data << Target->GetNewGUID();		   // target guid
-		data << Caster->GetNewGUID();		   // caster guid
-		data << SpellID;						// spellid
-		data << (uint32)1;					  // unknown? need research?
-		data << uint32(Flags | 0x1);			// aura school
-		data << Amount;						 // amount of done to target / heal / damage
-		data << g_spellSchoolConversionTable[School];
-		data << uint32(abs_dmg);
-		data << uint32(resisted_damage);
-
-		Caster->SendMessageToSet(&data, true);
+		uint32 entry[5] = { Flags | 0x1, Amount, g_spellSchoolConversionTable[School], abs_dmg, resisted_damage };
+		SendPeriodicLog(Caster, Target, Caster->GetGUID(), SpellID, entry, 5);
 	}
 
 	void SendPeriodicAuraLog(const uint64& CasterGuid, Unit * Target, uint32 SpellID, uint32 School, uint32 Amount, uint32 abs_dmg, uint32 resisted_damage, uint32 Flags)
 	{
-		WorldPacket data(SMSG_PERIODICAURALOG, 46);
-		data << Target->GetNewGUID();		   // target guid
-		FastGUIDPack(data, CasterGuid);		 // caster guid
-		data << SpellID;						// spellid
-		data << (uint32)1;					  // unknown?? need resource?
-		data << uint32(Flags | 0x1);			// aura school
-		data << Amount;						 // amount of done to target / heal / damage
-		data << g_spellSchoolConversionTable[School];
-		data << uint32(abs_dmg);
-		data << uint32(resisted_damage);
-
-		Target->SendMessageToSet(&data, true);
+		uint32 entry[5] = { Flags | 0x1, Amount, g_spellSchoolConversionTable[School], abs_dmg, resisted_damage };
+		SendPeriodicLog(Target, Target, CasterGuid, SpellID, entry, 5);
 	}
 
+	/** SMSG_PERIODICAURALOG with one entry (aura type, amount, ...), sent by sender. Ticks
+	 * fired together add their entries to one packet.
+	 */
+	void SendPeriodicLog(Unit * sender, Unit * target, const uint64 & caster, uint32 spell, const uint32 * entry, uint32 words);
+
 	bool WasCastInDuel() { return m_castInDuel; }
 
 	SpellEntry * m_spellProto;
@@ -713,6 +701,12 @@ private:
 
 	uint32 m_dynamicValue;
 
+	PeriodicAuraTick m_periodicTicks[MAX_AURA_PERIODIC_TICKS];
+	PeriodicAuraScheduler * m_periodicScheduler;	// scheduler the ticks are in, NULL while they are parked
+
+	PeriodicAuraTick * _NewPeriodicTick(uint8 type, uint32 eventType, uint32 period);
+	void _StartPeriodicTick(PeriodicAuraTick * t);
+
 protected:
 	uint32 m_casterfaction;
 
@@ -0,0 +1,353 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// SpellCache.cpp
+//
+
+#include "StdAfx.h"
+
+static uint32 FileCrc(const char * filename)
+{
+	MappedFile file;
+	if(!file.Open(filename))
+		return 0;
+
+	return (uint32)crc32(file.GetData(), (unsigned int)file.GetSize());
+}
+
+static void StripStrings(SpellEntry & sp)
+{
+	sp.Name = NULL;
+	sp.Rank = NULL;
+	sp.Description = NULL;
+	sp.BuffDescription = NULL;
+}
+
+static void ClearMask(uint8 * mask, size_t offset, size_t size)
+{
+	for(size_t i = offset; i < offset + size; ++i)
+		mask[i >> 3] &= ~(1 << (i & 7));
+}
+
+/** Marks the bytes which differ between before and after, the string pointers excluded.
+ */
+static bool BuildMask(const SpellEntry & before, const SpellEntry & after, uint8 * mask)
+{
+	const uint8 * b = (const uint8*)&before;
+	const uint8 * a = (const uint8*)&after;
+	bool changed = false;
+
+	memset(mask, 0, SPELL_CACHE_MASK_SIZE);
+	for(size_t i = 0; i < sizeof(SpellEntry); ++i)
+	{
+		if(a[i] != b[i])
+			mask[i >> 3] |= (1 << (i & 7));
+	}
+
+	ClearMask(mask, offsetof(SpellEntry, Name), sizeof(char*));
+	ClearMask(mask, offsetof(SpellEntry, Rank), sizeof(char*));
+	ClearMask(mask, offsetof(SpellEntry, Description), sizeof(char*));
+	ClearMask(mask, offsetof(SpellEntry, BuffDescription), sizeof(char*));
+
+	for(size_t i = 0; i < SPELL_CACHE_MASK_SIZE; ++i)
+		changed |= (mask[i] != 0);
+
+	return changed;
+}
+
+bool SpellCache::CalculateKey(uint32 * key)
+{
+	// every table which is written into SpellEntry before the passes run
+	static const char * spellTables[] = { "spellfixes", "spell_proc", "spell_effects_override", "ai_threattospellid", NULL };
+	static const char * spellOptions[] = { "DeriveInFrontStatus", "ProcInferFix", "EffectSwapFix", "PolarityListExtended", NULL };
+	ByteBuffer buf(256);
+	uint64 version;
+	bool known = true;
+
+	buf << uint32(SPELL_CACHE_VERSION) << uint32(SPELL_FIX_VERSION) << uint32(sizeof(SpellEntry));
+	buf << FileCrc("DBC/Spell.dbc") << FileCrc("DBC/SpellItemEnchantment.dbc");
+
+	// the passes run on top of the database spell overrides
+	for(uint32 i = 0; spellTables[i] != NULL; ++i)
+	{
+		known &= WorldDatabase.GetTableVersion(spellTables[i], &version);
+		buf << version;
+	}
+
+	for(uint32 i = 0; spellOptions[i] != NULL; ++i)
+		buf << uint8(Config.MainConfig.GetBoolDefault("SpellDBC", spellOptions[i], true) ? 1 : 0);
+	buf << uint8(Config.MainConfig.GetBoolDefault("SpellFixes", "EnableDBOverrides", false) ? 1 : 0);
+
+	*key = (uint32)crc32(buf.contents(), (unsigned int)buf.size());
+	return known;
+}
+
+void SpellCache::Begin()
+{
+	SpellCacheEnchantRow er;
+	EnchantEntry * ench;
+
+	m_spellsBefore.resize(dbcSpell.GetNumRows());
+	for(uint32 i = 0; i < dbcSpell.GetNumRows(); ++i)
+		memcpy(&m_spellsBefore[i], dbcSpell.LookupRow(i), sizeof(SpellEntry));
+
+	m_enchantsBefore.clear();
+	for(uint32 i = 0; i < dbcEnchant.GetNumRows(); ++i)
+	{
+		ench = dbcEnchant.LookupRow(i);
+		er.id = ench->Id;
+		memcpy(er.spell, ench->spell, sizeof(er.spell));
+		m_enchantsBefore.push_back(er);
+	}
+
+	m_dummyCount = sWorld.dummyspells.size();
+}
+
+void SpellCache::End()
+{
+	SpellCacheRow row;
+	SpellEntry * sp;
+	EnchantEntry * ench;
+	size_t i;
+
+	m_rows.clear();
+	m_enchants.clear();
+
+	for(i = 0; i < m_spellsBefore.size(); ++i)
+	{
+		sp = dbcSpell.LookupRow((uint32)i);
+		if(!BuildMask(m_spellsBefore[i], *sp, row.mask))
+			continue;
+
+		row.flags = 0;
+		row.entry = *sp;
+		StripStrings(row.entry);
+		m_rows.push_back(row);
+	}
+
+	i = 0;
+	for(list<SpellEntry*>::iterator itr = sWorld.dummyspells.begin(); itr != sWorld.dummyspells.end(); ++itr, ++i)
+	{
+		if(i < m_dummyCount)
+			continue;
+
+		row.flags = SPELL_CACHE_ROW_DUMMY;
+		memset(row.mask, 0xFF, SPELL_CACHE_MASK_SIZE);
+		row.entry = *(*itr);
+		StripStrings(row.entry);
+		m_rows.push_back(row);
+	}
+
+	for(i = 0; i < m_enchantsBefore.size(); ++i)
+	{
+		ench = dbcEnchant.LookupRow((uint32)i);
+		if(memcmp(ench->spell, m_enchantsBefore[i].spell, sizeof(ench->spell)) == 0)
+			continue;
+
+		m_enchants.push_back(m_enchantsBefore[i]);
+		memcpy(m_enchants.back().spell, ench->spell, sizeof(ench->spell));
+	}
+
+	m_spellsBefore.clear();
+	m_enchantsBefore.clear();
+}
+
+bool SpellCache::Save(const char * filename, uint32 key)
+{
+	SpellCacheHeader header;
+	string tmpname = string(filename) + ".tmp";
+	FILE * f;
+	size_t rowsize = m_rows.size() * sizeof(SpellCacheRow);
+	size_t enchsize = m_enchants.size() * sizeof(SpellCacheEnchantRow);
+
+	header.magic = SPELL_CACHE_MAGIC;
+	header.version = SPELL_CACHE_VERSION;
+	header.key = key;
+	header.entry_size = sizeof(SpellEntry);
+	header.spell_rows = (uint32)m_rows.size();
+	header.enchant_rows = (uint32)m_enchants.size();
+
+	// the crc covers both blocks, they are written back to back
+	ByteBuffer data(rowsize + enchsize);
+	if(rowsize)
+		data.append((const uint8*)&m_rows[0], rowsize);
+	if(enchsize)
+		data.append((const uint8*)&m_enchants[0], enchsize);
+	header.data_crc = data.size() ? (uint32)crc32(data.contents(), (unsigned int)data.size()) : 0;
+
+	f = fopen(tmpname.c_str(), "wb");
+	if(f == NULL)
+	{
+		Log.Error("SpellCache", "Could not create %s.", tmpname.c_str());
+		return false;
+	}
+
+	if(fwrite(&header, sizeof(header), 1, f) != 1 ||
+		(data.size() && fwrite(data.contents(), data.size(), 1, f) != 1))
+	{
+		Log.Error("SpellCache", "Could not write %s.", tmpname.c_str());
+		fclose(f);
+		remove(tmpname.c_str());
+		return false;
+	}
+	fclose(f);
+
+	// replace the old cache only once the new one is complete
+	remove(filename);
+	if(rename(tmpname.c_str(), filename) != 0)
+	{
+		Log.Error("SpellCache", "Could not rename %s to %s.", tmpname.c_str(), filename);
+		remove(tmpname.c_str());
+		return false;
+	}
+
+	Log.Notice("SpellCache", "Stored %u changed spells and %u enchantments in %s.", header.spell_rows, header.enchant_rows, filename);
+	return true;
+}
+
+bool SpellCache::Load(const char * filename, uint32 key, bool any_key)
+{
+	SpellCacheHeader header;
+	MappedFile file;
+	const uint8 * data;
+	size_t rowsize, enchsize;
+
+	m_rows.clear();
+	m_enchants.clear();
+
+	if(!file.Open(filename) || file.GetSize() < sizeof(header))
+		return false;
+
+	memcpy(&header, file.GetData(), sizeof(header));
+	if(header.magic != SPELL_CACHE_MAGIC || header.version != SPELL_CACHE_VERSION || header.entry_size != sizeof(SpellEntry))
+	{
+		Log.Notice("SpellCache", "%s was written by another build, ignoring it.", filename);
+		return false;
+	}
+
+	if(!any_key && header.key != key)
+	{
+		Log.Notice("SpellCache", "%s is out of date, running the spell fixes.", filename);
+		return false;
+	}
+
+	rowsize = header.spell_rows * sizeof(SpellCacheRow);
+	enchsize = header.enchant_rows * sizeof(SpellCacheEnchantRow);
+	data = file.GetData() + sizeof(header);
+	if(file.GetSize() != sizeof(header) + rowsize + enchsize ||
+		(rowsize + enchsize && (uint32)crc32(data, (unsigned int)(rowsize + enchsize)) != header.data_crc))
+	{
+		Log.Error("SpellCache", "%s is damaged, ignoring it.", filename);
+		return false;
+	}
+
+	m_rows.resize(header.spell_rows);
+	m_enchants.resize(header.enchant_rows);
+	if(rowsize)
+		memcpy(&m_rows[0], data, rowsize);
+	if(enchsize)
+		memcpy(&m_enchants[0], data + rowsize, enchsize);
+
+	return true;
+}
+
+void SpellCache::Apply()
+{
+	uint32 start = getMSTime();
+	SpellEntry * sp;
+	EnchantEntry * ench;
+	uint8 * dst;
+	const uint8 * src;
+
+	for(vector<SpellCacheRow>::iterator itr = m_rows.begin(); itr != m_rows.end(); ++itr)
+	{
+		if(itr->flags & SPELL_CACHE_ROW_DUMMY)
+		{
+			// same as CreateDummySpell
+			sp = new SpellEntry;
+			memcpy(sp, &itr->entry, sizeof(SpellEntry));
+			dbcSpell.SetRow(sp->Id, sp);
+			sWorld.dummyspells.push_back(sp);
+			continue;
+		}
+
+		sp = dbcSpell.LookupEntryForced(itr->entry.Id);
+		if(sp == NULL)
+			continue;
+
+		// only what the passes changed, fields of the database loaders stay as loaded
+		dst = (uint8*)sp;
+		src = (const uint8*)&itr->entry;
+		for(size_t i = 0; i < sizeof(SpellEntry); ++i)
+		{
+			if(itr->mask[i >> 3] & (1 << (i & 7)))
+				dst[i] = src[i];
+		}
+	}
+
+	for(vector<SpellCacheEnchantRow>::iterator itr = m_enchants.begin(); itr != m_enchants.end(); ++itr)
+	{
+		ench = dbcEnchant.LookupEntryForced(itr->id);
+		if(ench != NULL)
+			memcpy(ench->spell, itr->spell, sizeof(ench->spell));
+	}
+
+	Log.Notice("SpellCache", "Applied %u cached spell fixes in %ums.", (uint32)m_rows.size(), getMSTime() - start);
+}
+
+uint32 SpellCache::Diff(SpellCache & previous, SpellDeltaCallback dump)
+{
+	map<uint32, const SpellCacheRow*> old;
+	map<uint32, const SpellCacheRow*>::iterator it;
+	uint32 changed = 0;
+
+	for(vector<SpellCacheRow>::iterator itr = previous.m_rows.begin(); itr != previous.m_rows.end(); ++itr)
+		old[itr->entry.Id] = &(*itr);
+
+	for(vector<SpellCacheRow>::iterator itr = m_rows.begin(); itr != m_rows.end(); ++itr)
+	{
+		it = old.find(itr->entry.Id);
+		if(it == old.end())
+		{
+			Log.Notice("SpellCache", "Spell %u is now changed by the fixes.", itr->entry.Id);
+			++changed;
+			continue;
+		}
+
+		if(memcmp(&it->second->entry, &itr->entry, sizeof(SpellEntry)) != 0 ||
+			memcmp(it->second->mask, itr->mask, SPELL_CACHE_MASK_SIZE) != 0)
+		{
+			Log.Notice("SpellCache", "Spell %u differs from the previous cache:", itr->entry.Id);
+			dump("SpellCache", it->second->entry, itr->entry);
+			++changed;
+		}
+		old.erase(it);
+	}
+
+	// whatever is left was only changed by the old fixes
+	for(it = old.begin(); it != old.end(); ++it)
+	{
+		Log.Notice("SpellCache", "Spell %u is no longer changed by the fixes.", it->first);
+		++changed;
+	}
+
+	Log.Notice("SpellCache", "%u spells differ from the previous cache.", changed);
+	return changed;
+}
@@ -0,0 +1,119 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// SpellCache.h
+//
+
+#ifndef __SPELLCACHE_H
+#define __SPELLCACHE_H
+
+#define SPELL_CACHE_MAGIC			0x43505353		// "SSPC"
+#define SPELL_CACHE_VERSION			2
+
+/** Version of the fix passes (SpellFixes.cpp, SpellDbcPostProcess.cpp), bump it with every
+ * change to them. Rebuilding the same code keeps the cache, changing it without a bump
+ * keeps serving the old results.
+ */
+#define SPELL_FIX_VERSION			2
+
+#define SPELL_CACHE_ROW_DUMMY		0x01			// created by CreateDummySpell, not in Spell.dbc
+
+struct SpellCacheHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint32 key;
+	uint32 entry_size;			// sizeof(SpellEntry) of the build which wrote the cache
+	uint32 spell_rows;
+	uint32 enchant_rows;
+	uint32 data_crc;
+};
+
+#define SPELL_CACHE_MASK_SIZE		((sizeof(SpellEntry) + 7) / 8)
+
+/** Spell changed by the fix passes. mask has a bit for every byte of the entry the
+ * passes changed, only those are written back, everything the database loaders
+ * put into the row before the passes ran is kept. String pointers are never stored.
+ */
+struct SpellCacheRow
+{
+	uint32 flags;
+	uint8 mask[SPELL_CACHE_MASK_SIZE];
+	SpellEntry entry;
+};
+
+struct SpellCacheEnchantRow
+{
+	uint32 id;
+	uint32 spell[3];
+};
+
+typedef void (*SpellDeltaCallback)(const char * source, const SpellEntry & before, const SpellEntry & after);
+
+/** Result of the hardcoded spell fix passes (Apply112SpellFixes, ApplyExtraDataFixes,
+ * ApplyNormalFixes) stored as the rows they changed. The cache is keyed by the DBC
+ * files, the fix version and everything else the passes read, so a matching cache
+ * can be applied instead of running them.
+ */
+class SpellCache
+{
+public:
+	SpellCache() : m_dummyCount(0) {}
+
+	/** Key of the current Spell.dbc, fix version, spell tables and [SpellDBC] options.
+	 * Returns false if the database cannot tell whether a spell table changed.
+	 */
+	static bool CalculateKey(uint32 * key);
+
+	/** Remembers the state of the spells before the fix passes run.
+	 */
+	void Begin();
+
+	/** Collects the rows which changed since Begin().
+	 */
+	void End();
+
+	bool Save(const char * filename, uint32 key);
+
+	/** Reads the cache, any_key accepts a cache written for other data (for Diff).
+	 */
+	bool Load(const char * filename, uint32 key, bool any_key = false);
+
+	/** Writes the changed bytes of the cached rows into dbcSpell and the cached
+	 * enchantment spells into dbcEnchant.
+	 */
+	void Apply();
+
+	/** Logs the spells which differ from the previous cache, returns their count.
+	 */
+	uint32 Diff(SpellCache & previous, SpellDeltaCallback dump);
+
+	ASCENT_INLINE uint32 GetRowCount() { return (uint32)m_rows.size(); }
+
+private:
+	vector<SpellEntry> m_spellsBefore;
+	vector<SpellCacheEnchantRow> m_enchantsBefore;
+	size_t m_dummyCount;
+
+	vector<SpellCacheRow> m_rows;
+	vector<SpellCacheEnchantRow> m_enchants;
+};
+
+#endif
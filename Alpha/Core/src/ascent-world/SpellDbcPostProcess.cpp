@@ -10,6 +10,9 @@
 #include <map>
 #include <vector>
 
+// The cached spell fixes are made on top of this pass. Bump SPELL_FIX_VERSION (SpellCache.h)
+// with every change to it, or servers keep loading the old results.
+
 
 // -----------------------------------------------------------------------------
 // Minimal DBC-backed registries (no need to change SpellEntry structs)
@@ -19,6 +19,9 @@
 
 #include "StdAfx.h"
 
+// The spell cache stores the result of the passes in this file. Bump SPELL_FIX_VERSION
+// (SpellCache.h) with every change to them, or servers keep loading the old results.
+
 void CreateDummySpell(uint32 id)
 {
 	const char * name = "Dummy Trigger";
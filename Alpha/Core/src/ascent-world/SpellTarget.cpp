@@ -403,7 +403,7 @@ void Spell::SpellTargetSingleTargetEnemy(uint32 i, uint32 j)
 		uint32 jumps=m_spellInfo->EffectChainTarget[i]-1;
 		float range=GetMaxRange(dbcSpellRange.LookupEntry(m_spellInfo->rangeIndex));//this is probably wrong
 		range*=range;
-		std::set<Object*>::iterator itr;
+		Object::InRangeSet::iterator itr;
 		for( itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
 		{
 			if((*itr)->GetGUID()==m_targets.m_unitTarget)
@@ -535,7 +535,7 @@ void Spell::SpellTargetSingleGameobjectTarget(uint32 i, uint32 j)
 void Spell::SpellTargetInFrontOfCaster(uint32 i, uint32 j)
 {
 	TargetsList *tmpMap=&m_targetUnits[i];
-	std::set<Object*>::iterator itr;
+	Object::InRangeSet::iterator itr;
 	uint8 did_hit_result;
 	for( itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
 	{
@@ -870,7 +870,7 @@ void Spell::SpellTargetChainTargeting(uint32 i, uint32 j)
 	}//find nearby friendly target
 	else
 	{
-		std::set<Object*>::iterator itr;
+		Object::InRangeSet::iterator itr;
 		for( itr = firstTarget->GetInRangeSetBegin(); itr != firstTarget->GetInRangeSetEnd(); itr++ )
 		{
 			if( !(*itr)->IsUnit() || !((Unit*)(*itr))->isAlive())
@@ -928,7 +928,7 @@ void Spell::SpellTargetTargetAreaSelectedUnit(uint32 i, uint32 j)
 void Spell::SpellTargetInFrontOfCaster2(uint32 i, uint32 j)
 {
 	TargetsList *tmpMap=&m_targetUnits[i];
-	std::set<Object*>::iterator itr;
+	Object::InRangeSet::iterator itr;
 	uint8 did_hit_result;
 	for( itr = m_caster->GetInRangeSetBegin(); itr != m_caster->GetInRangeSetEnd(); itr++ )
 	{
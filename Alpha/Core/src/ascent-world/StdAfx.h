@@ -40,6 +40,7 @@
 #include "../ascent-shared/Common.h"
 #include "../ascent-shared/MersenneTwister.h"
 #include "../ascent-shared/WorldPacket.h"
+#include "../ascent-shared/WorldPacketPool.h"
 #include "../ascent-shared/Log.h"
 #include "../ascent-shared/NGLog.h"
 #include "../ascent-shared/ByteBuffer.h"
@@ -81,6 +82,7 @@
 #include "WordFilter.h"
 #include "EventMgr.h"
 #include "EventableObject.h"
+#include "IndexedObjectSet.h"
 #include "Object.h"
 #include "LootMgr.h"
 #include "Unit.h"
@@ -120,15 +122,21 @@
 #include "Pet.h"
 #include "WorldSocket.h"
 #include "WorldSession.h"
+#include "SharedUpdateBlock.h"
+#include "MapUpdateScheduler.h"
+#include "UpdateCompressor.h"
+#include "PeriodicAuraScheduler.h"
 #include "MapMgr.h"
 #include "MapScriptInterface.h"
 #include "Player.h"
+#include "FactionRelations.h"
 #include "faction.h"
 #include "Skill.h"
 #include "SkillNameMgr.h"
 #include "SpellNameHashes.h"
 #include "Spell.h"
 #include "SpellAuras.h"
+#include "SpellCache.h"
 #include "TaxiMgr.h"
 #include "TransporterHandler.h"
 #include "WarsongGulch.h"
@@ -23,8 +23,12 @@
 
 TerrainMgr::TerrainMgr(string MapPath, uint32 MapId, bool Instanced) : mapPath(MapPath), mapId(MapId), Instance(Instanced)
 {
+#ifndef USE_MEMORY_MAPPING_FOR_MAPS
 	FileDescriptor = NULL;
 	CellInformation = NULL;
+#else
+	m_cellOffsets = NULL;
+#endif
 }
 
 TerrainMgr::~TerrainMgr()
@@ -55,24 +59,8 @@ TerrainMgr::~TerrainMgr()
 		CellInformation = NULL;
 	}
 #else
-
-	mutex.Acquire();
-
-	// Big memory cleanup, whee.
-	for(uint32 x = 0; x < _sizeX; ++x)
-	{
-		delete [] CellInformation[x];
-	}
-	delete [] CellInformation;
-
-#ifdef WIN32
-	UnmapViewOfFile(m_Memory);
-	CloseHandle(hMap);
-	CloseHandle(hMappedFile);
-#else
-#error moo
-#endif
-	mutex.Release();
+	// nothing was allocated, the mapping goes away with m_file
+	m_cellOffsets = NULL;
 #endif
 }
 
@@ -138,52 +126,32 @@ bool TerrainMgr::LoadTerrainHeader()
 
 #else
 
-#ifdef WIN32
-	
-	DWORD sizehigh;
-
-	hMappedFile = CreateFile(File, GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_ARCHIVE, NULL);
-	if(hMappedFile == INVALID_HANDLE_VALUE)
-		return false;
-
-	hMap = CreateFileMapping(hMappedFile, NULL, PAGE_READONLY, 0, 0, NULL);
-	if(hMap==INVALID_HANDLE_VALUE)
+	if(!m_file.Open(File))
 	{
-		CloseHandle(hMappedFile);
+		Log.Error("TerrainMgr", "Map load failed for %s. Missing file?", File);
 		return false;
 	}
 
-	mFileSize = GetFileSize(hMappedFile, &sizehigh);
-
-	ASSERT(ReadFile(hMappedFile, CellOffsets, TERRAIN_HEADER_SIZE, &sizehigh, NULL));
-	ASSERT(sizehigh==TERRAIN_HEADER_SIZE);
-
-	SetFilePointer(hMappedFile, 0, NULL, FILE_BEGIN);
-	m_Memory = (uint8*)MapViewOfFile(hMap, FILE_MAP_READ, 0, TERRAIN_HEADER_SIZE, mFileSize-TERRAIN_HEADER_SIZE);
-	if(m_Memory==NULL)
+	/* file with no data */
+	if(m_file.GetSize() <= TERRAIN_HEADER_SIZE)
 	{
-		CloseHandle(hMap);
-		CloseHandle(hMappedFile);
+		m_file.Close();
+		return false;
 	}
 
-	// Allocate both storage arrays.
-	CellInformation = new CellTerrainInformation**[_sizeX];
-	for(uint32 x = 0; x < _sizeX; ++x)
+	// Every offset has to point at a whole cell, lookups don't check them again.
+	const uint32 * offsets = (const uint32*)m_file.GetData();
+	for(uint32 i = 0; i < _sizeX * _sizeY; ++i)
 	{
-		CellInformation[x] = new CellTerrainInformation*[_sizeY];
-		for(uint32 y = 0; y < _sizeY; ++y)
+		if(offsets[i] != 0 && (offsets[i] < TERRAIN_HEADER_SIZE || offsets[i] + sizeof(CellTerrainInformation) > m_file.GetSize()))
 		{
-			// Set pointer
-			if(CellOffsets[x][y] != 0)
-				CellInformation[x][y] = (CellTerrainInformation*)m_Memory+CellOffsets[x][y]-TERRAIN_HEADER_SIZE;
-			else
-				CellInformation[x][y] = 0;
+			Log.Error("TerrainMgr", "%s is damaged (cell %u points outside of the file).", File, i);
+			m_file.Close();
+			return false;
 		}
 	}
 
-#else
-#error unimplemented in *nix
-#endif
+	m_cellOffsets = offsets;
 	return true;
 #endif
 }
@@ -191,10 +159,12 @@ bool TerrainMgr::LoadTerrainHeader()
 bool TerrainMgr::LoadCellInformation(uint32 x, uint32 y)
 {
 #ifdef USE_MEMORY_MAPPING_FOR_MAPS
-	if(CellOffsets[x][y]==0)
+	if(!CellInformationLoaded(x, y))
 		return false;
-	else
-		return true;
+
+	// start reading the pages in before the first lookup faults on them
+	m_file.Prefetch(GetCellInformationOffset(x, y), sizeof(CellTerrainInformation));
+	return true;
 #else
 	if(!FileDescriptor)
 		return false;
@@ -261,6 +231,8 @@ bool TerrainMgr::LoadCellInformation(uint32 x, uint32 y)
 bool TerrainMgr::UnloadCellInformation(uint32 x, uint32 y)
 {
 #ifdef USE_MEMORY_MAPPING_FOR_MAPS
+	// the pages stay in the page cache for the other instances, they just leave our resident set
+	m_file.Release(GetCellInformationOffset(x, y), sizeof(CellTerrainInformation));
 	return true;
 #else
 	uint32 Start = getMSTime();
@@ -368,27 +340,121 @@ float TerrainMgr::GetLandHeight(float x, float y)
 	float IntX = ConvertInternalXCoordinate(x, CellX);
 	float IntY = ConvertInternalYCoordinate(y, CellY);
 
-	// Calculate x index.
-	float TempFloat = IntX * (MAP_RESOLUTION / CellsPerTile / _cellSize);
-	uint32 XOffset = FL2UINT(TempFloat);
-	if((TempFloat - (XOffset * _cellSize)) >= 0.5f)
-		++XOffset;
+	return GetInterpolatedHeight(GetCellInformation(CellX, CellY), CellX, CellY, IntX, IntY);
+}
+
+float TerrainMgr::GetHeightSample(CellTerrainInformation * info, uint32 CellX, uint32 CellY, uint32 x, uint32 y)
+{
+	if(x < CELL_RESOLUTION && y < CELL_RESOLUTION)
+		return info->Z[x][y];
 
-	// Calculate y index.
-	TempFloat = IntY * (MAP_RESOLUTION / CellsPerTile / _cellSize);
-	uint32 YOffset = FL2UINT(TempFloat);
-	if((TempFloat - (YOffset * _cellSize)) >= 0.5f)
-		++YOffset;
+	// The last row/column blends into the first one of the next cell.
+	uint32 NextX = (x < CELL_RESOLUTION) ? CellX : CellX + 1;
+	uint32 NextY = (y < CELL_RESOLUTION) ? CellY : CellY + 1;
+	if(NextX < _sizeX && NextY < _sizeY && CellInformationLoaded(NextX, NextY))
+		return GetCellInformation(NextX, NextY)->Z[x % CELL_RESOLUTION][y % CELL_RESOLUTION];
 
-	// Return our cached information.
-	return GetCellInformation(CellX, CellY)->Z[XOffset][YOffset];
+	// Not loaded, stay on our own edge.
+	return info->Z[(x < CELL_RESOLUTION) ? x : CELL_RESOLUTION - 1][(y < CELL_RESOLUTION) ? y : CELL_RESOLUTION - 1];
+}
+
+float TerrainMgr::GetInterpolatedHeight(CellTerrainInformation * info, uint32 CellX, uint32 CellY, float IntX, float IntY)
+{
+	// Position in the height grid.
+	float GridX = IntX * (CELL_RESOLUTION / _cellSize);
+	float GridY = IntY * (CELL_RESOLUTION / _cellSize);
+	if(GridX < 0.0f)
+		GridX = 0.0f;
+	if(GridY < 0.0f)
+		GridY = 0.0f;
+
+	uint32 XOffset = FL2UINT(GridX);
+	uint32 YOffset = FL2UINT(GridY);
+	if(XOffset >= CELL_RESOLUTION)
+		XOffset = CELL_RESOLUTION - 1;
+	if(YOffset >= CELL_RESOLUTION)
+		YOffset = CELL_RESOLUTION - 1;
+
+	// Distance from the sample, 0 - 1.
+	float DeltaX = GridX - XOffset;
+	float DeltaY = GridY - YOffset;
+	if(DeltaX > 1.0f)
+		DeltaX = 1.0f;
+	if(DeltaY > 1.0f)
+		DeltaY = 1.0f;
+
+	float h00 = info->Z[XOffset][YOffset];
+	float h10 = GetHeightSample(info, CellX, CellY, XOffset + 1, YOffset);
+	float h01 = GetHeightSample(info, CellX, CellY, XOffset, YOffset + 1);
+	float h11 = GetHeightSample(info, CellX, CellY, XOffset + 1, YOffset + 1);
+
+	float h0 = h00 + (h10 - h00) * DeltaX;
+	float h1 = h01 + (h11 - h01) * DeltaX;
+	return h0 + (h1 - h0) * DeltaY;
+}
+
+void TerrainMgr::GetTerrainInfo(uint32 count, const float * x, const float * y, float * heights, float * waterHeights, uint16 * areas)
+{
+	CellTerrainInformation * info = NULL;
+	uint32 LastX = 0xFFFFFFFF;
+	uint32 LastY = 0xFFFFFFFF;
+	uint32 CellX, CellY, AreaX, AreaY;
+	float IntX, IntY;
+
+	for(uint32 i = 0; i < count; ++i)
+	{
+		if(AreCoordinatesValid(x[i], y[i]))
+		{
+			CellX = ConvertGlobalXCoordinate(x[i]);
+			CellY = ConvertGlobalYCoordinate(y[i]);
+
+			// Only look the cell up again when we leave it.
+			if(CellX != LastX || CellY != LastY)
+			{
+				LastX = CellX;
+				LastY = CellY;
+				if(CellInformationLoaded(CellX, CellY) || LoadCellInformation(CellX, CellY))
+					info = GetCellInformation(CellX, CellY);
+				else
+					info = NULL;
+			}
+
+			if(info != NULL)
+			{
+				IntX = ConvertInternalXCoordinate(x[i], CellX);
+				IntY = ConvertInternalYCoordinate(y[i], CellY);
+				AreaX = ConvertTo2dArray(IntX);
+				AreaY = ConvertTo2dArray(IntY);
+
+				if(heights != NULL)
+					heights[i] = GetInterpolatedHeight(info, CellX, CellY, IntX, IntY);
+				if(waterHeights != NULL)
+					waterHeights[i] = info->LiquidLevel[AreaX][AreaY];
+				if(areas != NULL)
+					areas[i] = info->AreaID[AreaX][AreaY];
+				continue;
+			}
+		}
+
+		// Same values as the single point functions.
+		if(heights != NULL)
+			heights[i] = 0.0f;
+		if(waterHeights != NULL)
+			waterHeights[i] = 0.0f;
+		if(areas != NULL)
+			areas[i] = 0;
+	}
 }
 
 void TerrainMgr::CellGoneActive(uint32 x, uint32 y)
 {
+#ifdef USE_MEMORY_MAPPING_FOR_MAPS
+	LoadCellInformation(x, y);
+#else
 	// Load cell information if it's not already loaded.
 	if(!CellInformationLoaded(x, y))
 		LoadCellInformation(x, y);
+#endif
 }
 
 void TerrainMgr::CellGoneIdle(uint32 x, uint32 y)
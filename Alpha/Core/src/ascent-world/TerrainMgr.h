@@ -28,9 +28,15 @@ typedef struct
 	float Z[32][32];
 }CellTerrainInformation; 
 
+/* mapped cells are used as they are stored, big endian builds have to swap them */
+#if defined(USE_MEMORY_MAPPING_FOR_MAPS) && defined(USING_BIG_ENDIAN)
+#undef USE_MEMORY_MAPPING_FOR_MAPS
+#endif
+
 #define FL2UINT (uint32)
 #define TERRAIN_HEADER_SIZE 1048576	 // size of [512][512] array.
 #define MAP_RESOLUTION 256
+#define CELL_RESOLUTION (MAP_RESOLUTION / CellsPerTile)	 // height samples per cell and axis.
 
 /* @class TerrainMgr
    TerrainMgr maintains the MapCellInfo information for accessing water levels,
@@ -43,6 +49,11 @@ typedef struct
    However, on instanced maps, we would want to keep the cell's information
    loaded at all times as it is a lot smaller and we can have multiple instances
    wanting to access this information at once.
+
+   With USE_MEMORY_MAPPING_FOR_MAPS the whole file is mapped read-only instead.
+   Lookups read the mapping without locking, the pages are shared by all instances
+   of the map (and every process using the same file), and activity only decides
+   which pages the OS is asked to read ahead or may drop.
   */
 
 class SERVER_DECL TerrainMgr
@@ -83,6 +94,7 @@ public:
 	   These functions all take the same input values, an x and y global co-ordinate.
 	   They will all return 0 if the cell information is not loaded or does not exist,
 	   apart from the water function which will return '-999999.0'.
+	   Land heights are interpolated between the four surrounding height samples.
 	  */
 	float  GetLandHeight(float x, float y);
 	float  GetWaterHeight(float x, float y);
@@ -90,6 +102,19 @@ public:
 	uint8  GetWalkableState(float x, float y);
 	uint16 GetAreaID(float x, float y);
 
+	/* Retrieves the land height, water height and area id of many points at once.
+	   Points that fall into the same cell as the point before them reuse its lookup,
+	   so nearby points should be passed next to each other.
+	   Parameter 1: The number of points.
+	   Parameter 2: The global x co-ordinates.
+	   Parameter 3: The global y co-ordinates.
+	   Parameter 4: Receives the land heights, can be NULL.
+	   Parameter 5: Receives the water heights, can be NULL.
+	   Parameter 6: Receives the area id's, can be NULL.
+	   No return value.
+	  */
+	void GetTerrainInfo(uint32 count, const float * x, const float * y, float * heights, float * waterHeights, uint16 * areas);
+
 private:
 
 	/// MapPath contains the location of all mapfiles.
@@ -101,10 +126,10 @@ private:
 	/// Are we an instance?
 	bool Instance;
 
+#ifndef USE_MEMORY_MAPPING_FOR_MAPS
+
 	/// We don't want to be reading from a file from more than one thread at once
 	Mutex mutex;
-
-#ifndef USE_MEMORY_MAPPING_FOR_MAPS
 	
 	/// Our main file descriptor for accessing the binary terrain file.
 	FILE * FileDescriptor;
@@ -112,21 +137,18 @@ private:
 	/// This holds the offsets of the cell information for each cell.
 	uint32 CellOffsets[_sizeX][_sizeY];
 
+	/// Our storage array. This contains pointers to all allocated CellInfo's.
+	CellTerrainInformation *** CellInformation;
+
 #else
 
-	/// Mapped file handle
-	HANDLE hMappedFile;
-	HANDLE hMap;
-	uint32 mFileSize;
+	/// The whole map file, the offset table is at its start.
+	MappedFile m_file;
 
-	/// This holds the offsets of the cell information for each cell.
-	uint32 CellOffsets[_sizeX][_sizeY];
-	uint8 * m_Memory;
+	/// Offsets of the cell information for each cell, [_sizeX][_sizeY] inside the mapping.
+	const uint32 * m_cellOffsets;
 
 #endif
-
-	/// Our storage array. This contains pointers to all allocated CellInfo's.
-	CellTerrainInformation *** CellInformation;
 	
 public:
 	/* Initializes the file descriptor and readys it for data retreival.
@@ -151,6 +173,27 @@ protected:
 	  */
 	bool UnloadCellInformation(uint32 x, uint32 y);
 
+	/* Interpolates the land height between the four height samples around a point.
+	   Parameter 1: The information of the cell the point is in.
+	   Parameter 2: cell x co-ordinate.
+	   Parameter 3: cell y co-ordinate.
+	   Parameter 4: internal x co-ordinate of the point.
+	   Parameter 5: internal y co-ordinate of the point.
+	   Returns the land height.
+	  */
+	float GetInterpolatedHeight(CellTerrainInformation * info, uint32 CellX, uint32 CellY, float IntX, float IntY);
+
+	/* Gets a height sample of a cell. Samples one past the last row or column are
+	   taken from the neighbouring cell if it is loaded, otherwise from the edge.
+	   Parameter 1: The information of the cell.
+	   Parameter 2: cell x co-ordinate.
+	   Parameter 3: cell y co-ordinate.
+	   Parameter 4: sample x index, up to CELL_RESOLUTION.
+	   Parameter 5: sample y index, up to CELL_RESOLUTION.
+	   Returns the height of the sample.
+	  */
+	float GetHeightSample(CellTerrainInformation * info, uint32 CellX, uint32 CellY, uint32 x, uint32 y);
+
 	/* Gets the offset for the specified cell from the cached offset index.
 	   Parameter 1: cell x co-ordinate.
 	   Parameter 2: cell y co-ordinate.
@@ -158,7 +201,11 @@ protected:
 	  */
 	ASCENT_INLINE uint32 GetCellInformationOffset(uint32 x, uint32 y)
 	{
+#ifdef USE_MEMORY_MAPPING_FOR_MAPS
+		return m_cellOffsets[x * _sizeY + y];
+#else
 		return CellOffsets[x][y];
+#endif
 	}
 
 	/* Gets a cell information pointer so that another function can access its data.
@@ -168,7 +215,11 @@ protected:
 	  */
 	ASCENT_INLINE CellTerrainInformation* GetCellInformation(uint32 x, uint32 y)
 	{
+#ifdef USE_MEMORY_MAPPING_FOR_MAPS
+		return (CellTerrainInformation*)(m_file.GetData() + GetCellInformationOffset(x, y));
+#else
 		return CellInformation[x][y];
+#endif
 	}
 
 	/* Converts a global x co-ordinate into a cell x co-ordinate.
@@ -217,10 +268,15 @@ protected:
 	  */
 	ASCENT_INLINE bool CellInformationLoaded(uint32 x, uint32 y)
 	{
+#ifdef USE_MEMORY_MAPPING_FOR_MAPS
+		// mapped cells are always there, the OS pages them in
+		return (m_cellOffsets != NULL && GetCellInformationOffset(x, y) != 0);
+#else
 		if(CellInformation[x][y] != 0)
 			return true;
 		else
 			return false;
+#endif
 	}
 
 	/* Converts the internal co-ordinate to an index in the 
@@ -212,6 +212,8 @@ Unit::Unit()
 	m_redirectSpellPackets = 0;
 	can_parry = false;
 	bProcInUse = false;
+	m_procIndex = NULL;
+	m_procIndexDirty = false;
 	spellcritperc = 0;
 
 	polySpell = 0;
@@ -276,6 +278,11 @@ Unit::~Unit()
 
 	delete m_aiInterface;
 
+	if( m_procIndex != NULL )
+		delete m_procIndex;
+	for( vector< ProcTriggerIndex* >::iterator itr = m_procIndexRetired.begin(); itr != m_procIndexRetired.end(); ++itr )
+		delete *itr;
+
 	/*for(int i = 0; i < 4; i++)
 		if(m_ObjectSlots[i])
 			delete m_ObjectSlots[i];*/
@@ -568,15 +575,37 @@ void Unit::GiveGroupXP(Unit *pVictim, Player *PlayerInGroup)
 	}*/
 }
 
-void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint32 dmg, uint32 abs )
+void Unit::AddProcTriggerSpell( ProcTriggerSpell & pts, bool front )
 {
-	++m_procCounter;
-	bool can_delete = !bProcInUse; //if this is a nested proc then we should have this set to TRUE by the father proc
-	bProcInUse = true; //locking the proc list
+	pts.origSpell = dbcSpell.LookupEntry( pts.origId );
+	pts.spell = dbcSpell.LookupEntry( pts.spellId );
 
-	std::list< uint32 > remove;
-	std::list< struct ProcTriggerSpell >::iterator itr,itr2;
-	for( itr = m_procSpells.begin(); itr != m_procSpells.end(); )  // Proc Trigger Spells for Victim
+	if( front )
+		m_procSpells.push_front( pts );
+	else
+		m_procSpells.push_back( pts );
+
+	m_procIndexDirty = true;
+}
+
+void Unit::_UpdateProcIndex( bool can_delete )
+{
+	if( can_delete )
+	{
+		// no HandleProc is running, nothing iterates the replaced indexes any more
+		for( vector< ProcTriggerIndex* >::iterator itr = m_procIndexRetired.begin(); itr != m_procIndexRetired.end(); ++itr )
+			delete *itr;
+		m_procIndexRetired.clear();
+	}
+
+	if( !m_procIndexDirty )
+		return;
+
+	m_procIndexDirty = false;
+
+	ProcTriggerIndex * index = NULL;
+	std::list< struct ProcTriggerSpell >::iterator itr, itr2;
+	for( itr = m_procSpells.begin(); itr != m_procSpells.end(); )
 	{
 		itr2 = itr;
 		++itr;
@@ -587,28 +616,109 @@ void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint
 			continue;
 		}
 
-		uint32 origId = itr2->origId;
+		if( index == NULL )
+			index = new ProcTriggerIndex;
+		index->entries.push_back( &(*itr2) );
+	}
+
+	if( index != NULL )
+	{
+		uint32 count = (uint32)index->entries.size();
+		uint32 flags, b;
+		index->mask = 0;
+		index->words = ( count + 31 ) / 32;
+		index->buckets.resize( 32 * index->words, 0 );
+		for( uint32 i = 0; i < count; ++i )
+		{
+			flags = index->entries[i]->procFlags;
+			index->mask |= flags;
+			for( b = 0; flags != 0; flags >>= 1, ++b )
+			{
+				if( flags & 1 )
+					index->buckets[ b * index->words + i / 32 ] |= ( 1 << ( i % 32 ) );
+			}
+		}
+	}
+
+	// a HandleProc further up the stack may still walk the old one
+	if( m_procIndex != NULL )
+	{
+		if( can_delete )
+			delete m_procIndex;
+		else
+			m_procIndexRetired.push_back( m_procIndex );
+	}
+	m_procIndex = index;
+}
+
+void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint32 dmg, uint32 abs )
+{
+	++m_procCounter;
+	bool can_delete = !bProcInUse; //if this is a nested proc then we should have this set to TRUE by the father proc
+	bProcInUse = true; //locking the proc list
+
+	std::list< uint32 > remove;
+	_UpdateProcIndex( can_delete );
+
+	// Proc Trigger Spells for Victim. Only the buckets of the flags we were called with are
+	// visited, in registration order.
+	ProcTriggerIndex * index = m_procIndex;
+	uint32 trigger = ( index != NULL ) ? ( flag & index->mask ) : 0;
+	uint32 word = 0, bits = 0, pos = 0, t, b;
+	ProcTriggerSpell * pts;
+	while( trigger )
+	{
+		if( bits == 0 )
+		{
+			if( word == index->words )
+				break;
+			for( t = trigger, b = 0; t != 0; t >>= 1, ++b )
+			{
+				if( t & 1 )
+					bits |= index->buckets[ b * index->words + word ];
+			}
+			pos = word * 32;
+			++word;
+			continue;
+		}
+
+		while( !( bits & 1 ) )
+		{
+			bits >>= 1;
+			++pos;
+		}
+		bits >>= 1;
+		pts = index->entries[ pos++ ];
+
+		if( pts->deleted )
+		{
+			// dropped from the list the next time the index is built
+			m_procIndexDirty = true;
+			continue;
+		}
+
+		uint32 origId = pts->origId;
 		if( CastingSpell != NULL )
 		{
 			//this is to avoid spell proc on spellcast loop. We use dummy that is same for both spells
-			//if( CastingSpell->Id == itr2->spellId )
+			//if( CastingSpell->Id == pts->spellId )
 			if( 
-//				CastingSpell->Id == itr2->origId || // seed of corruption and pyroclasm proc on self 
-				CastingSpell->Id == itr2->spellId )
+//				CastingSpell->Id == pts->origId || // seed of corruption and pyroclasm proc on self 
+				CastingSpell->Id == pts->spellId )
 			{
-				//printf("WOULD CRASH HERE ON PROC: CastingId: %u, OrigId: %u, SpellId: %u\n", CastingSpell->Id, itr2->origId, itr2->spellId);
+				//printf("WOULD CRASH HERE ON PROC: CastingId: %u, OrigId: %u, SpellId: %u\n", CastingSpell->Id, pts->origId, pts->spellId);
 				continue;
 			}
 		}
-		SpellEntry* ospinfo = dbcSpell.LookupEntry( origId );//no need to check if exists or not since we were not able to register this trigger if it would not exist :P
+		SpellEntry* ospinfo = pts->origSpell;
 		
 		//this requires some specific spell check,not yet implemented
-		if( itr2->procFlags & flag )
+		if( pts->procFlags & flag )
 		{
-			uint32 spellId = itr2->spellId;
-			SpellEntry* spe  = dbcSpell.LookupEntry( spellId );
+			uint32 spellId = pts->spellId;
+			SpellEntry* spe  = pts->spell;
 
-			if( itr2->procFlags & PROC_ON_CAST_SPECIFIC_SPELL )
+			if( pts->procFlags & PROC_ON_CAST_SPECIFIC_SPELL )
 			{
 
 				if( CastingSpell == NULL )
@@ -631,7 +741,7 @@ void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint
 						continue;
 			}
 
-			uint32 proc_Chance = itr2->procChance;
+			uint32 proc_Chance = pts->procChance;
 
 			// feral = no procs (need a better way to do this)
 			/*if( this->IsPlayer() && static_cast<Player*>(this)->GetShapeShift() )
@@ -701,7 +811,7 @@ void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint
 			if( spellId && Rand( proc_Chance ) )
 			{
 				SpellCastTargets targets;
-				if( itr2->procFlags & PROC_TARGET_SELF )
+				if( pts->procFlags & PROC_TARGET_SELF )
 					targets.m_unitTarget = GetGUID();
 				else 
 					targets.m_unitTarget = victim->GetGUID();
@@ -718,12 +828,12 @@ void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint
 				if( ospinfo->proc_interval )
 				{
 					uint32 now_in_ms=getMSTime();
-					if( itr2->LastTrigger + ospinfo->proc_interval > now_in_ms )
+					if( pts->LastTrigger + ospinfo->proc_interval > now_in_ms )
 						continue; //we can't trigger it yet.
-					itr2->LastTrigger = now_in_ms; // consider it triggered
+					pts->LastTrigger = now_in_ms; // consider it triggered
 				}
 				//since we did not allow to remove auras like these with interrupt flag we have to remove them manually.
-				if( itr2->procFlags & PROC_REMOVEONUSE )
+				if( pts->procFlags & PROC_REMOVEONUSE )
 					RemoveAura( origId );
 				int dmg_overwrite = 0;
 
@@ -977,8 +1087,8 @@ void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint
 								if( CastingSpell->NameHash != SPELL_HASH_SEED_OF_CORRUPTION )						
 									continue;
 								//this spell builds up in time
-								(*itr2).procCharges += dmg;
-								if( (int32)(*itr2).procCharges >= ospinfo->EffectBasePoints[ 1 ] && //if charge built up
+								pts->procCharges += dmg;
+								if( (int32)pts->procCharges >= ospinfo->EffectBasePoints[ 1 ] && //if charge built up
 									dmg < (int32)this->GetUInt32Value( UNIT_FIELD_HEALTH ) ) //if this is not a killer blow
 									can_proc_now = true;
 							}
@@ -996,7 +1106,7 @@ void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint
 								targets.m_destZ = GetPositionZ();
 								spell->prepare(&targets);
 							}
-							(*itr2).deleted = true;
+							pts->deleted = true;
 							continue;
 						}break;							
 						// warlock - Improved Drain Soul
@@ -1167,8 +1277,8 @@ void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint
 									continue;
 								if( flag & PROC_ON_SPELL_CRIT_HIT )
 								{
-									itr2->procCharges++;
-									if( itr2->procCharges >= 3 ) //whatch that number cause it depends on original stack count !
+									pts->procCharges++;
+									if( pts->procCharges >= 3 ) //whatch that number cause it depends on original stack count !
 										RemoveAllAuraByNameHash( SPELL_HASH_COMBUSTION );
 									continue;
 								}
@@ -1755,14 +1865,15 @@ void Unit::HandleProc( uint32 flag, Unit* victim, SpellEntry* CastingSpell, uint
 
 				if(spellId==22858 && isInBack(victim)) //retatliation needs target to be not in front. Can be casted by creatures too
 					continue;
-				SpellEntry *spellInfo = dbcSpell.LookupEntry(spellId );
+				// some handlers (Lightning Overload) proc a different spell than the registered one
+				SpellEntry *spellInfo = (spellId == pts->spellId) ? pts->spell : dbcSpell.LookupEntry(spellId);
 				Spell *spell = new Spell(this, spellInfo ,true, NULL);
 				spell->forced_basepoints[0] = dmg_overwrite;
 				spell->ProcedOnSpell = CastingSpell;
 				//Spell *spell = new Spell(this,spellInfo,false,0,true,false);
 				if(spellId==974||spellId==32593||spellId==32594) // Earth Shield handler
 				{
-					spell->pSpellId=itr2->spellId;
+					spell->pSpellId=pts->spellId;
 					spell->SpellEffectDummy(0);
 					delete spell;
 					continue;
@@ -3351,7 +3462,7 @@ else
 		int32 m_temp = m_extrastriketargets;
 		m_extrastriketargets = 0;
 
-		for(set<Object*>::iterator itr = m_objectsInRange.begin(); itr != m_objectsInRange.end() && m_extra; ++itr)
+		for(Object::InRangeSet::iterator itr = m_objectsInRange.begin(); itr != m_objectsInRange.end() && m_extra; ++itr)
 		{
 			if(m_extra == 0)
 				break;
@@ -5337,7 +5448,7 @@ void Unit::UpdateVisibility()
 	}
 	else			// For units we can save a lot of work
 	{
-		for(set<Player*>::iterator it2 = GetInRangePlayerSetBegin(); it2 != GetInRangePlayerSetEnd(); ++it2)
+		for(Object::InRangePlayerSet::iterator it2 = GetInRangePlayerSetBegin(); it2 != GetInRangePlayerSetEnd(); ++it2)
 		{
 			can_see = (*it2)->CanSee(this);
 			is_visible = (*it2)->GetVisibility(this, &itr);
@@ -5856,7 +5967,7 @@ void Unit::CombatStatusHandler_ResetPvPTimeout()
 		{
 			if(!itr->second->deleted)
 			{
-				itr->second->currTime = 5000;
+				event_SetTimeLeft(itr->second, 5000);
 				m_lock.Release();
 				return;
 			}
@@ -586,6 +586,17 @@ enum AURA_CHECK_RESULT
 
 typedef std::list<struct ProcTriggerSpellOnSpell> ProcTriggerSpellOnSpellList;
 
+/* The live entries of Unit::m_procSpells bucketed by proc flag. Bit i of the bucket
+ * of flag bit b is set if entries[i] has that flag.
+ */
+struct ProcTriggerIndex
+{
+	uint32 mask;									// procFlags of all entries
+	uint32 words;									// uint32s per bucket
+	std::vector<struct ProcTriggerSpell*> entries;	// in m_procSpells order
+	std::vector<uint32> buckets;					// 32 buckets of words each
+};
+
 /************************************************************************/
 /* "In-Combat" Handler                                                  */
 /************************************************************************/
@@ -710,6 +721,7 @@ public:
 	//void SpellNonMeleeDamageLog(Unit *pVictim, uint32 spellID, uint32 damage);
 	uint32 m_procCounter;
 	void HandleProc(uint32 flag, Unit* Victim, SpellEntry* CastingSpell,uint32 dmg=-1,uint32 abs=0);
+	void _UpdateProcIndex(bool can_delete);
 	void HandleProcDmgShield(uint32 flag, Unit* attacker);//almost the same as handleproc :P
 //	void HandleProcSpellOnSpell(Unit* Victim,uint32 damage,bool critical);//nasty, some spells proc other spells
 
@@ -828,6 +840,13 @@ public:
 	std::list<struct DamageSplitTarget> m_damageSplitTargets;
  
 	std::list<struct ProcTriggerSpell> m_procSpells;
+	/* Registers a proc and resolves its spells, the front ones are checked first. Set
+	 * deleted to remove it again.
+	 */
+	void AddProcTriggerSpell(struct ProcTriggerSpell & pts, bool front = true);
+	ProcTriggerIndex * m_procIndex;
+	vector<ProcTriggerIndex*> m_procIndexRetired;	// replaced while a HandleProc was running
+	bool m_procIndexDirty;
 //	std::map<uint32,ProcTriggerSpellOnSpellList> m_procSpellonSpell; //index is namehash
 	std::map<uint32,struct SpellCharge> m_chargeSpells;
 	deque<uint32> m_chargeSpellRemoveQueue;
@@ -0,0 +1,293 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// UpdateCompressor.cpp
+//
+
+#include "StdAfx.h"
+initialiseSingleton(UpdateCompressor);
+
+static uint64 GetMicroTime()
+{
+#ifdef WIN32
+	LARGE_INTEGER freq, now;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (uint64)((now.QuadPart / freq.QuadPart) * 1000000 + ((now.QuadPart % freq.QuadPart) * 1000000) / freq.QuadPart);
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return ((uint64)tv.tv_sec * 1000000) + tv.tv_usec;
+#endif
+}
+
+void UpdatePacketJob::CopyTo(std::vector<uint8> & dest)
+{
+	size_t c = header.size();
+	if(dest.size() < size)
+		dest.resize(size);
+
+	memcpy(&dest[0], header.contents(), c);
+	for(std::vector<PendingUpdateSegment>::iterator itr = segments.begin(); itr != segments.end(); ++itr)
+	{
+		memcpy(&dest[c], itr->block != NULL ? itr->block->GetData() : data.contents() + itr->offset, itr->size);
+		c += itr->size;
+	}
+}
+
+UpdateCompressionContext::UpdateCompressionContext()
+{
+	memset(&m_stream, 0, sizeof(z_stream));
+	m_level = 0;
+	m_initialized = false;
+	m_packets = 0;
+	m_bytesIn = 0;
+	m_bytesOut = 0;
+	m_microseconds = 0;
+}
+
+UpdateCompressionContext::~UpdateCompressionContext()
+{
+	if(m_initialized)
+		deflateEnd(&m_stream);
+}
+
+bool UpdateCompressionContext::_Reset(int level)
+{
+	if(m_initialized && m_level == level)
+		return (deflateReset(&m_stream) == Z_OK);
+
+	// the level changed (rehash) or the last packet failed, start over
+	if(m_initialized)
+		deflateEnd(&m_stream);
+
+	memset(&m_stream, 0, sizeof(z_stream));
+	m_initialized = (deflateInit(&m_stream, level) == Z_OK);
+	m_level = level;
+	if(!m_initialized)
+		sLog.outError("deflateInit failed.");
+
+	return m_initialized;
+}
+
+bool UpdateCompressionContext::Compress(UpdatePacketJob * job)
+{
+	uint64 start = GetMicroTime();
+	uint32 destsize = job->size + job->size/10 + 16;
+	int rate = sWorld.getIntRate(INTRATE_COMPRESSION);
+	if(job->size >= 40000 && rate < 6)
+		rate = 6;
+
+	job->output_size = 0;
+	if(!_Reset(rate))
+		return false;
+
+	if(job->output.size() < destsize + 4)
+		job->output.resize(destsize + 4);
+
+	// header first, then the segments straight from where they are stored
+	m_chunks.clear();
+	m_chunkSizes.clear();
+	m_chunks.push_back(job->header.contents());
+	m_chunkSizes.push_back((uint32)job->header.size());
+	for(std::vector<PendingUpdateSegment>::iterator itr = job->segments.begin(); itr != job->segments.end(); ++itr)
+	{
+		m_chunks.push_back(itr->block != NULL ? itr->block->GetData() : job->data.contents() + itr->offset);
+		m_chunkSizes.push_back((uint32)itr->size);
+	}
+
+	// set up stream pointers
+	m_stream.next_out  = (Bytef*)&job->output[4];
+	m_stream.avail_out = destsize;
+
+	for(size_t i = 0; i < m_chunks.size(); ++i)
+	{
+		m_stream.next_in  = (Bytef*)m_chunks[i];
+		m_stream.avail_in = m_chunkSizes[i];
+
+		if(deflate(&m_stream, Z_NO_FLUSH) != Z_OK ||
+			m_stream.avail_in != 0)
+		{
+			sLog.outError("deflate failed.");
+			deflateEnd(&m_stream);
+			m_initialized = false;
+			return false;
+		}
+	}
+
+	// finish the deflate
+	if(deflate(&m_stream, Z_FINISH) != Z_STREAM_END)
+	{
+		sLog.outError("deflate failed: did not end stream");
+		deflateEnd(&m_stream);
+		m_initialized = false;
+		return false;
+	}
+
+	// fill in the full size of the compressed stream
+#ifdef USING_BIG_ENDIAN
+	*(uint32*)&job->output[0] = swap32(job->size);
+#else
+	*(uint32*)&job->output[0] = job->size;
+#endif
+
+	job->output_size = (uint32)m_stream.total_out + 4;
+
+	++m_packets;
+	m_bytesIn += job->size;
+	m_bytesOut += job->output_size;
+	m_microseconds += GetMicroTime() - start;
+	return true;
+}
+
+UpdateCompressor::UpdateCompressor()
+{
+	m_running = false;
+}
+
+UpdateCompressor::~UpdateCompressor()
+{
+	Shutdown();
+
+	for(vector<UpdateCompressionContext*>::iterator itr = m_contexts.begin(); itr != m_contexts.end(); ++itr)
+		delete *itr;
+
+	for(vector<UpdatePacketJob*>::iterator itr = m_freeJobs.begin(); itr != m_freeJobs.end(); ++itr)
+		delete *itr;
+}
+
+void UpdateCompressor::Startup()
+{
+	m_running = true;
+}
+
+void UpdateCompressor::Shutdown()
+{
+	m_running = false;
+}
+
+UpdateCompressionContext * UpdateCompressor::_AcquireContext()
+{
+	UpdateCompressionContext * ctx;
+
+	m_contextLock.Acquire();
+	if(m_freeContexts.size())
+	{
+		ctx = m_freeContexts.back();
+		m_freeContexts.pop_back();
+	}
+	else
+	{
+		ctx = new UpdateCompressionContext;
+		m_contexts.push_back(ctx);
+	}
+	m_contextLock.Release();
+
+	return ctx;
+}
+
+void UpdateCompressor::_ReleaseContext(UpdateCompressionContext * ctx)
+{
+	m_contextLock.Acquire();
+	m_freeContexts.push_back(ctx);
+	m_contextLock.Release();
+}
+
+UpdatePacketJob * UpdateCompressor::AllocateJob()
+{
+	UpdatePacketJob * job;
+
+	m_jobLock.Acquire();
+	if(m_freeJobs.size())
+	{
+		job = m_freeJobs.back();
+		m_freeJobs.pop_back();
+	}
+	else
+		job = new UpdatePacketJob;
+	m_jobLock.Release();
+
+	return job;
+}
+
+void UpdateCompressor::FreeJob(UpdatePacketJob * job)
+{
+	for(std::vector<PendingUpdateSegment>::iterator itr = job->segments.begin(); itr != job->segments.end(); ++itr)
+	{
+		if(itr->block != NULL)
+			itr->block->DecRef();
+	}
+
+	// buffers keep their memory for the next packet
+	job->player = NULL;
+	job->size = 0;
+	job->output_size = 0;
+	job->header.clear();
+	job->data.clear();
+	job->segments.clear();
+
+	m_jobLock.Acquire();
+	m_freeJobs.push_back(job);
+	m_jobLock.Release();
+}
+
+void UpdateCompressor::Compress(UpdatePacketJob * job)
+{
+	job->output_size = 0;
+	if(job->size < (uint32)sWorld.compression_threshold)
+		return;
+
+	// the deflate state is reused by whichever thread compresses next
+	UpdateCompressionContext * ctx = _AcquireContext();
+	ctx->Compress(job);
+	_ReleaseContext(ctx);
+}
+
+void UpdateCompressionBatch::Run(size_t index)
+{
+	sUpdateCompressor.Compress(jobs[index]);
+}
+
+void UpdateCompressor::Execute(UpdateCompressionBatch * batch)
+{
+	if(MapUpdateWorkerPool::getSingletonPtr() != NULL)
+	{
+		sMapUpdateWorkerPool.Execute(batch, batch->jobs.size());
+		return;
+	}
+
+	for(vector<UpdatePacketJob*>::iterator itr = batch->jobs.begin(); itr != batch->jobs.end(); ++itr)
+		Compress(*itr);
+}
+
+void UpdateCompressor::GetStatistics(uint64 * packets, uint64 * bytes_in, uint64 * bytes_out, uint64 * microseconds)
+{
+	*packets = *bytes_in = *bytes_out = *microseconds = 0;
+
+	m_contextLock.Acquire();
+	for(vector<UpdateCompressionContext*>::iterator itr = m_contexts.begin(); itr != m_contexts.end(); ++itr)
+	{
+		*packets += (*itr)->m_packets;
+		*bytes_in += (*itr)->m_bytesIn;
+		*bytes_out += (*itr)->m_bytesOut;
+		*microseconds += (*itr)->m_microseconds;
+	}
+	m_contextLock.Release();
+}
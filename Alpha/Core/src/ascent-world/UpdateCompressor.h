@@ -0,0 +1,136 @@
+/*
+ * OpenAscent MMORPG Server
+ * Copyright (C) 2008 <http://www.openascent.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// UpdateCompressor.h
+//
+
+#ifndef __UPDATECOMPRESSOR_H
+#define __UPDATECOMPRESSOR_H
+
+class Player;
+
+/** One SMSG_UPDATE_OBJECT packet taken out of a player's pending updates.
+ * The packet is the header followed by the segments, which either point into
+ * data or at a shared update block.
+ */
+class UpdatePacketJob
+{
+public:
+	UpdatePacketJob() : player(NULL), size(0), output_size(0), header(16), data(0) {}
+
+	/** Writes the uncompressed packet into dest.
+	 */
+	void CopyTo(std::vector<uint8> & dest);
+
+	Player * player;
+	uint32 size;
+
+	/** Compressed packet (uncompressed size + deflate stream), empty if it is sent uncompressed.
+	 */
+	uint32 output_size;
+	std::vector<uint8> output;
+
+	ByteBuffer header;
+	ByteBuffer data;
+	std::vector<PendingUpdateSegment> segments;
+};
+
+/** deflate state which is initialized once and reset for every packet,
+ * deflateInit allocates a few hundred KB each time.
+ */
+class UpdateCompressionContext
+{
+public:
+	UpdateCompressionContext();
+	~UpdateCompressionContext();
+
+	/** Fills job->output, returns false if the packet has to be sent uncompressed.
+	 */
+	bool Compress(UpdatePacketJob * job);
+
+	// statistics, only written by the thread which owns the context
+	uint64 m_packets;
+	uint64 m_bytesIn;
+	uint64 m_bytesOut;
+	uint64 m_microseconds;
+
+private:
+	bool _Reset(int level);
+
+	z_stream m_stream;
+	int m_level;
+	bool m_initialized;
+	std::vector<const uint8*> m_chunks;
+	std::vector<uint32> m_chunkSizes;
+};
+
+/** Packets of one MapMgr tick which are compressed at the same time.
+ */
+class UpdateCompressionBatch : public WorkerBatch
+{
+public:
+	void Run(size_t index);
+
+	vector<UpdatePacketJob*> jobs;
+};
+
+class SERVER_DECL UpdateCompressor : public Singleton<UpdateCompressor>
+{
+public:
+	UpdateCompressor();
+	~UpdateCompressor();
+
+	void Startup();
+	void Shutdown();
+
+	ASCENT_INLINE bool IsRunning() { return m_running; }
+
+	/** Compresses the job on the calling thread if it is above the compression threshold.
+	 */
+	void Compress(UpdatePacketJob * job);
+
+	/** Compresses all jobs of the batch on the map worker pool and returns when all of them
+	 * are done. The calling map thread compresses as well, sending stays on the map thread
+	 * so packets keep their order.
+	 */
+	void Execute(UpdateCompressionBatch * batch);
+
+	UpdatePacketJob * AllocateJob();
+	void FreeJob(UpdatePacketJob * job);
+
+	void GetStatistics(uint64 * packets, uint64 * bytes_in, uint64 * bytes_out, uint64 * microseconds);
+
+private:
+	UpdateCompressionContext * _AcquireContext();
+	void _ReleaseContext(UpdateCompressionContext * ctx);
+
+	Mutex m_contextLock;
+	vector<UpdateCompressionContext*> m_contexts;
+	vector<UpdateCompressionContext*> m_freeContexts;
+
+	Mutex m_jobLock;
+	vector<UpdatePacketJob*> m_freeJobs;
+
+	bool m_running;
+};
+
+#define sUpdateCompressor UpdateCompressor::getSingleton()
+
+#endif
@@ -726,7 +726,10 @@ bool ChatHandler::HandleGenerateWaypoints(const char* args, WorldSession * m_ses
 		return true;
 	}
 	int n = atol(pC);
+	if(n < 0)
+		n = 0;
 
+	vector<float> x(n), y(n), z(n);
 	for(int i=0;i<n;i++)
 	{
 		float ang = rand()/100.0f;
@@ -736,15 +739,21 @@ bool ChatHandler::HandleGenerateWaypoints(const char* args, WorldSession * m_ses
 			ran = (rand()%(r*10))/10.0f;
 		}
 
-		float x = cr->GetPositionX()+ran*sin(ang);
-		float y = cr->GetPositionY()+ran*cos(ang);
-		float z = cr->GetMapMgr()->GetBaseMap()->GetLandHeight(x,y);
-		 
+		x[i] = cr->GetPositionX()+ran*sin(ang);
+		y[i] = cr->GetPositionY()+ran*cos(ang);
+	}
+
+	// all heights in one go
+	if(n)
+		cr->GetMapMgr()->GetTerrainInfo(n, &x[0], &y[0], &z[0], NULL, NULL);
+
+	for(int i=0;i<n;i++)
+	{
 		WayPoint* wp = new WayPoint;
 		wp->id = (uint32)cr->GetAIInterface()->GetWayPointsCount()+1;
-		wp->x = x;
-		wp->y = y;
-		wp->z = z;
+		wp->x = x[i];
+		wp->y = y[i];
+		wp->z = z[i];
 		wp->waittime = 5000;
 		wp->flags = 0;
 		wp->forwardemoteoneshot = 0;
@@ -891,7 +900,7 @@ bool ChatHandler::HandleNpcSelectCommand(const char * args, WorldSession * m_ses
 	float dist = 999999.0f;
 	float dist2;
 	Player * plr = m_session->GetPlayer();
-	set<Object*>::iterator itr;
+	Object::InRangeSet::iterator itr;
 	for(itr = plr->GetInRangeSetBegin(); itr != plr->GetInRangeSetEnd(); ++itr)
 	{
 		if( (dist2 = plr->GetDistance2dSq(*itr)) < dist && (*itr)->GetTypeId() == TYPEID_UNIT )
@@ -125,6 +125,7 @@ World::World()
 	m_playerLimit = 0;
 	m_allowMovement = true;
 	m_gmTicketSystem = true;
+	m_rebuildSpellCache = false;
 
 	GmClientChannel = "";
 
@@ -136,6 +137,7 @@ World::World()
 	mQueueUpdateInterval = 10000;
 	PeakSessionCount = 0;
 	mInWorldPlayerCount = 0;
+	m_saveCount = m_saveTime = m_saveBytes = m_saveStatements = 0;
 	mAcceptedConnections = 0;
 	HordePlayers = 0;
 	AlliancePlayers = 0;
@@ -360,10 +362,164 @@ void Apply112SpellFixes();
 void ApplyExtraDataFixes();
 void ApplyNormalFixes();
 
+static void DumpSpellDelta(const char * source, const SpellEntry& before, const SpellEntry& after)
+{
+#define DUMP_U32(f) do { if(before.f != after.f) Log.Notice(source, "  %s: %u -> %u", #f, before.f, after.f); } while(0)
+#define DUMP_I32(f) do { if(before.f != after.f) Log.Notice(source, "  %s: %d -> %d", #f, before.f, after.f); } while(0)
+#define DUMP_F(f)   do { if(fabs(before.f - after.f) > 0.000001f) Log.Notice(source, "  %s: %.6f -> %.6f", #f, before.f, after.f); } while(0)
+#define DUMP_B(f)   do { if(before.f != after.f) Log.Notice(source, "  %s: %u -> %u", #f, before.f ? 1u : 0u, after.f ? 1u : 0u); } while(0)
+
+	DUMP_U32(Attributes);
+	DUMP_U32(AttributesEx);
+	DUMP_U32(AttributesExB);
+	DUMP_U32(AttributesExC);
+	DUMP_U32(AttributesExD);
+	DUMP_U32(AttributesExE);
+	DUMP_U32(AttributesExF);
+	DUMP_U32(InterruptFlags);
+	DUMP_U32(AuraInterruptFlags);
+	DUMP_U32(ChannelInterruptFlags);
+	DUMP_U32(procFlags);
+	DUMP_U32(procChance);
+	DUMP_I32(procCharges);
+	DUMP_U32(CastingTimeIndex);
+	DUMP_U32(RecoveryTime);
+	DUMP_U32(CategoryRecoveryTime);
+	DUMP_U32(DurationIndex);
+	DUMP_U32(powerType);
+	DUMP_U32(manaCost);
+	DUMP_U32(ManaCostPercentage);
+	DUMP_U32(rangeIndex);
+	DUMP_F(speed);
+	DUMP_U32(MaxTargets);
+	DUMP_U32(Spell_Dmg_Type);
+	DUMP_U32(PreventionType);
+	DUMP_U32(School);
+
+	for(uint32 j = 0; j < 3; ++j)
+	{
+		if(before.Effect[j] != after.Effect[j])
+			Log.Notice(source, "  Effect[%u]: %u -> %u", j, before.Effect[j], after.Effect[j]);
+		if(before.EffectApplyAuraName[j] != after.EffectApplyAuraName[j])
+			Log.Notice(source, "  EffectApplyAuraName[%u]: %u -> %u", j, before.EffectApplyAuraName[j], after.EffectApplyAuraName[j]);
+		if(before.EffectImplicitTargetA[j] != after.EffectImplicitTargetA[j])
+			Log.Notice(source, "  EffectImplicitTargetA[%u]: %u -> %u", j, before.EffectImplicitTargetA[j], after.EffectImplicitTargetA[j]);
+		if(before.EffectImplicitTargetB[j] != after.EffectImplicitTargetB[j])
+			Log.Notice(source, "  EffectImplicitTargetB[%u]: %u -> %u", j, before.EffectImplicitTargetB[j], after.EffectImplicitTargetB[j]);
+		if(before.EffectTriggerSpell[j] != after.EffectTriggerSpell[j])
+			Log.Notice(source, "  EffectTriggerSpell[%u]: %u -> %u", j, before.EffectTriggerSpell[j], after.EffectTriggerSpell[j]);
+		if(before.EffectRadiusIndex[j] != after.EffectRadiusIndex[j])
+			Log.Notice(source, "  EffectRadiusIndex[%u]: %u -> %u", j, before.EffectRadiusIndex[j], after.EffectRadiusIndex[j]);
+		if(before.EffectAmplitude[j] != after.EffectAmplitude[j])
+			Log.Notice(source, "  EffectAmplitude[%u]: %u -> %u", j, before.EffectAmplitude[j], after.EffectAmplitude[j]);
+		if(before.EffectChainTarget[j] != after.EffectChainTarget[j])
+			Log.Notice(source, "  EffectChainTarget[%u]: %u -> %u", j, before.EffectChainTarget[j], after.EffectChainTarget[j]);
+		if(before.EffectMiscValue[j] != after.EffectMiscValue[j])
+			Log.Notice(source, "  EffectMiscValue[%u]: %d -> %d", j, before.EffectMiscValue[j], after.EffectMiscValue[j]);
+		if(before.EffectMiscValueB[j] != after.EffectMiscValueB[j])
+			Log.Notice(source, "  EffectMiscValueB[%u]: %u -> %u", j, before.EffectMiscValueB[j], after.EffectMiscValueB[j]);
+		if(before.EffectBasePoints[j] != after.EffectBasePoints[j])
+			Log.Notice(source, "  EffectBasePoints[%u]: %d -> %d", j, before.EffectBasePoints[j], after.EffectBasePoints[j]);
+		if(before.EffectMechanic[j] != after.EffectMechanic[j])
+			Log.Notice(source, "  EffectMechanic[%u]: %d -> %d", j, before.EffectMechanic[j], after.EffectMechanic[j]);
+	}
+
+	DUMP_U32(DiminishStatus);
+	DUMP_U32(proc_interval);
+	DUMP_U32(buffIndexType);
+	DUMP_U32(c_is_flags);
+	DUMP_U32(buffType);
+	DUMP_U32(RankNumber);
+	DUMP_U32(NameHash);
+	DUMP_U32(talent_tree);
+	DUMP_U32(in_front_status);
+	DUMP_F(base_range_or_radius_sqr);
+	DUMP_F(cone_width);
+	DUMP_I32(ai_target_type);
+	DUMP_B(self_cast_only);
+	DUMP_B(apply_on_shapeshift_change);
+	DUMP_B(always_apply);
+	DUMP_B(is_melee_spell);
+	DUMP_B(is_ranged_spell);
+	DUMP_B(spell_can_crit);
+
+#undef DUMP_U32
+#undef DUMP_I32
+#undef DUMP_F
+#undef DUMP_B
+}
+
+static void ApplySpellFixPasses()
+{
+	// SpellFix audit (optional):
+	//   [SpellFixes] Audit=1 enables a pre/post CRC scan of Spell.dbc rows around Apply112SpellFixes().
+	//   AuditVerbose=1 logs each changed spell ID.
+	//   AuditDump=1 dumps field-level deltas for changed spells (best-effort) up to AuditDumpLimit.
+	const bool spellFixAudit        = Config.MainConfig.GetBoolDefault("SpellFixes", "Audit", false);
+	const bool spellFixAuditVerbose = Config.MainConfig.GetBoolDefault("SpellFixes", "AuditVerbose", false);
+	const bool spellFixAuditDump    = Config.MainConfig.GetBoolDefault("SpellFixes", "AuditDump", false);
+	const uint32 spellFixDumpLimit  = (uint32)Config.MainConfig.GetIntDefault("SpellFixes", "AuditDumpLimit", 25);
+
+	std::vector<uint32> preFixCrc;
+	std::vector<SpellEntry> preFixSnapshot;
+	if(spellFixAudit)
+	{
+		preFixCrc.resize(dbcSpell.GetNumRows());
+		if(spellFixAuditDump)
+			preFixSnapshot.resize(dbcSpell.GetNumRows());
+
+		for(uint32 i = 0; i < dbcSpell.GetNumRows(); ++i)
+		{
+			SpellEntry* sp = dbcSpell.LookupRow(i);
+			preFixCrc[i] = SpellEntryCrc(sp);
+			if(spellFixAuditDump && sp != NULL)
+				preFixSnapshot[i] = *sp; // shallow copy is fine; DBC strings are stable
+		}
+	}
+
+	Apply112SpellFixes();
+
+	if(spellFixAudit)
+	{
+		uint32 changed = 0;
+		uint32 dumped = 0;
+
+		for(uint32 i = 0; i < dbcSpell.GetNumRows(); ++i)
+		{
+			SpellEntry* sp = dbcSpell.LookupRow(i);
+			if(sp == NULL)
+				continue;
+
+			const uint32 post = SpellEntryCrc(sp);
+			if(post != preFixCrc[i])
+			{
+				++changed;
+
+				if(spellFixAuditVerbose)
+					Log.Notice("SpellFixAudit", "Apply112SpellFixes changed spell %u (%s)", sp->Id, sp->Name);
+
+				if(spellFixAuditDump && dumped < spellFixDumpLimit && i < preFixSnapshot.size())
+				{
+					++dumped;
+					Log.Notice("SpellFixAudit", "Delta for spell %u (%s):", sp->Id, sp->Name);
+					DumpSpellDelta("SpellFixAudit", preFixSnapshot[i], *sp);
+				}
+			}
+		}
+
+		Log.Notice("SpellFixAudit", "Apply112SpellFixes changed %u/%u spells.", changed, dbcSpell.GetNumRows());
+		if(spellFixAuditDump)
+			Log.Notice("SpellFixAudit", "Dumped %u/%u field-level deltas (limit %u).", dumped, changed, spellFixDumpLimit);
+	}
+	ApplyExtraDataFixes();
+	ApplyNormalFixes();
+}
+
 bool World::SetInitialWorldSettings()
 {
 	Log.Line();
 	Player::InitVisibleUpdateBits();
+	Item::InitSaveStatement();
 
 	CharacterDatabase.WaitExecute("UPDATE characters SET online = 0 WHERE online = 1");
 	//CharacterDatabase.WaitExecute("UPDATE characters SET level = 70 WHERE level > 70");
@@ -429,6 +585,8 @@ bool World::SetInitialWorldSettings()
 		return false;
 	}
 
+	BuildFactionRelations();
+
 	// Compute generic, DBC-driven derived fields for Spell.dbc rows.
 	// Optional debug/timing controlled by config: [SpellDBC] PostProcessDebug = 1
 	const bool spellDbcPPDebug = Config.MainConfig.GetBoolDefault("SpellDBC", "PostProcessDebug", false);
@@ -494,21 +652,16 @@ bool World::SetInitialWorldSettings()
 	sLog.outString("");*/
 
 #define MAKE_TASK(sp, ptr) tl.AddTask(new Task(new CallbackP0<sp>(sp::getSingletonPtr(), &sp::ptr)))
-	// Fill the task list with jobs to do.
+	// Fill the task list with jobs to do. Loaders only wait for the tasks they depend on,
+	// everything else runs next to the storages.
 	TaskList tl;
-	Storage_FillTaskList(tl);
-
-	// spawn worker threads (2 * number of cpus)
-	tl.spawn();
-
-	/* storage stuff has to be loaded first */
-	tl.wait();
-
-	Storage_LoadAdditionalTables();
+	StorageSnapshot::SetDirectory(Config.MainConfig.GetStringDefault("Startup", "StorageSnapshotDirectory", "").c_str());
+	Task * storage = Storage_FillTaskList(tl);
 
+	// guild bank items need the item prototypes
+	Task * players = MAKE_TASK(ObjectMgr, LoadPlayersInfo);
+	players->DependsOn(storage);
 	MAKE_TASK(ObjectMgr, LoadPlayerCreateInfo);
-	MAKE_TASK(ObjectMgr, LoadPlayersInfo);
-	tl.wait();
 
 	MAKE_TASK(ObjectMgr, LoadCreatureWaypoints);
 	MAKE_TASK(ObjectMgr, LoadCreatureTimedEmotes);
@@ -516,30 +669,43 @@ bool World::SetInitialWorldSettings()
 	MAKE_TASK(ObjectMgr, LoadTotemSpells);
 	MAKE_TASK(ObjectMgr, LoadSpellSkills);
 	MAKE_TASK(ObjectMgr, LoadSpellOverride);
-	MAKE_TASK(ObjectMgr, LoadVendors);
 	MAKE_TASK(ObjectMgr, LoadAIThreatToSpellId);
-	MAKE_TASK(ObjectMgr, LoadSpellFixes);
+	Task * spellfixes = MAKE_TASK(ObjectMgr, LoadSpellFixes);
 	MAKE_TASK(ObjectMgr, LoadSpellProcs);
 	MAKE_TASK(ObjectMgr, LoadSpellEffectsOverride);
 	MAKE_TASK(ObjectMgr, LoadDefaultPetSpells);
 	MAKE_TASK(ObjectMgr, LoadPetSpellCooldowns);
-	MAKE_TASK(ObjectMgr, LoadGuildCharters);
 	MAKE_TASK(ObjectMgr, LoadGMTickets);
 	MAKE_TASK(AddonMgr, LoadFromDB);
-	MAKE_TASK(ObjectMgr, SetHighestGuids);
 	MAKE_TASK(ObjectMgr, LoadReputationModifiers);
 	MAKE_TASK(ObjectMgr, LoadMonsterSay);
 	MAKE_TASK(WeatherMgr, LoadFromDB);
-	MAKE_TASK(ObjectMgr,LoadGroups);
-
-	MAKE_TASK(ObjectMgr, LoadExtraCreatureProtoStuff);
-	MAKE_TASK(ObjectMgr, LoadExtraItemStuff);
-	MAKE_TASK(QuestMgr, LoadExtraQuestStuff);
-	MAKE_TASK(ObjectMgr, LoadArenaTeams);
 	MAKE_TASK(ObjectMgr, LoadProfessionDiscoveries);
+	MAKE_TASK(ObjectMgr, LoadVendors)->DependsOn(storage);
+
+	// groups, charters and arena teams look up their members
+	Task * charters = MAKE_TASK(ObjectMgr, LoadGuildCharters);
+	charters->DependsOn(players);
+	Task * groups = MAKE_TASK(ObjectMgr, LoadGroups);
+	groups->DependsOn(players);
+	MAKE_TASK(ObjectMgr, LoadArenaTeams)->DependsOn(players);
+
+	Task * guids = MAKE_TASK(ObjectMgr, SetHighestGuids);
+	guids->DependsOn(players);
+	guids->DependsOn(charters);
+	guids->DependsOn(groups);
+
+	Task * extra = MAKE_TASK(ObjectMgr, LoadExtraCreatureProtoStuff);
+	extra->DependsOn(storage);
+	extra->DependsOn(spellfixes);
+	MAKE_TASK(ObjectMgr, LoadExtraItemStuff)->DependsOn(storage);
+	MAKE_TASK(QuestMgr, LoadExtraQuestStuff)->DependsOn(storage);
 
 #undef MAKE_TASK
 
+	// spawn worker threads (2 * number of cpus)
+	tl.spawn();
+
 	// wait for all loading to complete.
 	tl.wait();
 	sLocalizationMgr.Reload(false);
@@ -580,155 +746,37 @@ bool World::SetInitialWorldSettings()
 	Log.Notice("World", "Player size: %u bytes", sizeof(Player) + sizeof(ItemInterface) + 50000 + 30000 + 1000 + sizeof(AIInterface));
 	Log.Notice("World", "GameObject size: %u bytes", sizeof(GameObject));
 
-	// SpellFix audit (optional):
-	//   [SpellFixes] Audit=1 enables a pre/post CRC scan of Spell.dbc rows around Apply112SpellFixes().
-	//   AuditVerbose=1 logs each changed spell ID.
-	//   AuditDump=1 dumps field-level deltas for changed spells (best-effort) up to AuditDumpLimit.
-	const bool spellFixAudit        = Config.MainConfig.GetBoolDefault("SpellFixes", "Audit", false);
-	const bool spellFixAuditVerbose = Config.MainConfig.GetBoolDefault("SpellFixes", "AuditVerbose", false);
-	const bool spellFixAuditDump    = Config.MainConfig.GetBoolDefault("SpellFixes", "AuditDump", false);
-	const uint32 spellFixDumpLimit  = (uint32)Config.MainConfig.GetIntDefault("SpellFixes", "AuditDumpLimit", 25);
-
-	std::vector<uint32> preFixCrc;
-	std::vector<SpellEntry> preFixSnapshot;
-	if(spellFixAudit)
+	const string spellCacheFile = Config.MainConfig.GetStringDefault("SpellFixes", "Cache", "");
+	if(spellCacheFile.empty())
+		ApplySpellFixPasses();
+	else
 	{
-		preFixCrc.resize(dbcSpell.GetNumRows());
-		if(spellFixAuditDump)
-			preFixSnapshot.resize(dbcSpell.GetNumRows());
-
-		for(uint32 i = 0; i < dbcSpell.GetNumRows(); ++i)
+		// the cached result of the passes is used as long as nothing they read changed
+		SpellCache spellCache;
+		uint32 spellCacheKey;
+		bool spellCacheKeyed = SpellCache::CalculateKey(&spellCacheKey);
+		if(!spellCacheKeyed)
+			Log.Notice("World", "Spell tables have no version yet, not using the spell cache.");
+
+		if(!spellCacheKeyed || m_rebuildSpellCache || Config.MainConfig.GetBoolDefault("SpellFixes", "Audit", false) ||
+			!spellCache.Load(spellCacheFile.c_str(), spellCacheKey))
 		{
-			SpellEntry* sp = dbcSpell.LookupRow(i);
-			preFixCrc[i] = SpellEntryCrc(sp);
-			if(spellFixAuditDump && sp != NULL)
-				preFixSnapshot[i] = *sp; // shallow copy is fine; DBC strings are stable
-		}
-	}
-
-	Apply112SpellFixes();
+			spellCache.Begin();
+			ApplySpellFixPasses();
+			spellCache.End();
 
-	if(spellFixAudit)
-	{
-		uint32 changed = 0;
-		uint32 dumped = 0;
-
-		auto DumpSpellDelta = [&](const SpellEntry& before, const SpellEntry& after)
-		{
-#define DUMP_U32(f) do { if(before.f != after.f) Log.Notice("SpellFixAudit", "  %s: %u -> %u", #f, before.f, after.f); } while(0)
-#define DUMP_I32(f) do { if(before.f != after.f) Log.Notice("SpellFixAudit", "  %s: %d -> %d", #f, before.f, after.f); } while(0)
-#define DUMP_F(f)   do { if(fabs(before.f - after.f) > 0.000001f) Log.Notice("SpellFixAudit", "  %s: %.6f -> %.6f", #f, before.f, after.f); } while(0)
-#define DUMP_B(f)   do { if(before.f != after.f) Log.Notice("SpellFixAudit", "  %s: %u -> %u", #f, before.f ? 1u : 0u, after.f ? 1u : 0u); } while(0)
-
-			DUMP_U32(Attributes);
-			DUMP_U32(AttributesEx);
-			DUMP_U32(AttributesExB);
-			DUMP_U32(AttributesExC);
-			DUMP_U32(AttributesExD);
-			DUMP_U32(AttributesExE);
-			DUMP_U32(AttributesExF);
-			DUMP_U32(InterruptFlags);
-			DUMP_U32(AuraInterruptFlags);
-			DUMP_U32(ChannelInterruptFlags);
-			DUMP_U32(procFlags);
-			DUMP_U32(procChance);
-			DUMP_I32(procCharges);
-			DUMP_U32(CastingTimeIndex);
-			DUMP_U32(RecoveryTime);
-			DUMP_U32(CategoryRecoveryTime);
-			DUMP_U32(DurationIndex);
-			DUMP_U32(powerType);
-			DUMP_U32(manaCost);
-			DUMP_U32(ManaCostPercentage);
-			DUMP_U32(rangeIndex);
-			DUMP_F(speed);
-			DUMP_U32(MaxTargets);
-			DUMP_U32(Spell_Dmg_Type);
-			DUMP_U32(PreventionType);
-			DUMP_U32(School);
-
-			for(uint32 j = 0; j < 3; ++j)
+			if(m_rebuildSpellCache)
 			{
-				if(before.Effect[j] != after.Effect[j])
-					Log.Notice("SpellFixAudit", "  Effect[%u]: %u -> %u", j, before.Effect[j], after.Effect[j]);
-				if(before.EffectApplyAuraName[j] != after.EffectApplyAuraName[j])
-					Log.Notice("SpellFixAudit", "  EffectApplyAuraName[%u]: %u -> %u", j, before.EffectApplyAuraName[j], after.EffectApplyAuraName[j]);
-				if(before.EffectImplicitTargetA[j] != after.EffectImplicitTargetA[j])
-					Log.Notice("SpellFixAudit", "  EffectImplicitTargetA[%u]: %u -> %u", j, before.EffectImplicitTargetA[j], after.EffectImplicitTargetA[j]);
-				if(before.EffectImplicitTargetB[j] != after.EffectImplicitTargetB[j])
-					Log.Notice("SpellFixAudit", "  EffectImplicitTargetB[%u]: %u -> %u", j, before.EffectImplicitTargetB[j], after.EffectImplicitTargetB[j]);
-				if(before.EffectTriggerSpell[j] != after.EffectTriggerSpell[j])
-					Log.Notice("SpellFixAudit", "  EffectTriggerSpell[%u]: %u -> %u", j, before.EffectTriggerSpell[j], after.EffectTriggerSpell[j]);
-				if(before.EffectRadiusIndex[j] != after.EffectRadiusIndex[j])
-					Log.Notice("SpellFixAudit", "  EffectRadiusIndex[%u]: %u -> %u", j, before.EffectRadiusIndex[j], after.EffectRadiusIndex[j]);
-				if(before.EffectAmplitude[j] != after.EffectAmplitude[j])
-					Log.Notice("SpellFixAudit", "  EffectAmplitude[%u]: %u -> %u", j, before.EffectAmplitude[j], after.EffectAmplitude[j]);
-				if(before.EffectChainTarget[j] != after.EffectChainTarget[j])
-					Log.Notice("SpellFixAudit", "  EffectChainTarget[%u]: %u -> %u", j, before.EffectChainTarget[j], after.EffectChainTarget[j]);
-				if(before.EffectMiscValue[j] != after.EffectMiscValue[j])
-					Log.Notice("SpellFixAudit", "  EffectMiscValue[%u]: %d -> %d", j, before.EffectMiscValue[j], after.EffectMiscValue[j]);
-				if(before.EffectMiscValueB[j] != after.EffectMiscValueB[j])
-					Log.Notice("SpellFixAudit", "  EffectMiscValueB[%u]: %u -> %u", j, before.EffectMiscValueB[j], after.EffectMiscValueB[j]);
-				if(before.EffectBasePoints[j] != after.EffectBasePoints[j])
-					Log.Notice("SpellFixAudit", "  EffectBasePoints[%u]: %d -> %d", j, before.EffectBasePoints[j], after.EffectBasePoints[j]);
-				if(before.EffectMechanic[j] != after.EffectMechanic[j])
-					Log.Notice("SpellFixAudit", "  EffectMechanic[%u]: %d -> %d", j, before.EffectMechanic[j], after.EffectMechanic[j]);
-			}
-
-			DUMP_U32(DiminishStatus);
-			DUMP_U32(proc_interval);
-			DUMP_U32(buffIndexType);
-			DUMP_U32(c_is_flags);
-			DUMP_U32(buffType);
-			DUMP_U32(RankNumber);
-			DUMP_U32(NameHash);
-			DUMP_U32(talent_tree);
-			DUMP_U32(in_front_status);
-			DUMP_F(base_range_or_radius_sqr);
-			DUMP_F(cone_width);
-			DUMP_I32(ai_target_type);
-			DUMP_B(self_cast_only);
-			DUMP_B(apply_on_shapeshift_change);
-			DUMP_B(always_apply);
-			DUMP_B(is_melee_spell);
-			DUMP_B(is_ranged_spell);
-			DUMP_B(spell_can_crit);
-
-#undef DUMP_U32
-#undef DUMP_I32
-#undef DUMP_F
-#undef DUMP_B
-		};
-
-		for(uint32 i = 0; i < dbcSpell.GetNumRows(); ++i)
-		{
-			SpellEntry* sp = dbcSpell.LookupRow(i);
-			if(sp == NULL)
-				continue;
-
-			const uint32 post = SpellEntryCrc(sp);
-			if(post != preFixCrc[i])
-			{
-				++changed;
-
-				if(spellFixAuditVerbose)
-					Log.Notice("SpellFixAudit", "Apply112SpellFixes changed spell %u (%s)", sp->Id, sp->Name);
-
-				if(spellFixAuditDump && dumped < spellFixDumpLimit && i < preFixSnapshot.size())
-				{
-					++dumped;
-					Log.Notice("SpellFixAudit", "Delta for spell %u (%s):", sp->Id, sp->Name);
-					DumpSpellDelta(preFixSnapshot[i], *sp);
-				}
+				SpellCache previous;
+				if(previous.Load(spellCacheFile.c_str(), spellCacheKey, true))
+					spellCache.Diff(previous, &DumpSpellDelta);
 			}
+			if(spellCacheKeyed)
+				spellCache.Save(spellCacheFile.c_str(), spellCacheKey);
 		}
-
-		Log.Notice("SpellFixAudit", "Apply112SpellFixes changed %u/%u spells.", changed, dbcSpell.GetNumRows());
-		if(spellFixAuditDump)
-			Log.Notice("SpellFixAudit", "Dumped %u/%u field-level deltas (limit %u).", dumped, changed, spellFixDumpLimit);
+		else
+			spellCache.Apply();
 	}
-	ApplyExtraDataFixes();
-	ApplyNormalFixes();
 
 // ------------------------------------------------------------------------------------------------
 
@@ -764,6 +812,25 @@ bool World::SetInitialWorldSettings()
 	dw = new DayWatcherThread();
 	ThreadPool.ExecuteTask( dw );
 
+	// region updates and update compression share the map worker threads
+	uint32 map_workers = 0;
+	bool map_parallel = Config.MainConfig.GetBoolDefault("ParallelMapUpdate", "Enabled", false);
+	bool update_compression = Config.MainConfig.GetBoolDefault("UpdateCompression", "Enabled", false);
+	if(map_parallel)
+		map_workers = Config.MainConfig.GetIntDefault("ParallelMapUpdate", "Threads", 0);
+	if(update_compression)
+		map_workers = max(map_workers, (uint32)Config.MainConfig.GetIntDefault("UpdateCompression", "Threads", 0));
+
+	if(map_parallel || update_compression)
+	{
+		new MapUpdateWorkerPool;
+		sMapUpdateWorkerPool.Startup(map_workers);
+	}
+
+	new UpdateCompressor;
+	if(update_compression)
+		sUpdateCompressor.Startup();
+
 	ThreadPool.ExecuteTask( new CharacterLoaderThread() );
 
 #ifdef ENABLE_COMPRESSED_MOVEMENT
@@ -851,6 +918,7 @@ void World::Update(time_t diff)
 
 void World::SendGlobalMessage(WorldPacket *packet, WorldSession *self)
 {
+	PacketBroadcast broadcast(packet);
 	m_sessionlock.AcquireReadLock();
 
 	SessionMap::iterator itr;
@@ -860,7 +928,7 @@ void World::SendGlobalMessage(WorldPacket *packet, WorldSession *self)
 			itr->second->GetPlayer()->IsInWorld()
 			&& itr->second != self)  // dont send to self!
 		{
-			itr->second->SendPacket(packet);
+			broadcast.Send(itr->second);
 		}
 	}
 
@@ -868,6 +936,7 @@ void World::SendGlobalMessage(WorldPacket *packet, WorldSession *self)
 }
 void World::SendFactionMessage(WorldPacket *packet, uint8 teamId)
 {
+	PacketBroadcast broadcast(packet);
 	m_sessionlock.AcquireReadLock();
 	SessionMap::iterator itr;
 	Player * plr;
@@ -878,13 +947,14 @@ void World::SendFactionMessage(WorldPacket *packet, uint8 teamId)
 			continue;
 
 		if(plr->GetTeam() == teamId)
-			itr->second->SendPacket(packet);
+			broadcast.Send(itr->second);
 	}
 	m_sessionlock.ReleaseReadLock();
 }
 
 void World::SendGamemasterMessage(WorldPacket *packet, WorldSession *self)
 {
+	PacketBroadcast broadcast(packet);
 	m_sessionlock.AcquireReadLock();
 	SessionMap::iterator itr;
 	for(itr = m_sessions.begin(); itr != m_sessions.end(); itr++)
@@ -894,7 +964,7 @@ void World::SendGamemasterMessage(WorldPacket *packet, WorldSession *self)
 	  && itr->second != self)  // dont send to self!
 	  {
 		if(itr->second->CanUseCommand('u'))
-		itr->second->SendPacket(packet);
+		broadcast.Send(itr->second);
 	  }
 	}
 	m_sessionlock.ReleaseReadLock();
@@ -902,6 +972,7 @@ void World::SendGamemasterMessage(WorldPacket *packet, WorldSession *self)
 
 void World::SendZoneMessage(WorldPacket *packet, uint32 zoneid, WorldSession *self)
 {
+	PacketBroadcast broadcast(packet);
 	m_sessionlock.AcquireReadLock();
 
 	SessionMap::iterator itr;
@@ -912,7 +983,7 @@ void World::SendZoneMessage(WorldPacket *packet, uint32 zoneid, WorldSession *se
 			&& itr->second != self)  // dont send to self!
 		{
 			if (itr->second->GetPlayer()->GetZoneId() == zoneid)
-				itr->second->SendPacket(packet);
+				broadcast.Send(itr->second);
 		}
 	}
 
@@ -921,6 +992,7 @@ void World::SendZoneMessage(WorldPacket *packet, uint32 zoneid, WorldSession *se
 
 void World::SendInstanceMessage(WorldPacket *packet, uint32 instanceid, WorldSession *self)
 {
+	PacketBroadcast broadcast(packet);
 	m_sessionlock.AcquireReadLock();
 
 	SessionMap::iterator itr;
@@ -931,7 +1003,7 @@ void World::SendInstanceMessage(WorldPacket *packet, uint32 instanceid, WorldSes
 			&& itr->second != self)  // dont send to self!
 		{
 			if (itr->second->GetPlayer()->GetInstanceID() == (int32)instanceid)
-				itr->second->SendPacket(packet);
+				broadcast.Send(itr->second);
 		}
 	}
 
@@ -1201,6 +1273,26 @@ void World::SaveAllPlayers()
 	sLog.outString("Saved %u players.", count);
 }
 
+void World::AddSaveStatistics(uint32 ms, uint32 bytes, uint32 statements)
+{
+	m_saveStatsLock.Acquire();
+	++m_saveCount;
+	m_saveTime += ms;
+	m_saveBytes += bytes;
+	m_saveStatements += statements;
+	m_saveStatsLock.Release();
+}
+
+void World::GetSaveStatistics(uint64 * saves, uint64 * ms, uint64 * bytes, uint64 * statements)
+{
+	m_saveStatsLock.Acquire();
+	*saves = m_saveCount;
+	*ms = m_saveTime;
+	*bytes = m_saveBytes;
+	*statements = m_saveStatements;
+	m_saveStatsLock.Release();
+}
+
 WorldSession* World::FindSessionByName(const char * Name)//case insensetive
 {
 	m_sessionlock.AcquireReadLock();
@@ -1232,6 +1324,15 @@ void World::ShutdownClasses()
 
 	Log.Notice("MailSystem", "~MailSystem()");
 	delete MailSystem::getSingletonPtr();
+
+	if(MapUpdateWorkerPool::getSingletonPtr() != NULL)
+	{
+		Log.Notice("MapUpdateWorkerPool", "~MapUpdateWorkerPool()");
+		delete MapUpdateWorkerPool::getSingletonPtr();
+	}
+
+	Log.Notice("UpdateCompressor", "~UpdateCompressor()");
+	delete UpdateCompressor::getSingletonPtr();
 }
 
 void World::GetStats(uint32 * GMCount, float * AverageLatency)
@@ -1257,11 +1358,23 @@ void World::GetStats(uint32 * GMCount, float * AverageLatency)
 	*GMCount = gm;
 }
 
-void TaskList::AddTask(Task * task)
+Task * TaskList::AddTask(Task * task)
 {
 	queueLock.Acquire();
 	tasks.insert(task);
 	queueLock.Release();
+	return task;
+}
+
+void TaskList::CompleteTask(Task * task)
+{
+	queueLock.Acquire();
+	task->completed = true;
+	for(vector<Task*>::iterator itr = task->dependents.begin(); itr != task->dependents.end(); ++itr)
+		--(*itr)->pending;
+
+	tasks.erase(task);
+	queueLock.Release();
 }
 
 Task * TaskList::GetTask()
@@ -1271,7 +1384,7 @@ Task * TaskList::GetTask()
 	Task* t = 0;
 	for(set<Task*>::iterator itr = tasks.begin(); itr != tasks.end(); ++itr)
 	{
-		if(!(*itr)->in_progress)
+		if(!(*itr)->in_progress && (*itr)->pending == 0)
 		{
 			t = (*itr);
 			t->in_progress = true;
@@ -1365,8 +1478,7 @@ bool TaskExecutor::run()
 			if(t)
 			{
 				t->execute();
-				t->completed = true;
-				starter->RemoveTask(t);
+				starter->CompleteTask(t);
 				delete t;
 			}
 			else
@@ -1415,6 +1527,9 @@ void World::Rehash(bool load)
 	BreathingEnabled = Config.MainConfig.GetBoolDefault("Server", "EnableBreathing", true);
 	SendStatsOnJoin = Config.MainConfig.GetBoolDefault("Server", "SendStatsOnJoin", true);
 	compression_threshold = Config.MainConfig.GetIntDefault("Server", "CompressionThreshold", 1000);
+	map_parallel_region_cells = Config.MainConfig.GetBoolDefault("ParallelMapUpdate", "Enabled", false) ? Config.MainConfig.GetIntDefault("ParallelMapUpdate", "RegionSize", 8) : 0;
+	map_parallel_min_players = Config.MainConfig.GetIntDefault("ParallelMapUpdate", "MinPlayers", 200);
+	creature_idle_update_interval = Config.MainConfig.GetIntDefault("CreatureAI", "IdleUpdateInterval", 1000);
 
 	// load regeneration rates.
 	setRate(RATE_HEALTH,Config.MainConfig.GetFloatDefault("Rates", "Health",1));
@@ -1887,6 +2002,7 @@ bool CharacterLoaderThread::run()
 	pthread_cond_init(&cond,NULL);
 #endif
 	running=true;
+	Database::SetConnectionPriority(DATABASE_PRIORITY_LOW);
 	for(;;)
 	{
 		// Get a single connection to maintain for the whole process.
@@ -1902,7 +2018,7 @@ bool CharacterLoaderThread::run()
 		   WaitForSingleObject will suspend the thread,
 		   and on unix, select will as well. - Burlex
 			*/
-		con->Busy.Release();
+		CharacterDatabase.ReleaseConnection(con);
 #ifdef WIN32
 		WaitForSingleObject(hEvent,LOAD_THREAD_SLEEP*1000);
 #else
@@ -246,11 +246,24 @@ class Task
 {
 	CallbackBase * _cb;
 public:
-	Task(CallbackBase * cb) : _cb(cb), completed(false), in_progress(false) {}
+	Task(CallbackBase * cb) : _cb(cb), completed(false), in_progress(false), pending(0) {}
 	~Task() { delete _cb; }
 	bool completed;
 	bool in_progress;
 	void execute();
+
+	/** The task is not started before dep has completed. Dependencies have to be set up
+	 * before the tasks are handed to the worker threads, completed tasks are deleted.
+	 */
+	void DependsOn(Task * dep)
+	{
+		dep->dependents.push_back(this);
+		++pending;
+	}
+
+	// protected by the queue lock of the task list
+	uint32 pending;
+	vector<Task*> dependents;
 };
 
 struct CharacterLoaderThread : public ThreadBase
@@ -275,7 +288,7 @@ class TaskList
 	Mutex queueLock;
 public:
 	Task * GetTask();
-	void AddTask(Task* task);
+	Task * AddTask(Task* task);
 	void RemoveTask(Task * task)
 	{
 		queueLock.Acquire();
@@ -283,6 +296,10 @@ public:
 		queueLock.Release();
 	}
 
+	/** Removes the task and releases the tasks waiting for it.
+	 */
+	void CompleteTask(Task * task);
+
 	void spawn();
 	void kill();
 
@@ -462,6 +479,17 @@ public:
 
 	void SaveAllPlayers();
 
+	/** Records one periodic character save, called from the map threads.
+	 */
+	void AddSaveStatistics(uint32 ms, uint32 bytes, uint32 statements);
+	void GetSaveStatistics(uint64 * saves, uint64 * ms, uint64 * bytes, uint64 * statements);
+
+	Mutex m_saveStatsLock;
+	uint64 m_saveCount;
+	uint64 m_saveTime;
+	uint64 m_saveBytes;
+	uint64 m_saveStatements;
+
 	string MapPath;
 	string vMapPath;
 	bool UnloadMapFiles;
@@ -483,6 +511,16 @@ public:
 
 	uint32 compression_threshold;
 
+	// continents updated by the region workers, see MapUpdateScheduler.h
+	uint32 map_parallel_region_cells;
+	uint32 map_parallel_min_players;
+
+	// idle creatures without players in range only run their AI this often (ms)
+	uint32 creature_idle_update_interval;
+
+	// results of async queries issued by the world thread (session login, character list)
+	AsyncQueryCompletionQueue queryCompletions;
+
 	void	SetKickAFKPlayerTime(uint32 idletimer){m_KickAFKPlayers=idletimer;}
 	uint32	GetKickAFKPlayerTime(){return m_KickAFKPlayers;}
 
@@ -590,6 +628,7 @@ public:
 	bool m_reqGmForCommands;
 	bool m_lfgForNonLfg;
 	list<SpellEntry*> dummyspells;
+	bool m_rebuildSpellCache;		// --rebuild-spell-cache
 	uint32 m_levelCap;
 	uint32 m_genLevelCap;
 	bool m_limitedNames;
@@ -37,6 +37,9 @@ bool WorldRunnable::run()
 
 	THREAD_TRY_EXECUTION2
 
+	// async queries of the sessions updated here complete on this thread
+	sWorld.queryCompletions.Bind();
+
 	while(ThreadState != THREADSTATE_TERMINATE)
 	{
 		// Provision for pausing this thread.
@@ -74,6 +77,7 @@ bool WorldRunnable::run()
 			diff=now-LastSessionsUpdate;
 		
 		LastSessionsUpdate=now;
+		sWorld.queryCompletions.Process();
 		sWorld.UpdateSessions( diff );
 		
 		now=getMSTime();
@@ -95,6 +99,9 @@ bool WorldRunnable::run()
 		Sleep(WORLD_UPDATE_DELAY-diff);
 	}
 
+	sWorld.queryCompletions.Drain();
+	AsyncQueryCompletionQueue::Unbind();
+
 	THREAD_HANDLE_CRASH2
 	return true;
 }
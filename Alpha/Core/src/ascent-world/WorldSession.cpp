@@ -69,7 +69,7 @@ WorldSession::~WorldSession()
 	WorldPacket *packet;
 
 	while((packet = _recvQueue.Pop()))
-		delete packet;
+		WorldPacketPool::Free(packet);
 
 	for(uint32 x=0;x<8;x++)
 	{
@@ -166,7 +166,7 @@ int WorldSession::Update(uint32 InstanceID)
 			}
 		}
 
-		delete packet;
+		WorldPacketPool::Free(packet);
 
 		if(InstanceID != instanceId)
 		{
@@ -121,6 +121,31 @@ void WorldSocket::OutPacket(uint16 opcode, size_t len, const void* data)
 	}
 }
 
+void WorldSocket::OutPacket(uint16 opcode, SharedBuffer * payload)
+{
+	OUTPACKET_RESULT res;
+	size_t len = payload->GetSize();
+	if( (len + 10) > WORLDSOCKET_SENDBUF_SIZE )
+	{
+		printf("WARNING: Tried to send a packet of %u bytes (which is too large) to a socket. Opcode was: %u (0x%03X)\n", (unsigned int)len, (unsigned int)opcode, (unsigned int)opcode);
+		return;
+	}
+
+	res = _OutPacket(opcode, len, payload->GetData(), payload);
+	if(res == OUTPACKET_RESULT_SUCCESS)
+		return;
+
+	if(res == OUTPACKET_RESULT_NO_ROOM_IN_BUFFER)
+	{
+		/* queue the packet */
+		queueLock.Acquire();
+		WorldPacket * pck = new WorldPacket(opcode, len);
+		if(len) pck->append(payload->GetData(), len);
+		_queue.Push(pck);
+		queueLock.Release();
+	}
+}
+
 void WorldSocket::UpdateQueuedPackets()
 {
 	queueLock.Acquire();
@@ -162,18 +187,31 @@ void WorldSocket::UpdateQueuedPackets()
 	queueLock.Release();
 }
 
-OUTPACKET_RESULT WorldSocket::_OutPacket(uint16 opcode, size_t len, const void* data)
+OUTPACKET_RESULT WorldSocket::_OutPacket(uint16 opcode, size_t len, const void* data, SharedBuffer * payload)
 {
 	bool rv;
 	if(!IsConnected())
 		return OUTPACKET_RESULT_NOT_CONNECTED;
 
 	BurstBegin();
+
+	// shared payloads stay outside the send buffer where the socket supports it, but don't let
+	// them pile up on a stalled client either
+	if( payload != NULL && !CanSendShared(len) )
+		payload = NULL;
+
 	//if((m_writeByteCount + len + 4) >= m_writeBufferSize)
-	if( GetWriteBuffer().GetSpace() < (len+4) )
+	bool overflow = false;
+	if( GetWriteBuffer().GetSpace() < (payload != NULL ? 4 : len + 4) )
 	{
-		BurstEnd();
-		return OUTPACKET_RESULT_NO_ROOM_IN_BUFFER;
+		// the send buffer is full, the packet can still wait behind it as one block so that it
+		// goes out with the next flush instead of the packet queue
+		if( !CanSendShared(len + 4) )
+		{
+			BurstEnd();
+			return OUTPACKET_RESULT_NO_ROOM_IN_BUFFER;
+		}
+		overflow = true;
 	}
 
 	// Packet logger :)
@@ -191,13 +229,27 @@ OUTPACKET_RESULT WorldSocket::_OutPacket(uint16 opcode, size_t len, const void*
 #endif
     _crypt.EncryptFourSend((uint8*)&Header);
 
+	if(overflow)
+	{
+		SharedBuffer * block = SharedBuffer::Create(&Header, 4, data, len);
+		rv = BurstSendShared(block);
+		block->DecRef();
+
+		BurstPush();
+		BurstEnd();
+		return rv ? OUTPACKET_RESULT_SUCCESS : OUTPACKET_RESULT_SOCKET_ERROR;
+	}
+
 	// Pass the header to our send buffer
 	rv = BurstSend((const uint8*)&Header, 4);
 
 	// Pass the rest of the packet to our send buffer (if there is any)
 	if(len > 0 && rv)
 	{
-		rv = BurstSend((const uint8*)data, (uint32)len);
+		if(payload != NULL)
+			rv = BurstSendShared(payload);
+		else
+			rv = BurstSend((const uint8*)data, (uint32)len);
 	}
 
 	if(rv) BurstPush();
@@ -205,6 +257,24 @@ OUTPACKET_RESULT WorldSocket::_OutPacket(uint16 opcode, size_t len, const void*
 	return rv ? OUTPACKET_RESULT_SUCCESS : OUTPACKET_RESULT_SOCKET_ERROR;
 }
 
+void PacketBroadcast::Send(WorldSession * session)
+{
+	WorldSocket * s = session->GetSocket();
+	if(s == NULL || !s->IsConnected())
+		return;
+
+	if(m_packet->size() < WORLDSOCKET_SHARED_PAYLOAD_MIN)
+	{
+		s->SendPacket(m_packet);
+		return;
+	}
+
+	if(m_payload == NULL)
+		m_payload = SharedBuffer::Create(m_packet->contents(), m_packet->size());
+
+	s->OutPacket(m_packet->GetOpcode(), m_payload);
+}
+
 void WorldSocket::OnConnect()
 {
 	sWorld.mAcceptedConnections++;
@@ -562,7 +632,7 @@ void WorldSocket::OnRead()
 			}
 		}
 
-		Packet = new WorldPacket(mOpcode, mSize);
+		Packet = WorldPacketPool::Allocate(mOpcode, mSize);
 		Packet->resize(mSize);
 
 		if(mRemaining > 0)
@@ -581,7 +651,7 @@ void WorldSocket::OnRead()
 		case CMSG_PING:
 			{
 				_HandlePing(Packet);
-				delete Packet;
+				WorldPacketPool::Free(Packet);
 			}break;
 		case CMSG_AUTH_SESSION:
 			{
@@ -590,7 +660,7 @@ void WorldSocket::OnRead()
 		default:
 			{
 				if(mSession) mSession->QueuePacket(Packet);
-				else delete Packet;
+				else WorldPacketPool::Free(Packet);
 			}break;
 		}
 	}
@@ -29,6 +29,9 @@
 #define WORLDSOCKET_SENDBUF_SIZE 131078
 #define WORLDSOCKET_RECVBUF_SIZE 16384
 
+// broadcast payloads smaller than this are copied into each send buffer, a shared reference is not worth it
+#define WORLDSOCKET_SHARED_PAYLOAD_MIN 64
+
 class WorldPacket;
 class SocketHandler;
 class WorldSession;
@@ -52,7 +55,10 @@ public:
 	ASCENT_INLINE void SendPacket(StackBufferBase * packet) { if(!packet) return; OutPacket(packet->GetOpcode(), packet->GetSize(), (packet->GetSize() ? (const void*)packet->GetBufferPointer() : NULL)); }
 
 	void __fastcall OutPacket(uint16 opcode, size_t len, const void* data);
-	OUTPACKET_RESULT __fastcall _OutPacket(uint16 opcode, size_t len, const void* data);
+	OUTPACKET_RESULT __fastcall _OutPacket(uint16 opcode, size_t len, const void* data, SharedBuffer * payload = NULL);
+
+	// Only the header is encrypted and buffered, the payload is referenced by the socket until it is sent.
+	void __fastcall OutPacket(uint16 opcode, SharedBuffer * payload);
    
 	ASCENT_INLINE uint32 GetLatency() { return _latency; }
 
@@ -98,6 +104,22 @@ private:
 	string * m_fullAccountName;
 };
 
+/** Sends one packet to many sessions. The first socket that gets it copies the payload
+ * into a shared buffer, all others only encrypt their own header and reference it.
+ */
+class SERVER_DECL PacketBroadcast
+{
+public:
+	PacketBroadcast(WorldPacket * packet) : m_packet(packet), m_payload(NULL) {}
+	~PacketBroadcast() { if(m_payload != NULL) m_payload->DecRef(); }
+
+	void __fastcall Send(WorldSession * session);
+
+private:
+	WorldPacket * m_packet;
+	SharedBuffer * m_payload;
+};
+
 #endif
 
 static inline void FastGUIDPack(ByteBuffer & buf, const uint64 & oldguid)
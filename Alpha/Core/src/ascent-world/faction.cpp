@@ -41,36 +41,9 @@ bool isHostile(Object* objA, Object* objB)// B is hostile for A?
 	if(objB->GetTypeId() == TYPEID_CORPSE)
 		return false;
 
-	uint32 faction = objB->m_faction->Mask;
-	uint32 host = objA->m_faction->HostileMask;
-
-	/*if( faction != 0 )
-	{*/
-		if(faction & host)
-		{
-			hostile = true;
-		}
-	/*}
-	else
-	{
-		// default to true
+	// masks and enemy/friend lists
+	if(GetFactionRelation(objA->m_faction, objB->m_faction) & FACTION_RELATION_HOSTILE)
 		hostile = true;
-	}*/
-
-	// check friend/enemy list
-	for(uint32 i = 0; i < 4; i++)
-	{
-		if(objA->m_faction->EnemyFactions[i] == objB->m_faction->Faction)
-		{
-			hostile = true;
-			break;
-		}
-		if(objA->m_faction->FriendlyFactions[i] == objB->m_faction->Faction)
-		{
-			hostile = false;
-			break;
-		}
-	}
 
 	// PvP Flag System Checks
 	// We check this after the normal isHostile test, that way if we're
@@ -337,30 +310,7 @@ bool isCombatSupport(Object* objA, Object* objB)// B combat supports A?
 	if( objA->IsPet() || objB->IsPet() ) // fixes an issue where horde pets would chain aggro horde guards and vice versa for alliance.
 		return false;
 
-	bool combatSupport = false;
-
-	uint32 fSupport = objB->m_faction->FriendlyMask;
-	uint32 myFaction = objA->m_faction->Mask;
-
-	if(myFaction & fSupport)
-	{
-		combatSupport = true;
-	}
-	// check friend/enemy list
-	for(uint32 i = 0; i < 4; i++)
-	{
-		if(objB->m_faction->EnemyFactions[i] == objA->m_faction->Faction)
-		{
-			combatSupport = false;
-			break;
-		}
-		if(objB->m_faction->FriendlyFactions[i] == objA->m_faction->Faction)
-		{
-			combatSupport = true;
-			break;
-		}
-	}
-	return combatSupport;
+	return (GetFactionRelation(objA->m_faction, objB->m_faction) & FACTION_RELATION_SUPPORT) ? true : false;
 }
 
 
@@ -1953,7 +1953,7 @@ int luaUnit_GetClosestPlayer(lua_State * L, Unit * ptr)
 	float dist, d2;
 	Player * ret=NULL;
 
-	for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+	for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 	{
 		d2=(*itr)->GetDistanceSq(ptr);
 		if(!ret||d2<dist)
@@ -1987,7 +1987,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 			uint32 r = RandomUInt(count-1);
 			count=0;
 
-			for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+			for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 			{
 				if (count==r)
 				{
@@ -2001,7 +2001,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 	case RANDOM_IN_SHORTRANGE:
 		{
 			uint32 count = 0;
-			for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+			for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 			{
 				Player* obj = (Player*)(*itr);
 				if (obj && obj->CalcDistance(obj,ptr)<=8)
@@ -2011,7 +2011,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 			{
 				uint32 r = RandomUInt(count-1);
 				count=0;
-				for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+				for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 				{
 					Player* obj = (Player*)(*itr);
 					if (obj && obj->CalcDistance(obj,ptr)<=8 && count==r)
@@ -2027,7 +2027,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 	case RANDOM_IN_MIDRANGE:
 		{
 			uint32 count = 0;
-			for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+			for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 			{
 				Player* obj = (Player*)(*itr);
 				if (!obj)
@@ -2040,7 +2040,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 			{
 				uint32 r = RandomUInt(count-1);
 				count=0;
-				for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+				for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 				{
 					Player* obj = (Player*)(*itr);
 					if (!obj)
@@ -2059,7 +2059,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 	case RANDOM_IN_LONGRANGE:
 		{
 			uint32 count = 0;
-			for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+			for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 			{
 				Player* obj = (Player*)(*itr);
 				if (obj && obj->CalcDistance(obj,ptr)>=20)
@@ -2069,7 +2069,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 			{
 				uint32 r = RandomUInt(count-1);
 				count=0;
-				for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+				for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 				{
 					Player* obj = (Player*)(*itr);
 					if (obj && obj->CalcDistance(obj,ptr)>=20 && count==r)
@@ -2085,7 +2085,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 	case RANDOM_WITH_MANA:
 		{
 			uint32 count = 0;
-			for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+			for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 			{
 				Player* obj = (Player*)(*itr);
 				if (obj && obj->GetPowerType() == POWER_TYPE_MANA)
@@ -2095,7 +2095,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 			{
 				uint32 r = RandomUInt(count-1);
 				count=0;
-				for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+				for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 				{
 					Player* obj = (Player*)(*itr);
 					if (obj && obj->GetPowerType() == POWER_TYPE_MANA && count==r)
@@ -2111,7 +2111,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 	case RANDOM_WITH_ENERGY:
 		{
 			uint32 count = 0;
-			for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+			for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 			{
 				Player* obj = (Player*)(*itr);
 				if (obj && obj->GetPowerType() == POWER_TYPE_ENERGY)
@@ -2121,7 +2121,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 			{
 				uint32 r = RandomUInt(count-1);
 				count=0;
-				for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+				for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 				{
 					Player* obj = (Player*)(*itr);
 					if (obj && obj->GetPowerType() == POWER_TYPE_ENERGY && count==r)
@@ -2137,7 +2137,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 	case RANDOM_WITH_RAGE:
 		{
 			uint32 count = 0;
-			for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+			for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 			{
 				Player* obj = (Player*)(*itr);
 				if (obj && obj->GetPowerType() == POWER_TYPE_RAGE)
@@ -2147,7 +2147,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 			{
 				uint32 r = RandomUInt(count-1);
 				count=0;
-				for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+				for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 				{
 					Player* obj = (Player*)(*itr);
 					if (obj && obj->GetPowerType() == POWER_TYPE_RAGE && count==r)
@@ -2167,7 +2167,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 			if (mt == NULL || !mt->IsPlayer())
 				return 0;
 
-			for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+			for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 			{
 				Player* obj = (Player*)(*itr);
 				if (obj != mt)
@@ -2177,7 +2177,7 @@ int luaUnit_GetRandomPlayer(lua_State * L, Unit * ptr)
 			{
 				uint32 r = RandomUInt(count-1);
 				count=0;
-				for(set<Player*>::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
+				for(Object::InRangePlayerSet::iterator itr = ptr->GetInRangePlayerSetBegin(); itr != ptr->GetInRangePlayerSetEnd(); ++itr)
 				{
 					Player* obj = (Player*)(*itr);
 					if (obj && obj != mt && count==r)
@@ -2207,7 +2207,7 @@ int luaUnit_GetRandomFriend(lua_State * L, Unit * ptr)
 	Unit * ret=NULL;
 	uint32 count = 0;
 
-	for(set<Object*>::iterator itr = ptr->GetInRangeSetBegin(); itr != ptr->GetInRangeSetEnd(); ++itr)
+	for(Object::InRangeSet::iterator itr = ptr->GetInRangeSetBegin(); itr != ptr->GetInRangeSetEnd(); ++itr)
 	{
 		Object* obj = (Object*)(*itr);
 		if (obj->IsUnit() && isFriendly(obj,ptr))
@@ -2218,7 +2218,7 @@ int luaUnit_GetRandomFriend(lua_State * L, Unit * ptr)
 	{
 		uint32 r = RandomUInt(count-1);
 		count=0;
-		for(set<Object*>::iterator itr = ptr->GetInRangeSetBegin(); itr != ptr->GetInRangeSetEnd(); ++itr)
+		for(Object::InRangeSet::iterator itr = ptr->GetInRangeSetBegin(); itr != ptr->GetInRangeSetEnd(); ++itr)
 		{
 			Object* obj = (Object*)(*itr);
 			if (obj->IsUnit() && isFriendly(obj,ptr) && count==r)
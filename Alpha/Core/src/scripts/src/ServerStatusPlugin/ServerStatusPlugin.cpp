@@ -367,6 +367,47 @@ void StatDumper::DumpStats()
         fprintf(f, "    <peakcount>%u</peakcount>\n", (unsigned int)sWorld.PeakSessionCount);
 		fprintf(f, "    <wdbquerysize>%u</wdbquerysize>\n", WorldDatabase.GetQueueSize());
 		fprintf(f, "    <cdbquerysize>%u</cdbquerysize>\n", CharacterDatabase.GetQueueSize());
+
+		static const char * db_tags[2] = { "wdb", "cdb" };
+		Database * dbs[2] = { &WorldDatabase, &CharacterDatabase };
+		for(uint32 i = 0; i < 2; ++i)
+		{
+			uint64 checkouts, waits, wait_time;
+			dbs[i]->GetPoolStatistics(&checkouts, &waits, &wait_time);
+			fprintf(f, "    <%scheckouts>%u</%scheckouts>\n", db_tags[i], (unsigned int)checkouts, db_tags[i]);
+			fprintf(f, "    <%swaits>%u</%swaits>\n", db_tags[i], (unsigned int)waits, db_tags[i]);
+			fprintf(f, "    <%swaittime>%u</%swaittime>\n", db_tags[i], (unsigned int)wait_time, db_tags[i]);
+			for(int32 j = 0; j < dbs[i]->GetConnectionCount(); ++j)
+			{
+				DatabaseConnection * con = dbs[i]->GetConnection(j);
+				fprintf(f, "    <%sconnection id=\"%d\" queries=\"%u\" checkouts=\"%u\" holdtime=\"%u\" />\n", db_tags[i], j,
+					(unsigned int)con->Queries, (unsigned int)con->Checkouts, (unsigned int)con->HoldTime);
+			}
+		}
+
+		uint64 packets, bytes_in, bytes_out, usecs;
+		sUpdateCompressor.GetStatistics(&packets, &bytes_in, &bytes_out, &usecs);
+		fprintf(f, "    <updpackets>%u</updpackets>\n", (unsigned int)packets);
+		fprintf(f, "    <updbytes>%u</updbytes>\n", packets ? (unsigned int)(bytes_out / packets) : 0);
+		fprintf(f, "    <updratio>%.3f</updratio>\n", bytes_in ? (float)bytes_out / (float)bytes_in : 0.0f);
+		fprintf(f, "    <updtime>%.1f</updtime>\n", packets ? (float)usecs / (float)packets : 0.0f);
+
+		uint64 saves, save_time, save_bytes, save_statements;
+		sWorld.GetSaveStatistics(&saves, &save_time, &save_bytes, &save_statements);
+		fprintf(f, "    <saves>%u</saves>\n", (unsigned int)saves);
+		fprintf(f, "    <savetime>%u</savetime>\n", (unsigned int)save_time);
+		fprintf(f, "    <savebytes>%u</savebytes>\n", (unsigned int)save_bytes);
+		fprintf(f, "    <savestatements>%u</savestatements>\n", (unsigned int)save_statements);
+
+		uint64 allocs, hits, misses;
+		WorldPacketPool::GetStatistics(&allocs, &hits, &misses);
+		fprintf(f, "    <pckallocs>%u</pckallocs>\n", (unsigned int)allocs);
+		fprintf(f, "    <pckhits>%u</pckhits>\n", (unsigned int)hits);
+		fprintf(f, "    <pckmisses>%u</pckmisses>\n", (unsigned int)misses);
+#ifdef CONFIG_USE_EPOLL
+		fprintf(f, "    <sendpackets>%u</sendpackets>\n", (unsigned int)sSocketMgr.GetSentPackets());
+		fprintf(f, "    <sendsyscalls>%u</sendsyscalls>\n", (unsigned int)sSocketMgr.GetSendSyscalls());
+#endif
     }
     fprintf(f, "  </status>\n");
 	static const char * race_names[RACE_DRAENEI+1] = {